@@ -0,0 +1,172 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Packs a directory of assets into one file for MountAssetPack. Every file
+// under the directory becomes an entry named by its path relative to the
+// directory, so after MountAssetPack("data.pack", "data") the game loads
+// "data/sprites/hero.tga" from the pack. Entries are deflated unless their
+// extension is in the store list or they don't shrink. Files are added in
+// sorted order, the same directory gives the same pack byte for byte.
+//
+// Usage: asset_pack_builder [--out data.pack] [--level 0-10]
+//                           [--align bytes] [--store ogg,wav,png]
+//                           directory
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "engine/arctic_platform.h"
+#include "engine/asset_pack.h"
+#include "engine/easy.h"
+
+using namespace arctic;  // NOLINT
+
+namespace {
+
+std::vector<std::string> ParseList(const char *text) {
+  std::vector<std::string> items;
+  std::string item;
+  for (const char *p = text; ; ++p) {
+    if (*p == ',' || *p == 0) {
+      if (!item.empty()) {
+        items.push_back(item);
+      }
+      item.clear();
+      if (!*p) {
+        break;
+      }
+    } else {
+      item.push_back(*p);
+    }
+  }
+  return items;
+}
+
+bool IsStoredExtension(const std::string &name,
+    const std::vector<std::string> &store_extensions) {
+  size_t dot = name.rfind('.');
+  if (dot == std::string::npos || name.find('/', dot) != std::string::npos) {
+    return false;
+  }
+  const char *extension = name.c_str() + dot + 1;
+  for (const std::string &stored : store_extensions) {
+    if (StrCaseCmp(extension, stored.c_str()) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AddDirectory(const std::string &path, const std::string &prefix,
+    const std::vector<std::string> &store_extensions,
+    AssetPackWriter *writer) {
+  std::vector<DirectoryEntry> entries;
+  if (!GetDirectoryEntries(path.c_str(), &entries)) {
+    return false;
+  }
+  std::sort(entries.begin(), entries.end(),
+    [](const DirectoryEntry &a, const DirectoryEntry &b) {
+      return a.title < b.title;
+    });
+  for (const DirectoryEntry &entry : entries) {
+    if (entry.title == "." || entry.title == "..") {
+      continue;
+    }
+    std::string file_name = GluePath(path.c_str(), entry.title.c_str());
+    std::string name = prefix + entry.title;
+    if (entry.is_directory == kTrivalentTrue) {
+      if (!AddDirectory(file_name, name + "/", store_extensions, writer)) {
+        return false;
+      }
+    } else if (entry.is_file == kTrivalentTrue) {
+      writer->AddFile(file_name, name,
+        !IsStoredExtension(name, store_extensions));
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const char *out_path = "data.pack";
+  const char *directory = nullptr;
+  Si32 level = 6;
+  Ui32 alignment = 16;
+  std::vector<std::string> store_extensions = {"ogg", "png", "jpg", "jpeg",
+    "zip", "pack"};
+  bool is_usage_ok = true;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--out") == 0 && has_value) {
+      out_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--level") == 0 && has_value) {
+      level = static_cast<Si32>(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--align") == 0 && has_value) {
+      alignment = static_cast<Ui32>(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--store") == 0 && has_value) {
+      store_extensions = ParseList(argv[++i]);
+    } else if (argv[i][0] != '-' && !directory) {
+      directory = argv[i];
+    } else {
+      is_usage_ok = false;
+    }
+  }
+  if (!is_usage_ok || !directory || level < 0 || level > 10 ||
+      alignment < 16 || (alignment & (alignment - 1))) {
+    fprintf(stderr, "Usage: %s [--out file] [--level 0-10] [--align bytes]"
+      " [--store extensions] directory\n"
+      "Alignment is a power of two from 16, files with the comma separated"
+      " store extensions are never deflated.\n", argv[0]);
+    return 2;
+  }
+
+  StartLogger();
+  HeadlessPlatformInit();
+
+  auto start = std::chrono::steady_clock::now();
+  AssetPackWriter writer;
+  bool is_saved = AddDirectory(directory, "", store_extensions, &writer) &&
+    writer.Save(out_path, level, alignment);
+  double wall = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  if (is_saved) {
+    printf("%llu files, %llu bytes packed into %llu bytes (%.1f%%)"
+      " in %.3f s\n",
+      static_cast<unsigned long long>(writer.GetEntryCount()),
+      static_cast<unsigned long long>(writer.GetRawSize()),
+      static_cast<unsigned long long>(writer.GetPackSize()),
+      100.0 * static_cast<double>(writer.GetPackSize()) /
+        static_cast<double>(std::max<Ui64>(writer.GetRawSize(), 1)),
+      wall);
+  } else {
+    fprintf(stderr, "Can't pack %s into %s\n", directory, out_path);
+  }
+
+  StopLogger();
+  return is_saved ? 0 : 1;
+}
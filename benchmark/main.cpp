@@ -28,7 +28,9 @@
 #include "engine/gl_texture2d.h"
 #include "engine/mesh.h"
 #include "engine/opengl.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <string>
 #include <vector>
 
 using namespace arctic;  // NOLINT
@@ -787,6 +789,29 @@ void TestFontDrawEmptyPaletteCrash() {
               "empty palette without crashing.\n");
 }
 
+// Measures the logger thread end-to-end: messages are enqueued from the main
+// thread and StopLogger() waits until the last batch is written to log.txt.
+void BenchmarkLogger() {
+  const Si32 kMessageCount = 200000;
+  const std::string message =
+    "Logger benchmark message with some typical payload, frame 12345, x: 1.5";
+  StopLogger();
+  StartLogger();
+  auto start = std::chrono::steady_clock::now();
+  for (Si32 i = 0; i < kMessageCount; ++i) {
+    Log(message.c_str());
+  }
+  StopLogger();
+  double seconds = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  StartLogger();
+  double bytes = static_cast<double>(kMessageCount) *
+    static_cast<double>(message.size() + 2);
+  std::printf("[logger      ] %d messages in %.3f s: %.0f messages/s, %.2f MB/s\n",
+    kMessageCount, seconds, kMessageCount / seconds,
+    bytes / seconds / (1024.0 * 1024.0));
+}
+
 void EasyMain() {
   SetVSync(false);
   g_prev_time = Time();
@@ -803,6 +828,10 @@ void EasyMain() {
   TestFontDrawEmptyPaletteCrash();
   std::printf("-----------------------------\n");
 
+  std::printf("--- logger throughput ---\n");
+  BenchmarkLogger();
+  std::printf("-------------------------\n");
+
   Init();
 
   // GL context is ready after Init() -- run GL bug reproduction tests.
@@ -36,6 +36,7 @@
 #include "engine/mtq_mpsc_vinfarr.h"
 #include "engine/mtq_spmc_array.h"
 #include "engine/mtq_mpmc_befsbfsp_allocator.h"
+#include "engine/profiler.h"
 #include "engine/sound_handle.h"
 #include "engine/sound_task.h"
 #include "engine/arctic_pi.h"
@@ -329,6 +330,7 @@ struct SoundMixerState {
   /// @param tmp Temporary buffer for processing
   template <class T>
   void MixSound(T *mix_l, T *mix_r, Si32 mix_stride, Si32 buffer_samples_per_channel, Si16 *tmp) {
+    ARCTIC_PROFILE_SCOPE("MixSound");
     InputTasksToMixerThread();
     float master_volume_16 = static_cast<float>(
       this->master_volume.load() / 32767.0);
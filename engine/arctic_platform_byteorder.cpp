@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/arctic_platform_byteorder.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARCTIC_BYTEORDER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ARCTIC_BYTEORDER_NEON
+#endif
+
+namespace arctic {
+
+static inline Ui16 SwapValue(Ui16 x) {
+  return static_cast<Ui16>((x >> 8) | (x << 8));
+}
+
+static inline Ui32 SwapValue(Ui32 x) {
+  return (x >> 24) | ((x >> 8) & 0xff00u) | ((x << 8) & 0xff0000u) | (x << 24);
+}
+
+static inline Ui64 SwapValue(Ui64 x) {
+  return (static_cast<Ui64>(SwapValue(static_cast<Ui32>(x))) << 32) |
+    SwapValue(static_cast<Ui32>(x >> 32));
+}
+
+// Handles the elements left after the 16-byte blocks
+template <typename T>
+static void ReverseBytesScalar(Ui8 *data, Ui64 count) {
+  for (Ui64 i = 0; i < count; ++i) {
+    T x;
+    std::memcpy(&x, data + i * sizeof(T), sizeof(T));
+    x = SwapValue(x);
+    std::memcpy(data + i * sizeof(T), &x, sizeof(T));
+  }
+}
+
+#if defined(ARCTIC_BYTEORDER_SSE2)
+// SSE2 has no byte shuffle: 16-bit words are reordered with shuffles and
+// the bytes of each word are swapped with shifts
+static inline __m128i SwapWordBytes(__m128i v) {
+  return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+#endif
+
+void ReverseBytes16(void *data, Ui64 count) {
+  Ui8 *bytes = static_cast<Ui8*>(data);
+  Ui64 i = 0;
+#if defined(ARCTIC_BYTEORDER_SSE2)
+  for (; i + 8 <= count; i += 8) {
+    __m128i *block = reinterpret_cast<__m128i*>(bytes + i * 2);
+    _mm_storeu_si128(block, SwapWordBytes(_mm_loadu_si128(block)));
+  }
+#elif defined(ARCTIC_BYTEORDER_NEON)
+  for (; i + 8 <= count; i += 8) {
+    vst1q_u8(bytes + i * 2, vrev16q_u8(vld1q_u8(bytes + i * 2)));
+  }
+#endif
+  ReverseBytesScalar<Ui16>(bytes + i * 2, count - i);
+}
+
+void ReverseBytes32(void *data, Ui64 count) {
+  Ui8 *bytes = static_cast<Ui8*>(data);
+  Ui64 i = 0;
+#if defined(ARCTIC_BYTEORDER_SSE2)
+  for (; i + 4 <= count; i += 4) {
+    __m128i *block = reinterpret_cast<__m128i*>(bytes + i * 4);
+    __m128i v = _mm_loadu_si128(block);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    _mm_storeu_si128(block, SwapWordBytes(v));
+  }
+#elif defined(ARCTIC_BYTEORDER_NEON)
+  for (; i + 4 <= count; i += 4) {
+    vst1q_u8(bytes + i * 4, vrev32q_u8(vld1q_u8(bytes + i * 4)));
+  }
+#endif
+  ReverseBytesScalar<Ui32>(bytes + i * 4, count - i);
+}
+
+void ReverseBytes64(void *data, Ui64 count) {
+  Ui8 *bytes = static_cast<Ui8*>(data);
+  Ui64 i = 0;
+#if defined(ARCTIC_BYTEORDER_SSE2)
+  for (; i + 2 <= count; i += 2) {
+    __m128i *block = reinterpret_cast<__m128i*>(bytes + i * 8);
+    __m128i v = _mm_loadu_si128(block);
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    _mm_storeu_si128(block, SwapWordBytes(v));
+  }
+#elif defined(ARCTIC_BYTEORDER_NEON)
+  for (; i + 2 <= count; i += 2) {
+    vst1q_u8(bytes + i * 8, vrev64q_u8(vld1q_u8(bytes + i * 8)));
+  }
+#endif
+  ReverseBytesScalar<Ui64>(bytes + i * 8, count - i);
+}
+
+void ReverseBytes(void *data, Ui64 count, Ui64 element_size) {
+  switch (element_size) {
+    case 2:
+      ReverseBytes16(data, count);
+      break;
+    case 4:
+      ReverseBytes32(data, count);
+      break;
+    case 8:
+      ReverseBytes64(data, count);
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace arctic
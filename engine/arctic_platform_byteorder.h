@@ -58,6 +58,38 @@ Ui32 ToBe(Ui32 x);
 /// @copydoc ToBe()
 Si32 ToBe(Si32 x);
 
+/// @brief Byte order of binary data
+enum ByteOrder {
+  kByteOrderLittleEndian = 0,
+  kByteOrderBigEndian = 1
+};
+
+/// @brief Returns the byte order of the cpu
+inline ByteOrder GetHostByteOrder() {
+  const Ui16 probe = 1;
+  return *reinterpret_cast<const Ui8*>(&probe) ? kByteOrderLittleEndian
+                                              : kByteOrderBigEndian;
+}
+
+/// @brief Reverses the byte order of each 16-bit element of an array
+/// @param [in,out] data The array, needs no alignment
+/// @param [in] count Number of elements
+void ReverseBytes16(void *data, Ui64 count);
+
+/// @brief Reverses the byte order of each 32-bit element of an array
+/// @copydetails ReverseBytes16()
+void ReverseBytes32(void *data, Ui64 count);
+
+/// @brief Reverses the byte order of each 64-bit element of an array
+/// @copydetails ReverseBytes16()
+void ReverseBytes64(void *data, Ui64 count);
+
+/// @brief Reverses the byte order of each element of an array
+/// @param [in,out] data The array, needs no alignment
+/// @param [in] count Number of elements
+/// @param [in] element_size 2, 4 or 8, arrays of other sizes are left as is
+void ReverseBytes(void *data, Ui64 count, Ui64 element_size);
+
 /// @}
 
 }  // namespace arctic
@@ -32,14 +32,40 @@
 #include "engine/arctic_platform_tcpip.h"
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netdb.h>
+#include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define ARCTIC_SOCKET_POLLER_EPOLL
+#else
+#include <poll.h>
+#endif  // defined(__linux__)
+
+#if defined(__linux__)
+#define ARCTIC_DATAGRAM_MMSG
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif  // UDP_SEGMENT
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif  // UDP_GRO
+#ifndef SOL_UDP
+#define SOL_UDP IPPROTO_UDP
+#endif  // SOL_UDP
+#endif  // defined(__linux__)
+
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <string>
+#include <vector>
 
 namespace arctic {
 
@@ -193,6 +219,103 @@ ConnectionSocket::~ConnectionSocket() {
   return SocketResult::kSocketOk;
 }
 
+static const size_t kSocketBufferChunk = 64;
+
+[[nodiscard]] SocketResult ConnectionSocket::ReadVector(
+    const SocketBuffer *buffers, size_t count, size_t *out_size) {
+  if (!out_size) {
+    last_error_ = "Error: out_size argument of ReadVector is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_size = 0;
+  if (handle_.nix == -1) {
+    return SocketResult::kSocketError;
+  }
+  iovec vec[kSocketBufferChunk];
+  count = std::min(count, kSocketBufferChunk);
+  for (size_t idx = 0; idx < count; ++idx) {
+    vec[idx].iov_base = buffers[idx].data;
+    vec[idx].iov_len = buffers[idx].size;
+  }
+  ssize_t result = readv(handle_.nix, vec, static_cast<int>(count));
+  if (result == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+      return SocketResult::kSocketOk;
+    }
+    int saved_errno = errno;
+    last_error_ = "OS failed to read from socket, ";
+    char buff[100];
+    snprintf(buff, sizeof(buff), "error code: %d, ", saved_errno);
+    last_error_.append(buff);
+    last_error_.append(std::strerror(saved_errno));
+    close(handle_.nix);
+    handle_.nix = -1;
+    if (saved_errno == ECONNRESET) {
+      return SocketResult::kSocketConnectionReset;
+    }
+    return SocketResult::kSocketError;
+  }
+  if (result == 0) {
+    bool is_empty_request = true;
+    for (size_t idx = 0; idx < count; ++idx) {
+      is_empty_request = is_empty_request && vec[idx].iov_len == 0;
+    }
+    if (is_empty_request) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "Recv returned with code 0, the connection is gracefully closed.";
+    close(handle_.nix);
+    handle_.nix = -1;
+    return SocketResult::kSocketConnectionReset;
+  }
+  *out_size = static_cast<size_t>(result);
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult ConnectionSocket::WriteVector(
+    const SocketBuffer *buffers, size_t count, size_t *out_size) {
+  if (!out_size) {
+    last_error_ = "Error: out_size argument of WriteVector is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_size = 0;
+  if (handle_.nix == -1) {
+    return SocketResult::kSocketError;
+  }
+  iovec vec[kSocketBufferChunk];
+  count = std::min(count, kSocketBufferChunk);
+  for (size_t idx = 0; idx < count; ++idx) {
+    vec[idx].iov_base = buffers[idx].data;
+    vec[idx].iov_len = buffers[idx].size;
+  }
+  // sendmsg is writev with flags, MSG_NOSIGNAL keeps a closed peer from
+  // raising SIGPIPE just like in Write
+  msghdr header;
+  memset(&header, 0, sizeof(header));
+  header.msg_iov = vec;
+  header.msg_iovlen = count;
+  ssize_t result = sendmsg(handle_.nix, &header, MSG_NOSIGNAL);
+  if (result == -1) {
+    if (errno == EAGAIN || errno == EINTR || errno == EWOULDBLOCK) {
+      return SocketResult::kSocketOk;
+    }
+    int saved_errno = errno;
+    last_error_ = "OS failed to write to socket ";
+    char buff[100];
+    snprintf(buff, sizeof(buff), "error code: %d, ", saved_errno);
+    last_error_.append(buff);
+    last_error_.append(std::strerror(saved_errno));
+    close(handle_.nix);
+    handle_.nix = -1;
+    if (saved_errno == ECONNRESET) {
+      return SocketResult::kSocketConnectionReset;
+    }
+    return SocketResult::kSocketError;
+  }
+  *out_size = static_cast<size_t>(result);
+  return SocketResult::kSocketOk;
+}
+
 template <typename Value>
 [[nodiscard]] inline SocketResult setsockopt(SocketHandle handle, int level,
     int pName, Value value, std::string* out_last_error) {
@@ -492,6 +615,784 @@ ListenerSocket::ListenerSocket(ListenerSocket&& rhs) noexcept {
   last_error_ = std::move(rhs.last_error_);
 }
 
+uint16_t ListenerSocket::GetLocalPort() const {
+  sockaddr_storage address{};
+  socklen_t size = sizeof(address);
+  if (handle_.nix == -1 ||
+      getsockname(handle_.nix, reinterpret_cast<sockaddr*>(&address),
+        &size) == -1) {
+    return 0;
+  }
+  if (address.ss_family == AF_INET) {
+    return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+  }
+  if (address.ss_family == AF_INET6) {
+    return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+  }
+  return 0;
+}
+
+static_assert(sizeof(SocketAddress::data) >= sizeof(sockaddr_in6),
+  "SocketAddress is too small for sockaddr_in6");
+
+bool SocketAddress::Resolve(const std::string &host, uint16_t port,
+    AddressFamily family) {
+  char port_buffer[8];
+  snprintf(port_buffer, sizeof(port_buffer), "%d", port);
+  addrinfo hints{};
+  hints.ai_family = family == AddressFamily::kIpV4 ? AF_INET : AF_INET6;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_protocol = IPPROTO_UDP;
+  addrinfo *res = nullptr;
+  if (getaddrinfo(host.c_str(), port_buffer, &hints, &res) != 0 || !res) {
+    size = 0;
+    return false;
+  }
+  bool is_ok = res->ai_addrlen <= sizeof(data);
+  if (is_ok) {
+    memset(data, 0, sizeof(data));
+    memcpy(data, res->ai_addr, res->ai_addrlen);
+    size = static_cast<uint32_t>(res->ai_addrlen);
+  }
+  freeaddrinfo(res);
+  return is_ok;
+}
+
+std::string SocketAddress::GetIp() const {
+  char text[INET6_ADDRSTRLEN] = {0};
+  const sockaddr *address = reinterpret_cast<const sockaddr*>(data);
+  if (size == 0) {
+    return std::string();
+  }
+  if (address->sa_family == AF_INET) {
+    inet_ntop(AF_INET,
+      &reinterpret_cast<const sockaddr_in*>(data)->sin_addr,
+      text, sizeof(text));
+  } else if (address->sa_family == AF_INET6) {
+    inet_ntop(AF_INET6,
+      &reinterpret_cast<const sockaddr_in6*>(data)->sin6_addr,
+      text, sizeof(text));
+  }
+  return std::string(text);
+}
+
+uint16_t SocketAddress::GetPort() const {
+  const sockaddr *address = reinterpret_cast<const sockaddr*>(data);
+  if (size == 0) {
+    return 0;
+  }
+  if (address->sa_family == AF_INET) {
+    return ntohs(reinterpret_cast<const sockaddr_in*>(data)->sin_port);
+  }
+  if (address->sa_family == AF_INET6) {
+    return ntohs(reinterpret_cast<const sockaddr_in6*>(data)->sin6_port);
+  }
+  return 0;
+}
+
+bool SocketAddress::operator==(const SocketAddress &rhs) const {
+  return size == rhs.size && memcmp(data, rhs.data, size) == 0;
+}
+
+DatagramSocket::DatagramSocket() {
+  handle_.nix = -1;
+}
+
+DatagramSocket::DatagramSocket(AddressFamily family) {
+  int result = socket(family == AddressFamily::kIpV4 ? AF_INET : AF_INET6,
+    SOCK_DGRAM, IPPROTO_UDP);
+  if (result == -1) {
+    handle_.nix = -1;
+    last_error_ = "OS failed to create socket ";
+    last_error_.append(std::strerror(errno));
+    return;
+  }
+  handle_.nix = result;
+}
+
+DatagramSocket::DatagramSocket(DatagramSocket&& rhs) noexcept {
+  handle_.nix = rhs.handle_.nix;
+  rhs.handle_.nix = -1;
+  is_gro_enabled_ = rhs.is_gro_enabled_;
+  last_error_ = std::move(rhs.last_error_);
+}
+
+DatagramSocket::~DatagramSocket() {
+  if (handle_.nix != -1) {
+    close(handle_.nix);
+  }
+}
+
+DatagramSocket& DatagramSocket::operator=(DatagramSocket&& rhs) noexcept {
+  if (this != &rhs) {
+    if (handle_.nix != -1) {
+      close(handle_.nix);
+    }
+    handle_.nix = rhs.handle_.nix;
+    rhs.handle_.nix = -1;
+    is_gro_enabled_ = rhs.is_gro_enabled_;
+    last_error_ = std::move(rhs.last_error_);
+  }
+  return *this;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::Bind(const std::string address,
+    uint16_t port) {
+  sockaddr_storage local{};
+  socklen_t local_size = sizeof(local);
+  getsockname(handle_.nix, reinterpret_cast<sockaddr*>(&local), &local_size);
+  SocketAddress bind_address;
+  if (!bind_address.Resolve(address, port, local.ss_family == AF_INET6 ?
+      AddressFamily::kIpV6 : AddressFamily::kIpV4)) {
+    last_error_ = "OS failed to resolve address " + address;
+    return SocketResult::kSocketError;
+  }
+  if (::bind(handle_.nix, reinterpret_cast<sockaddr*>(bind_address.data),
+      bind_address.size) == -1) {
+    last_error_ = "OS failed to bind datagram socket ";
+    last_error_.append(std::strerror(errno));
+    return SocketResult::kSocketError;
+  }
+  return SocketResult::kSocketOk;
+}
+
+uint16_t DatagramSocket::GetLocalPort() const {
+  SocketAddress address;
+  socklen_t size = sizeof(address.data);
+  if (handle_.nix == -1 || getsockname(handle_.nix,
+      reinterpret_cast<sockaddr*>(address.data), &size) == -1) {
+    return 0;
+  }
+  address.size = size;
+  return address.GetPort();
+}
+
+static bool IsDatagramWouldBlock(int error) {
+  return error == EAGAIN || error == EWOULDBLOCK || error == EINTR;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SendTo(
+    const SocketAddress &address, const void *buffer, size_t length,
+    size_t *out_size) {
+  if (!out_size) {
+    last_error_ = "Error: out_size argument of SendTo is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_size = 0;
+  auto result = sendto(handle_.nix, buffer, length, MSG_NOSIGNAL,
+    reinterpret_cast<const sockaddr*>(address.data), address.size);
+  if (result == -1) {
+    if (IsDatagramWouldBlock(errno)) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "OS failed to send datagram ";
+    last_error_.append(std::strerror(errno));
+    return SocketResult::kSocketError;
+  }
+  *out_size = static_cast<size_t>(result);
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::ReceiveFrom(void *buffer,
+    size_t length, SocketAddress *out_address, size_t *out_size) {
+  if (!out_size || !out_address) {
+    last_error_ = "Error: out argument of ReceiveFrom is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_size = 0;
+  socklen_t size = sizeof(out_address->data);
+  auto result = recvfrom(handle_.nix, buffer, length, 0,
+    reinterpret_cast<sockaddr*>(out_address->data), &size);
+  if (result == -1) {
+    out_address->size = 0;
+    if (IsDatagramWouldBlock(errno)) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "OS failed to receive datagram ";
+    last_error_.append(std::strerror(errno));
+    return SocketResult::kSocketError;
+  }
+  out_address->size = size;
+  *out_size = static_cast<size_t>(result);
+  return SocketResult::kSocketOk;
+}
+
+#ifdef ARCTIC_DATAGRAM_MMSG
+
+// Messages per system call, the headers live on the stack
+static const size_t kDatagramChunk = 64;
+
+[[nodiscard]] SocketResult DatagramSocket::SendBatch(
+    const DatagramPacket *packets, size_t count, size_t *out_sent) {
+  if (!out_sent) {
+    last_error_ = "Error: out_sent argument of SendBatch is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  mmsghdr messages[kDatagramChunk];
+  iovec vectors[kDatagramChunk];
+  SocketResult status = SocketResult::kSocketOk;
+  size_t sent = 0;
+  while (sent < count) {
+    size_t chunk = std::min(kDatagramChunk, count - sent);
+    for (size_t idx = 0; idx < chunk; ++idx) {
+      const DatagramPacket &packet = packets[sent + idx];
+      vectors[idx].iov_base = packet.data;
+      vectors[idx].iov_len = packet.size;
+      messages[idx] = mmsghdr{};
+      messages[idx].msg_hdr.msg_name =
+        const_cast<uint8_t*>(packet.address.data);
+      messages[idx].msg_hdr.msg_namelen = packet.address.size;
+      messages[idx].msg_hdr.msg_iov = &vectors[idx];
+      messages[idx].msg_hdr.msg_iovlen = 1;
+    }
+    int result = sendmmsg(handle_.nix, messages,
+      static_cast<unsigned int>(chunk), MSG_NOSIGNAL);
+    if (result == -1) {
+      if (IsDatagramWouldBlock(errno)) {
+        break;
+      }
+      // The first message failed, drop it and go on with the rest
+      last_error_ = "OS failed to send datagram ";
+      last_error_.append(std::strerror(errno));
+      status = SocketResult::kSocketError;
+      result = 1;
+    }
+    sent += static_cast<size_t>(result);
+  }
+  *out_sent = sent;
+  return status;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::ReceiveBatch(
+    DatagramPacket *packets, size_t count, size_t *out_received) {
+  if (!out_received) {
+    last_error_ = "Error: out_received argument of ReceiveBatch is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_received = 0;
+  mmsghdr messages[kDatagramChunk];
+  iovec vectors[kDatagramChunk];
+  union Control {
+    char buffer[CMSG_SPACE(sizeof(int))];
+    cmsghdr align;
+  };
+  Control controls[kDatagramChunk];
+  size_t received = 0;
+  while (received < count) {
+    size_t chunk = std::min(kDatagramChunk, count - received);
+    for (size_t idx = 0; idx < chunk; ++idx) {
+      DatagramPacket &packet = packets[received + idx];
+      vectors[idx].iov_base = packet.data;
+      vectors[idx].iov_len = packet.capacity;
+      messages[idx] = mmsghdr{};
+      messages[idx].msg_hdr.msg_name = packet.address.data;
+      messages[idx].msg_hdr.msg_namelen = sizeof(packet.address.data);
+      messages[idx].msg_hdr.msg_iov = &vectors[idx];
+      messages[idx].msg_hdr.msg_iovlen = 1;
+      if (is_gro_enabled_) {
+        messages[idx].msg_hdr.msg_control = controls[idx].buffer;
+        messages[idx].msg_hdr.msg_controllen = sizeof(controls[idx].buffer);
+      }
+    }
+    // Only the very first datagram may be waited for
+    int result = recvmmsg(handle_.nix, messages,
+      static_cast<unsigned int>(chunk),
+      received ? MSG_DONTWAIT : MSG_WAITFORONE, nullptr);
+    if (result == -1) {
+      if (IsDatagramWouldBlock(errno) || received) {
+        break;
+      }
+      last_error_ = "OS failed to receive datagrams ";
+      last_error_.append(std::strerror(errno));
+      return SocketResult::kSocketError;
+    }
+    for (size_t idx = 0; idx < static_cast<size_t>(result); ++idx) {
+      DatagramPacket &packet = packets[received + idx];
+      const msghdr &header = messages[idx].msg_hdr;
+      packet.address.size = header.msg_namelen;
+      packet.size = messages[idx].msg_len;
+      packet.is_truncated = (header.msg_flags & MSG_TRUNC) != 0;
+      packet.segment_size = 0;
+      for (cmsghdr *cmsg = is_gro_enabled_ ?
+            CMSG_FIRSTHDR(&messages[idx].msg_hdr) : nullptr;
+          cmsg; cmsg = CMSG_NXTHDR(&messages[idx].msg_hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+          int segment_size = 0;
+          memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+          if (static_cast<size_t>(segment_size) < packet.size) {
+            packet.segment_size = static_cast<uint16_t>(segment_size);
+          }
+        }
+      }
+    }
+    received += static_cast<size_t>(result);
+    if (static_cast<size_t>(result) < chunk) {
+      break;
+    }
+  }
+  *out_received = received;
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetUdpSegmentSize(uint16_t size) {
+  return setsockopt(handle_, SOL_UDP, UDP_SEGMENT, static_cast<int>(size),
+    &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetUdpGro(bool flag) {
+  SocketResult result = setsockopt(handle_, SOL_UDP, UDP_GRO,
+    static_cast<int>(flag), &last_error_);
+  if (result == SocketResult::kSocketOk) {
+    is_gro_enabled_ = flag;
+  }
+  return result;
+}
+
+#else  // ARCTIC_DATAGRAM_MMSG
+
+[[nodiscard]] SocketResult DatagramSocket::SendBatch(
+    const DatagramPacket *packets, size_t count, size_t *out_sent) {
+  if (!out_sent) {
+    last_error_ = "Error: out_sent argument of SendBatch is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  SocketResult status = SocketResult::kSocketOk;
+  size_t sent = 0;
+  for (; sent < count; ++sent) {
+    const DatagramPacket &packet = packets[sent];
+    auto result = sendto(handle_.nix, packet.data, packet.size, MSG_NOSIGNAL,
+      reinterpret_cast<const sockaddr*>(packet.address.data),
+      packet.address.size);
+    if (result == -1) {
+      if (IsDatagramWouldBlock(errno)) {
+        break;
+      }
+      last_error_ = "OS failed to send datagram ";
+      last_error_.append(std::strerror(errno));
+      status = SocketResult::kSocketError;
+    }
+  }
+  *out_sent = sent;
+  return status;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::ReceiveBatch(
+    DatagramPacket *packets, size_t count, size_t *out_received) {
+  if (!out_received) {
+    last_error_ = "Error: out_received argument of ReceiveBatch is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  size_t received = 0;
+  for (; received < count; ++received) {
+    DatagramPacket &packet = packets[received];
+    socklen_t size = sizeof(packet.address.data);
+    // Only the very first datagram may be waited for
+    auto result = recvfrom(handle_.nix, packet.data, packet.capacity,
+      received ? MSG_DONTWAIT | MSG_TRUNC : MSG_TRUNC,
+      reinterpret_cast<sockaddr*>(packet.address.data), &size);
+    if (result == -1) {
+      if (IsDatagramWouldBlock(errno) || received) {
+        break;
+      }
+      *out_received = 0;
+      last_error_ = "OS failed to receive datagrams ";
+      last_error_.append(std::strerror(errno));
+      return SocketResult::kSocketError;
+    }
+    packet.address.size = size;
+    packet.is_truncated = static_cast<size_t>(result) > packet.capacity;
+    packet.size = std::min(static_cast<size_t>(result), packet.capacity);
+    packet.segment_size = 0;
+  }
+  *out_received = received;
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetUdpSegmentSize(uint16_t size) {
+  last_error_ = "Error: UDP segmentation offload is not supported.";
+  return SocketResult::kSocketError;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetUdpGro(bool flag) {
+  last_error_ = "Error: UDP receive offload is not supported.";
+  return SocketResult::kSocketError;
+}
+
+#endif  // ARCTIC_DATAGRAM_MMSG
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoBroadcast(bool flag) {
+  return setsockopt(handle_, SOL_SOCKET, SO_BROADCAST,
+      static_cast<int>(flag), &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoReuseAddress(bool flag) {
+  return setsockopt(handle_, SOL_SOCKET, SO_REUSEADDR,
+      static_cast<int>(flag), &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoSendBufferSize(int size) {
+  return setsockopt(handle_, SOL_SOCKET, SO_SNDBUF, size, &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoReceiveBufferSize(int size) {
+  return setsockopt(handle_, SOL_SOCKET, SO_RCVBUF, size, &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoNonblocking(bool flag) {
+  int flags = fcntl(handle_.nix, F_GETFL, 0);
+  auto result = fcntl(handle_.nix, F_SETFL,
+      flag ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+  if (result == -1) {
+    last_error_ = "OS failed to set O_NONBLOCK socket ";
+    last_error_.append(std::strerror(errno));
+    return SocketResult::kSocketError;
+  }
+  return SocketResult::kSocketOk;
+}
+
+bool DatagramSocket::IsValid() const {
+  return handle_.nix != -1;
+}
+
+enum SocketPollerOperation {
+  kSocketPollerAdd = 0,
+  kSocketPollerModify = 1,
+  kSocketPollerRemove = 2
+};
+
+#ifdef ARCTIC_SOCKET_POLLER_EPOLL
+
+struct SocketPoller::Impl {
+  int epoll_fd = -1;
+  int wake_fd = -1;
+  std::vector<uint64_t> token_by_fd;
+  std::vector<epoll_event> ready;
+};
+
+SocketPoller::SocketPoller() : impl_(new Impl) {
+  impl_->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  impl_->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (impl_->epoll_fd == -1 || impl_->wake_fd == -1) {
+    last_error_ = "OS failed to create epoll ";
+    last_error_.append(std::strerror(errno));
+    return;
+  }
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLET;
+  event.data.fd = impl_->wake_fd;
+  epoll_ctl(impl_->epoll_fd, EPOLL_CTL_ADD, impl_->wake_fd, &event);
+}
+
+SocketPoller::~SocketPoller() {
+  if (impl_->epoll_fd != -1) {
+    close(impl_->epoll_fd);
+  }
+  if (impl_->wake_fd != -1) {
+    close(impl_->wake_fd);
+  }
+}
+
+bool SocketPoller::IsValid() const {
+  return impl_->epoll_fd != -1 && impl_->wake_fd != -1;
+}
+
+SocketResult SocketPoller::Control(SocketHandle handle, uint32_t events,
+    uint64_t token, int operation) {
+  if (handle.nix == -1 || !IsValid()) {
+    last_error_ = "Error: invalid socket or poller.";
+    return SocketResult::kSocketError;
+  }
+  epoll_event event{};
+  event.events = EPOLLET | EPOLLRDHUP |
+    ((events & kSocketEventRead) ? EPOLLIN : 0u) |
+    ((events & kSocketEventWrite) ? EPOLLOUT : 0u);
+  event.data.fd = handle.nix;
+  int op = operation == kSocketPollerAdd ? EPOLL_CTL_ADD :
+    (operation == kSocketPollerModify ? EPOLL_CTL_MOD : EPOLL_CTL_DEL);
+  if (epoll_ctl(impl_->epoll_fd, op, handle.nix, &event) == -1) {
+    last_error_ = "OS failed to change epoll set ";
+    last_error_.append(std::strerror(errno));
+    return SocketResult::kSocketError;
+  }
+  if (operation != kSocketPollerRemove) {
+    if (impl_->token_by_fd.size() <= static_cast<size_t>(handle.nix)) {
+      impl_->token_by_fd.resize(static_cast<size_t>(handle.nix) + 1);
+    }
+    impl_->token_by_fd[static_cast<size_t>(handle.nix)] = token;
+  }
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult SocketPoller::Wait(SocketEvent *out_events,
+    size_t max_events, int32_t timeout_ms, size_t *out_count) {
+  if (!out_count) {
+    last_error_ = "Error: out_count argument of Wait is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_count = 0;
+  if (!IsValid() || max_events == 0) {
+    return SocketResult::kSocketError;
+  }
+  if (impl_->ready.size() < max_events) {
+    impl_->ready.resize(max_events);
+  }
+  int count = epoll_wait(impl_->epoll_fd, impl_->ready.data(),
+    static_cast<int>(max_events), timeout_ms);
+  if (count == -1) {
+    if (errno == EINTR) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "OS failed to wait for epoll events ";
+    last_error_.append(std::strerror(errno));
+    return SocketResult::kSocketError;
+  }
+  size_t out_idx = 0;
+  for (int idx = 0; idx < count; ++idx) {
+    const epoll_event &event = impl_->ready[static_cast<size_t>(idx)];
+    if (event.data.fd == impl_->wake_fd) {
+      uint64_t value;
+      ssize_t result = read(impl_->wake_fd, &value, sizeof(value));
+      (void)result;
+      continue;
+    }
+    uint32_t flags = 0;
+    if (event.events & EPOLLIN) {
+      flags |= kSocketEventRead;
+    }
+    if (event.events & EPOLLOUT) {
+      flags |= kSocketEventWrite;
+    }
+    if (event.events & (EPOLLHUP | EPOLLRDHUP)) {
+      flags |= kSocketEventHangup;
+    }
+    if (event.events & EPOLLERR) {
+      flags |= kSocketEventError;
+    }
+    out_events[out_idx].token =
+      impl_->token_by_fd[static_cast<size_t>(event.data.fd)];
+    out_events[out_idx].events = flags;
+    ++out_idx;
+  }
+  *out_count = out_idx;
+  return SocketResult::kSocketOk;
+}
+
+void SocketPoller::Wake() {
+  uint64_t value = 1;
+  ssize_t result = write(impl_->wake_fd, &value, sizeof(value));
+  (void)result;
+}
+
+#else  // ARCTIC_SOCKET_POLLER_EPOLL
+
+struct SocketPoller::Impl {
+  int wake_pipe[2] = {-1, -1};
+  // Index 0 is the wake pipe
+  std::vector<pollfd> fds;
+  std::vector<uint64_t> tokens;
+  std::vector<int> index_by_fd;
+  size_t next_start = 1;
+};
+
+SocketPoller::SocketPoller() : impl_(new Impl) {
+  if (pipe(impl_->wake_pipe) == -1) {
+    impl_->wake_pipe[0] = -1;
+    impl_->wake_pipe[1] = -1;
+    last_error_ = "OS failed to create a pipe ";
+    last_error_.append(std::strerror(errno));
+    return;
+  }
+  for (int fd : impl_->wake_pipe) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  }
+  impl_->fds.push_back(pollfd{impl_->wake_pipe[0], POLLIN, 0});
+  impl_->tokens.push_back(0);
+}
+
+SocketPoller::~SocketPoller() {
+  for (int fd : impl_->wake_pipe) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+}
+
+bool SocketPoller::IsValid() const {
+  return impl_->wake_pipe[0] != -1;
+}
+
+SocketResult SocketPoller::Control(SocketHandle handle, uint32_t events,
+    uint64_t token, int operation) {
+  if (handle.nix == -1 || !IsValid()) {
+    last_error_ = "Error: invalid socket or poller.";
+    return SocketResult::kSocketError;
+  }
+  Impl &impl = *impl_;
+  size_t fd = static_cast<size_t>(handle.nix);
+  if (impl.index_by_fd.size() <= fd) {
+    impl.index_by_fd.resize(fd + 1, -1);
+  }
+  int index = impl.index_by_fd[fd];
+  if (operation == kSocketPollerRemove) {
+    if (index < 0) {
+      last_error_ = "Error: the socket is not registered.";
+      return SocketResult::kSocketError;
+    }
+    size_t last = impl.fds.size() - 1;
+    impl.fds[static_cast<size_t>(index)] = impl.fds[last];
+    impl.tokens[static_cast<size_t>(index)] = impl.tokens[last];
+    impl.index_by_fd[static_cast<size_t>(impl.fds[last].fd)] = index;
+    impl.fds.pop_back();
+    impl.tokens.pop_back();
+    impl.index_by_fd[fd] = -1;
+    return SocketResult::kSocketOk;
+  }
+  // A closed and reused descriptor is registered again in place
+  if (index < 0) {
+    if (operation == kSocketPollerModify) {
+      last_error_ = "Error: the socket is not registered.";
+      return SocketResult::kSocketError;
+    }
+    index = static_cast<int>(impl.fds.size());
+    impl.index_by_fd[fd] = index;
+    impl.fds.push_back(pollfd{handle.nix, 0, 0});
+    impl.tokens.push_back(0);
+  }
+  short poll_events = 0;
+  if (events & kSocketEventRead) {
+    poll_events |= POLLIN;
+  }
+  if (events & kSocketEventWrite) {
+    poll_events |= POLLOUT;
+  }
+  impl.fds[static_cast<size_t>(index)].events = poll_events;
+  impl.tokens[static_cast<size_t>(index)] = token;
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult SocketPoller::Wait(SocketEvent *out_events,
+    size_t max_events, int32_t timeout_ms, size_t *out_count) {
+  if (!out_count) {
+    last_error_ = "Error: out_count argument of Wait is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_count = 0;
+  if (!IsValid() || max_events == 0) {
+    return SocketResult::kSocketError;
+  }
+  Impl &impl = *impl_;
+  int count = poll(impl.fds.data(), static_cast<nfds_t>(impl.fds.size()),
+    timeout_ms);
+  if (count == -1) {
+    if (errno == EINTR) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "OS failed to poll ";
+    last_error_.append(std::strerror(errno));
+    return SocketResult::kSocketError;
+  }
+  if (impl.fds[0].revents) {
+    char buffer[64];
+    while (read(impl.wake_pipe[0], buffer, sizeof(buffer)) > 0) {
+    }
+  }
+  // Starts where the previous call stopped so that no socket starves
+  size_t out_idx = 0;
+  size_t socket_count = impl.fds.size() - 1;
+  if (impl.next_start > socket_count) {
+    impl.next_start = 1;
+  }
+  for (size_t step = 0; step < socket_count && out_idx < max_events;
+      ++step) {
+    size_t idx = 1 + (impl.next_start - 1 + step) % socket_count;
+    short revents = impl.fds[idx].revents;
+    if (!revents) {
+      continue;
+    }
+    impl.fds[idx].revents = 0;
+    if (revents & POLLNVAL) {
+      // Closed by a failed Read or Write, dropped after the loop
+      impl.fds[idx].events = 0;
+      impl.tokens[idx] = ~0ull;
+      continue;
+    }
+    uint32_t flags = 0;
+    if (revents & POLLIN) {
+      flags |= kSocketEventRead;
+    }
+    if (revents & POLLOUT) {
+      flags |= kSocketEventWrite;
+    }
+    if (revents & POLLHUP) {
+      flags |= kSocketEventHangup;
+    }
+    if (revents & POLLERR) {
+      flags |= kSocketEventError;
+    }
+    out_events[out_idx].token = impl.tokens[idx];
+    out_events[out_idx].events = flags;
+    ++out_idx;
+    impl.next_start = idx + 1;
+  }
+  for (size_t idx = impl.fds.size(); idx-- > 1;) {
+    if (impl.fds[idx].events == 0 && impl.tokens[idx] == ~0ull) {
+      SocketHandle handle;
+      handle.nix = impl.fds[idx].fd;
+      Control(handle, 0, 0, kSocketPollerRemove);
+    }
+  }
+  *out_count = out_idx;
+  return SocketResult::kSocketOk;
+}
+
+void SocketPoller::Wake() {
+  char value = 1;
+  ssize_t result = write(impl_->wake_pipe[1], &value, 1);
+  (void)result;
+}
+
+#endif  // ARCTIC_SOCKET_POLLER_EPOLL
+
+[[nodiscard]] SocketResult SocketPoller::Add(const ConnectionSocket &socket,
+    uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerAdd);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Add(const ListenerSocket &socket,
+    uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerAdd);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Modify(
+    const ConnectionSocket &socket, uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerModify);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Remove(
+    const ConnectionSocket &socket) {
+  return Control(socket.handle_, 0, 0, kSocketPollerRemove);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Remove(
+    const ListenerSocket &socket) {
+  return Control(socket.handle_, 0, 0, kSocketPollerRemove);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Add(const DatagramSocket &socket,
+    uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerAdd);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Modify(
+    const DatagramSocket &socket, uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerModify);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Remove(
+    const DatagramSocket &socket) {
+  return Control(socket.handle_, 0, 0, kSocketPollerRemove);
+}
+
 }  // namespace arctic
 
 #endif  // defined(ARCTIC_PLATFORM_PI)|| defined(ARCTIC_PLATFORM_MACOSX) ||defined(ARCTIC_PLATFORM_WEB)
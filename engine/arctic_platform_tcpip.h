@@ -30,8 +30,10 @@
 #include <cstdint>
 
 // exceptions
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 //
 
 namespace arctic {
@@ -73,6 +75,12 @@ struct SocketHandle {
   };
 };
 
+/// @brief A memory region for scatter/gather socket operations.
+struct SocketBuffer {
+  char *data = nullptr;
+  size_t size = 0;
+};
+
 /// @brief A socket for sending and receiving data.
 class ConnectionSocket {
  public:
@@ -84,6 +92,7 @@ class ConnectionSocket {
   /// @param handle The socket handle representing an existing socket
   explicit ConnectionSocket(SocketHandle handle) {
     handle_ = handle;
+    state_ = SocketState::kConnected;
   }
   ConnectionSocket(const ConnectionSocket& other) = delete;
   ConnectionSocket(ConnectionSocket&& rhs) noexcept;
@@ -130,6 +139,24 @@ class ConnectionSocket {
     return Write(container.data(), container.size());
   }
 
+  /// @brief Read data from the socket into several buffers with one call,
+  /// at most 64 buffers are filled per call
+  /// @param buffers The buffers to fill, in order
+  /// @param count The number of buffers
+  /// @param out_size Pointer to store the total number of bytes read
+  /// @return The result of the read operation
+  [[nodiscard]] SocketResult ReadVector(const SocketBuffer *buffers,
+      size_t count, size_t *out_size);
+
+  /// @brief Write data from several buffers to the socket with one call,
+  /// at most 64 buffers are sent per call
+  /// @param buffers The buffers to write, in order, they are not modified
+  /// @param count The number of buffers
+  /// @param out_size Pointer to store the total number of bytes written
+  /// @return The result of the write operation
+  [[nodiscard]] SocketResult WriteVector(const SocketBuffer *buffers,
+      size_t count, size_t *out_size);
+
   // Config Functions
   /// @brief Set TCP_NODELAY option, disables Nagle's algorithm, reducing latency. 
   /// @param flag True to enable, false to disable 
@@ -210,6 +237,8 @@ class ConnectionSocket {
   void UpdateConnectionInProgressState();
 
  protected:
+  friend class SocketPoller;
+
   SocketHandle handle_;
   SocketState state_;
   std::string last_error_;
@@ -241,6 +270,10 @@ class ListenerSocket {
   /// @return A ConnectionSocket object representing the new connection
   ConnectionSocket Accept() const;
 
+  /// @brief Get the port the socket is bound to, useful after binding to port 0
+  /// @return The port or 0 if the socket is not bound
+  uint16_t GetLocalPort() const;
+
   /// @brief Set SO_REUSEADDR option. This option allows binding to an address that is in a TIME_WAIT state.
   /// @param flag True to enable, false to disable
   /// @return The result of the operation
@@ -272,7 +305,308 @@ class ListenerSocket {
   }
 
  protected:
+  friend class SocketPoller;
+
+  SocketHandle handle_;
+  std::string last_error_;
+};
+
+/// @brief An IPv4 or IPv6 address with a port, stored as a raw sockaddr.
+struct SocketAddress {
+  /// @brief Resolve a host name or a numeric address
+  /// @param host The host name or the IP address
+  /// @param port The port
+  /// @param family The address family to resolve to
+  /// @return True on success
+  bool Resolve(const std::string &host, uint16_t port,
+      AddressFamily family = AddressFamily::kIpV4);
+
+  /// @brief Get the numeric IP address, an empty string if not set
+  std::string GetIp() const;
+
+  /// @brief Get the port, 0 if not set
+  uint16_t GetPort() const;
+
+  bool operator==(const SocketAddress &rhs) const;
+  bool operator!=(const SocketAddress &rhs) const {
+    return !(*this == rhs);
+  }
+
+  /// Large enough for sockaddr_in6
+  alignas(8) uint8_t data[28] = {};
+  /// Number of meaningful bytes in data, 0 for an unset address
+  uint32_t size = 0;
+};
+
+/// @brief A datagram with its peer address, see DatagramPacketPool.
+struct DatagramPacket {
+  SocketAddress address; ///< The source or the destination.
+  uint8_t *data = nullptr; ///< The payload.
+  size_t size = 0; ///< Payload bytes.
+  size_t capacity = 0; ///< Bytes available at data.
+  /// Set by ReceiveBatch with GRO enabled when data holds several datagrams
+  /// of segment_size bytes each (the last one may be shorter), otherwise 0.
+  uint16_t segment_size = 0;
+  bool is_truncated = false; ///< The datagram did not fit into capacity.
+};
+
+/// @brief Packets with preallocated buffers in one block of memory.
+/// The same pool can be passed to ReceiveBatch over and over, so a
+/// receive loop does not allocate.
+class DatagramPacketPool {
+ public:
+  /// @param packet_count The number of packets
+  /// @param packet_capacity The buffer size of each packet, 1500 fits a
+  /// typical MTU, up to 65535 is useful with GRO
+  explicit DatagramPacketPool(size_t packet_count,
+      size_t packet_capacity = 1500)
+      : storage_(packet_count * packet_capacity)
+      , packets_(packet_count) {
+    for (size_t idx = 0; idx < packet_count; ++idx) {
+      packets_[idx].data = storage_.data() + idx * packet_capacity;
+      packets_[idx].capacity = packet_capacity;
+    }
+  }
+
+  DatagramPacket &operator[](size_t idx) {
+    return packets_[idx];
+  }
+
+  DatagramPacket *GetPackets() {
+    return packets_.data();
+  }
+
+  size_t GetCount() const {
+    return packets_.size();
+  }
+
+ private:
+  std::vector<uint8_t> storage_;
+  std::vector<DatagramPacket> packets_;
+};
+
+/// @brief A UDP socket that sends and receives datagrams with peer
+/// addresses.
+///
+/// Batch calls use sendmmsg/recvmmsg on Linux, so a whole batch costs a
+/// single system call, other platforms loop over the packets. Unlike
+/// ConnectionSocket the socket is never closed by a failed operation, an
+/// error concerns one datagram or one peer.
+class DatagramSocket {
+ public:
+  DatagramSocket();
+  /// @param family The address family (IPv4 or IPv6)
+  explicit DatagramSocket(AddressFamily family);
+  DatagramSocket(const DatagramSocket& other) = delete;
+  DatagramSocket(DatagramSocket&& rhs) noexcept;
+  ~DatagramSocket();
+  DatagramSocket& operator=(const DatagramSocket& rhs) = delete;
+  DatagramSocket& operator=(DatagramSocket&& rhs) noexcept;
+
+  /// @brief Bind the socket to a local address and port
+  /// @param address The address to bind to, "0.0.0.0" or "::" for any
+  /// @param port The port to bind to, 0 to pick a free one
+  /// @return The result of the bind operation
+  [[nodiscard]] SocketResult Bind(const std::string address, uint16_t port);
+
+  /// @brief Get the port the socket is bound to
+  /// @return The port or 0 if the socket is not bound
+  uint16_t GetLocalPort() const;
+
+  /// @brief Send a datagram
+  /// @param address The destination
+  /// @param buffer The payload
+  /// @param length The payload size in bytes
+  /// @param out_size Pointer to store the number of bytes sent, 0 if the
+  /// non-blocking socket would block
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult SendTo(const SocketAddress &address,
+      const void *buffer, size_t length, size_t *out_size);
+
+  /// @brief Receive a datagram
+  /// @param buffer The buffer to receive into
+  /// @param length The buffer size, the rest of a longer datagram is lost
+  /// @param out_address Pointer to store the source address
+  /// @param out_size Pointer to store the datagram size, 0 if the
+  /// non-blocking socket has nothing to read
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult ReceiveFrom(void *buffer, size_t length,
+      SocketAddress *out_address, size_t *out_size);
+
+  /// @brief Send several datagrams
+  /// @param packets The packets, address, data and size are used
+  /// @param count The number of packets
+  /// @param out_sent Pointer to store the number of packets processed from
+  /// the front. Fewer than count means the non-blocking socket would block.
+  /// Packets that fail for other reasons are counted and dropped.
+  /// @return kSocketError if any packet was dropped
+  [[nodiscard]] SocketResult SendBatch(const DatagramPacket *packets,
+      size_t count, size_t *out_sent);
+
+  /// @brief Receive up to count datagrams without waiting for more than
+  /// the first one
+  /// @param packets The packets with data and capacity set, for example
+  /// from DatagramPacketPool
+  /// @param count The number of packets
+  /// @param out_received Pointer to store the number of packets filled
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult ReceiveBatch(DatagramPacket *packets,
+      size_t count, size_t *out_received);
+
+  /// @brief Let the kernel split a send into datagrams of size bytes each
+  /// (UDP GSO), so one SendTo of n * size bytes sends n datagrams.
+  /// Linux only.
+  /// @param size The datagram size, 0 to disable
+  /// @return The result of the operation, kSocketError if unsupported
+  [[nodiscard]] SocketResult SetUdpSegmentSize(uint16_t size);
+
+  /// @brief Let the kernel coalesce datagrams of one flow into a single
+  /// ReceiveBatch packet (UDP GRO), see DatagramPacket::segment_size.
+  /// Linux only, ReceiveFrom does not report segment sizes.
+  /// @param flag True to enable, false to disable
+  /// @return The result of the operation, kSocketError if unsupported
+  [[nodiscard]] SocketResult SetUdpGro(bool flag);
+
+  /// @brief Set SO_BROADCAST option, allows sending packets to all hosts on
+  /// the network.
+  /// @param flag True to enable, false to disable
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult SetSoBroadcast(bool flag);
+
+  /// @brief Set SO_REUSEADDR option, allows several sockets to bind to the
+  /// same port.
+  /// @param flag True to enable, false to disable
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult SetSoReuseAddress(bool flag);
+
+  /// @brief Set SO_SNDBUF option, specifies the size of the send buffer.
+  /// @param size The send buffer size in bytes
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult SetSoSendBufferSize(int size);
+
+  /// @brief Set SO_RCVBUF option, specifies the size of the receive buffer.
+  /// A larger buffer drops fewer datagrams under bursts.
+  /// @param size The receive buffer size in bytes
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult SetSoReceiveBufferSize(int size);
+
+  /// @brief Set socket to non-blocking mode.
+  /// @param flag True to enable non-blocking, false for blocking
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult SetSoNonblocking(bool flag);
+
+  /// @brief Check if the socket is valid.
+  /// @return True if the socket is valid, false otherwise
+  bool IsValid() const;
+
+  /// @brief Get the last error message. The last error message is set when
+  /// an operation fails.
+  /// @return The last error message as a string
+  std::string GetLastError() const {
+    return last_error_;
+  }
+
+ protected:
+  friend class SocketPoller;
+
   SocketHandle handle_;
+  bool is_gro_enabled_ = false;
+  std::string last_error_;
+};
+
+/// @brief Readiness flags of the SocketPoller interest masks and events.
+enum SocketEventFlags : uint32_t {
+  kSocketEventRead = 1, ///< Data can be read or a connection can be accepted.
+  kSocketEventWrite = 2, ///< Data can be written.
+  kSocketEventHangup = 4, ///< The remote host closed the connection.
+  kSocketEventError = 8 ///< The socket failed or was closed.
+};
+
+/// @brief A readiness event returned by SocketPoller::Wait.
+struct SocketEvent {
+  uint64_t token; ///< The token the socket was registered with.
+  uint32_t events; ///< A combination of SocketEventFlags.
+};
+
+/// @brief Waits for readiness of many sockets at once.
+///
+/// Sockets are registered with an interest mask and a token, Wait returns
+/// the tokens of the ready sockets in a batch. Linux uses edge-triggered
+/// epoll, so a socket is reported again only after new data arrives; other
+/// platforms use level-triggered poll. Reading or writing until the
+/// operation returns 0 bytes works with both.
+/// All calls but Wake must come from one thread, usually a dedicated
+/// network thread. Sockets closed by a failed Read or Write are dropped
+/// automatically, other sockets must be removed before they are closed.
+class SocketPoller {
+ public:
+  SocketPoller();
+  SocketPoller(const SocketPoller& other) = delete;
+  SocketPoller& operator=(const SocketPoller& rhs) = delete;
+  ~SocketPoller();
+
+  /// @brief Register a socket
+  /// @param socket The socket, non-blocking mode is recommended
+  /// @param events The interest mask, kSocketEventRead and kSocketEventWrite
+  /// @param token The value returned in the events of the socket
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult Add(const ConnectionSocket &socket,
+      uint32_t events, uint64_t token);
+
+  /// @brief Register a listener, it is readable when a connection can be accepted
+  [[nodiscard]] SocketResult Add(const ListenerSocket &socket,
+      uint32_t events, uint64_t token);
+
+  /// @brief Register a datagram socket
+  [[nodiscard]] SocketResult Add(const DatagramSocket &socket,
+      uint32_t events, uint64_t token);
+
+  /// @brief Change the interest mask and the token of a registered socket
+  [[nodiscard]] SocketResult Modify(const ConnectionSocket &socket,
+      uint32_t events, uint64_t token);
+
+  /// @brief Change the interest mask and the token of a datagram socket
+  [[nodiscard]] SocketResult Modify(const DatagramSocket &socket,
+      uint32_t events, uint64_t token);
+
+  /// @brief Unregister a socket
+  [[nodiscard]] SocketResult Remove(const ConnectionSocket &socket);
+
+  /// @brief Unregister a listener
+  [[nodiscard]] SocketResult Remove(const ListenerSocket &socket);
+
+  /// @brief Unregister a datagram socket
+  [[nodiscard]] SocketResult Remove(const DatagramSocket &socket);
+
+  /// @brief Wait for events
+  /// @param out_events The array to store the events in
+  /// @param max_events The size of the array
+  /// @param timeout_ms Milliseconds to wait, 0 to return at once, -1 to wait
+  /// until an event or a Wake call
+  /// @param out_count Pointer to store the number of events
+  /// @return The result of the operation
+  [[nodiscard]] SocketResult Wait(SocketEvent *out_events, size_t max_events,
+      int32_t timeout_ms, size_t *out_count);
+
+  /// @brief Make a Wait call in progress or the next one return early.
+  /// Can be called from any thread.
+  void Wake();
+
+  /// @brief Check if the poller was created successfully
+  bool IsValid() const;
+
+  /// @brief Get the last error message
+  std::string GetLastError() const {
+    return last_error_;
+  }
+
+ private:
+  struct Impl;
+
+  SocketResult Control(SocketHandle handle, uint32_t events, uint64_t token,
+      int operation);
+
+  std::unique_ptr<Impl> impl_;
   std::string last_error_;
 };
 
@@ -31,7 +31,10 @@
 #include "engine/arctic_platform_tcpip.h"
 #include <WinSock2.h>
 #include <WS2tcpip.h>
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace arctic {
 
@@ -136,6 +139,82 @@ ConnectionSocket::~ConnectionSocket() {
   return SocketResult::kSocketOk;
 }
 
+static const size_t kSocketBufferChunk = 64;
+
+[[nodiscard]] SocketResult ConnectionSocket::ReadVector(
+    const SocketBuffer *buffers, size_t count, size_t *out_size) {
+  if (!out_size) {
+    last_error_ = "Error: out_size argument of ReadVector is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_size = 0;
+  WSABUF vec[kSocketBufferChunk];
+  if (count > kSocketBufferChunk) {
+    count = kSocketBufferChunk;
+  }
+  bool is_empty_request = true;
+  for (size_t idx = 0; idx < count; ++idx) {
+    vec[idx].buf = buffers[idx].data;
+    vec[idx].len = static_cast<ULONG>(buffers[idx].size);
+    is_empty_request = is_empty_request && buffers[idx].size == 0;
+  }
+  DWORD received = 0;
+  DWORD flags = 0;
+  int res = WSARecv((SOCKET)handle_.win, vec, static_cast<DWORD>(count),
+      &received, &flags, nullptr, nullptr);
+  if (res == SOCKET_ERROR) {
+    int error = WSAGetLastError();
+    if (error == WSAEWOULDBLOCK) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "WinSock failed to read from socket ";
+    last_error_.append(arctic::GetLastError());
+    if (error == WSAECONNRESET) {
+      return SocketResult::kSocketConnectionReset;
+    }
+    return SocketResult::kSocketError;
+  }
+  if (received == 0 && !is_empty_request) {
+    return SocketResult::kSocketConnectionReset;
+  }
+  *out_size = received;
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult ConnectionSocket::WriteVector(
+    const SocketBuffer *buffers, size_t count, size_t *out_size) {
+  if (!out_size) {
+    last_error_ = "Error: out_size argument of WriteVector is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_size = 0;
+  WSABUF vec[kSocketBufferChunk];
+  if (count > kSocketBufferChunk) {
+    count = kSocketBufferChunk;
+  }
+  for (size_t idx = 0; idx < count; ++idx) {
+    vec[idx].buf = buffers[idx].data;
+    vec[idx].len = static_cast<ULONG>(buffers[idx].size);
+  }
+  DWORD sent = 0;
+  int res = WSASend((SOCKET)handle_.win, vec, static_cast<DWORD>(count),
+      &sent, 0, nullptr, nullptr);
+  if (res == SOCKET_ERROR) {
+    int error = WSAGetLastError();
+    if (error == WSAEWOULDBLOCK) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "WinSock failed to write to socket ";
+    last_error_.append(arctic::GetLastError());
+    if (error == WSAECONNRESET) {
+      return SocketResult::kSocketConnectionReset;
+    }
+    return SocketResult::kSocketError;
+  }
+  *out_size = sent;
+  return SocketResult::kSocketOk;
+}
+
 template <typename Value>
 [[nodiscard]] inline SocketResult setsockopt(SocketHandle handle, int level,
     int opt_name, Value value, std::string *out_last_error) {
@@ -374,6 +453,590 @@ ListenerSocket::ListenerSocket(ListenerSocket&& rhs) noexcept {
   last_error_ = std::move(rhs.last_error_);
 }
 
+uint16_t ListenerSocket::GetLocalPort() const {
+  sockaddr_storage address{};
+  int size = sizeof(address);
+  if (handle_.win == INVALID_SOCKET ||
+      getsockname((SOCKET)handle_.win, reinterpret_cast<sockaddr*>(&address),
+        &size) == SOCKET_ERROR) {
+    return 0;
+  }
+  if (address.ss_family == AF_INET) {
+    return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+  }
+  if (address.ss_family == AF_INET6) {
+    return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+  }
+  return 0;
+}
+
+static_assert(sizeof(SocketAddress::data) >= sizeof(sockaddr_in6),
+  "SocketAddress is too small for sockaddr_in6");
+
+bool SocketAddress::Resolve(const std::string &host, uint16_t port,
+    AddressFamily family) {
+  WSAData wsa_data{};
+  if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+    size = 0;
+    return false;
+  }
+  char port_buffer[8];
+  snprintf(port_buffer, sizeof(port_buffer), "%d", port);
+  addrinfo hints{};
+  hints.ai_family = family == AddressFamily::kIpV4 ? AF_INET : AF_INET6;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_protocol = IPPROTO_UDP;
+  addrinfo *res = nullptr;
+  bool is_ok = getaddrinfo(host.c_str(), port_buffer, &hints, &res) == 0 &&
+    res && res->ai_addrlen <= sizeof(data);
+  size = 0;
+  if (is_ok) {
+    memset(data, 0, sizeof(data));
+    memcpy(data, res->ai_addr, res->ai_addrlen);
+    size = static_cast<uint32_t>(res->ai_addrlen);
+  }
+  if (res) {
+    freeaddrinfo(res);
+  }
+  WSACleanup();
+  return is_ok;
+}
+
+std::string SocketAddress::GetIp() const {
+  char text[INET6_ADDRSTRLEN] = {0};
+  const sockaddr *address = reinterpret_cast<const sockaddr*>(data);
+  if (size == 0) {
+    return std::string();
+  }
+  if (address->sa_family == AF_INET) {
+    inet_ntop(AF_INET,
+      &reinterpret_cast<const sockaddr_in*>(data)->sin_addr,
+      text, sizeof(text));
+  } else if (address->sa_family == AF_INET6) {
+    inet_ntop(AF_INET6,
+      &reinterpret_cast<const sockaddr_in6*>(data)->sin6_addr,
+      text, sizeof(text));
+  }
+  return std::string(text);
+}
+
+uint16_t SocketAddress::GetPort() const {
+  const sockaddr *address = reinterpret_cast<const sockaddr*>(data);
+  if (size == 0) {
+    return 0;
+  }
+  if (address->sa_family == AF_INET) {
+    return ntohs(reinterpret_cast<const sockaddr_in*>(data)->sin_port);
+  }
+  if (address->sa_family == AF_INET6) {
+    return ntohs(reinterpret_cast<const sockaddr_in6*>(data)->sin6_port);
+  }
+  return 0;
+}
+
+bool SocketAddress::operator==(const SocketAddress &rhs) const {
+  return size == rhs.size && memcmp(data, rhs.data, size) == 0;
+}
+
+DatagramSocket::DatagramSocket() {
+  handle_.win = INVALID_SOCKET;
+}
+
+DatagramSocket::DatagramSocket(AddressFamily family) {
+  WSAData data{};
+  auto status = WSAStartup(MAKEWORD(2, 2), &data);
+  if (status != 0) {
+    handle_.win = INVALID_SOCKET;
+    last_error_ = "WinSock failed to initialize ";
+    last_error_.append(arctic::GetLastError());
+    return;
+  }
+  SOCKET result = socket(family == AddressFamily::kIpV4 ? AF_INET : AF_INET6,
+    SOCK_DGRAM, IPPROTO_UDP);
+  if (result == INVALID_SOCKET) {
+    handle_.win = INVALID_SOCKET;
+    last_error_ = "WinSock failed to create socket ";
+    last_error_.append(arctic::GetLastError());
+    WSACleanup();
+    return;
+  }
+  // Otherwise an ICMP port unreachable reply to any earlier datagram makes
+  // the next receive fail with WSAECONNRESET
+#ifndef SIO_UDP_CONNRESET
+#define SIO_UDP_CONNRESET _WSAIOW(IOC_VENDOR, 12)
+#endif  // SIO_UDP_CONNRESET
+  BOOL is_reported = FALSE;
+  DWORD bytes_returned = 0;
+  WSAIoctl(result, SIO_UDP_CONNRESET, &is_reported, sizeof(is_reported),
+    NULL, 0, &bytes_returned, NULL, NULL);
+  handle_.win = result;
+}
+
+DatagramSocket::DatagramSocket(DatagramSocket&& rhs) noexcept {
+  handle_.win = rhs.handle_.win;
+  rhs.handle_.win = INVALID_SOCKET;
+  is_gro_enabled_ = rhs.is_gro_enabled_;
+  last_error_ = std::move(rhs.last_error_);
+}
+
+DatagramSocket::~DatagramSocket() {
+  if (handle_.win != INVALID_SOCKET) {
+    closesocket((SOCKET)handle_.win);
+    WSACleanup();
+  }
+}
+
+DatagramSocket& DatagramSocket::operator=(DatagramSocket&& rhs) noexcept {
+  if (this != &rhs) {
+    if (handle_.win != INVALID_SOCKET) {
+      closesocket((SOCKET)handle_.win);
+      WSACleanup();
+    }
+    handle_.win = rhs.handle_.win;
+    rhs.handle_.win = INVALID_SOCKET;
+    is_gro_enabled_ = rhs.is_gro_enabled_;
+    last_error_ = std::move(rhs.last_error_);
+  }
+  return *this;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::Bind(const std::string address,
+    uint16_t port) {
+  sockaddr_storage local{};
+  int local_size = sizeof(local);
+  getsockname((SOCKET)handle_.win, reinterpret_cast<sockaddr*>(&local),
+    &local_size);
+  SocketAddress bind_address;
+  if (!bind_address.Resolve(address, port, local.ss_family == AF_INET6 ?
+      AddressFamily::kIpV6 : AddressFamily::kIpV4)) {
+    last_error_ = "WinSock failed to resolve address " + address;
+    return SocketResult::kSocketError;
+  }
+  if (::bind((SOCKET)handle_.win,
+      reinterpret_cast<sockaddr*>(bind_address.data),
+      static_cast<int>(bind_address.size)) == SOCKET_ERROR) {
+    last_error_ = "WinSock failed to bind datagram socket ";
+    last_error_.append(arctic::GetLastError());
+    return SocketResult::kSocketError;
+  }
+  return SocketResult::kSocketOk;
+}
+
+uint16_t DatagramSocket::GetLocalPort() const {
+  SocketAddress address;
+  int size = sizeof(address.data);
+  if (handle_.win == INVALID_SOCKET || getsockname((SOCKET)handle_.win,
+      reinterpret_cast<sockaddr*>(address.data), &size) == SOCKET_ERROR) {
+    return 0;
+  }
+  address.size = static_cast<uint32_t>(size);
+  return address.GetPort();
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SendTo(
+    const SocketAddress &address, const void *buffer, size_t length,
+    size_t *out_size) {
+  if (!out_size) {
+    last_error_ = "Error: out_size argument of SendTo is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_size = 0;
+  int result = sendto((SOCKET)handle_.win,
+    static_cast<const char*>(buffer), static_cast<int>(length), 0,
+    reinterpret_cast<const sockaddr*>(address.data),
+    static_cast<int>(address.size));
+  if (result == SOCKET_ERROR) {
+    if (WSAGetLastError() == WSAEWOULDBLOCK) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "WinSock failed to send datagram ";
+    last_error_.append(arctic::GetLastError());
+    return SocketResult::kSocketError;
+  }
+  *out_size = static_cast<size_t>(result);
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::ReceiveFrom(void *buffer,
+    size_t length, SocketAddress *out_address, size_t *out_size) {
+  if (!out_size || !out_address) {
+    last_error_ = "Error: out argument of ReceiveFrom is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_size = 0;
+  int size = sizeof(out_address->data);
+  int result = recvfrom((SOCKET)handle_.win, static_cast<char*>(buffer),
+    static_cast<int>(length), 0,
+    reinterpret_cast<sockaddr*>(out_address->data), &size);
+  if (result == SOCKET_ERROR) {
+    int error = WSAGetLastError();
+    if (error == WSAEMSGSIZE) {
+      // Truncated, the buffer is full
+      out_address->size = static_cast<uint32_t>(size);
+      *out_size = length;
+      return SocketResult::kSocketOk;
+    }
+    out_address->size = 0;
+    if (error == WSAEWOULDBLOCK) {
+      return SocketResult::kSocketOk;
+    }
+    last_error_ = "WinSock failed to receive datagram ";
+    last_error_.append(arctic::GetLastError());
+    return SocketResult::kSocketError;
+  }
+  out_address->size = static_cast<uint32_t>(size);
+  *out_size = static_cast<size_t>(result);
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SendBatch(
+    const DatagramPacket *packets, size_t count, size_t *out_sent) {
+  if (!out_sent) {
+    last_error_ = "Error: out_sent argument of SendBatch is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  SocketResult status = SocketResult::kSocketOk;
+  size_t sent = 0;
+  for (; sent < count; ++sent) {
+    const DatagramPacket &packet = packets[sent];
+    int result = sendto((SOCKET)handle_.win,
+      reinterpret_cast<const char*>(packet.data),
+      static_cast<int>(packet.size), 0,
+      reinterpret_cast<const sockaddr*>(packet.address.data),
+      static_cast<int>(packet.address.size));
+    if (result == SOCKET_ERROR) {
+      if (WSAGetLastError() == WSAEWOULDBLOCK) {
+        break;
+      }
+      last_error_ = "WinSock failed to send datagram ";
+      last_error_.append(arctic::GetLastError());
+      status = SocketResult::kSocketError;
+    }
+  }
+  *out_sent = sent;
+  return status;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::ReceiveBatch(
+    DatagramPacket *packets, size_t count, size_t *out_received) {
+  if (!out_received) {
+    last_error_ = "Error: out_received argument of ReceiveBatch is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  size_t received = 0;
+  for (; received < count; ++received) {
+    if (received) {
+      // Only the very first datagram may be waited for
+      u_long pending = 0;
+      if (ioctlsocket((SOCKET)handle_.win, FIONREAD, &pending) != 0 ||
+          pending == 0) {
+        break;
+      }
+    }
+    DatagramPacket &packet = packets[received];
+    int size = sizeof(packet.address.data);
+    int result = recvfrom((SOCKET)handle_.win,
+      reinterpret_cast<char*>(packet.data),
+      static_cast<int>(packet.capacity), 0,
+      reinterpret_cast<sockaddr*>(packet.address.data), &size);
+    packet.is_truncated = false;
+    packet.segment_size = 0;
+    if (result == SOCKET_ERROR) {
+      int error = WSAGetLastError();
+      if (error == WSAEMSGSIZE) {
+        packet.address.size = static_cast<uint32_t>(size);
+        packet.size = packet.capacity;
+        packet.is_truncated = true;
+        continue;
+      }
+      if (error == WSAEWOULDBLOCK || received) {
+        break;
+      }
+      *out_received = 0;
+      last_error_ = "WinSock failed to receive datagrams ";
+      last_error_.append(arctic::GetLastError());
+      return SocketResult::kSocketError;
+    }
+    packet.address.size = static_cast<uint32_t>(size);
+    packet.size = static_cast<size_t>(result);
+  }
+  *out_received = received;
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetUdpSegmentSize(uint16_t size) {
+  last_error_ = "Error: UDP segmentation offload is not supported.";
+  return SocketResult::kSocketError;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetUdpGro(bool flag) {
+  last_error_ = "Error: UDP receive offload is not supported.";
+  return SocketResult::kSocketError;
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoBroadcast(bool flag) {
+  return setsockopt(handle_, SOL_SOCKET, SO_BROADCAST,
+      static_cast<BOOL>(flag), &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoReuseAddress(bool flag) {
+  return setsockopt(handle_, SOL_SOCKET, SO_REUSEADDR,
+      static_cast<BOOL>(flag), &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoSendBufferSize(int size) {
+  return setsockopt(handle_, SOL_SOCKET, SO_SNDBUF, size, &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoReceiveBufferSize(int size) {
+  return setsockopt(handle_, SOL_SOCKET, SO_RCVBUF, size, &last_error_);
+}
+
+[[nodiscard]] SocketResult DatagramSocket::SetSoNonblocking(bool flag) {
+  u_long ulong_flag = flag ? 1U : 0U;
+  auto result = ioctlsocket((SOCKET)handle_.win, FIONBIO, &ulong_flag);
+  if (result != 0) {
+    last_error_ = "Error: failed to set socket to nonblocking ";
+    last_error_.append(arctic::GetLastError());
+    return SocketResult::kSocketError;
+  }
+  return SocketResult::kSocketOk;
+}
+
+bool DatagramSocket::IsValid() const {
+  return handle_.win != INVALID_SOCKET;
+}
+
+enum SocketPollerOperation {
+  kSocketPollerAdd = 0,
+  kSocketPollerModify = 1,
+  kSocketPollerRemove = 2
+};
+
+struct SocketPoller::Impl {
+  bool is_wsa_started = false;
+  // A loopback UDP socket connected to itself, Wake sends it a byte
+  SOCKET wake_socket = INVALID_SOCKET;
+  // Index 0 is the wake socket
+  std::vector<WSAPOLLFD> fds;
+  std::vector<uint64_t> tokens;
+  std::unordered_map<uint64_t, size_t> index_by_socket;
+  size_t next_start = 1;
+};
+
+SocketPoller::SocketPoller() : impl_(new Impl) {
+  WSAData data{};
+  if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+    last_error_ = "WinSock failed to initialize ";
+    last_error_.append(arctic::GetLastError());
+    return;
+  }
+  impl_->is_wsa_started = true;
+  SOCKET wake = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int size = sizeof(address);
+  u_long non_blocking = 1;
+  if (wake == INVALID_SOCKET ||
+      bind(wake, reinterpret_cast<sockaddr*>(&address), size) != 0 ||
+      getsockname(wake, reinterpret_cast<sockaddr*>(&address), &size) != 0 ||
+      connect(wake, reinterpret_cast<sockaddr*>(&address), size) != 0 ||
+      ioctlsocket(wake, FIONBIO, &non_blocking) != 0) {
+    last_error_ = "WinSock failed to create the wake socket ";
+    last_error_.append(arctic::GetLastError());
+    if (wake != INVALID_SOCKET) {
+      closesocket(wake);
+    }
+    return;
+  }
+  impl_->wake_socket = wake;
+  WSAPOLLFD wake_fd{};
+  wake_fd.fd = wake;
+  wake_fd.events = POLLRDNORM;
+  impl_->fds.push_back(wake_fd);
+  impl_->tokens.push_back(0);
+}
+
+SocketPoller::~SocketPoller() {
+  if (impl_->wake_socket != INVALID_SOCKET) {
+    closesocket(impl_->wake_socket);
+  }
+  if (impl_->is_wsa_started) {
+    WSACleanup();
+  }
+}
+
+bool SocketPoller::IsValid() const {
+  return impl_->wake_socket != INVALID_SOCKET;
+}
+
+SocketResult SocketPoller::Control(SocketHandle handle, uint32_t events,
+    uint64_t token, int operation) {
+  if (handle.win == INVALID_SOCKET || !IsValid()) {
+    last_error_ = "Error: invalid socket or poller.";
+    return SocketResult::kSocketError;
+  }
+  Impl &impl = *impl_;
+  auto it = impl.index_by_socket.find(handle.win);
+  if (operation == kSocketPollerRemove) {
+    if (it == impl.index_by_socket.end()) {
+      last_error_ = "Error: the socket is not registered.";
+      return SocketResult::kSocketError;
+    }
+    size_t index = it->second;
+    size_t last = impl.fds.size() - 1;
+    impl.fds[index] = impl.fds[last];
+    impl.tokens[index] = impl.tokens[last];
+    impl.index_by_socket[(uint64_t)impl.fds[index].fd] = index;
+    impl.fds.pop_back();
+    impl.tokens.pop_back();
+    impl.index_by_socket.erase(handle.win);
+    return SocketResult::kSocketOk;
+  }
+  size_t index;
+  if (it == impl.index_by_socket.end()) {
+    if (operation == kSocketPollerModify) {
+      last_error_ = "Error: the socket is not registered.";
+      return SocketResult::kSocketError;
+    }
+    index = impl.fds.size();
+    impl.index_by_socket[handle.win] = index;
+    WSAPOLLFD fd{};
+    fd.fd = (SOCKET)handle.win;
+    impl.fds.push_back(fd);
+    impl.tokens.push_back(0);
+  } else {
+    index = it->second;
+  }
+  SHORT poll_events = 0;
+  if (events & kSocketEventRead) {
+    poll_events |= POLLRDNORM;
+  }
+  if (events & kSocketEventWrite) {
+    poll_events |= POLLWRNORM;
+  }
+  impl.fds[index].events = poll_events;
+  impl.tokens[index] = token;
+  return SocketResult::kSocketOk;
+}
+
+[[nodiscard]] SocketResult SocketPoller::Wait(SocketEvent *out_events,
+    size_t max_events, int32_t timeout_ms, size_t *out_count) {
+  if (!out_count) {
+    last_error_ = "Error: out_count argument of Wait is nullptr.";
+    return SocketResult::kSocketError;
+  }
+  *out_count = 0;
+  if (!IsValid() || max_events == 0) {
+    return SocketResult::kSocketError;
+  }
+  Impl &impl = *impl_;
+  int count = WSAPoll(impl.fds.data(), static_cast<ULONG>(impl.fds.size()),
+    timeout_ms);
+  if (count == SOCKET_ERROR) {
+    last_error_ = "WinSock failed to poll ";
+    last_error_.append(arctic::GetLastError());
+    return SocketResult::kSocketError;
+  }
+  if (impl.fds[0].revents) {
+    char buffer[64];
+    while (recv(impl.wake_socket, buffer, sizeof(buffer), 0) > 0) {
+    }
+    impl.fds[0].revents = 0;
+  }
+  // Starts where the previous call stopped so that no socket starves
+  size_t out_idx = 0;
+  size_t socket_count = impl.fds.size() - 1;
+  if (impl.next_start > socket_count) {
+    impl.next_start = 1;
+  }
+  std::vector<uint64_t> closed;
+  for (size_t step = 0; step < socket_count && out_idx < max_events;
+      ++step) {
+    size_t idx = 1 + (impl.next_start - 1 + step) % socket_count;
+    SHORT revents = impl.fds[idx].revents;
+    if (!revents) {
+      continue;
+    }
+    impl.fds[idx].revents = 0;
+    if (revents & POLLNVAL) {
+      // Closed by a failed Read or Write
+      closed.push_back((uint64_t)impl.fds[idx].fd);
+      continue;
+    }
+    uint32_t flags = 0;
+    if (revents & POLLRDNORM) {
+      flags |= kSocketEventRead;
+    }
+    if (revents & POLLWRNORM) {
+      flags |= kSocketEventWrite;
+    }
+    if (revents & POLLHUP) {
+      flags |= kSocketEventHangup;
+    }
+    if (revents & POLLERR) {
+      flags |= kSocketEventError;
+    }
+    out_events[out_idx].token = impl.tokens[idx];
+    out_events[out_idx].events = flags;
+    ++out_idx;
+    impl.next_start = idx + 1;
+  }
+  for (uint64_t socket : closed) {
+    SocketHandle handle;
+    handle.win = socket;
+    Control(handle, 0, 0, kSocketPollerRemove);
+  }
+  *out_count = out_idx;
+  return SocketResult::kSocketOk;
+}
+
+void SocketPoller::Wake() {
+  char value = 1;
+  send(impl_->wake_socket, &value, 1, 0);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Add(const ConnectionSocket &socket,
+    uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerAdd);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Add(const ListenerSocket &socket,
+    uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerAdd);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Modify(
+    const ConnectionSocket &socket, uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerModify);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Remove(
+    const ConnectionSocket &socket) {
+  return Control(socket.handle_, 0, 0, kSocketPollerRemove);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Remove(
+    const ListenerSocket &socket) {
+  return Control(socket.handle_, 0, 0, kSocketPollerRemove);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Add(const DatagramSocket &socket,
+    uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerAdd);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Modify(
+    const DatagramSocket &socket, uint32_t events, uint64_t token) {
+  return Control(socket.handle_, events, token, kSocketPollerModify);
+}
+
+[[nodiscard]] SocketResult SocketPoller::Remove(
+    const DatagramSocket &socket) {
+  return Control(socket.handle_, 0, 0, kSocketPollerRemove);
+}
+
 }  // namespace arctic
 
 #endif  // ARCTIC_PLATFORM_WINDOWS
@@ -0,0 +1,429 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/asset_pack.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "engine/arctic_platform_fatal.h"
+#include "engine/miniz.h"
+
+namespace arctic {
+
+namespace {
+
+const char kAssetPackMagic[8] = {'A', 'R', 'C', 'T', 'P', 'A', 'C', 'K'};
+const Ui32 kAssetPackVersion = 1;
+// Deflate expands data at most about 1032 times, a deflated entry claiming
+// more comes from a corrupt pack
+const Ui64 kMaxInflateRatio = 1032;
+
+struct AssetPackHeader {
+  char magic[8];
+  Ui32 version;
+  Ui32 entry_count;
+  Ui32 bucket_count;
+  Ui32 names_size;
+  Ui64 directory_offset;
+};
+static_assert(sizeof(AssetPackHeader) == 32, "AssetPackHeader size");
+static_assert(sizeof(AssetPack::Entry) == 48, "AssetPack::Entry size");
+
+Ui64 HashAssetName(const char *name, Ui64 size) {
+  Ui64 hash = 0xcbf29ce484222325ull;
+  for (Ui64 i = 0; i < size; ++i) {
+    hash ^= static_cast<Ui8>(name[i]);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+struct MountedAssetPack {
+  std::string file_name;
+  std::string mount_point;
+  std::shared_ptr<AssetPack> pack;
+};
+
+std::mutex g_mounted_packs_mutex;
+std::vector<MountedAssetPack> g_mounted_packs;
+// Lets ReadFile and MappedFile skip the lock when nothing is mounted
+std::atomic<Ui32> g_mounted_pack_count(0);
+
+}  // namespace
+
+bool AssetPack::Open(const char *file_name) {
+  Close();
+  if (!file_.Open(file_name)) {
+    return false;
+  }
+  const Ui8 *data = file_.Data();
+  Ui64 size = file_.Size();
+  AssetPackHeader header;
+  if (size < sizeof(header)) {
+    Close();
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  Ui64 bucket_count = header.bucket_count;
+  Ui64 entry_count = header.entry_count;
+  if (std::memcmp(header.magic, kAssetPackMagic, sizeof(kAssetPackMagic)) ||
+      header.version != kAssetPackVersion ||
+      bucket_count < 2 || (bucket_count & (bucket_count - 1)) ||
+      header.directory_offset < sizeof(header) ||
+      header.directory_offset % 8 ||
+      header.directory_offset > size ||
+      size - header.directory_offset != bucket_count * sizeof(Ui32) +
+        entry_count * sizeof(Entry) + header.names_size) {
+    Close();
+    return false;
+  }
+  const Ui8 *directory = data + header.directory_offset;
+  buckets_ = reinterpret_cast<const Ui32*>(directory);
+  entries_ = reinterpret_cast<const Entry*>(
+    directory + bucket_count * sizeof(Ui32));
+  names_ = reinterpret_cast<const char*>(entries_ + entry_count);
+  entry_count_ = header.entry_count;
+  bucket_mask_ = header.bucket_count - 1;
+  bool is_valid = true;
+  for (Ui64 i = 0; i < bucket_count; ++i) {
+    is_valid = is_valid &&
+      (buckets_[i] == kAssetPackNoEntry || buckets_[i] < entry_count);
+  }
+  for (Ui64 i = 0; i < entry_count && is_valid; ++i) {
+    const Entry &entry = entries_[i];
+    is_valid = entry.offset >= sizeof(header) &&
+      entry.stored_size <= header.directory_offset &&
+      entry.offset <= header.directory_offset - entry.stored_size &&
+      entry.name_size <= header.names_size &&
+      entry.name_offset <= header.names_size - entry.name_size &&
+      (entry.next == kAssetPackNoEntry || entry.next < entry_count) &&
+      (entry.flags & ~kEntryDeflated) == 0 &&
+      ((entry.flags & kEntryDeflated) || entry.stored_size == entry.size) &&
+      entry.size / kMaxInflateRatio <= entry.stored_size &&
+      static_cast<size_t>(entry.size) == entry.size &&
+      entry.hash == HashAssetName(names_ + entry.name_offset,
+        entry.name_size);
+  }
+  if (!is_valid) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void AssetPack::Close() {
+  file_.Close();
+  buckets_ = nullptr;
+  entries_ = nullptr;
+  names_ = nullptr;
+  entry_count_ = 0;
+  bucket_mask_ = 0;
+}
+
+Ui32 AssetPack::Find(const char *name) const {
+  if (!entry_count_) {
+    return kAssetPackNoEntry;
+  }
+  Ui64 name_size = std::strlen(name);
+  Ui64 hash = HashAssetName(name, name_size);
+  Ui32 index = buckets_[hash & bucket_mask_];
+  // The step limit guards against a corrupt chain with a loop
+  for (Ui32 step = 0; index != kAssetPackNoEntry && step < entry_count_;
+      ++step) {
+    const Entry &entry = entries_[index];
+    if (entry.hash == hash && entry.name_size == name_size &&
+        std::memcmp(names_ + entry.name_offset, name, name_size) == 0) {
+      return index;
+    }
+    index = entry.next;
+  }
+  return kAssetPackNoEntry;
+}
+
+std::string AssetPack::GetName(Ui32 index) const {
+  Check(index < entry_count_, "AssetPack::GetName Error. Invalid index");
+  return std::string(names_ + entries_[index].name_offset,
+    entries_[index].name_size);
+}
+
+Ui64 AssetPack::GetSize(Ui32 index) const {
+  Check(index < entry_count_, "AssetPack::GetSize Error. Invalid index");
+  return entries_[index].size;
+}
+
+bool AssetPack::IsDeflated(Ui32 index) const {
+  Check(index < entry_count_, "AssetPack::IsDeflated Error. Invalid index");
+  return (entries_[index].flags & kEntryDeflated) != 0;
+}
+
+const Ui8 *AssetPack::GetStoredData(Ui32 index) const {
+  Check(index < entry_count_,
+    "AssetPack::GetStoredData Error. Invalid index");
+  return file_.Data() + entries_[index].offset;
+}
+
+bool AssetPack::Read(Ui32 index, std::vector<Ui8> *out_data) const {
+  Check(index < entry_count_, "AssetPack::Read Error. Invalid index");
+  const Entry &entry = entries_[index];
+  const Ui8 *stored = file_.Data() + entry.offset;
+  if (!(entry.flags & kEntryDeflated)) {
+    out_data->assign(stored, stored + entry.size);
+    return true;
+  }
+  mz_ulong size = static_cast<mz_ulong>(entry.size);
+  if (size != entry.size ||
+      static_cast<mz_ulong>(entry.stored_size) != entry.stored_size) {
+    out_data->clear();
+    return false;
+  }
+  out_data->resize(static_cast<size_t>(entry.size));
+  if (mz_uncompress(out_data->data(), &size, stored,
+        static_cast<mz_ulong>(entry.stored_size)) != MZ_OK ||
+      size != entry.size) {
+    out_data->clear();
+    return false;
+  }
+  return true;
+}
+
+void AssetPackWriter::Add(const std::string &name, std::vector<Ui8> data,
+    bool is_compressible) {
+  Source source;
+  source.name = name;
+  source.data = std::move(data);
+  source.is_compressible = is_compressible;
+  AddSource(std::move(source));
+}
+
+void AssetPackWriter::AddFile(const std::string &file_name,
+    const std::string &name, bool is_compressible) {
+  Source source;
+  source.name = name;
+  source.file_name = file_name;
+  source.is_compressible = is_compressible;
+  AddSource(std::move(source));
+}
+
+void AssetPackWriter::AddSource(Source source) {
+  source.name = NormalizeAssetPath(source.name.c_str());
+  auto it = index_by_name_.find(source.name);
+  if (it != index_by_name_.end()) {
+    entries_[it->second] = std::move(source);
+    return;
+  }
+  index_by_name_[source.name] = entries_.size();
+  entries_.push_back(std::move(source));
+}
+
+bool AssetPackWriter::Save(const char *file_name, Si32 level,
+    Ui32 alignment) {
+  Check(alignment >= 16 && (alignment & (alignment - 1)) == 0,
+    "AssetPackWriter::Save Error. Alignment must be a power of two from 16");
+  raw_size_ = 0;
+  pack_size_ = 0;
+  if (entries_.size() >= kAssetPackNoEntry) {
+    return false;
+  }
+  std::ofstream out(file_name,
+    std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+  if (!out.is_open()) {
+    return false;
+  }
+  AssetPackHeader header;
+  std::memset(&header, 0, sizeof(header));
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  Ui64 pos = sizeof(header);
+  const char padding[4096] = {};
+  auto pad_to = [&](Ui64 to_alignment) {
+    Ui64 pad = (to_alignment - pos % to_alignment) % to_alignment;
+    while (pad) {
+      Ui64 part = std::min<Ui64>(pad, sizeof(padding));
+      out.write(padding, static_cast<std::streamsize>(part));
+      pos += part;
+      pad -= part;
+    }
+  };
+
+  std::vector<AssetPack::Entry> entries(entries_.size());
+  std::string names;
+  std::vector<Ui8> compressed;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const Source &source = entries_[i];
+    MappedFile file;
+    const Ui8 *data = source.data.data();
+    Ui64 size = source.data.size();
+    if (!source.file_name.empty()) {
+      if (!file.Open(source.file_name.c_str())) {
+        return false;
+      }
+      data = file.Data();
+      size = file.Size();
+    }
+    AssetPack::Entry &entry = entries[i];
+    entry.hash = HashAssetName(source.name.data(), source.name.size());
+    entry.size = size;
+    entry.stored_size = size;
+    entry.name_offset = static_cast<Ui32>(names.size());
+    entry.name_size = static_cast<Ui32>(source.name.size());
+    entry.next = kAssetPackNoEntry;
+    entry.flags = 0;
+    names += source.name;
+    const Ui8 *stored = data;
+    if (source.is_compressible && level > 0 && size > 0 &&
+        static_cast<mz_ulong>(size) == size) {
+      mz_ulong compressed_size = mz_compressBound(static_cast<mz_ulong>(size));
+      compressed.resize(compressed_size);
+      if (mz_compress2(compressed.data(), &compressed_size, data,
+            static_cast<mz_ulong>(size), std::min(level, 10)) == MZ_OK &&
+          compressed_size < size) {
+        stored = compressed.data();
+        entry.stored_size = compressed_size;
+        entry.flags = AssetPack::kEntryDeflated;
+      }
+    }
+    pad_to(alignment);
+    entry.offset = pos;
+    out.write(reinterpret_cast<const char*>(stored),
+      static_cast<std::streamsize>(entry.stored_size));
+    pos += entry.stored_size;
+    raw_size_ += size;
+  }
+
+  Ui32 bucket_count = 2;
+  while (bucket_count < entries.size()) {
+    bucket_count *= 2;
+  }
+  std::vector<Ui32> buckets(bucket_count, kAssetPackNoEntry);
+  // Inserted in reverse so that each bucket lists its entries in pack order
+  for (size_t i = entries.size(); i-- > 0;) {
+    Ui32 &head = buckets[entries[i].hash & (bucket_count - 1)];
+    entries[i].next = head;
+    head = static_cast<Ui32>(i);
+  }
+  pad_to(8);
+  std::memcpy(header.magic, kAssetPackMagic, sizeof(header.magic));
+  header.version = kAssetPackVersion;
+  header.entry_count = static_cast<Ui32>(entries.size());
+  header.bucket_count = bucket_count;
+  header.names_size = static_cast<Ui32>(names.size());
+  header.directory_offset = pos;
+  out.write(reinterpret_cast<const char*>(buckets.data()),
+    static_cast<std::streamsize>(buckets.size() * sizeof(Ui32)));
+  out.write(reinterpret_cast<const char*>(entries.data()),
+    static_cast<std::streamsize>(entries.size() * sizeof(AssetPack::Entry)));
+  out.write(names.data(), static_cast<std::streamsize>(names.size()));
+  pos += buckets.size() * sizeof(Ui32) +
+    entries.size() * sizeof(AssetPack::Entry) + names.size();
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.close();
+  if (out.fail()) {
+    return false;
+  }
+  pack_size_ = pos;
+  return true;
+}
+
+std::string NormalizeAssetPath(const char *path) {
+  std::string result(path);
+  for (char &c : result) {
+    if (c == '\\') {
+      c = '/';
+    }
+  }
+  size_t begin = 0;
+  while (result.compare(begin, 2, "./") == 0) {
+    begin += 2;
+  }
+  return result.substr(begin);
+}
+
+bool MountAssetPack(const char *file_name, const char *mount_point) {
+  std::shared_ptr<AssetPack> pack = std::make_shared<AssetPack>();
+  if (!pack->Open(file_name)) {
+    return false;
+  }
+  MountedAssetPack mounted;
+  mounted.file_name = file_name;
+  mounted.mount_point = NormalizeAssetPath(mount_point);
+  while (!mounted.mount_point.empty() && mounted.mount_point.back() == '/') {
+    mounted.mount_point.pop_back();
+  }
+  if (mounted.mount_point == ".") {
+    mounted.mount_point.clear();
+  }
+  if (!mounted.mount_point.empty()) {
+    mounted.mount_point.push_back('/');
+  }
+  mounted.pack = std::move(pack);
+  UnmountAssetPack(file_name);
+  std::lock_guard<std::mutex> lock(g_mounted_packs_mutex);
+  g_mounted_packs.push_back(std::move(mounted));
+  g_mounted_pack_count = static_cast<Ui32>(g_mounted_packs.size());
+  return true;
+}
+
+bool UnmountAssetPack(const char *file_name) {
+  std::lock_guard<std::mutex> lock(g_mounted_packs_mutex);
+  for (auto it = g_mounted_packs.begin(); it != g_mounted_packs.end(); ++it) {
+    if (it->file_name == file_name) {
+      g_mounted_packs.erase(it);
+      g_mounted_pack_count = static_cast<Ui32>(g_mounted_packs.size());
+      return true;
+    }
+  }
+  return false;
+}
+
+void UnmountAllAssetPacks() {
+  std::lock_guard<std::mutex> lock(g_mounted_packs_mutex);
+  g_mounted_packs.clear();
+  g_mounted_pack_count = 0;
+}
+
+std::shared_ptr<AssetPack> FindMountedAsset(const char *file_name,
+    Ui32 *out_index) {
+  if (!g_mounted_pack_count.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  std::string path = NormalizeAssetPath(file_name);
+  std::lock_guard<std::mutex> lock(g_mounted_packs_mutex);
+  for (auto it = g_mounted_packs.rbegin(); it != g_mounted_packs.rend();
+      ++it) {
+    if (path.compare(0, it->mount_point.size(), it->mount_point) != 0) {
+      continue;
+    }
+    Ui32 index = it->pack->Find(path.c_str() + it->mount_point.size());
+    if (index != kAssetPackNoEntry) {
+      *out_index = index;
+      return it->pack;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace arctic
@@ -0,0 +1,203 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_ASSET_PACK_H_
+#define ENGINE_ASSET_PACK_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/mapped_file.h"
+
+namespace arctic {
+
+/// @addtogroup global_files
+/// @{
+
+/// @brief Entry index returned by AssetPack::Find when there is no such entry
+static const Ui32 kAssetPackNoEntry = 0xFFFFFFFFu;
+
+/// @brief A read-only archive of many asset files in one memory mapped file
+///
+/// Layout: a 32 byte header, the entry data, each entry aligned so that it
+/// can be used straight from the mapping, then the directory: a power of
+/// two table of hash buckets, the entries and their names. Names are found
+/// by their 64-bit FNV-1a hash in one bucket lookup. Entries are either
+/// stored as they are or deflated with miniz. All numbers are little
+/// endian. Packs are written by AssetPackWriter or the asset_pack_builder
+/// tool and mounted with MountAssetPack.
+class AssetPack {
+ public:
+  /// @brief Directory entry, as stored in the pack
+  struct Entry {
+    Ui64 hash;
+    Ui64 offset;
+    Ui64 stored_size;
+    Ui64 size;
+    Ui32 name_offset;
+    Ui32 name_size;
+    Ui32 next;  ///< Next entry in the bucket or kAssetPackNoEntry
+    Ui32 flags;
+  };
+  static const Ui32 kEntryDeflated = 1;
+
+  /// @brief Maps the pack and validates its directory
+  /// @param file_name Path to the pack
+  /// @return True if the file is a valid pack
+  bool Open(const char *file_name);
+
+  /// @brief Unmaps the pack
+  void Close();
+
+  bool IsOpen() const {
+    return file_.IsOpen();
+  }
+
+  Ui32 GetEntryCount() const {
+    return entry_count_;
+  }
+
+  /// @brief Finds an entry by its name, like "sprites/hero.tga"
+  /// @return Entry index or kAssetPackNoEntry
+  Ui32 Find(const char *name) const;
+
+  /// @brief Returns the name of an entry
+  std::string GetName(Ui32 index) const;
+
+  /// @brief Returns the size of the file stored in an entry
+  Ui64 GetSize(Ui32 index) const;
+
+  /// @brief Returns true if the entry is deflated
+  bool IsDeflated(Ui32 index) const;
+
+  /// @brief Returns the bytes of an entry as stored in the pack, for an
+  /// entry that is not deflated these are the file contents
+  const Ui8 *GetStoredData(Ui32 index) const;
+
+  /// @brief Reads the file stored in an entry, inflating it if needed
+  /// @param index Entry index
+  /// @param [out] out_data Filled with the file contents
+  /// @return False if deflated data is corrupt
+  bool Read(Ui32 index, std::vector<Ui8> *out_data) const;
+
+ private:
+  MappedFile file_;
+  const Ui32 *buckets_ = nullptr;
+  const Entry *entries_ = nullptr;
+  const char *names_ = nullptr;
+  Ui32 entry_count_ = 0;
+  Ui32 bucket_mask_ = 0;
+};
+
+/// @brief Builds an asset pack
+/// Example:
+/// @code
+///   AssetPackWriter writer;
+///   writer.AddFile("data/hero.tga", "hero.tga");
+///   writer.Add("levels/1.txt", level_text);
+///   bool is_saved = writer.Save("data.pack");
+/// @endcode
+class AssetPackWriter {
+ public:
+  /// @brief Adds a file kept in memory, replaces an entry of the same name
+  /// @param name Entry name, backslashes are turned into slashes
+  /// @param data File contents
+  /// @param is_compressible If false the entry is always stored as is
+  void Add(const std::string &name, std::vector<Ui8> data,
+    bool is_compressible = true);
+
+  /// @brief Adds a file from the disk, it is read by Save
+  /// @param file_name Path to the file
+  /// @param name Entry name, backslashes are turned into slashes
+  /// @param is_compressible If false the entry is always stored as is
+  void AddFile(const std::string &file_name, const std::string &name,
+    bool is_compressible = true);
+
+  /// @brief Writes the pack
+  /// @param file_name Path to the pack
+  /// @param level Deflate level, 0 stores every entry as is, 1 (fastest)
+  ///   to 10 (slowest). Entries that don't shrink are stored as is.
+  /// @param alignment Alignment of the entry data, a power of two from 16
+  /// @return False if a file could not be read or the pack written
+  bool Save(const char *file_name, Si32 level = 6, Ui32 alignment = 16);
+
+  Ui64 GetEntryCount() const {
+    return entries_.size();
+  }
+
+  /// @brief Returns the total size of the files after Save
+  Ui64 GetRawSize() const {
+    return raw_size_;
+  }
+
+  /// @brief Returns the size of the pack after Save
+  Ui64 GetPackSize() const {
+    return pack_size_;
+  }
+
+ private:
+  struct Source {
+    std::string name;
+    std::string file_name;
+    std::vector<Ui8> data;
+    bool is_compressible;
+  };
+  void AddSource(Source source);
+
+  std::vector<Source> entries_;
+  std::unordered_map<std::string, size_t> index_by_name_;
+  Ui64 raw_size_ = 0;
+  Ui64 pack_size_ = 0;
+};
+
+/// @brief Turns backslashes into slashes and drops leading "./"
+std::string NormalizeAssetPath(const char *path);
+
+/// @brief Mounts a pack so that ReadFile, MappedFile and the loaders built
+/// on them find its entries before the loose files
+/// @param file_name Path to the pack
+/// @param mount_point Directory the entries appear in, like "data"
+/// @return False if the pack can't be opened
+bool MountAssetPack(const char *file_name, const char *mount_point = "");
+
+/// @brief Unmounts a pack, files already loaded from it stay valid
+/// @return False if the pack is not mounted
+bool UnmountAssetPack(const char *file_name);
+
+/// @brief Unmounts all packs
+void UnmountAllAssetPacks();
+
+/// @brief Finds a file in the mounted packs, packs mounted later come first
+/// @param file_name Path to the file, like "data/hero.tga"
+/// @param [out] out_index Entry index in the pack returned
+/// @return The pack or nullptr if no mounted pack has the file
+std::shared_ptr<AssetPack> FindMountedAsset(const char *file_name,
+  Ui32 *out_index);
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_ASSET_PACK_H_
@@ -0,0 +1,367 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/async_loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "engine/log.h"
+#include "engine/mapped_file.h"
+#include "engine/profiler.h"
+
+namespace arctic {
+
+namespace {
+
+// A load goes from an I/O thread that maps the file and touches its pages,
+// to a decode thread, to the main thread that publishes the result
+class AsyncLoadJob {
+ public:
+  virtual ~AsyncLoadJob() = default;
+  /// Runs on a decode thread
+  virtual void Decode() = 0;
+  /// Runs on the main thread
+  virtual void Complete() = 0;
+
+  std::string file_name;
+  bool is_copy_on_write = false;
+  std::shared_ptr<MappedFile> file;
+};
+
+template <class TAsset>
+class AsyncAssetJob : public AsyncLoadJob {
+ public:
+  AsyncAssetJob(const char *name, std::function<void(TAsset&)> on_loaded)
+      : state(std::make_shared<AsyncAssetState<TAsset>>()) {
+    file_name = name;
+    state->on_loaded = std::move(on_loaded);
+  }
+
+  void Complete() override {
+    Publish();
+  }
+
+  void Publish() {
+    state->asset = std::move(asset);
+    state->is_loaded = is_loaded;
+    state->is_ready = true;
+    if (state->on_loaded) {
+      std::function<void(TAsset&)> on_loaded = std::move(state->on_loaded);
+      state->on_loaded = nullptr;
+      on_loaded(state->asset);
+    }
+  }
+
+  std::shared_ptr<AsyncAssetState<TAsset>> state;
+  TAsset asset;
+  bool is_loaded = false;
+};
+
+class SpriteJob : public AsyncAssetJob<Sprite> {
+ public:
+  using AsyncAssetJob<Sprite>::AsyncAssetJob;
+
+  void Decode() override {
+    asset.LoadFromData(file->Data(), file->Size(), file_name.c_str());
+    is_loaded = asset.Width() > 0;
+  }
+};
+
+class HwSpriteJob : public AsyncAssetJob<HwSprite> {
+ public:
+  using AsyncAssetJob<HwSprite>::AsyncAssetJob;
+
+  void Decode() override {
+    decoded.LoadFromData(file->Data(), file->Size(), file_name.c_str());
+    is_loaded = decoded.Width() > 0;
+  }
+
+  void Complete() override {
+    if (is_loaded) {
+      asset.LoadFromSoftwareSprite(decoded);
+    }
+    decoded = Sprite();
+    Publish();
+  }
+
+  Sprite decoded;
+};
+
+class SoundJob : public AsyncAssetJob<Sound> {
+ public:
+  SoundJob(const char *name, bool unpack,
+      std::function<void(Sound&)> on_loaded)
+      : AsyncAssetJob<Sound>(name, std::move(on_loaded)),
+      do_unpack(unpack) {
+    const char *last_dot = strrchr(name, '.');
+    is_copy_on_write = last_dot && StrCaseCmp(last_dot, ".wav") == 0;
+  }
+
+  void Decode() override {
+    asset.LoadFromFile(file_name.c_str(), do_unpack, file);
+    is_loaded = asset.GetInstance() != nullptr;
+  }
+
+  bool do_unpack;
+};
+
+class FontJob : public AsyncAssetJob<Font> {
+ public:
+  using AsyncAssetJob<Font>::AsyncAssetJob;
+
+  void Decode() override {
+    asset.LoadFromData(file->Data(), file->Size(), file_name.c_str());
+    is_loaded = !asset.IsEmpty();
+  }
+};
+
+class AsyncLoader {
+ public:
+  ~AsyncLoader() {
+    std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+    StopThreads();
+  }
+
+  template <class TJob>
+  auto Start(std::unique_ptr<TJob> job) {
+    auto state = job->state;
+    ++pending_count;
+    std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (threads_.empty()) {
+      StartThreads();
+    }
+    io_queue_.push_back(std::move(job));
+    io_cv_.notify_one();
+    return state;
+  }
+
+  void Process(bool is_waiting) {
+    ARCTIC_PROFILE_SCOPE("ProcessAsyncLoads");
+    auto start = std::chrono::steady_clock::now();
+    while (pending_count) {
+      std::unique_ptr<AsyncLoadJob> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (done_queue_.empty() && !is_waiting) {
+          return;
+        }
+        done_cv_.wait(lock, [this]() { return !done_queue_.empty(); });
+        job = std::move(done_queue_.front());
+        done_queue_.pop_front();
+      }
+      job->Complete();
+      --pending_count;
+      if (!is_waiting && std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count() >= frame_budget) {
+        return;
+      }
+    }
+  }
+
+  void SetThreadCounts(Ui32 io_thread_count, Ui32 decode_thread_count) {
+    Process(true);
+    std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+    StopThreads();
+    io_thread_count_ = io_thread_count;
+    decode_thread_count_ = decode_thread_count;
+  }
+
+  std::atomic<Ui64> pending_count = ATOMIC_VAR_INIT(0);
+  double frame_budget = 0.004;
+
+ private:
+  void StartThreads() {
+    Ui32 io_count = io_thread_count_ ? io_thread_count_ : 2;
+    Ui32 decode_count = decode_thread_count_;
+    if (!decode_count) {
+      decode_count = std::max(1u, std::thread::hardware_concurrency() - 1);
+    }
+    for (Ui32 i = 0; i < io_count; ++i) {
+      threads_.emplace_back([this]() { IoThread(); });
+    }
+    for (Ui32 i = 0; i < decode_count; ++i) {
+      threads_.emplace_back([this]() { DecodeThread(); });
+    }
+  }
+
+  // Lets the threads finish the queued reads and decodes, the jobs stay in
+  // the done queue until the next Process. The caller holds threads_mutex_,
+  // so no loads are started meanwhile.
+  void StopThreads() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_stopping_ = true;
+      io_cv_.notify_all();
+      decode_cv_.notify_all();
+    }
+    for (std::thread &thread : threads_) {
+      thread.join();
+    }
+    threads_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = false;
+  }
+
+  void IoThread() {
+    SetProfilerThreadName("Async I/O");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      io_cv_.wait(lock, [this]() {
+        return is_stopping_ || !io_queue_.empty();
+      });
+      if (io_queue_.empty()) {
+        return;
+      }
+      std::unique_ptr<AsyncLoadJob> job = std::move(io_queue_.front());
+      io_queue_.pop_front();
+      ++io_busy_count_;
+      lock.unlock();
+      {
+        ARCTIC_PROFILE_SCOPE("AsyncLoad read");
+        job->file = std::make_shared<MappedFile>();
+        if (job->file->Open(job->file_name.c_str(), job->is_copy_on_write) &&
+            job->file->IsMapped()) {
+          // Page faults happen here rather than on the decode threads
+          const volatile Ui8 *data = job->file->Data();
+          for (Ui64 i = 0; i < job->file->Size(); i += 4096) {
+            data[i];
+          }
+        }
+      }
+      lock.lock();
+      --io_busy_count_;
+      decode_queue_.push_back(std::move(job));
+      if (is_stopping_) {
+        // Idle decode threads may exit once the reads are done
+        decode_cv_.notify_all();
+      } else {
+        decode_cv_.notify_one();
+      }
+    }
+  }
+
+  void DecodeThread() {
+    SetProfilerThreadName("Async decode");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      decode_cv_.wait(lock, [this]() {
+        return !decode_queue_.empty() || (is_stopping_ &&
+            io_queue_.empty() && io_busy_count_ == 0);
+      });
+      if (decode_queue_.empty()) {
+        return;
+      }
+      std::unique_ptr<AsyncLoadJob> job = std::move(decode_queue_.front());
+      decode_queue_.pop_front();
+      lock.unlock();
+      {
+        ARCTIC_PROFILE_SCOPE("AsyncLoad decode");
+        if (job->file->IsOpen()) {
+          job->Decode();
+        }
+        job->file = nullptr;
+      }
+      lock.lock();
+      done_queue_.push_back(std::move(job));
+      done_cv_.notify_all();
+    }
+  }
+
+  // Held while the threads are started or stopped
+  std::mutex threads_mutex_;
+  std::mutex mutex_;
+  std::condition_variable io_cv_;
+  std::condition_variable decode_cv_;
+  std::condition_variable done_cv_;
+  std::deque<std::unique_ptr<AsyncLoadJob>> io_queue_;
+  std::deque<std::unique_ptr<AsyncLoadJob>> decode_queue_;
+  std::deque<std::unique_ptr<AsyncLoadJob>> done_queue_;
+  std::vector<std::thread> threads_;
+  Ui32 io_thread_count_ = 0;
+  Ui32 decode_thread_count_ = 0;
+  Ui32 io_busy_count_ = 0;
+  bool is_stopping_ = false;
+};
+
+AsyncLoader g_async_loader;
+
+}  // namespace
+
+AsyncAsset<Sprite> LoadSpriteAsync(const char *file_name,
+    std::function<void(Sprite&)> on_loaded) {
+  Check(!!file_name, "Error in LoadSpriteAsync, file_name is nullptr.");
+  return AsyncAsset<Sprite>(g_async_loader.Start(
+    std::make_unique<SpriteJob>(file_name, std::move(on_loaded))));
+}
+
+AsyncAsset<HwSprite> LoadHwSpriteAsync(const char *file_name,
+    std::function<void(HwSprite&)> on_loaded) {
+  Check(!!file_name, "Error in LoadHwSpriteAsync, file_name is nullptr.");
+  return AsyncAsset<HwSprite>(g_async_loader.Start(
+    std::make_unique<HwSpriteJob>(file_name, std::move(on_loaded))));
+}
+
+AsyncAsset<Sound> LoadSoundAsync(const char *file_name, bool do_unpack,
+    std::function<void(Sound&)> on_loaded) {
+  Check(!!file_name, "Error in LoadSoundAsync, file_name is nullptr.");
+  return AsyncAsset<Sound>(g_async_loader.Start(
+    std::make_unique<SoundJob>(file_name, do_unpack, std::move(on_loaded))));
+}
+
+AsyncAsset<Font> LoadFontAsync(const char *file_name,
+    std::function<void(Font&)> on_loaded) {
+  Check(!!file_name, "Error in LoadFontAsync, file_name is nullptr.");
+  return AsyncAsset<Font>(g_async_loader.Start(
+    std::make_unique<FontJob>(file_name, std::move(on_loaded))));
+}
+
+void SetAsyncLoadThreads(Ui32 io_thread_count, Ui32 decode_thread_count) {
+  g_async_loader.SetThreadCounts(io_thread_count, decode_thread_count);
+}
+
+void SetAsyncLoadFrameBudget(double seconds) {
+  g_async_loader.frame_budget = seconds;
+}
+
+Ui64 GetPendingAsyncLoadCount() {
+  return g_async_loader.pending_count;
+}
+
+void ProcessAsyncLoads() {
+  g_async_loader.Process(false);
+}
+
+void WaitForAsyncLoads() {
+  g_async_loader.Process(true);
+}
+
+}  // namespace arctic
@@ -0,0 +1,139 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_ASYNC_LOADER_H_
+#define ENGINE_ASYNC_LOADER_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "engine/arctic_platform_fatal.h"
+#include "engine/arctic_types.h"
+#include "engine/easy_hw_sprite.h"
+#include "engine/easy_sound.h"
+#include "engine/easy_sprite.h"
+#include "engine/font.h"
+
+namespace arctic {
+
+/// @addtogroup global_files
+/// @{
+
+/// @brief Shared state of an asset loaded in the background
+template <class TAsset>
+struct AsyncAssetState {
+  TAsset asset;
+  bool is_ready = false;
+  bool is_loaded = false;
+  std::function<void(TAsset&)> on_loaded;
+};
+
+/// @brief Handle of an asset loaded in the background
+///
+/// The asset becomes ready on the main thread, in ShowFrame or
+/// WaitForAsyncLoads, right before its on_loaded callback runs. Loads can be
+/// started from any thread, use the handle from the main thread only.
+template <class TAsset>
+class AsyncAsset {
+ public:
+  AsyncAsset() = default;
+  explicit AsyncAsset(std::shared_ptr<AsyncAssetState<TAsset>> state)
+    : state_(std::move(state)) {
+  }
+
+  /// @brief Returns true once the load is complete, successful or not
+  bool IsReady() const {
+    return state_ && state_->is_ready;
+  }
+
+  /// @brief Returns true if the load is complete and successful
+  bool IsLoaded() const {
+    return state_ && state_->is_ready && state_->is_loaded;
+  }
+
+  /// @brief Returns the asset, empty until the load is complete
+  TAsset &Get() {
+    Check(!!state_, "AsyncAsset::Get Error. No load is started");
+    return state_->asset;
+  }
+
+ private:
+  std::shared_ptr<AsyncAssetState<TAsset>> state_;
+};
+
+/// @brief Starts loading a sprite in the background
+/// @details An I/O thread maps and reads the file, a decode thread decodes
+///   it, the sprite becomes ready in ShowFrame.
+/// @param file_name Name of the file to load
+/// @param on_loaded Called on the main thread when the load is complete,
+///   even if it failed
+/// @return Handle of the sprite
+AsyncAsset<Sprite> LoadSpriteAsync(const char *file_name,
+  std::function<void(Sprite&)> on_loaded = nullptr);
+
+/// @brief Starts loading a hardware sprite in the background
+/// @details The image is decoded on a decode thread, the texture is created
+///   in ShowFrame on the main thread that owns the OpenGL context.
+AsyncAsset<HwSprite> LoadHwSpriteAsync(const char *file_name,
+  std::function<void(HwSprite&)> on_loaded = nullptr);
+
+/// @brief Starts loading a sound in the background
+/// @param file_name Name of the file to load
+/// @param do_unpack Whether to unpack Vorbis sounds, see Sound::Load
+/// @param on_loaded Called on the main thread when the load is complete
+AsyncAsset<Sound> LoadSoundAsync(const char *file_name, bool do_unpack = true,
+  std::function<void(Sound&)> on_loaded = nullptr);
+
+/// @brief Starts loading a font in the background, see Font::Load
+/// @note Font loading errors are fatal, as they are for Font::Load.
+AsyncAsset<Font> LoadFontAsync(const char *file_name,
+  std::function<void(Font&)> on_loaded = nullptr);
+
+/// @brief Sets the number of I/O and decode threads
+/// @details Waits for the loads in progress. 0 selects the default:
+///   2 I/O threads and a decode thread per core but one.
+/// @note Call from the main thread only, the waiting completes the loads.
+void SetAsyncLoadThreads(Ui32 io_thread_count, Ui32 decode_thread_count);
+
+/// @brief Sets the time ShowFrame spends on completing loads each frame
+/// @param seconds Completion time budget, at least one load is completed
+///   per frame (default 0.004)
+/// @note Call from the main thread only.
+void SetAsyncLoadFrameBudget(double seconds);
+
+/// @brief Returns the number of loads started and not yet complete
+Ui64 GetPendingAsyncLoadCount();
+
+/// @brief Completes the loads whose data is ready, within the frame budget
+/// @note Called automatically by ShowFrame().
+void ProcessAsyncLoads();
+
+/// @brief Waits for all loads started so far and completes them
+/// @note Call from the main thread only.
+void WaitForAsyncLoads();
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_ASYNC_LOADER_H_
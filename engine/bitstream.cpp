@@ -26,60 +26,116 @@
 
 #include "engine/bitstream.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace arctic {
 
-BitStream::BitStream()
-  : write_cursor_(&zero_)
-  , read_cursor_(&zero_) {}
+BitStream::BitStream() {
+}
 
 BitStream::BitStream(const std::vector<Ui8> &data)
-    : write_cursor_(&zero_)
-    , read_cursor_(&zero_) {
-  data_.resize(data.size());
-  std::copy(data.begin(), data.end(), data_.begin());
+    : data_(data)
+    , write_byte_idx_(data.size()) {
   BeginRead();
 }
 
-void BitStream::PushBit(Ui64 bit) {
-  if (unused_bits_) {
-    --unused_bits_;
-    *write_cursor_ |= ((bit & 1ull) << unused_bits_);
-  } else {
-    data_.push_back(static_cast<Ui8>((bit & 1ull) << 7u));
-    write_cursor_ = &data_.back();
-    unused_bits_ = 7;
+void BitStream::Grow() {
+  // New bytes are zero, the unfinished byte is kept
+  data_.resize(std::max(write_byte_idx_ + 8, data_.capacity()));
+}
+
+void BitStream::WriteVarUint(Ui64 value) {
+  while (value >= 0x80) {
+    Write((value & 0x7f) | 0x80, 8);
+    value >>= 7;
   }
+  Write(value, 8);
+}
+
+void BitStream::WriteBytes(const Ui8 *data, Ui64 size) {
+  if (write_bits_ == 0) {
+    data_.resize(write_byte_idx_);
+    data_.insert(data_.end(), data, data + size);
+    write_byte_idx_ = data_.size();
+    return;
+  }
+  Ui64 idx = 0;
+  for (; idx + 8 <= size; idx += 8) {
+    Write(LoadBigEndian64(data + idx), 64);
+  }
+  for (; idx < size; ++idx) {
+    Write(data[idx], 8);
+  }
+}
+
+void BitStream::Clear() {
+  data_.clear();
+  write_byte_idx_ = 0;
+  write_acc_ = 0;
+  write_bits_ = 0;
+  BeginRead();
+}
+
+void BitStream::Assign(const Ui8 *data, Ui64 size) {
+  Clear();
+  data_.assign(data, data + size);
+  write_byte_idx_ = data_.size();
+  BeginRead();
 }
 
 void BitStream::BeginRead() {
-  read_byte_idx_ = 0;
-  read_bit_shift_ = 7;
-  if (!data_.empty()) {
-    read_cursor_ = &data_.front();
-  } else {
-    read_cursor_ = &zero_;
+  read_bit_idx_ = 0;
+  read_end_bit_ = BitCount();
+}
+
+Ui64 BitStream::ReadSlow(Ui32 nbits) {
+  Ui64 value = 0;
+  for (Ui32 i = 0; i < nbits; ++i, ++read_bit_idx_) {
+    Ui64 bit = 0;
+    if (read_bit_idx_ < read_end_bit_) {
+      bit = (data_[read_bit_idx_ >> 3] >> (7 - (read_bit_idx_ & 7))) & 1u;
+    }
+    value = (value << 1) | bit;
+  }
+  return value;
+}
+
+Ui64 BitStream::ReadVarUint() {
+  Ui64 value = 0;
+  for (Ui32 shift = 0; shift < 64; shift += 7) {
+    Ui64 group = Read(8);
+    value |= (group & 0x7f) << shift;
+    if (!(group & 0x80)) {
+      break;
+    }
   }
+  return value;
 }
 
-Ui8 BitStream::ReadBit() {
-  Ui8 bit = (((*read_cursor_) >> read_bit_shift_) & 1ull);
-  if (read_bit_shift_ > 0) {
-    --read_bit_shift_;
-  } else {
-    read_bit_shift_ = 7;
-    read_byte_idx_++;
-    if (read_byte_idx_ < data_.size()) {
-      read_cursor_ = &data_[read_byte_idx_];
-    } else {
-      read_cursor_ = &zero_;
+void BitStream::ReadBytes(Ui8 *out, Ui64 size) {
+  if (read_bit_idx_ & 7) {
+    for (Ui64 idx = 0; idx < size; ++idx) {
+      out[idx] = static_cast<Ui8>(Read(8));
     }
+    return;
+  }
+  const Ui64 begin = read_bit_idx_ >> 3;
+  const Ui64 end = read_end_bit_ >> 3;
+  const Ui64 count = begin < end ? std::min(size, end - begin) : 0;
+  if (count) {
+    std::memcpy(out, data_.data() + begin, static_cast<std::size_t>(count));
+    read_bit_idx_ += count * 8;
+  }
+  // The unfinished last byte and the bits past the end
+  for (Ui64 idx = count; idx < size; ++idx) {
+    out[idx] = static_cast<Ui8>(ReadSlow(8));
   }
-  return bit;
 }
 
-const std::deque<Ui8>& BitStream::GetData() {
+const std::vector<Ui8>& BitStream::GetData() {
+  data_.resize(write_byte_idx_ + (write_bits_ ? 1 : 0));
   return data_;
 }
 
 }  // namespace arctic
-
@@ -24,7 +24,6 @@
 #ifndef ENGINE_BITSTREAM_H_
 #define ENGINE_BITSTREAM_H_
 
-#include <deque>
 #include <vector>
 
 #include "engine/arctic_types.h"
@@ -37,14 +36,40 @@ class BitStream {
   // Single bit is represented with 1 byte of 10000000 or 0x80
   // sequence of 10001001 becomes 1 byte of 0x89
   // adding bits does not change preexisting ones
+  //
+  // Writes keep the bits of the unfinished byte at the bottom of a 64-bit
+  // accumulator and store it with one unaligned 8-byte store, so data_ has
+  // at least 8 bytes past the write cursor. Reads are one unaligned 8-byte
+  // load and two shifts.
  protected:
-  std::deque<Ui8> data_;
-  Ui8 *write_cursor_;
-  Ui8 unused_bits_ = 0;
-  Ui8 *read_cursor_;
-  Ui8 zero_ = 0;
-  std::size_t read_byte_idx_ = 0;
-  Ui64 read_bit_shift_ = 0;
+  std::vector<Ui8> data_;
+  std::size_t write_byte_idx_ = 0;  // The byte holding the next bit
+  Ui64 write_acc_ = 0;  // The lowest write_bits_ bits are the unfinished byte
+  Ui32 write_bits_ = 0;  // 0 to 7
+  Ui64 read_bit_idx_ = 0;
+  Ui64 read_end_bit_ = 0;
+
+  void Grow();
+  Ui64 ReadSlow(Ui32 nbits);
+
+  static Ui64 LoadBigEndian64(const Ui8 *p) {
+    return (static_cast<Ui64>(p[0]) << 56) | (static_cast<Ui64>(p[1]) << 48) |
+      (static_cast<Ui64>(p[2]) << 40) | (static_cast<Ui64>(p[3]) << 32) |
+      (static_cast<Ui64>(p[4]) << 24) | (static_cast<Ui64>(p[5]) << 16) |
+      (static_cast<Ui64>(p[6]) << 8) | static_cast<Ui64>(p[7]);
+  }
+
+  static void StoreBigEndian64(Ui8 *p, Ui64 value) {
+    p[0] = static_cast<Ui8>(value >> 56);
+    p[1] = static_cast<Ui8>(value >> 48);
+    p[2] = static_cast<Ui8>(value >> 40);
+    p[3] = static_cast<Ui8>(value >> 32);
+    p[4] = static_cast<Ui8>(value >> 24);
+    p[5] = static_cast<Ui8>(value >> 16);
+    p[6] = static_cast<Ui8>(value >> 8);
+    p[7] = static_cast<Ui8>(value);
+  }
+
  public:
   BitStream();
 
@@ -53,18 +78,143 @@ class BitStream {
 
   /// @brief Push a bit to the bitstream
   /// @param bit The bit to push. Only the lowest bit is used.
-  void PushBit(Ui64 bit);
+  void PushBit(Ui64 bit) {
+    Write(bit, 1);
+  }
+
+  /// @brief Write the lowest bits of a value, most significant first
+  /// @param value The value to write. Bits above nbits are ignored.
+  /// @param nbits Number of bits to write, 0 to 64.
+  void Write(Ui64 value, Ui32 nbits) {
+    if (nbits > 56) {
+      Write(value >> 32, nbits - 32);
+      Write(value, 32);
+      return;
+    }
+    if (nbits == 0) {
+      return;
+    }
+    if (write_byte_idx_ + 8 > data_.size()) {
+      Grow();
+    }
+    // Members are updated after the byte store that may alias them
+    const Ui32 bits = write_bits_ + nbits;
+    const Ui64 acc = (write_acc_ << nbits) |
+      (value & (~0ull >> (64u - nbits)));
+    const std::size_t byte_idx = write_byte_idx_;
+    StoreBigEndian64(data_.data() + byte_idx, acc << (64u - bits));
+    write_byte_idx_ = byte_idx + (bits >> 3);
+    write_acc_ = acc;
+    write_bits_ = bits & 7;
+  }
+
+  /// @brief Write an unsigned integer in 8-bit groups of 7 value bits
+  /// and a continuation bit (LEB128). Values below 128 take one byte.
+  void WriteVarUint(Ui64 value);
+
+  /// @brief Write a signed integer as a zigzag-encoded WriteVarUint.
+  void WriteVarSint(Si64 value) {
+    WriteVarUint(ZigZagEncode(value));
+  }
+
+  /// @brief Pad the stream with zero bits up to a byte boundary
+  void AlignWrite() {
+    Write(0, (8u - write_bits_) & 7u);
+  }
+
+  /// @brief Write bytes. Writes at a byte boundary are copied in bulk.
+  void WriteBytes(const Ui8 *data, Ui64 size);
+
+  /// @brief Reserve buffer space for a number of bytes
+  void Reserve(Ui64 bytes) {
+    data_.reserve(static_cast<std::size_t>(bytes + 8));
+  }
+
+  /// @brief Remove all bits, keeping the buffer memory for reuse
+  void Clear();
+
+  /// @brief Replace the content with a copy of the data and begin reading,
+  /// reusing the buffer memory
+  void Assign(const Ui8 *data, Ui64 size);
+
+  /// @brief Returns the number of bits written
+  Ui64 BitCount() const {
+    return write_byte_idx_ * 8ull + write_bits_;
+  }
 
   /// @brief Begin reading from the bitstream
   void BeginRead();
 
   /// @brief Read a bit from the bitstream
   /// @return The bit read. Only the lowest bit is used.
-  Ui8 ReadBit();
+  Ui8 ReadBit() {
+    return static_cast<Ui8>(Read(1));
+  }
+
+  /// @brief Read bits in the order they were written. Bits past the end
+  /// of the data read at BeginRead are zeros.
+  /// @param nbits Number of bits to read, 0 to 64.
+  /// @return The value read.
+  Ui64 Read(Ui32 nbits) {
+    if (nbits > 56) {
+      Ui64 high = Read(nbits - 32);
+      return (high << 32) | Read(32);
+    }
+    if (nbits == 0) {
+      return 0;
+    }
+    if (read_bit_idx_ + nbits > read_end_bit_ ||
+        (read_bit_idx_ >> 3) + 8 > data_.size()) {
+      return ReadSlow(nbits);
+    }
+    Ui64 word = LoadBigEndian64(data_.data() + (read_bit_idx_ >> 3));
+    word <<= read_bit_idx_ & 7;
+    read_bit_idx_ += nbits;
+    return word >> (64u - nbits);
+  }
+
+  /// @brief Read an unsigned integer written with WriteVarUint
+  Ui64 ReadVarUint();
+
+  /// @brief Read a signed integer written with WriteVarSint
+  Si64 ReadVarSint() {
+    return ZigZagDecode(ReadVarUint());
+  }
+
+  /// @brief Skip bits up to the next byte boundary
+  void AlignRead() {
+    read_bit_idx_ = (read_bit_idx_ + 7) & ~7ull;
+  }
+
+  /// @brief Read bytes. Reads at a byte boundary are copied in bulk.
+  void ReadBytes(Ui8 *out, Ui64 size);
+
+  /// @brief Returns the number of unread bits
+  Ui64 ReadBitsLeft() const {
+    return read_bit_idx_ < read_end_bit_ ? read_end_bit_ - read_bit_idx_ : 0;
+  }
+
+  /// @brief Returns true if more bits were read than the data holds
+  bool IsReadPastEnd() const {
+    return read_bit_idx_ > read_end_bit_;
+  }
 
   /// @brief Get the underlying data of the bitstream
-  /// @return The underlying data of the bitstream
-  const std::deque<Ui8>& GetData();
+  /// @return The underlying data of the bitstream. The last byte is padded
+  /// with zero bits.
+  const std::vector<Ui8>& GetData();
+
+  /// @brief Maps signed integers to unsigned ones so that small magnitudes
+  /// stay small: 0, -1, 1, -2 become 0, 1, 2, 3.
+  static Ui64 ZigZagEncode(Si64 value) {
+    return (static_cast<Ui64>(value) << 1) ^
+      static_cast<Ui64>(value >> 63);
+  }
+
+  /// @brief Inverse of ZigZagEncode
+  static Si64 ZigZagDecode(Ui64 value) {
+    return static_cast<Si64>((value >> 1) ^ (0ull - (value & 1ull)));
+  }
 };
 /// @}
 
@@ -0,0 +1,469 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/compressed_data.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "engine/arctic_platform_fatal.h"
+#include "engine/miniz.h"
+
+namespace arctic {
+
+namespace {
+
+// File layout, little-endian: "ACDZ", version, block size, then blocks of
+// raw size, stored size and the stored bytes. The high bit of the stored
+// size marks a block stored as is. A block of raw size 0 ends the file.
+const Ui8 kCompressedMagic[4] = {'A', 'C', 'D', 'Z'};
+const Ui32 kCompressedVersion = 1;
+const Ui32 kCompressedHeaderSize = 12;
+const Ui32 kBlockHeaderSize = 8;
+const Ui32 kStoredRawFlag = 0x80000000u;
+const Ui64 kMinBlockSize = 4 << 10;
+const Ui64 kMaxBlockSize = 1 << 30;
+// Blocks in flight between the caller and the thread, bounds the memory
+const size_t kMaxQueuedBlocks = 3;
+// After a block stored as is, the next one is stored as is too unless
+// its first bytes shrink
+const size_t kProbeSize = 16 << 10;
+
+void PutUint32(Ui32 value, Ui8 *out) {
+  out[0] = static_cast<Ui8>(value);
+  out[1] = static_cast<Ui8>(value >> 8);
+  out[2] = static_cast<Ui8>(value >> 16);
+  out[3] = static_cast<Ui8>(value >> 24);
+}
+
+Ui32 GetUint32(const Ui8 *in) {
+  return static_cast<Ui32>(in[0]) | (static_cast<Ui32>(in[1]) << 8) |
+    (static_cast<Ui32>(in[2]) << 16) | (static_cast<Ui32>(in[3]) << 24);
+}
+
+}  // namespace
+
+class CompressedDataWriter::Worker : public DataSink {
+ public:
+  Worker(Si32 level, Ui64 block_size, bool is_raw_if_incompressible)
+      : level_(level)
+      , block_size_(block_size)
+      , is_raw_if_incompressible_(is_raw_if_incompressible) {
+  }
+
+  ~Worker() {
+    Finish();
+  }
+
+  bool Start(const char *file_name) {
+    file_.open(file_name,
+      std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!file_.is_open() || mz_deflateInit(&deflate_, level_) != MZ_OK) {
+      return false;
+    }
+    is_deflate_init_ = true;
+    Ui8 header[kCompressedHeaderSize];
+    std::memcpy(header, kCompressedMagic, 4);
+    PutUint32(kCompressedVersion, header + 4);
+    PutUint32(static_cast<Ui32>(block_size_), header + 8);
+    WriteFile(header, sizeof(header));
+    thread_ = std::thread(&Worker::Run, this);
+    return true;
+  }
+
+  bool Consume(std::vector<Ui8> *data) override {
+    raw_size_ += data->size();
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_condition_.wait(lock, [this] {
+      return queue_.size() < kMaxQueuedBlocks;
+    });
+    queue_.push_back(std::move(*data));
+    if (free_blocks_.empty()) {
+      data->clear();
+      data->reserve(static_cast<size_t>(block_size_));
+    } else {
+      *data = std::move(free_blocks_.back());
+      free_blocks_.pop_back();
+    }
+    work_condition_.notify_one();
+    return is_ok_;
+  }
+
+  bool Finish() {
+    if (thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_finishing_ = true;
+      }
+      work_condition_.notify_one();
+      thread_.join();
+      Ui8 end_marker[kBlockHeaderSize] = {};
+      WriteFile(end_marker, sizeof(end_marker));
+      file_.close();
+      is_ok_ = is_ok_ && !file_.fail();
+    }
+    if (is_deflate_init_) {
+      mz_deflateEnd(&deflate_);
+      is_deflate_init_ = false;
+    }
+    return is_ok_;
+  }
+
+  Ui64 GetRawSize() const {
+    return raw_size_;
+  }
+
+  Ui64 GetCompressedSize() const {
+    return compressed_size_;
+  }
+
+ private:
+  void Run() {
+    while (true) {
+      std::vector<Ui8> block;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_condition_.wait(lock, [this] {
+          return !queue_.empty() || is_finishing_;
+        });
+        if (queue_.empty()) {
+          return;
+        }
+        block = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      // Writes larger than a block arrive as one buffer
+      for (size_t pos = 0; pos < block.size(); pos += block_size_) {
+        CompressBlock(block.data() + pos,
+          std::min<size_t>(block.size() - pos, block_size_));
+      }
+      block.clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_blocks_.push_back(std::move(block));
+      }
+      space_condition_.notify_one();
+    }
+  }
+
+  // Returns the deflated size or 0 if the output does not fit
+  size_t Deflate(const Ui8 *data, size_t size) {
+    mz_deflateReset(&deflate_);
+    compressed_.resize(kBlockHeaderSize +
+      mz_deflateBound(&deflate_, static_cast<mz_ulong>(size)));
+    deflate_.next_in = data;
+    deflate_.avail_in = static_cast<unsigned int>(size);
+    deflate_.next_out = compressed_.data() + kBlockHeaderSize;
+    deflate_.avail_out = static_cast<unsigned int>(
+      compressed_.size() - kBlockHeaderSize);
+    if (mz_deflate(&deflate_, MZ_FINISH) != MZ_STREAM_END) {
+      return 0;
+    }
+    return static_cast<size_t>(deflate_.total_out);
+  }
+
+  void CompressBlock(const Ui8 *data, size_t size) {
+    size_t stored_size = 0;
+    if (!is_last_raw_ || size <= kProbeSize * 2 ||
+        Deflate(data, kProbeSize) < kProbeSize - kProbeSize / 32) {
+      stored_size = Deflate(data, size);
+    }
+    Ui8 header[kBlockHeaderSize];
+    PutUint32(static_cast<Ui32>(size), header);
+    bool is_raw = !stored_size ||
+      (is_raw_if_incompressible_ && stored_size >= size);
+    is_last_raw_ = is_raw && is_raw_if_incompressible_;
+    if (is_raw) {
+      PutUint32(static_cast<Ui32>(size) | kStoredRawFlag, header + 4);
+      WriteFile(header, kBlockHeaderSize);
+      WriteFile(data, size);
+      return;
+    }
+    PutUint32(static_cast<Ui32>(stored_size), header + 4);
+    std::memcpy(compressed_.data(), header, kBlockHeaderSize);
+    WriteFile(compressed_.data(), kBlockHeaderSize + stored_size);
+  }
+
+  void WriteFile(const Ui8 *data, size_t size) {
+    file_.write(reinterpret_cast<const char*>(data),
+      static_cast<std::streamsize>(size));
+    compressed_size_ += size;
+    if (!file_.good()) {
+      is_ok_ = false;
+    }
+  }
+
+  const Si32 level_;
+  const Ui64 block_size_;
+  const bool is_raw_if_incompressible_;
+  std::ofstream file_;
+  mz_stream deflate_ = {};
+  bool is_deflate_init_ = false;
+  bool is_last_raw_ = false;
+  std::vector<Ui8> compressed_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable work_condition_;
+  std::condition_variable space_condition_;
+  std::deque<std::vector<Ui8>> queue_;
+  std::vector<std::vector<Ui8>> free_blocks_;
+  bool is_finishing_ = false;
+  std::atomic<bool> is_ok_{true};
+  Ui64 raw_size_ = 0;
+  std::atomic<Ui64> compressed_size_{0};
+};
+
+CompressedDataWriter::CompressedDataWriter() {
+}
+
+CompressedDataWriter::~CompressedDataWriter() {
+  Close();
+}
+
+bool CompressedDataWriter::Open(const char *file_name, Si32 level,
+    Ui64 block_size, bool is_raw_if_incompressible) {
+  Check(level >= 0 && level <= 10,
+    "CompressedDataWriter level must be 0 to 10");
+  Check(block_size >= kMinBlockSize && block_size <= kMaxBlockSize,
+    "CompressedDataWriter block size must be 4 KiB to 1 GiB");
+  Close();
+  worker_.reset(new Worker(level, block_size, is_raw_if_incompressible));
+  if (!worker_->Start(file_name)) {
+    worker_.reset();
+    return false;
+  }
+  OpenSink(worker_.get(), block_size);
+  return true;
+}
+
+bool CompressedDataWriter::Close() {
+  bool is_ok = DataWriter::Close();
+  if (worker_) {
+    is_ok = worker_->Finish() && is_ok;
+  }
+  return is_ok;
+}
+
+Ui64 CompressedDataWriter::GetRawSize() const {
+  return worker_ ? worker_->GetRawSize() + data.size() : 0;
+}
+
+Ui64 CompressedDataWriter::GetCompressedSize() const {
+  return worker_ ? worker_->GetCompressedSize() : 0;
+}
+
+class CompressedDataReader::Worker : public DataSource {
+ public:
+  ~Worker() {
+    if (thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopping_ = true;
+      }
+      space_condition_.notify_one();
+      thread_.join();
+    }
+    if (is_inflate_init_) {
+      mz_inflateEnd(&inflate_);
+    }
+  }
+
+  bool Start(const char *file_name) {
+    file_.open(file_name, std::ios_base::in | std::ios_base::binary);
+    Ui8 header[kCompressedHeaderSize];
+    if (!file_.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        std::memcmp(header, kCompressedMagic, 4) != 0 ||
+        GetUint32(header + 4) != kCompressedVersion) {
+      return false;
+    }
+    block_size_ = GetUint32(header + 8);
+    if (block_size_ < kMinBlockSize || block_size_ > kMaxBlockSize ||
+        mz_inflateInit(&inflate_) != MZ_OK) {
+      return false;
+    }
+    is_inflate_init_ = true;
+    thread_ = std::thread(&Worker::Run, this);
+    return true;
+  }
+
+  Ui64 Read(void *dst, Ui64 size) override {
+    Ui8 *out = static_cast<Ui8*>(dst);
+    Ui64 done = 0;
+    while (done < size) {
+      if (current_pos_ == current_.size()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (current_.capacity()) {
+          current_.clear();
+          free_blocks_.push_back(std::move(current_));
+          current_.clear();
+          current_pos_ = 0;
+        }
+        ready_condition_.wait(lock, [this] {
+          return !ready_.empty() || is_done_;
+        });
+        if (ready_.empty()) {
+          break;
+        }
+        current_ = std::move(ready_.front());
+        ready_.pop_front();
+        current_pos_ = 0;
+        space_condition_.notify_one();
+      }
+      Ui64 part = std::min<Ui64>(size - done, current_.size() - current_pos_);
+      std::memcpy(out + done, current_.data() + current_pos_,
+        static_cast<size_t>(part));
+      current_pos_ += static_cast<size_t>(part);
+      done += part;
+    }
+    return done;
+  }
+
+  bool IsCorrupt() const {
+    return is_corrupt_;
+  }
+
+ private:
+  void Run() {
+    bool is_ok = true;
+    while (is_ok) {
+      std::vector<Ui8> block;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_condition_.wait(lock, [this] {
+          return ready_.size() < kMaxQueuedBlocks || is_stopping_;
+        });
+        if (is_stopping_) {
+          break;
+        }
+        if (!free_blocks_.empty()) {
+          block = std::move(free_blocks_.back());
+          free_blocks_.pop_back();
+        }
+      }
+      Ui8 header[kBlockHeaderSize];
+      if (!file_.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        is_corrupt_ = true;
+        break;
+      }
+      Ui32 raw_size = GetUint32(header);
+      Ui32 stored_size = GetUint32(header + 4);
+      if (raw_size == 0) {
+        is_corrupt_ = (stored_size != 0);
+        break;
+      }
+      is_ok = ReadBlock(raw_size, stored_size, &block);
+      if (!is_ok) {
+        is_corrupt_ = true;
+        break;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.push_back(std::move(block));
+      }
+      ready_condition_.notify_one();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_done_ = true;
+    }
+    ready_condition_.notify_one();
+  }
+
+  bool ReadBlock(Ui32 raw_size, Ui32 stored_size, std::vector<Ui8> *out) {
+    if (raw_size > block_size_) {
+      return false;
+    }
+    out->resize(raw_size);
+    if (stored_size & kStoredRawFlag) {
+      return (stored_size & ~kStoredRawFlag) == raw_size &&
+        file_.read(reinterpret_cast<char*>(out->data()), raw_size);
+    }
+    if (stored_size > mz_compressBound(static_cast<mz_ulong>(block_size_))) {
+      return false;
+    }
+    compressed_.resize(stored_size);
+    if (!file_.read(reinterpret_cast<char*>(compressed_.data()),
+        stored_size)) {
+      return false;
+    }
+    mz_inflateReset(&inflate_);
+    inflate_.next_in = compressed_.data();
+    inflate_.avail_in = stored_size;
+    inflate_.next_out = out->data();
+    inflate_.avail_out = raw_size;
+    return mz_inflate(&inflate_, MZ_FINISH) == MZ_STREAM_END &&
+      inflate_.total_out == raw_size;
+  }
+
+  std::ifstream file_;
+  Ui64 block_size_ = 0;
+  mz_stream inflate_ = {};
+  bool is_inflate_init_ = false;
+  std::vector<Ui8> compressed_;
+  std::vector<Ui8> current_;
+  size_t current_pos_ = 0;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable ready_condition_;
+  std::condition_variable space_condition_;
+  std::deque<std::vector<Ui8>> ready_;
+  std::vector<std::vector<Ui8>> free_blocks_;
+  bool is_stopping_ = false;
+  bool is_done_ = false;
+  std::atomic<bool> is_corrupt_{false};
+};
+
+CompressedDataReader::CompressedDataReader() {
+}
+
+CompressedDataReader::~CompressedDataReader() {
+  Close();
+}
+
+bool CompressedDataReader::Open(const char *file_name, Ui64 buffer_size) {
+  Close();
+  worker_.reset(new Worker());
+  if (!worker_->Start(file_name)) {
+    worker_.reset();
+    return false;
+  }
+  OpenSource(worker_.get(), buffer_size);
+  return true;
+}
+
+void CompressedDataReader::Close() {
+  ResetView(nullptr, 0);
+  worker_.reset();
+}
+
+bool CompressedDataReader::IsCorrupt() const {
+  return worker_ && worker_->IsCorrupt();
+}
+
+}  // namespace arctic
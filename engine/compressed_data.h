@@ -0,0 +1,110 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_COMPRESSED_DATA_H_
+#define ENGINE_COMPRESSED_DATA_H_
+
+#include <memory>
+
+#include "engine/arctic_types.h"
+#include "engine/data_reader.h"
+#include "engine/data_writer.h"
+
+namespace arctic {
+
+/// @addtogroup global_utility
+/// @{
+
+/// @brief A DataWriter that deflates its data into a file
+///
+/// The buffer is handed to a background thread whenever it fills a block,
+/// so compressing a large save game or replay does not stall the frame.
+/// Blocks are compressed independently with a zlib checksum each. Writes
+/// wait only if the thread falls several blocks behind.
+/// Example:
+/// @code
+///   CompressedDataWriter writer;
+///   writer.Open("save.bin", 6);
+///   writer.WriteUInt32(version);
+///   writer.WriteArray(positions.data(), positions.size());
+///   bool is_saved = writer.Close();
+/// @endcode
+struct CompressedDataWriter : public DataWriter {
+  CompressedDataWriter();
+  ~CompressedDataWriter();
+
+  /// @brief Truncates the file and starts writing to it
+  /// @param file_name Path to the file
+  /// @param level Compression level, 0 (store) to 10 (slowest)
+  /// @param block_size Bytes compressed at once, 4 KiB to 1 GiB
+  /// @param is_raw_if_incompressible Store blocks that don't shrink as is
+  /// @return True if the file is open
+  bool Open(const char *file_name, Si32 level = 6,
+    Ui64 block_size = 1 << 20, bool is_raw_if_incompressible = true);
+
+  /// @brief Compresses the rest of the data, waits for the thread and
+  /// closes the file
+  /// @return True if all data reached the file
+  bool Close();
+
+  /// @brief Returns the number of bytes written so far, as passed to Write
+  Ui64 GetRawSize() const;
+
+  /// @brief Returns the size of the file, final after Close
+  Ui64 GetCompressedSize() const;
+
+ private:
+  class Worker;
+  std::unique_ptr<Worker> worker_;
+};
+
+/// @brief A DataReader that inflates a file written by CompressedDataWriter
+///
+/// A background thread reads and inflates the blocks ahead of the reads.
+/// Corrupt or truncated data ends the data early, so the reads past it
+/// fail like reads past the end of the file.
+struct CompressedDataReader : public DataReader {
+  CompressedDataReader();
+  ~CompressedDataReader();
+
+  /// @brief Starts reading a file
+  /// @param file_name Path to the file
+  /// @param buffer_size Bytes taken from the inflated blocks at once
+  /// @return True if the file is open and has a valid header
+  bool Open(const char *file_name, Ui64 buffer_size = 1 << 16);
+
+  /// @brief Stops the thread and closes the file
+  void Close();
+
+  /// @brief Returns true if the data ended at a corrupt or truncated block
+  bool IsCorrupt() const;
+
+ private:
+  class Worker;
+  std::unique_ptr<Worker> worker_;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_COMPRESSED_DATA_H_
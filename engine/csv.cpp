@@ -24,14 +24,28 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <sstream>
 #include <iomanip>
-#include <cstring>
+#include <limits>
+#include <sstream>
+#include <thread>  // NOLINT
+#include <utility>
 
 #include "engine/csv.h"
 #include "engine/arctic_types.h"
 #include "engine/arctic_platform_fatal.h"
+#include "engine/mapped_file.h"
+#include "engine/profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARCTIC_CSV_SSE2
+#endif
 
 namespace arctic {
 
@@ -59,75 +73,423 @@ static std::string CsvEscapeField(const std::string &field, char sep) {
   return result;
 }
 
+template<typename T>
+static bool ParseCsvInteger(CsvCell cell, T *out_value) {
+  const char *p = cell.data;
+  const char *end = cell.data + cell.size;
+  while (p != end && (*p == ' ' || *p == '\t')) {
+    ++p;
+  }
+  bool is_negative = false;
+  if (p != end && (*p == '-' || *p == '+')) {
+    is_negative = (*p == '-');
+    ++p;
+  }
+  if (p == end || (is_negative && !std::numeric_limits<T>::is_signed)) {
+    return false;
+  }
+  const Ui64 limit = static_cast<Ui64>(std::numeric_limits<T>::max()) +
+    (is_negative ? 1 : 0);
+  Ui64 value = 0;
+  for (; p != end; ++p) {
+    Ui32 digit = static_cast<Ui32>(static_cast<Ui8>(*p)) - '0';
+    if (digit > 9 || value > (limit - digit) / 10) {
+      return false;
+    }
+    value = value * 10 + digit;
+  }
+  if (is_negative) {
+    *out_value = static_cast<T>(-static_cast<Si64>(value - 1) - 1);
+  } else {
+    *out_value = static_cast<T>(value);
+  }
+  return true;
+}
+
+template<typename T, typename TParse>
+static bool ParseCsvFloat(CsvCell cell, T *out_value, TParse parse) {
+  // strtod needs a terminating zero, cells in the table buffer have none.
+  char buffer[64];
+  std::string long_text;
+  const char *text = buffer;
+  if (cell.size < sizeof(buffer)) {
+    memcpy(buffer, cell.data, static_cast<size_t>(cell.size));
+    buffer[cell.size] = '\0';
+  } else {
+    long_text = cell.ToString();
+    text = long_text.c_str();
+  }
+  while (*text == ' ' || *text == '\t') {
+    ++text;
+  }
+  char *end = nullptr;
+  T value = parse(text, &end);
+  if (end == text || *end != '\0') {
+    return false;
+  }
+  *out_value = value;
+  return true;
+}
+
+bool ParseCsvCell(CsvCell cell, Si16 *out_value) {
+  return ParseCsvInteger(cell, out_value);
+}
+
+bool ParseCsvCell(CsvCell cell, Ui16 *out_value) {
+  return ParseCsvInteger(cell, out_value);
+}
+
+bool ParseCsvCell(CsvCell cell, Si32 *out_value) {
+  return ParseCsvInteger(cell, out_value);
+}
+
+bool ParseCsvCell(CsvCell cell, Ui32 *out_value) {
+  return ParseCsvInteger(cell, out_value);
+}
+
+bool ParseCsvCell(CsvCell cell, Si64 *out_value) {
+  return ParseCsvInteger(cell, out_value);
+}
+
+bool ParseCsvCell(CsvCell cell, Ui64 *out_value) {
+  return ParseCsvInteger(cell, out_value);
+}
+
+bool ParseCsvCell(CsvCell cell, float *out_value) {
+  return ParseCsvFloat(cell, out_value, [](const char *text, char **end) {
+    return std::strtof(text, end);
+  });
+}
+
+bool ParseCsvCell(CsvCell cell, double *out_value) {
+  return ParseCsvFloat(cell, out_value, [](const char *text, char **end) {
+    return std::strtod(text, end);
+  });
+}
+
+bool ParseCsvCell(CsvCell cell, std::string *out_value) {
+  out_value->assign(cell.data, static_cast<size_t>(cell.size));
+  return true;
+}
+
+CsvHeader::CsvHeader(std::vector<std::string> names)
+    : names_(std::move(names)) {
+  index_.reserve(names_.size());
+  for (size_t i = 0; i < names_.size(); ++i) {
+    index_.emplace(names_[i], static_cast<Ui64>(i));
+  }
+}
+
+Si64 CsvHeader::Find(const std::string &name) const {
+  auto it = index_.find(name);
+  if (it == index_.end()) {
+    return -1;
+  }
+  return static_cast<Si64>(it->second);
+}
+
+// Positions and counts in the quote-parity pre-pass.
+static const Ui64 kCsvNoPosition = std::numeric_limits<Ui64>::max();
+
+// Returns the position of the first byte in [pos, end) that is equal to a, b
+// or c, or end if there is none.
+static Ui64 FindCsvByte(const char *data, Ui64 pos, Ui64 end,
+    char a, char b, char c) {
+#ifdef ARCTIC_CSV_SSE2
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  const __m128i vc = _mm_set1_epi8(c);
+  while (pos + 16 <= end) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va),
+      _mm_cmpeq_epi8(v, vb)), _mm_cmpeq_epi8(v, vc));
+    Ui32 mask = static_cast<Ui32>(_mm_movemask_epi8(eq));
+    if (mask) {
+      Ui64 idx = 0;
+      while (!(mask & 1)) {
+        mask >>= 1;
+        ++idx;
+      }
+      return pos + idx;
+    }
+    pos += 16;
+  }
+#else
+  // Eight bytes at a time, a byte of (x ^ pattern) is zero on a match.
+  const Ui64 kOnes = 0x0101010101010101ull;
+  const Ui64 kHighs = 0x8080808080808080ull;
+  const Ui64 pa = kOnes * static_cast<Ui8>(a);
+  const Ui64 pb = kOnes * static_cast<Ui8>(b);
+  const Ui64 pc = kOnes * static_cast<Ui8>(c);
+  while (pos + 8 <= end) {
+    Ui64 v;
+    memcpy(&v, data + pos, sizeof(v));
+    Ui64 xa = v ^ pa;
+    Ui64 xb = v ^ pb;
+    Ui64 xc = v ^ pc;
+    if (((xa - kOnes) & ~xa & kHighs) | ((xb - kOnes) & ~xb & kHighs) |
+        ((xc - kOnes) & ~xc & kHighs)) {
+      break;
+    }
+    pos += 8;
+  }
+#endif  // ARCTIC_CSV_SSE2
+  for (; pos < end; ++pos) {
+    char ch = data[pos];
+    if (ch == a || ch == b || ch == c) {
+      return pos;
+    }
+  }
+  return end;
+}
+
+// Counts quotes and line feeds in [pos, end).
+static void CountCsvQuotesAndLines(const char *data, Ui64 pos, Ui64 end,
+    Ui64 *in_out_quotes, Ui64 *in_out_lines) {
+  Ui64 quotes = 0;
+  Ui64 lines = 0;
+#ifdef ARCTIC_CSV_SSE2
+  const __m128i vq = _mm_set1_epi8('"');
+  const __m128i vn = _mm_set1_epi8('\n');
+  const __m128i zero = _mm_setzero_si128();
+  while (pos + 16 <= end) {
+    // Byte counters are flushed before they can overflow.
+    __m128i acc_q = zero;
+    __m128i acc_n = zero;
+    for (Si32 i = 0; i < 255 && pos + 16 <= end; ++i, pos += 16) {
+      __m128i v = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(data + pos));
+      acc_q = _mm_sub_epi8(acc_q, _mm_cmpeq_epi8(v, vq));
+      acc_n = _mm_sub_epi8(acc_n, _mm_cmpeq_epi8(v, vn));
+    }
+    __m128i sum_q = _mm_sad_epu8(acc_q, zero);
+    __m128i sum_n = _mm_sad_epu8(acc_n, zero);
+    quotes += static_cast<Ui64>(_mm_cvtsi128_si32(sum_q)) +
+      static_cast<Ui64>(_mm_cvtsi128_si32(_mm_srli_si128(sum_q, 8)));
+    lines += static_cast<Ui64>(_mm_cvtsi128_si32(sum_n)) +
+      static_cast<Ui64>(_mm_cvtsi128_si32(_mm_srli_si128(sum_n, 8)));
+  }
+#endif  // ARCTIC_CSV_SSE2
+  for (; pos < end; ++pos) {
+    quotes += (data[pos] == '"');
+    lines += (data[pos] == '\n');
+  }
+  *in_out_quotes += quotes;
+  *in_out_lines += lines;
+}
+
+static Ui64 SkipCsvEmptyLines(const char *data, Ui64 pos, Ui64 end) {
+  while (pos < end && data[pos] == '\n') {
+    ++pos;
+  }
+  return pos;
+}
+
+// Splits the record starting at *in_out_pos into cells, calls
+// on_cell(begin, size) for each of them and moves *in_out_pos past the line
+// feed ending the record. Quotes switch quoting on and off anywhere in a
+// field, they are removed and "" inside quotes is unescaped in place, the
+// output never outruns the input. Line feeds inside quotes belong to the
+// cell. Returns false if the record ends inside quotes. Used by both
+// CsvTable and CsvStreamReader, so they split records the same way.
+template<typename TOnCell>
+static bool SplitCsvRecord(char *data, Ui64 *in_out_pos, Ui64 end, char sep,
+    const TOnCell &on_cell) {
+  Ui64 i = *in_out_pos;
+  Ui64 out = i;
+  Ui64 cell_begin = i;
+  bool quoted = false;
+  while (true) {
+    Ui64 next = quoted ? FindCsvByte(data, i, end, '"', '"', '"')
+      : FindCsvByte(data, i, end, sep, '"', '\n');
+    if (out != i) {
+      memmove(data + out, data + i, static_cast<size_t>(next - i));
+    }
+    out += next - i;
+    i = next;
+    if (i == end) {
+      break;
+    }
+    char c = data[i];
+    if (c == '"') {
+      if (quoted && i + 1 < end && data[i + 1] == '"') {
+        data[out++] = '"';
+        i += 2;
+      } else {
+        quoted = !quoted;
+        ++i;
+      }
+    } else if (c == sep) {
+      Ui64 cell_end = out;
+      while (cell_end > cell_begin && data[cell_end - 1] == '\r') {
+        --cell_end;
+      }
+      on_cell(cell_begin, cell_end - cell_begin);
+      ++i;
+      cell_begin = out;
+    } else {
+      ++i;
+      break;
+    }
+  }
+  Ui64 cell_end = out;
+  while (cell_end > cell_begin && data[cell_end - 1] == '\r') {
+    --cell_end;
+  }
+  on_cell(cell_begin, cell_end - cell_begin);
+  *in_out_pos = i;
+  return !quoted;
+}
+
+// Part of the data parsed by one job.
+struct CsvTable::Chunk {
+  Ui64 begin = 0;
+  Ui64 end = 0;
+  Ui64 line_count = 0;
+  std::vector<CellRange> cells;
+  Ui64 row_count = 0;
+  bool is_ok = true;
+  bool is_unmatched_quote = false;
+  Ui64 error_cell_count = 0;
+};
+
+// Quote-parity statistics of a fixed-size region of the data.
+struct CsvRegionStats {
+  Ui64 quote_count = 0;
+  Ui64 line_count = 0;
+  // The first line feed preceded by an even and by an odd number of quotes
+  // in the region.
+  Ui64 first_line_end[2] = {kCsvNoPosition, kCsvNoPosition};
+};
+
+static void ScanCsvRegion(const char *data, Ui64 begin, Ui64 end,
+    CsvRegionStats *stats) {
+  Ui64 pos = begin;
+  while (stats->first_line_end[0] == kCsvNoPosition ||
+      stats->first_line_end[1] == kCsvNoPosition) {
+    pos = FindCsvByte(data, pos, end, '"', '\n', '\n');
+    if (pos == end) {
+      return;
+    }
+    if (data[pos] == '"') {
+      stats->quote_count++;
+    } else {
+      stats->line_count++;
+      Ui64 &line_end = stats->first_line_end[stats->quote_count & 1];
+      if (line_end == kCsvNoPosition) {
+        line_end = pos;
+      }
+    }
+    ++pos;
+  }
+  CountCsvQuotesAndLines(data, pos, end, &stats->quote_count,
+    &stats->line_count);
+}
+
+// Runs job(0) ... job(job_count - 1) on up to thread_count threads.
+template<typename TJob>
+static void RunCsvJobs(Ui64 job_count, Ui32 thread_count, const TJob &job) {
+  std::atomic<Ui64> next_job(0);
+  auto worker = [&next_job, job_count, &job]() {
+    for (Ui64 idx = next_job++; idx < job_count; idx = next_job++) {
+      job(idx);
+    }
+  };
+  std::vector<std::thread> threads;
+  Ui64 extra_threads = std::min<Ui64>(thread_count, job_count);
+  for (Ui64 i = 1; i < extra_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
 CsvRow CsvRow::invalid_row_{std::vector<std::string>()};
 
-CsvTable::CsvTable() {
+const Ui64 CsvTable::kDefaultChunkSize;
+
+CsvTable::CsvTable()
+    : header_(std::make_shared<CsvHeader>(std::vector<std::string>())) {
 }
 
 void CsvTable::Clear() {
-  for (auto it = content_.begin(); it != content_.end(); ++it) {
-    delete *it;
+  for (RowSlot &slot : rows_) {
+    delete slot.row;
   }
-  content_.clear();
-  header_.clear();
-  original_file_.clear();
+  rows_.clear();
+  cells_.clear();
+  data_.clear();
+  mapping_.Close();
+  text_ = nullptr;
+  text_size_ = 0;
+  parse_pos_ = 0;
+  header_ = std::make_shared<CsvHeader>(std::vector<std::string>());
   error_description.clear();
 }
 
+void CsvTable::SetParallelism(Ui32 thread_count, Ui64 chunk_size) {
+  thread_count_ = thread_count;
+  chunk_size_ = std::max<Ui64>(chunk_size, 1);
+}
+
+bool CsvTable::SplitRecord(char *data, Ui64 *in_out_pos, Ui64 end, char sep,
+    std::vector<CellRange> *out_cells) {
+  return SplitCsvRecord(data, in_out_pos, end, sep,
+    [out_cells](Ui64 begin, Ui64 size) {
+      out_cells->push_back(CellRange{static_cast<Ui32>(begin),
+        static_cast<Ui32>(size)});
+    });
+}
+
 bool CsvTable::LoadFile(const std::string &filename, char sep) {
+  ARCTIC_PROFILE_SCOPE("CsvTable::LoadFile");
   Clear();
   type_ = kCsvSourceFile;
   sep_ = sep;
   file_ = filename;
-  std::string line;
-  std::ifstream ifile(file_.c_str());
-  if (ifile.is_open()) {
-    while (ifile.good()) {
-      getline(ifile, line);
-      if (!line.empty()) {
-        original_file_.push_back(line);
-      }
-    }
-    ifile.close();
+  // Records are unquoted in place in the private copy-on-write pages
+  if (!mapping_.Open(file_.c_str(), true)) {
+    error_description = std::string("Failed to open ").append(file_);
+    return false;
+  }
+  text_ = reinterpret_cast<char*>(mapping_.MutableData());
+  text_size_ = mapping_.Size();
 
-    if (original_file_.empty()) {
-      error_description = std::string("No Data in ").append(file_);
+  Ui64 begin = SkipCsvEmptyLines(text_, 0, text_size_);
+  if (begin == text_size_) {
+    error_description = std::string("No Data in ").append(file_);
+    return false;
+  }
+  // Remove the BOM (Byte Order Mark) for UTF-8
+  if (text_size_ - begin >= 3 &&
+      Ui8(text_[begin]) == 0xEF &&
+      Ui8(text_[begin + 1]) == 0xBB &&
+      Ui8(text_[begin + 2]) == 0xBF) {
+    // Check if header becomes empty after BOM removal
+    if (begin + 3 == text_size_ || text_[begin + 3] == '\n') {
+      error_description = "Header line is empty after BOM removal";
       return false;
     }
-    // Remove the BOM (Byte Order Mark) for UTF-8
-    if (original_file_[0].length() >= 3 &&
-        Ui8(original_file_[0][0]) == 0xEF &&
-        Ui8(original_file_[0][1]) == 0xBB &&
-        Ui8(original_file_[0][2]) == 0xBF) {
-      original_file_[0] = original_file_[0].erase(0, 3);
-      // Check if header becomes empty after BOM removal
-      if (original_file_[0].empty()) {
-        error_description = "Header line is empty after BOM removal";
-        return false;
-      }
-    }
-    bool is_ok = true;
-    is_ok = is_ok && ParseHeader();
-    is_ok = is_ok && ParseContent();
-    return is_ok;
-  } else {
-    error_description = std::string("Failed to open ").append(file_);
-    return false;
+    begin += 3;
   }
+  parse_pos_ = begin;
+  bool is_ok = true;
+  is_ok = is_ok && ParseHeader();
+  is_ok = is_ok && ParseContent();
+  return is_ok;
 }
 
 bool CsvTable::LoadString(const std::string &data, char sep) {
+  ARCTIC_PROFILE_SCOPE("CsvTable::LoadString");
   Clear();
   type_ = kCsvSourcePure;
   sep_ = sep;
-  std::string line;
-  std::istringstream stream(data);
-  while (std::getline(stream, line)) {
-    if (!line.empty()) {
-      original_file_.push_back(line);
-    }
-  }
-  if (original_file_.empty()) {
+  data_ = data;
+  text_ = &data_[0];
+  text_size_ = data_.size();
+  if (SkipCsvEmptyLines(text_, 0, text_size_) == text_size_) {
     error_description = std::string("No Data in pure content");
     return false;
   }
@@ -143,130 +505,185 @@ CsvTable::~CsvTable() {
 }
 
 bool CsvTable::ParseHeader() {
-  const std::string& header_line = original_file_[0];
-  bool quoted = false;
-  std::string current_field;
-  current_field.reserve(header_line.length()); // Reserve memory to avoid reallocations
-  
-  for (size_t i = 0; i < header_line.length(); ++i) {
-    char c = header_line.at(i);
-    
-    if (c == '"') {
-      // Check for escaped quote ("")
-      if (i + 1 < header_line.length() && header_line.at(i + 1) == '"' && quoted) {
-        // Escaped quote - add one quote to field and skip the second
-        current_field += '"';
-        ++i; // Skip the second quote
-      } else {
-        // Toggle quoted state, but don't add the quote to the field
-        quoted = !quoted;
-      }
-    } else if (c == sep_ && !quoted) {
-      // End of field - remove any trailing \r and add to header
-      while (!current_field.empty() && current_field.back() == '\r') {
-        current_field.pop_back();
-      }
-      header_.push_back(current_field);
-      current_field.clear();
-    } else {
-      // Regular character - add to current field
-      current_field += c;
-    }
+  if (text_size_ > std::numeric_limits<Ui32>::max()) {
+    error_description = "CSV data is larger than 4 GiB";
+    return false;
+  }
+  parse_pos_ = SkipCsvEmptyLines(text_, parse_pos_, text_size_);
+  if (parse_pos_ == text_size_) {
+    error_description = "No CSV header";
+    return false;
   }
-  
-  // Handle the last field
-  while (!current_field.empty() && current_field.back() == '\r') {
-    current_field.pop_back();
+  bool is_ok = SplitRecord(text_, &parse_pos_, text_size_, sep_,
+    &cells_);
+  std::vector<std::string> names;
+  names.reserve(cells_.size());
+  for (const CellRange &cell : cells_) {
+    names.emplace_back(text_ + cell.offset, cell.size);
   }
-  header_.push_back(current_field);
-  
+  cells_.clear();
+  header_ = std::make_shared<CsvHeader>(std::move(names));
   // Check for unmatched quotes in header
-  if (quoted) {
+  if (!is_ok) {
     error_description = "Unmatched quote in CSV header";
     return false;
   }
-  
   return true;
 }
 
-bool CsvTable::ParseContent() {
-  if (original_file_.size() <= 1) {
-    // No content rows to process, only header
-    return true;
+void CsvTable::SplitIntoChunks(Ui32 thread_count,
+    std::vector<Chunk> *out_chunks) const {
+  // Records may span lines, so a line feed is a safe split point only if an
+  // even number of quotes precedes it. Regions are scanned in parallel, the
+  // parity at each region start is known after a prefix pass over the
+  // region quote counts.
+  const char *data = text_;
+  const Ui64 size = text_size_;
+  const Ui64 region_count = (size - parse_pos_ + chunk_size_ - 1) /
+    chunk_size_;
+  std::vector<CsvRegionStats> regions(static_cast<size_t>(region_count));
+  RunCsvJobs(region_count, thread_count, [&](Ui64 idx) {
+    Ui64 begin = parse_pos_ + idx * chunk_size_;
+    ScanCsvRegion(data, begin, std::min(begin + chunk_size_, size),
+      &regions[static_cast<size_t>(idx)]);
+  });
+
+  out_chunks->clear();
+  out_chunks->emplace_back();
+  out_chunks->back().begin = parse_pos_;
+  Ui64 quote_parity = 0;
+  for (size_t idx = 0; idx < regions.size(); ++idx) {
+    const CsvRegionStats &region = regions[idx];
+    Ui64 line_end = region.first_line_end[quote_parity];
+    if (idx > 0 && line_end != kCsvNoPosition && line_end + 1 < size) {
+      out_chunks->back().end = line_end + 1;
+      out_chunks->emplace_back();
+      out_chunks->back().begin = line_end + 1;
+    }
+    out_chunks->back().line_count += region.line_count;
+    quote_parity ^= region.quote_count & 1;
   }
-  
-  std::deque<std::string>::iterator it = original_file_.begin();
-  ++it;  // skip header
-  Ui64 line_idx = 1;
-  for (; it != original_file_.end(); ++it) {
-    bool quoted = false;
-    std::string current_field;
-    current_field.reserve(it->length()); // Reserve memory to avoid reallocations
-    CsvRow *row = new CsvRow(header_, sep_);
+  out_chunks->back().end = size;
+}
 
-    for (size_t i = 0; i < it->length(); ++i) {
-      char c = it->at(i);
-      
-      if (c == '"') {
-        // Check for escaped quote ("")
-        if (i + 1 < it->length() && it->at(i + 1) == '"' && quoted) {
-          // Escaped quote - add one quote to field and skip the second
-          current_field += '"';
-          ++i; // Skip the second quote
-        } else {
-          // Toggle quoted state, but don't add the quote to the field
-          quoted = !quoted;
-        }
-      } else if (c == sep_ && !quoted) {
-        // End of field - remove any trailing \r and add to row
-        while (!current_field.empty() && current_field.back() == '\r') {
-          current_field.pop_back();
-        }
-        row->Push(current_field);
-        current_field.clear();
-      } else {
-        // Regular character - add to current field
-        current_field += c;
-      }
+void CsvTable::ParseChunk(Chunk *chunk) {
+  char *data = text_;
+  const Ui64 column_count = header_->Size();
+  chunk->cells.reserve(static_cast<size_t>(
+    (chunk->line_count + 1) * column_count));
+  Ui64 pos = chunk->begin;
+  while (true) {
+    pos = SkipCsvEmptyLines(data, pos, chunk->end);
+    if (pos == chunk->end) {
+      return;
     }
-    
-    // Handle the last field
-    while (!current_field.empty() && current_field.back() == '\r') {
-      current_field.pop_back();
+    Ui64 first_cell = chunk->cells.size();
+    bool is_ok = SplitRecord(data, &pos, chunk->end, sep_, &chunk->cells);
+    Ui64 cell_count = chunk->cells.size() - first_cell;
+    if (!is_ok || cell_count != column_count) {
+      chunk->cells.resize(static_cast<size_t>(first_cell));
+      chunk->is_ok = false;
+      chunk->is_unmatched_quote = !is_ok;
+      chunk->error_cell_count = cell_count;
+      return;
     }
-    row->Push(current_field);
+    chunk->row_count++;
+  }
+}
 
-    // Check for unmatched quotes in this row
-    if (quoted) {
-      std::stringstream str;
-      str << "Unmatched quote at line " << line_idx
-        << " of file \"" << file_ << "\"";
-      error_description = str.str();
-      delete row;
-      return false;
-    }
+bool CsvTable::ParseContent() {
+  ARCTIC_PROFILE_SCOPE("CsvTable::ParseContent");
+  const Ui64 column_count = header_->Size();
+  Ui32 thread_count = thread_count_;
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
 
-    // if value(s) missing
-    if (row->Size() != header_.size()) {
-      std::stringstream str;
-      str << "Сorrupted data at line " << line_idx
-        << " of file \"" << file_ << "\""
-        << " header items: " << header_.size()
-        << " row items: " << row->Size();
-      error_description = str.str();
-      delete row;
-      return false;
+  std::vector<Chunk> chunks;
+  if (thread_count > 1 && text_size_ - parse_pos_ > chunk_size_) {
+    SplitIntoChunks(thread_count, &chunks);
+  } else {
+    chunks.resize(1);
+    chunks[0].begin = parse_pos_;
+    chunks[0].end = text_size_;
+    chunks[0].line_count = static_cast<Ui64>(std::count(
+      text_ + parse_pos_, text_ + text_size_, '\n'));
+  }
+  RunCsvJobs(chunks.size(), thread_count, [&](Ui64 idx) {
+    ParseChunk(&chunks[static_cast<size_t>(idx)]);
+  });
+  parse_pos_ = text_size_;
+
+  // Rows after the first error are dropped, as a sequential parse would
+  // stop there.
+  size_t used_chunks = 0;
+  Ui64 row_count = 0;
+  while (used_chunks < chunks.size()) {
+    row_count += chunks[used_chunks].row_count;
+    if (!chunks[used_chunks++].is_ok) {
+      break;
+    }
+  }
+  if (used_chunks == 1) {
+    cells_.swap(chunks[0].cells);
+  } else {
+    std::vector<Ui64> first_cells(used_chunks);
+    Ui64 cell_count = 0;
+    for (size_t i = 0; i < used_chunks; ++i) {
+      first_cells[i] = cell_count;
+      cell_count += chunks[i].cells.size();
     }
-    content_.push_back(row);
+    cells_.resize(static_cast<size_t>(cell_count));
+    RunCsvJobs(used_chunks, thread_count, [&](Ui64 idx) {
+      std::vector<CellRange> &cells = chunks[static_cast<size_t>(idx)].cells;
+      if (!cells.empty()) {
+        memcpy(&cells_[static_cast<size_t>(first_cells[idx])], cells.data(),
+          cells.size() * sizeof(CellRange));
+      }
+      std::vector<CellRange>().swap(cells);
+    });
+  }
+  rows_.resize(static_cast<size_t>(row_count));
+  for (size_t row = 0; row < rows_.size(); ++row) {
+    rows_[row] = RowSlot{row * column_count, nullptr};
+  }
 
-    line_idx++;
+  const Chunk &last_chunk = chunks[used_chunks - 1];
+  if (last_chunk.is_ok) {
+    return true;
   }
-  return true;
+  std::stringstream str;
+  Ui64 line_idx = row_count + 1;
+  if (last_chunk.is_unmatched_quote) {
+    str << "Unmatched quote at line " << line_idx
+      << " of file \"" << file_ << "\"";
+  } else {
+    str << "Сorrupted data at line " << line_idx
+      << " of file \"" << file_ << "\""
+      << " header items: " << column_count
+      << " row items: " << last_chunk.error_cell_count;
+  }
+  error_description = str.str();
+  return false;
+}
+
+CsvRow *CsvTable::MaterializeRow(RowSlot *slot) const {
+  if (!slot->row) {
+    CsvRow *row = new CsvRow(header_, sep_);
+    const Ui64 column_count = header_->Size();
+    row->values_.reserve(static_cast<size_t>(column_count));
+    for (Ui64 i = 0; i < column_count; ++i) {
+      const CellRange &cell = cells_[static_cast<size_t>(slot->first_cell + i)];
+      row->values_.emplace_back(text_ + cell.offset, cell.size);
+    }
+    slot->row = row;
+  }
+  return slot->row;
 }
 
 CsvRow *CsvTable::GetRow(Ui64 row_position) const {
-  if (row_position < content_.size()) {
-    return content_[static_cast<size_t>(row_position)];
+  if (row_position < rows_.size()) {
+    return MaterializeRow(&rows_[static_cast<size_t>(row_position)]);
   }
   return nullptr;
 }
@@ -279,75 +696,110 @@ CsvRow &CsvTable::operator[](Ui64 row_position) const {
   return *row;
 }
 
+CsvCell CsvTable::GetCell(Ui64 row, Ui64 column) const {
+  CsvCell result;
+  if (row >= rows_.size()) {
+    return result;
+  }
+  const RowSlot &slot = rows_[static_cast<size_t>(row)];
+  if (slot.row) {
+    if (column < slot.row->values_.size()) {
+      const std::string &value = slot.row->values_[static_cast<size_t>(column)];
+      result.data = value.data();
+      result.size = value.size();
+    }
+  } else if (column < header_->Size()) {
+    const CellRange &cell = cells_[static_cast<size_t>(slot.first_cell + column)];
+    result.data = text_ + cell.offset;
+    result.size = cell.size;
+  }
+  return result;
+}
+
 std::string CsvTable::GetErrorDescription() const {
   return error_description;
 }
 
 Ui64 CsvTable::RowCount() const {
-  return static_cast<Ui64>(content_.size());
+  return static_cast<Ui64>(rows_.size());
 }
 
 Ui64 CsvTable::ColumnCount() const {
-  return static_cast<Ui64>(header_.size());
+  return header_->Size();
 }
 
 std::vector<std::string> CsvTable::GetHeader() const {
-  return header_;
+  return header_->Names();
 }
 
 const std::string CsvTable::GetHeaderElement(Ui64 pos) const {
-  if (pos >= header_.size()) {
+  if (pos >= header_->Size()) {
     return std::string();
   }
-  return header_[static_cast<size_t>(pos)];
+  return header_->Names()[static_cast<size_t>(pos)];
 }
 
 bool CsvTable::DeleteRow(Ui64 pos) {
-  if (static_cast<size_t>(pos) < content_.size()) {
-    delete *(content_.begin() + static_cast<size_t>(pos));
-    content_.erase(content_.begin() + static_cast<size_t>(pos));
+  if (static_cast<size_t>(pos) < rows_.size()) {
+    delete rows_[static_cast<size_t>(pos)].row;
+    rows_.erase(rows_.begin() + static_cast<size_t>(pos));
     return true;
   }
   return false;
 }
 
 bool CsvTable::AddRow(Ui64 pos, const std::vector<std::string> &r) {
+  if (pos > rows_.size()) {
+    return false;
+  }
   CsvRow *row = new CsvRow(header_, sep_);
-
   for (auto it = r.begin(); it != r.end(); ++it) {
     row->Push(*it);
   }
+  rows_.insert(rows_.begin() + static_cast<size_t>(pos), RowSlot{0, row});
+  return true;
+}
 
-  if (pos <= content_.size()) {
-    content_.insert(content_.begin() + static_cast<int>(pos), row);
-    return true;
-  }
-  delete row;
-  return false;
+void CsvTable::Create(const std::vector<std::string> &header, char sep) {
+  Clear();
+  header_ = std::make_shared<CsvHeader>(header);
+  file_.clear();
+  type_ = CsvSourceType::kCsvSourcePure;
+  sep_ = sep;
 }
 
 void CsvTable::SaveFile() const {
   if (type_ == CsvSourceType::kCsvSourceFile) {
-    std::ofstream f;
-    f.open(file_, std::ios::out | std::ios::trunc);
-
-    // header
-    Ui64 i = 0;
-    for (auto it = header_.begin(); it != header_.end(); ++it) {
-      f << CsvEscapeField(*it, sep_);
-      if (i < header_.size() - 1) {
+    SaveFile(file_);
+  }
+}
+
+bool CsvTable::SaveFile(const std::string &filename) const {
+  std::ofstream f;
+  f.open(filename, std::ios::out | std::ios::trunc);
+
+  // header
+  const std::vector<std::string> &header = header_->Names();
+  for (size_t i = 0; i < header.size(); ++i) {
+    f << CsvEscapeField(header[i], sep_);
+    f << (i + 1 < header.size() ? sep_ : '\n');
+  }
+
+  for (size_t row = 0; row < rows_.size(); ++row) {
+    if (rows_[row].row) {
+      f << *rows_[row].row << '\n';
+      continue;
+    }
+    for (Ui64 column = 0; column < header_->Size(); ++column) {
+      if (column) {
         f << sep_;
-      } else {
-        f << std::endl;
       }
-      i++;
-    }
-
-    for (auto it = content_.begin(); it != content_.end(); ++it) {
-      f << **it << std::endl;
+      f << CsvEscapeField(GetCell(row, column).ToString(), sep_);
     }
-    f.close();
+    f << '\n';
   }
+  f.close();
+  return !f.fail();
 }
 
 const std::string &CsvTable::GetFileName() const {
@@ -356,7 +808,12 @@ const std::string &CsvTable::GetFileName() const {
 
 // ROW
 CsvRow::CsvRow(const std::vector<std::string> &header, char sep)
-    : header_(header)
+    : header_(std::make_shared<CsvHeader>(header))
+    , sep_(sep)
+{}
+
+CsvRow::CsvRow(std::shared_ptr<const CsvHeader> header, char sep)
+    : header_(std::move(header))
     , sep_(sep)
 {}
 
@@ -373,19 +830,15 @@ void CsvRow::Push(const std::string &value) {
 
 bool CsvRow::Set(const std::string &key, const std::string &value) {
   Check(this != &invalid_row_, "CsvRow::Set called on invalid row");
-  std::vector<std::string>::const_iterator it;
-  size_t pos = 0;
-  for (it = header_.begin(); it != header_.end(); ++it) {
-    if (key == *it) {
-      if (pos >= values_.size()) {
-        values_.resize(pos + 1);
-      }
-      values_[pos] = value;
-      return true;
-    }
-    pos++;
+  Si64 pos = header_->Find(key);
+  if (pos < 0) {
+    return false;
   }
-  return false;
+  if (static_cast<size_t>(pos) >= values_.size()) {
+    values_.resize(static_cast<size_t>(pos) + 1);
+  }
+  values_[static_cast<size_t>(pos)] = value;
+  return true;
 }
 
 const std::string CsvRow::operator[](Ui64 value_position) const {
@@ -396,18 +849,155 @@ const std::string CsvRow::operator[](Ui64 value_position) const {
 }
 
 const std::string CsvRow::operator[](const std::string &key) const {
-  std::vector<std::string>::const_iterator it;
-  size_t pos = 0;
-  for (it = header_.begin(); it != header_.end(); ++it) {
-    if (key == *it) {
-      if (pos >= values_.size()) {
-        return std::string();
+  Si64 pos = header_->Find(key);
+  if (pos < 0 || static_cast<size_t>(pos) >= values_.size()) {
+    return std::string();
+  }
+  return values_[static_cast<size_t>(pos)];
+}
+
+// STREAM READER
+const Ui64 CsvStreamReader::kDefaultBufferSize;
+
+CsvStreamReader::CsvStreamReader(Ui64 buffer_size)
+    : buffer_(static_cast<size_t>(std::max(buffer_size, Ui64(16)))) {
+}
+
+bool CsvStreamReader::Open(const std::string &filename, char sep) {
+  Close();
+  file_name_ = filename;
+  sep_ = sep;
+  file_.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file_.is_open()) {
+    error_description_ = std::string("Failed to open ").append(filename);
+    return false;
+  }
+  is_eof_ = false;
+  // Skip the UTF-8 BOM
+  if (Refill() && end_ >= 3 &&
+      Ui8(buffer_[0]) == 0xEF && Ui8(buffer_[1]) == 0xBB &&
+      Ui8(buffer_[2]) == 0xBF) {
+    begin_ = 3;
+    scan_pos_ = 3;
+  }
+  return error_description_.empty();
+}
+
+void CsvStreamReader::Close() {
+  if (file_.is_open()) {
+    file_.close();
+  }
+  file_.clear();
+  begin_ = 0;
+  end_ = 0;
+  scan_pos_ = 0;
+  is_scan_quoted_ = false;
+  is_eof_ = true;
+  line_ = 1;
+  record_line_ = 0;
+  error_description_.clear();
+}
+
+bool CsvStreamReader::Refill() {
+  if (begin_ > 0) {
+    memmove(buffer_.data(), buffer_.data() + begin_,
+      static_cast<size_t>(end_ - begin_));
+    end_ -= begin_;
+    scan_pos_ -= begin_;
+    begin_ = 0;
+  }
+  if (end_ == buffer_.size()) {
+    std::stringstream str;
+    str << "Record at line " << line_ << " of file \"" << file_name_
+      << "\" does not fit into the " << buffer_.size() << " byte buffer";
+    error_description_ = str.str();
+    return false;
+  }
+  file_.read(buffer_.data() + end_,
+    static_cast<std::streamsize>(buffer_.size() - end_));
+  std::streamsize count = file_.gcount();
+  end_ += static_cast<Ui64>(count);
+  if (count == 0 || !file_) {
+    is_eof_ = true;
+  }
+  return true;
+}
+
+bool CsvStreamReader::ReadRow(std::vector<CsvCell> *out_cells) {
+  out_cells->clear();
+  char *data = buffer_.data();
+  while (true) {
+    // Find the end of the record, line breaks inside quotes do not count.
+    Ui64 pos = scan_pos_;
+    bool quoted = is_scan_quoted_;
+    while (pos < end_) {
+      char c = data[pos];
+      if (c == '"') {
+        quoted = !quoted;
+      } else if (c == '\n' && !quoted) {
+        break;
+      }
+      ++pos;
+    }
+    if (pos == end_ && !is_eof_) {
+      scan_pos_ = pos;
+      is_scan_quoted_ = quoted;
+      if (!Refill()) {
+        return false;
       }
-      return values_[pos];
+      data = buffer_.data();
+      continue;
+    }
+    if (pos == end_ && begin_ == end_) {
+      return false;
     }
-    pos++;
+    Ui64 record_begin = begin_;
+    Ui64 record_end = pos;
+    record_line_ = line_;
+    line_ += 1 + static_cast<Ui64>(std::count(data + record_begin,
+      data + record_end, '\n'));
+    begin_ = std::min(pos + 1, end_);
+    scan_pos_ = begin_;
+    is_scan_quoted_ = false;
+    if (quoted) {
+      std::stringstream str;
+      str << "Unmatched quote at line " << record_line_
+        << " of file \"" << file_name_ << "\"";
+      error_description_ = str.str();
+      return false;
+    }
+    if (record_end > record_begin && data[record_end - 1] == '\r') {
+      --record_end;
+    }
+    if (record_end == record_begin) {
+      continue;
+    }
+    SplitRecord(record_begin, record_end, out_cells);
+    return true;
   }
-  return std::string();
+}
+
+void CsvStreamReader::SplitRecord(Ui64 begin, Ui64 end,
+    std::vector<CsvCell> *out_cells) {
+  char *data = buffer_.data();
+  SplitCsvRecord(data, &begin, end, sep_,
+    [data, out_cells](Ui64 cell_begin, Ui64 size) {
+      CsvCell cell;
+      cell.data = data + cell_begin;
+      cell.size = size;
+      out_cells->push_back(cell);
+    });
+}
+
+bool CsvStreamReader::ForEachRow(
+    const std::function<bool(const std::vector<CsvCell> &cells)> &on_row) {
+  std::vector<CsvCell> cells;
+  while (ReadRow(&cells)) {
+    if (!on_row(cells)) {
+      break;
+    }
+  }
+  return error_description_.empty();
 }
 
 std::ostream &operator<<(std::ostream &os, const CsvRow &row) {
@@ -25,24 +25,83 @@
 #define ENGINE_CSV_H_
 
 #include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <list>
 #include <sstream>
 
 #include "engine/arctic_types.h"
+#include "engine/mapped_file.h"
 
 namespace arctic {
 
 /// @addtogroup global_utility
 /// @{
 
+/// @brief Column names of a CSV table with a hashed name-to-index map.
+/// One instance is shared by the table and all of its rows.
+class CsvHeader {
+ public:
+  /// @brief Constructs a header from column names.
+  /// @param names Column names; for duplicates the first one wins on lookup.
+  explicit CsvHeader(std::vector<std::string> names);
+
+  /// @brief Returns the column names.
+  const std::vector<std::string> &Names() const {
+    return names_;
+  }
+
+  /// @brief Returns the number of columns.
+  Ui64 Size() const {
+    return static_cast<Ui64>(names_.size());
+  }
+
+  /// @brief Finds a column by name.
+  /// @param name The column name.
+  /// @return The column index or -1 if there is no such column.
+  Si64 Find(const std::string &name) const;
+
+ private:
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, Ui64> index_;
+};
+
+/// @brief A view of a CSV cell, it does not own the characters.
+struct CsvCell {
+  const char *data = "";  ///< First character, not null-terminated
+  Ui64 size = 0;  ///< Number of characters
+
+  /// @brief Returns a copy of the cell content.
+  std::string ToString() const {
+    return std::string(data, static_cast<size_t>(size));
+  }
+};
+
+/// @brief Parses the whole cell as a number, leading spaces are skipped.
+/// @param cell The cell to parse.
+/// @param out_value Receives the value on success.
+/// @return True if the cell holds a valid number that fits the type.
+bool ParseCsvCell(CsvCell cell, Si16 *out_value);
+bool ParseCsvCell(CsvCell cell, Ui16 *out_value);
+bool ParseCsvCell(CsvCell cell, Si32 *out_value);
+bool ParseCsvCell(CsvCell cell, Ui32 *out_value);
+bool ParseCsvCell(CsvCell cell, Si64 *out_value);
+bool ParseCsvCell(CsvCell cell, Ui64 *out_value);
+bool ParseCsvCell(CsvCell cell, float *out_value);
+bool ParseCsvCell(CsvCell cell, double *out_value);
+bool ParseCsvCell(CsvCell cell, std::string *out_value);
+
 /// @brief Represents a row in a CSV file.
 class CsvRow {
  private:
+  friend class CsvTable;
   static CsvRow invalid_row_;
-  const std::vector<std::string> header_;
+  std::shared_ptr<const CsvHeader> header_;
   std::vector<std::string> values_;
   char sep_ = ',';
 
@@ -51,6 +110,10 @@ class CsvRow {
   /// @param header The header for the CSV row.
   explicit CsvRow(const std::vector<std::string> &header, char sep = ',');
 
+  /// @brief Constructs a CsvRow sharing the given header.
+  /// @param header The header for the CSV row.
+  explicit CsvRow(std::shared_ptr<const CsvHeader> header, char sep = ',');
+
   /// @brief Returns a reference to a static invalid row sentinel.
   /// Mutating methods on the invalid row will trigger a fatal error.
   /// @return Reference to the invalid row.
@@ -145,11 +208,30 @@ enum CsvSourceType {
 };
 
 /// @brief Represents a CSV table.
+/// @details The file is kept in one buffer and cells are stored as
+///   offset/length pairs into it, column-major access through GetCell and
+///   GetColumn does not allocate per cell. CsvRow objects are created on the
+///   first GetRow call for the row, so GetRow is not thread-safe.
+///   Quoted fields may contain separators, "" and line breaks. Data larger
+///   than one chunk is parsed on several threads, see SetParallelism.
 class CsvTable {
  public:
+  /// @brief Default amount of data per parsing chunk.
+  static const Ui64 kDefaultChunkSize = 4 << 20;
+
   /// @brief Default constructor for CsvTable.
   CsvTable();
 
+  /// @brief Sets up parallel parsing for the following loads.
+  /// @details The data is split into chunks at record boundaries found with
+  ///   a quote-parity pre-pass, chunks are parsed on separate threads and
+  ///   merged in file order, so the result does not depend on the settings.
+  /// @param thread_count The maximum number of parsing threads, 0 means one
+  ///   per hardware thread (the default), 1 disables parallel parsing.
+  /// @param chunk_size The amount of data per chunk in bytes.
+  void SetParallelism(Ui32 thread_count,
+    Ui64 chunk_size = kDefaultChunkSize);
+
   /// @brief Loads a CSV file.
   /// @param filename The name of the file to load.
   /// @param sep The separator character (default is comma).
@@ -202,9 +284,19 @@ class CsvTable {
   /// @return True if the row was added successfully, false otherwise.
   bool AddRow(Ui64 pos, const std::vector<std::string> &row_data);
 
-  /// @brief Saves the CSV table to a file.
+  /// @brief Starts an empty table with the given columns.
+  /// @param header The column names.
+  /// @param sep The separator character used when saving (default is comma).
+  void Create(const std::vector<std::string> &header, char sep = ',');
+
+  /// @brief Saves the CSV table to the file it was loaded from.
   void SaveFile() const;
 
+  /// @brief Saves the CSV table to a file.
+  /// @param filename The name of the file to write.
+  /// @return True if the file was written successfully, false otherwise.
+  bool SaveFile(const std::string &filename) const;
+
   /// @brief Accesses a row in the table by index.
   /// @param row The index of the row.
   /// @return A reference to the CsvRow at the specified index.
@@ -214,6 +306,53 @@ class CsvTable {
   /// @return The error description string.
   std::string GetErrorDescription() const;
 
+  /// @brief Finds a column by name.
+  /// @param name The column name.
+  /// @return The column index or -1 if there is no such column.
+  Si64 ColumnIndex(const std::string &name) const {
+    return header_->Find(name);
+  }
+
+  /// @brief Returns a view of a cell.
+  /// @param row The row index.
+  /// @param column The column index.
+  /// @return The cell, empty if out of range. Valid until the table or the
+  ///   row is modified or reloaded.
+  CsvCell GetCell(Ui64 row, Ui64 column) const;
+
+  /// @brief Extracts a typed column.
+  /// @tparam T Si16, Ui16, Si32, Ui32, Si64, Ui64, float, double or std::string.
+  /// @param column The column index.
+  /// @param default_value The value used for cells that fail to parse.
+  /// @return One value per row, empty if the column does not exist.
+  template<typename T>
+  std::vector<T> GetColumn(Ui64 column, T default_value = T()) const {
+    std::vector<T> result;
+    if (column >= ColumnCount()) {
+      return result;
+    }
+    result.resize(rows_.size(), default_value);
+    for (size_t row = 0; row < rows_.size(); ++row) {
+      ParseCsvCell(GetCell(row, column), &result[row]);
+    }
+    return result;
+  }
+
+  /// @brief Extracts a typed column by name.
+  /// @tparam T Si16, Ui16, Si32, Ui32, Si64, Ui64, float, double or std::string.
+  /// @param name The column name.
+  /// @param default_value The value used for cells that fail to parse.
+  /// @return One value per row, empty if the column does not exist.
+  template<typename T>
+  std::vector<T> GetColumn(const std::string &name,
+      T default_value = T()) const {
+    Si64 column = ColumnIndex(name);
+    if (column < 0) {
+      return std::vector<T>();
+    }
+    return GetColumn<T>(static_cast<Ui64>(column), default_value);
+  }
+
  protected:
   /// @brief Parses the header of the CSV.
   /// @return True if the header was parsed successfully, false otherwise.
@@ -224,16 +363,120 @@ class CsvTable {
   bool ParseContent();
 
  private:
+  /// Cell location in text_.
+  struct CellRange {
+    Ui32 offset;
+    Ui32 size;
+  };
+
+  /// Row of the table, either a range of cells_ or a materialized CsvRow.
+  struct RowSlot {
+    Ui64 first_cell;
+    CsvRow *row;
+  };
+
+  struct Chunk;
+
   void Clear();
+  static bool SplitRecord(char *data, Ui64 *in_out_pos, Ui64 end, char sep,
+    std::vector<CellRange> *out_cells);
+  void SplitIntoChunks(Ui32 thread_count, std::vector<Chunk> *out_chunks) const;
+  void ParseChunk(Chunk *chunk);
+  CsvRow *MaterializeRow(RowSlot *slot) const;
 
   std::string file_;
   CsvSourceType type_ = kCsvSourcePure;
   char sep_ = ',';
-  std::deque<std::string> original_file_;
-  std::vector<std::string> header_;
-  std::vector<CsvRow *> content_;
+  Ui32 thread_count_ = 0;
+  Ui64 chunk_size_ = kDefaultChunkSize;
+  // The parsed text is in data_ for LoadString and in the copy-on-write
+  // mapping_ for LoadFile, cells point into it
+  std::string data_;
+  MappedFile mapping_;
+  char *text_ = nullptr;
+  Ui64 text_size_ = 0;
+  Ui64 parse_pos_ = 0;
+  std::vector<CellRange> cells_;
+  std::shared_ptr<CsvHeader> header_;
+  mutable std::vector<RowSlot> rows_;
   std::string error_description;
 };
+/// @brief Reads a CSV file record by record with memory bounded by the buffer.
+/// @details Splits records exactly as CsvTable does: a quote anywhere in a
+///   field switches quoting on or off, quoted parts may contain separators,
+///   "" and line breaks. Records end with LF or CRLF, empty lines
+///   are skipped. The header is not treated specially, it is the first row.
+///   A record must fit into the buffer. Usage:
+/// @code
+///   CsvStreamReader reader;
+///   if (reader.Open("telemetry.csv")) {
+///     std::vector<CsvCell> cells;
+///     while (reader.ReadRow(&cells)) {
+///       ...
+///     }
+///   }
+///   if (!reader.GetErrorDescription().empty()) { ... }
+/// @endcode
+class CsvStreamReader {
+ public:
+  /// @brief Default buffer size, the maximum record size.
+  static const Ui64 kDefaultBufferSize = 1 << 20;
+
+  /// @brief Constructs a reader.
+  /// @param buffer_size Size of the read buffer in bytes.
+  explicit CsvStreamReader(Ui64 buffer_size = kDefaultBufferSize);
+
+  /// @brief Opens a file for reading.
+  /// @param filename The name of the file to read.
+  /// @param sep The separator character (default is comma).
+  /// @return True if the file was opened successfully, false otherwise.
+  bool Open(const std::string &filename, char sep = ',');
+
+  /// @brief Closes the file.
+  void Close();
+
+  /// @brief Reads the next record.
+  /// @param out_cells Receives views of the cells, valid until the next
+  ///   ReadRow call.
+  /// @return False at the end of the file or on error, see
+  ///   GetErrorDescription.
+  bool ReadRow(std::vector<CsvCell> *out_cells);
+
+  /// @brief Calls on_row for every remaining record.
+  /// @param on_row Receives the cells, returns false to stop reading.
+  /// @return False on error.
+  bool ForEachRow(
+    const std::function<bool(const std::vector<CsvCell> &cells)> &on_row);
+
+  /// @brief Returns the number of the first line of the last record read.
+  Ui64 LineNumber() const {
+    return record_line_;
+  }
+
+  /// @brief Gets the error description if an operation fails.
+  /// @return The error description string, empty if there was no error.
+  const std::string &GetErrorDescription() const {
+    return error_description_;
+  }
+
+ private:
+  bool Refill();
+  void SplitRecord(Ui64 begin, Ui64 end, std::vector<CsvCell> *out_cells);
+
+  std::ifstream file_;
+  std::string file_name_;
+  char sep_ = ',';
+  std::vector<char> buffer_;
+  Ui64 begin_ = 0;  // Start of the current record
+  Ui64 end_ = 0;  // End of the valid data
+  Ui64 scan_pos_ = 0;  // Record end search position
+  bool is_scan_quoted_ = false;
+  bool is_eof_ = true;
+  Ui64 line_ = 1;
+  Ui64 record_line_ = 0;
+  std::string error_description_;
+};
+
 /// @}
 
 }  // namespace arctic
@@ -23,12 +23,23 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
+#include <algorithm>
 #include <cstring>
 #include "engine/data_reader.h"
 
 namespace arctic {
 
+void DataReader::CloseSources() {
+  file_.Close();
+  if (stream_.is_open()) {
+    stream_.close();
+  }
+  stream_.clear();
+  source_ = nullptr;
+}
+
 void DataReader::Reset(std::vector<Ui8> &&in_data) {
+  CloseSources();
   data = std::move(in_data);
   is_ok_ = true;
   if (data.empty()) {
@@ -40,8 +51,98 @@ void DataReader::Reset(std::vector<Ui8> &&in_data) {
   }
 }
 
+void DataReader::ResetView(const void *begin, Ui64 size) {
+  CloseSources();
+  data.clear();
+  is_ok_ = true;
+  p = static_cast<const Ui8*>(begin);
+  end = p + size;
+}
+
+bool DataReader::OpenMapped(const char *file_name) {
+  ResetView(nullptr, 0);
+  if (!file_.Open(file_name)) {
+    return false;
+  }
+  p = file_.Data();
+  end = p + file_.Size();
+  return true;
+}
+
+bool DataReader::OpenStream(const char *file_name, Ui64 buffer_size) {
+  ResetView(nullptr, 0);
+  stream_buffer_size_ = std::max<Ui64>(buffer_size, 64);
+  stream_.open(file_name, std::ios_base::in | std::ios_base::binary);
+  return stream_.is_open();
+}
+
+void DataReader::OpenSource(DataSource *source, Ui64 buffer_size) {
+  ResetView(nullptr, 0);
+  stream_buffer_size_ = std::max<Ui64>(buffer_size, 64);
+  source_ = source;
+}
+
+Ui64 DataReader::ReadStream(void *dst, Ui64 amount) {
+  if (source_) {
+    return source_->Read(dst, amount);
+  }
+  stream_.read(static_cast<char*>(dst), static_cast<std::streamsize>(amount));
+  return static_cast<Ui64>(stream_.gcount());
+}
+
+bool DataReader::FillStream(Ui64 amount) {
+  if (!IsStreaming()) {
+    return false;
+  }
+  // Keep the unread bytes, then append from the file
+  Ui64 remaining = static_cast<Ui64>(end - p);
+  if (remaining && p != data.data()) {
+    std::memmove(data.data(), p, static_cast<size_t>(remaining));
+  }
+  // Grows by at most one buffer per read, so a bogus amount stops at the
+  // end of the file
+  const Ui64 target = std::max(amount, stream_buffer_size_);
+  while (remaining < target) {
+    Ui64 chunk = std::min(target - remaining, stream_buffer_size_);
+    if (data.size() < remaining + chunk) {
+      data.resize(static_cast<size_t>(remaining + chunk));
+    }
+    Ui64 part = ReadStream(data.data() + remaining, chunk);
+    remaining += part;
+    if (part < chunk) {
+      break;
+    }
+  }
+  Ui8 *buffer = data.data();
+  p = buffer;
+  end = buffer + remaining;
+  return remaining >= amount;
+}
+
 Ui64 DataReader::Read(void *dst, Ui64 amount) {
   Ui64 to_read = std::min(amount, (Ui64)(end - p));
+  if (to_read < amount && IsStreaming()) {
+    // Large reads go straight from the file to the destination
+    Ui8 *out = static_cast<Ui8*>(dst);
+    if (to_read) {
+      memcpy(out, p, (size_t)to_read);
+    }
+    p = end;
+    if (amount - to_read >= stream_buffer_size_) {
+      to_read += ReadStream(out + to_read, amount - to_read);
+    } else {
+      FillStream(amount - to_read);
+      Ui64 part = std::min(amount - to_read, (Ui64)(end - p));
+      memcpy(out + to_read, p, (size_t)part);
+      p += part;
+      to_read += part;
+    }
+    if (to_read < amount) {
+      memset(out + to_read, 0, (size_t)(amount - to_read));
+      is_ok_ = false;
+    }
+    return to_read;
+  }
   memcpy(dst, p, (size_t)to_read);
   if (to_read < amount) {
     memset(static_cast<Ui8*>(dst) + to_read, 0, (size_t)(amount - to_read));
@@ -51,55 +152,65 @@ Ui64 DataReader::Read(void *dst, Ui64 amount) {
   return to_read;
 }
 
-Ui8 DataReader::ReadUInt8() {
-  Ui8 n;
-  Read(&n, 1);
-  return n;
-}
-
-Ui16 DataReader::ReadUInt16() {
-  Ui16 n;
-  Read(&n, 2);
-  return n;
-}
-
-Ui32 DataReader::ReadUInt32() {
-  Ui32 n;
-  Read(&n, 4);
-  return n;
-}
-
-Ui64 DataReader::ReadUInt64() {
-  Ui64 n;
-  Read(&n, 8);
-  return n;
+Ui64 DataReader::ReadVarUint() {
+  Ui64 value = 0;
+  for (Ui32 shift = 0; shift < 64; shift += 7) {
+    Ui8 byte = ReadValue<Ui8>();
+    value |= static_cast<Ui64>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  // More than 10 bytes is not a valid 64-bit varint
+  is_ok_ = false;
+  return value;
 }
 
-float DataReader::ReadFloat() {
-  float n;
-  Read(&n, 4);
-  return n;
+void *DataReader::CopyToScratch(const Ui8 *src, Ui64 count,
+    Ui64 element_size) {
+  Ui64 size = count * element_size;
+  scratch_.resize(static_cast<size_t>(size / 8 + 1));
+  if (size) {
+    memcpy(scratch_.data(), src, (size_t)size);
+  }
+  if (byte_order != GetHostByteOrder()) {
+    ReverseBytes(scratch_.data(), count, element_size);
+  }
+  return scratch_.data();
 }
 
+// Arrays are converted in bulk after the copy
 void DataReader::ReadFloatarray2(float *dst, Ui64 amount) {
   Read(dst, amount*4);
+  if (byte_order != GetHostByteOrder()) {
+    ReverseBytes32(dst, amount);
+  }
 }
 
 void DataReader::ReadUInt32array(Ui32 *dst, Ui64 amount) {
   Read(dst, amount*4);
+  if (byte_order != GetHostByteOrder()) {
+    ReverseBytes32(dst, amount);
+  }
 }
 
 
 void DataReader::ReadUInt64array(Ui64 *dst, Ui64 amount) {
   Read(dst, amount*8);
+  if (byte_order != GetHostByteOrder()) {
+    ReverseBytes64(dst, amount);
+  }
 }
 
 void DataReader::ReadUInt32array2(Ui32 *dst, Ui64 amount) {
-  Read(dst, amount*4);
+  ReadUInt32array(dst, amount);
 }
 
 void DataReader::ReadUInt16array(Ui16 *dst, Ui64 amount) {
   Read(dst, amount*2);
+  if (byte_order != GetHostByteOrder()) {
+    ReverseBytes16(dst, amount);
+  }
 }
 
 void DataReader::ReadUInt8array(Ui8 *dst, Ui64 amount) {
@@ -108,6 +219,9 @@ void DataReader::ReadUInt8array(Ui8 *dst, Ui64 amount) {
 
 void DataReader::ReadDoublearray2(double *dst, Ui64 amount) {
   Read(dst, amount*8);
+  if (byte_order != GetHostByteOrder()) {
+    ReverseBytes64(dst, amount);
+  }
 }
 
 }
@@ -25,25 +25,71 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
 #include <vector>
+#include "engine/arctic_platform_byteorder.h"
 #include "engine/arctic_types.h"
+#include "engine/mapped_file.h"
 
 namespace arctic {
 
 /// @addtogroup global_utility
 /// @{
 
+/// @brief Provides the bytes of a DataReader opened with OpenSource
+class DataSource {
+ public:
+  virtual ~DataSource() {}
+
+  /// @brief Reads the next bytes
+  /// @param dst The destination
+  /// @param size The number of bytes wanted
+  /// @return The number of bytes read, less than size only at the end
+  virtual Ui64 Read(void *dst, Ui64 size) = 0;
+};
+
 /// @brief A class for reading data from a buffer
+///
+/// The data is an owned vector (Reset), a non-owning span (ResetView), a
+/// memory mapped file (OpenMapped), a file read through a buffer
+/// (OpenStream) or a source read through a buffer (OpenSource). Numbers are
+/// converted from byte_order to the cpu byte order.
 struct DataReader {
   std::vector<Ui8> data;
-  Ui8 *p = nullptr;
-  Ui8 *end = nullptr;
+  const Ui8 *p = nullptr;
+  const Ui8 *end = nullptr;
   bool is_ok_ = true;
+  /// Byte order of the data
+  ByteOrder byte_order = GetHostByteOrder();
 
   /// @brief Reset the data reader with a new buffer
   /// @param in_data The new buffer to read from
   void Reset(std::vector<Ui8> &&in_data);
 
+  /// @brief Reset the data reader to read memory it does not own
+  /// @param begin The memory to read, must outlive the reads
+  /// @param size Size of the memory in bytes
+  void ResetView(const void *begin, Ui64 size);
+
+  /// @brief Reset the data reader to read a memory mapped file
+  /// @param file_name Path to the file
+  /// @return True if the file is open
+  bool OpenMapped(const char *file_name);
+
+  /// @brief Reset the data reader to read a file through a buffer
+  /// @param file_name Path to the file
+  /// @param buffer_size Bytes read from the file at once
+  /// @return True if the file is open
+  bool OpenStream(const char *file_name, Ui64 buffer_size = 1 << 20);
+
+  /// @brief Reset the data reader to read a source through a buffer
+  /// @param source The source, must outlive the reads
+  /// @param buffer_size Bytes read from the source at once
+  void OpenSource(DataSource *source, Ui64 buffer_size = 1 << 16);
+
   /// @brief Check if all reads so far completed without truncation
   bool IsOk() const { return is_ok_; }
 
@@ -55,22 +101,87 @@ struct DataReader {
 
   /// @brief Read an 8-bit unsigned integer from the buffer
   /// @return The 8-bit unsigned integer read
-  Ui8 ReadUInt8();
+  Ui8 ReadUInt8() {
+    return ReadValue<Ui8>();
+  }
 
   /// @brief Read a 16-bit unsigned integer from the buffer
   /// @return The 16-bit unsigned integer read
-  Ui16 ReadUInt16();
+  Ui16 ReadUInt16() {
+    return ReadValue<Ui16>();
+  }
 
   /// @brief Read a 32-bit unsigned integer from the buffer
   /// @return The 32-bit unsigned integer read
-  Ui32 ReadUInt32();
+  Ui32 ReadUInt32() {
+    return ReadValue<Ui32>();
+  }
   
   /// @brief Read a 64-bit unsigned integer from the buffer
   /// @return The 64-bit unsigned integer read
-  Ui64 ReadUInt64();
+  Ui64 ReadUInt64() {
+    return ReadValue<Ui64>();
+  }
 
   /// @brief Read a float from the buffer
-  float ReadFloat();
+  float ReadFloat() {
+    return ReadValue<float>();
+  }
+
+  /// @brief Read an unsigned LEB128 varint: 7 bits per byte, the high bit
+  /// set on all bytes but the last
+  Ui64 ReadVarUint();
+
+  /// @brief Read a zigzag-encoded signed LEB128 varint
+  Si64 ReadVarSint() {
+    Ui64 x = ReadVarUint();
+    return static_cast<Si64>((x >> 1) ^ (0ull - (x & 1ull)));
+  }
+
+  /// @brief Read a value of a trivially copyable type
+  template <typename T>
+  T ReadValue() {
+    static_assert(std::is_trivially_copyable<T>::value,
+      "ReadValue needs a trivially copyable type");
+    T value;
+    if (static_cast<Ui64>(end - p) >= sizeof(T)) {
+      std::memcpy(&value, p, sizeof(T));
+      p += sizeof(T);
+    } else {
+      Read(&value, sizeof(T));
+    }
+    if (sizeof(T) > 1 && byte_order != GetHostByteOrder()) {
+      ReverseBytes(&value, 1, sizeof(T));
+    }
+    return value;
+  }
+
+  /// @brief Read an array without copying when possible
+  ///
+  /// Points into the buffer or the mapping when the byte order matches and
+  /// the data is aligned for T, otherwise the elements are copied to a
+  /// scratch buffer and converted. The pointer is valid until the next
+  /// read.
+  /// @param count Number of elements
+  /// @return Pointer to the elements or nullptr if the data is too short
+  template <typename T>
+  const T *ReadSpan(Ui64 count) {
+    static_assert(std::is_trivially_copyable<T>::value,
+      "ReadSpan needs a trivially copyable type");
+    if (static_cast<Ui64>(end - p) / sizeof(T) < count &&
+        (count > ~0ull / sizeof(T) || !FillStream(count * sizeof(T)))) {
+      p = end;
+      is_ok_ = false;
+      return nullptr;
+    }
+    const Ui8 *span = p;
+    p += count * sizeof(T);
+    if ((sizeof(T) == 1 || byte_order == GetHostByteOrder()) &&
+        reinterpret_cast<std::uintptr_t>(span) % alignof(T) == 0) {
+      return reinterpret_cast<const T*>(span);
+    }
+    return static_cast<const T*>(CopyToScratch(span, count, sizeof(T)));
+  }
   
   /// @brief Read an array of floats from the buffer
   /// @param dst The destination to read to
@@ -106,7 +217,23 @@ struct DataReader {
   /// @param dst The destination to read to
   /// @param amount The amount of data to read (in 8-bit unsigned integers)
   void ReadUInt8array(Ui8 *dst, Ui64 amount);
-  
+
+ private:
+  // Makes at least amount bytes available from the stream, false when
+  // not streaming or the file is too short
+  bool FillStream(Ui64 amount);
+  bool IsStreaming() const {
+    return source_ || stream_.is_open();
+  }
+  Ui64 ReadStream(void *dst, Ui64 amount);
+  void *CopyToScratch(const Ui8 *src, Ui64 count, Ui64 element_size);
+  void CloseSources();
+
+  MappedFile file_;
+  std::ifstream stream_;
+  DataSource *source_ = nullptr;
+  Ui64 stream_buffer_size_ = 0;
+  std::vector<Ui64> scratch_;
 };
 /// @}
 
@@ -23,11 +23,16 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
+#include <algorithm>
 #include <cstring>
 #include "engine/data_writer.h"
 
 namespace arctic {
 
+DataWriter::~DataWriter() {
+  Close();
+}
+
 Ui64 DataWriter::Write(const void *src, Ui64 amount) {
   size_t old_size = data.size();
   if (data.capacity() < old_size + amount) {
@@ -36,47 +41,120 @@ Ui64 DataWriter::Write(const void *src, Ui64 amount) {
   }
   data.resize(old_size + (size_t)amount);
   memcpy(&data[old_size], src, (size_t)amount);
+  if (stream_buffer_size_ && data.size() >= stream_buffer_size_) {
+    Flush();
+  }
   return amount;
 }
 
-void DataWriter::WriteUInt8(Ui8 x) {
-  Write(&x, 1);
+bool DataWriter::OpenStream(const char *file_name, Ui64 buffer_size) {
+  Close();
+  data.clear();
+  stream_.open(file_name,
+    std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  is_stream_ok_ = stream_.is_open();
+  stream_buffer_size_ = is_stream_ok_ ? std::max<Ui64>(buffer_size, 64) : 0;
+  data.reserve(static_cast<size_t>(stream_buffer_size_));
+  return is_stream_ok_;
 }
 
-void DataWriter::WriteUInt16(Ui16 x) {
-  Write(&x, 2);
+void DataWriter::OpenSink(DataSink *sink, Ui64 buffer_size) {
+  Close();
+  data.clear();
+  sink_ = sink;
+  is_stream_ok_ = true;
+  stream_buffer_size_ = std::max<Ui64>(buffer_size, 64);
+  data.reserve(static_cast<size_t>(stream_buffer_size_));
 }
 
-void DataWriter::WriteUInt32(Ui32 n) {
-  Write(&n, 4);
+bool DataWriter::Flush() {
+  if (sink_) {
+    if (!data.empty()) {
+      is_stream_ok_ = sink_->Consume(&data) && is_stream_ok_;
+      data.clear();
+    }
+    return is_stream_ok_;
+  }
+  if (!stream_.is_open()) {
+    return is_stream_ok_;
+  }
+  if (!data.empty()) {
+    stream_.write(reinterpret_cast<const char*>(data.data()),
+      static_cast<std::streamsize>(data.size()));
+    data.clear();
+  }
+  stream_.flush();
+  is_stream_ok_ = is_stream_ok_ && stream_.good();
+  return is_stream_ok_;
 }
 
-void DataWriter::WriteUInt64(Ui64 n) {
-  Write(&n, 8);
+bool DataWriter::Close() {
+  if (sink_) {
+    bool is_ok = Flush();
+    sink_ = nullptr;
+    stream_buffer_size_ = 0;
+    return is_ok;
+  }
+  if (!stream_.is_open()) {
+    return is_stream_ok_;
+  }
+  bool is_ok = Flush();
+  stream_.close();
+  stream_buffer_size_ = 0;
+  return is_ok && !stream_.fail();
+}
+
+void DataWriter::WriteVarUint(Ui64 x) {
+  Ui8 bytes[10];
+  Ui32 size = 0;
+  while (x >= 0x80) {
+    bytes[size++] = static_cast<Ui8>(x | 0x80);
+    x >>= 7;
+  }
+  bytes[size++] = static_cast<Ui8>(x);
+  Write(bytes, size);
 }
 
-void DataWriter::WriteFloat(float x) {
-  Write(&x, 4);
+void DataWriter::WriteElements(const void *src, Ui64 count,
+    Ui64 element_size) {
+  if (element_size == 1 || byte_order == GetHostByteOrder()) {
+    Write(src, count * element_size);
+    return;
+  }
+  // Converted in place after the copy, before the buffer can be flushed
+  const Ui64 kChunk = 4096;
+  const Ui8 *bytes = static_cast<const Ui8*>(src);
+  while (count) {
+    Ui64 part = std::min(count, kChunk);
+    size_t old_size = data.size();
+    data.insert(data.end(), bytes, bytes + part * element_size);
+    ReverseBytes(&data[old_size], part, element_size);
+    bytes += part * element_size;
+    count -= part;
+    if (stream_buffer_size_ && data.size() >= stream_buffer_size_) {
+      Flush();
+    }
+  }
 }
 
 void DataWriter::WriteFloatarray2(float *src, Ui64 amount) {
-  Write(src, 4*(size_t)amount);
+  WriteArray(src, amount);
 }
 
 void DataWriter::WriteDoublearray2(double *src, Ui64 amount) {
-  Write(src, (size_t)amount*8);
+  WriteArray(src, amount);
 }
 
 void DataWriter::WriteUInt32array(Ui32 *src, Ui64 amount) {
-  Write(src, amount*4);
+  WriteArray(src, amount);
 }
 
 void DataWriter::WriteUInt64array(Ui64 *src, Ui64 amount) {
-  Write(src, amount*8);
+  WriteArray(src, amount);
 }
 
 void DataWriter::WriteUInt16array(Ui16 *src, Ui64 amount) {
-  Write(src, amount*2);
+  WriteArray(src, amount);
 }
 
 void DataWriter::WriteUInt8array(Ui8 *src, Ui64 amount) {
@@ -25,14 +25,40 @@
 
 #pragma once
 
+#include <cstring>
+#include <fstream>
+#include <type_traits>
 #include <vector>
+#include "engine/arctic_platform_byteorder.h"
 #include "engine/arctic_types.h"
 
 namespace arctic {
 
+/// @brief Receives the bytes of a DataWriter opened with OpenSink
+class DataSink {
+ public:
+  virtual ~DataSink() {}
+
+  /// @brief Takes the buffered bytes
+  /// @param data The bytes, the sink may swap the vector with an empty one
+  /// @return False if the bytes can't be stored
+  virtual bool Consume(std::vector<Ui8> *data) = 0;
+};
+
 /// @brief A class for writing data to a buffer
+///
+/// After OpenStream or OpenSink the buffer is passed on whenever it grows
+/// past the buffer size. Numbers are converted from the cpu byte order to
+/// byte_order.
 struct DataWriter {
   std::vector<Ui8> data;
+  /// Byte order of the written data
+  ByteOrder byte_order = GetHostByteOrder();
+
+  DataWriter() = default;
+  DataWriter(DataWriter &&other) = default;
+  DataWriter &operator=(DataWriter &&other) = default;
+  ~DataWriter();
 
   /// @brief Write data to the buffer
   /// @param src The source of the data to write
@@ -40,25 +66,88 @@ struct DataWriter {
   /// @return The amount of data written (in bytes)
   Ui64 Write(const void *src, Ui64 amount);
 
+  /// @brief Start writing to a file through the buffer
+  /// @param file_name Path to the file, it is truncated
+  /// @param buffer_size Bytes collected before writing to the file
+  /// @return True if the file is open
+  bool OpenStream(const char *file_name, Ui64 buffer_size = 1 << 20);
+
+  /// @brief Start passing the buffer to a sink
+  /// @param sink The sink, must outlive the writer or the Close call
+  /// @param buffer_size Bytes collected before passing them to the sink
+  void OpenSink(DataSink *sink, Ui64 buffer_size = 1 << 20);
+
+  /// @brief Write the buffered data to the file or the sink
+  /// @return True if all data written so far reached the file or the sink
+  bool Flush();
+
+  /// @brief Flush and close the file
+  /// @return True if all data written reached the file
+  bool Close();
+
   /// @brief Write an 8-bit unsigned integer to the buffer
   /// @param x The 8-bit unsigned integer to write
-  void WriteUInt8(Ui8 x);
+  void WriteUInt8(Ui8 x) {
+    WriteValue(x);
+  }
 
   /// @brief Write a 16-bit unsigned integer to the buffer
   /// @param x The 16-bit unsigned integer to write
-  void WriteUInt16(Ui16 x);
+  void WriteUInt16(Ui16 x) {
+    WriteValue(x);
+  }
 
   /// @brief Write a 32-bit unsigned integer to the buffer
   /// @param x The 32-bit unsigned integer to write
-  void WriteUInt32(Ui32 x);
+  void WriteUInt32(Ui32 x) {
+    WriteValue(x);
+  }
 
   /// @brief Write a 64-bit unsigned integer to the buffer
   /// @param x The 64-bit unsigned integer to write
-  void WriteUInt64(Ui64 x);
+  void WriteUInt64(Ui64 x) {
+    WriteValue(x);
+  }
 
   /// @brief Write a float to the buffer
   /// @param x The float to write
-  void WriteFloat(float x);
+  void WriteFloat(float x) {
+    WriteValue(x);
+  }
+
+  /// @brief Write an unsigned LEB128 varint: 7 bits per byte, the high bit
+  /// set on all bytes but the last
+  /// @param x The value to write
+  void WriteVarUint(Ui64 x);
+
+  /// @brief Write a zigzag-encoded signed LEB128 varint
+  /// @param x The value to write
+  void WriteVarSint(Si64 x) {
+    WriteVarUint((static_cast<Ui64>(x) << 1) ^ static_cast<Ui64>(x >> 63));
+  }
+
+  /// @brief Write a value of a trivially copyable type
+  /// @param x The value to write
+  template <typename T>
+  void WriteValue(T x) {
+    static_assert(std::is_trivially_copyable<T>::value,
+      "WriteValue needs a trivially copyable type");
+    if (sizeof(T) == 1 || byte_order == GetHostByteOrder()) {
+      Write(&x, sizeof(T));
+    } else {
+      WriteElements(&x, 1, sizeof(T));
+    }
+  }
+
+  /// @brief Write an array of 2, 4 or 8 byte numbers, converted in bulk
+  /// @param src The source array
+  /// @param count The number of elements in the array
+  template <typename T>
+  void WriteArray(const T *src, Ui64 count) {
+    static_assert(std::is_trivially_copyable<T>::value,
+      "WriteArray needs a trivially copyable type");
+    WriteElements(src, count, sizeof(T));
+  }
 
   /// @brief Write an array of 8-bit unsigned integers to the buffer
   /// @param src The source array of 8-bit unsigned integers
@@ -89,6 +178,14 @@ struct DataWriter {
   /// @param src The source array of doubles
   /// @param amount The number of elements in the array
   void WriteDoublearray2(double *src, Ui64 amount);
+
+ private:
+  void WriteElements(const void *src, Ui64 count, Ui64 element_size);
+
+  std::ofstream stream_;
+  DataSink *sink_ = nullptr;
+  Ui64 stream_buffer_size_ = 0;
+  bool is_stream_ok_ = true;
 };
 
 } // namespace arctic
@@ -25,13 +25,14 @@
 // IN THE SOFTWARE.
 
 #include <chrono>  // NOLINT
-#include <deque>
 #include <fstream>
 #include <limits>
 #include <thread>  // NOLINT
 #include <utility>
 
 #include "engine/arctic_platform.h"
+#include "engine/asset_pack.h"
+#include "engine/async_loader.h"
 #include "engine/easy_advanced.h"
 #include "engine/easy_drawing.h"
 #include "engine/easy_files.h"
@@ -39,7 +40,9 @@
 #include "engine/easy_sound.h"
 #include "engine/easy_sprite.h"
 #include "engine/easy_util.h"
+#include "engine/frame_arena.h"
 #include "engine/log.h"
+#include "engine/profiler.h"
 #include "engine/vec4si32.h"
 #include "engine/vec4f.h"
 #include "vec2d.h"
@@ -97,7 +100,7 @@ struct KeyState {
 };
 
 static KeyState g_key_state[kKeyCount];
-static std::deque<InputMessage> g_input_messages;
+static FrameVector<InputMessage> g_input_messages;
 
 static Engine *g_engine = nullptr;
 static Vec2Si32 g_mouse_pos_prev = Vec2Si32(0, 0);
@@ -1055,13 +1058,18 @@ void DrawArrow(Sprite &to_sprite, Vec2F source_pos, Vec2F destination_pos,
 void ShowFrame() {
   GetEngine()->Draw2d();
 
+  // Everything allocated from the frame arena must be released before the reset.
+  FrameVector<InputMessage>().swap(g_input_messages);
+  ResetFrameArena();
+  ProfilerFrameMark();
+
+  ARCTIC_PROFILE_SCOPE("ShowFrame input");
   for (Si32 i = 0; i < kKeyCount; ++i) {
     g_key_state[i].OnShowFrame();
   }
   InputMessage message;
   g_mouse_pos_prev = g_mouse_pos;
   g_mouse_wheel_delta = 0;
-  g_input_messages.clear();
   Vec2F accumulated_delta(0.0f, 0.0f);
   while (PopInputMessage(&message)) {
     if (message.kind == InputMessage::kKeyboard) {
@@ -1101,6 +1109,7 @@ void ShowFrame() {
   } else {
     g_mouse_move = g_mouse_pos - g_mouse_pos_prev;
   }
+  ProcessAsyncLoads();
 }
 
 bool IsKeyDownwardImpl(Ui32 key_code) {
@@ -1366,6 +1375,10 @@ double Time() {
   return GetEngine()->GetTime();
 }
 
+void SeedRandom(Ui64 seed) {
+  GetEngine()->SeedRandom(seed);
+}
+
 Si64 Random(Si64 min, Si64 max) {
   return GetEngine()->GetRandom(min, max);
 }
@@ -1425,8 +1438,17 @@ void Sleep(double duration_seconds) {
 }
 
 std::vector<Ui8> ReadFile(const char *file_name, bool is_bulletproof) {
-  std::ifstream in(file_name, std::ios_base::in | std::ios_base::binary);
   std::vector<Ui8> data;
+  Ui32 entry = 0;
+  std::shared_ptr<AssetPack> pack = FindMountedAsset(file_name, &entry);
+  if (pack) {
+    if (!pack->Read(entry, &data) && !is_bulletproof) {
+      Fatal("Error in ReadFile. Corrupt asset pack entry, file_name: ",
+        file_name);
+    }
+    return data;
+  }
+  std::ifstream in(file_name, std::ios_base::in | std::ios_base::binary);
   if (in.rdstate() & std::ios_base::failbit) {
     if (is_bulletproof) {
       return data;
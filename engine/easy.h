@@ -32,6 +32,8 @@
 
 #include "engine/arctic_input.h"
 #include "engine/arctic_types.h"
+#include "engine/asset_pack.h"
+#include "engine/async_loader.h"
 #include "engine/csv.h"
 #include "engine/easy_advanced.h"
 #include "engine/easy_drawing.h"
@@ -46,6 +48,7 @@
 #include "engine/gui.h"
 #include "engine/localization.h"
 #include "engine/log.h"
+#include "engine/resource_cache.h"
 #include "engine/rgba.h"
 #include "engine/vec2si32.h"
 #include "engine/mat22f.h"
@@ -33,6 +33,7 @@ namespace arctic {
 /// @{
 
 /// @brief Loads all data from a file specified.
+/// Files in the mounted asset packs are found first, see MountAssetPack.
 /// @param [in] file_name Name of the file to load.
 /// @param [in] is_bulletproof If true, the function will not throw an exception if the file is not found.
 /// @return Vector of bytes containing the file data.
@@ -37,6 +37,7 @@
 #include "engine/vec2f.h"
 #include "engine/vec3f.h"
 #include "engine/log.h"
+#include "engine/mapped_file.h"
 #include "engine/easy_advanced.h"
 #include "engine/easy_files.h"
 #include "engine/rgba.h"
@@ -250,14 +251,14 @@ void HwSprite::Load(const char *file_name) {
     return;
   }
   if (StrCaseCmp(last_dot, ".tga") == 0) {
-    std::vector<Ui8> data = ReadFile(file_name, true);
-    if (data.empty()) {
+    MappedFile file;
+    if (!file.Open(file_name) || !file.Size()) {
       *Log() << "Error in HwSprite::Load, file: \""
         << file_name << "\" could not be loaded (data is empty)."
           " Not loading sprite.";
       return;
     }
-    sprite_instance_ = HwSpriteInstance::LoadTga(data.data(), static_cast<Si64>(data.size()));
+    sprite_instance_ = HwSpriteInstance::LoadTga(file.Data(), static_cast<Si64>(file.Size()));
     ref_pos_ = Vec2Si32(0, 0);
     ref_size_ = sprite_instance_ ? Vec2Si32(sprite_instance_->width(),
       sprite_instance_->height()) : Vec2Si32(0, 0);
@@ -34,6 +34,7 @@
 #include "engine/log.h"
 #include "engine/easy_files.h"
 #include "engine/easy_sound_instance.h"
+#include "engine/mapped_file.h"
 
 #define STB_VORBIS_NO_PUSHDATA_API
 #define STB_VORBIS_NO_STDIO
@@ -46,46 +47,71 @@ void Sound::Load(const char *file_name) {
   Load(file_name, true);
 }
 void Sound::Load(const char *file_name, bool do_unpack, std::vector<Ui8> *in_data) {
+  if (in_data) {
+    LoadImpl(file_name, do_unpack, in_data, nullptr);
+    return;
+  }
+  Check(!!file_name, "Error in Sound::Load, file_name is nullptr.");
+  // Files are mapped rather than read, 16-bit stereo 44100 Hz WAV and packed
+  // Vorbis sounds keep using the mapping and are paged in when played
+  const char *last_dot = strrchr(file_name, '.');
+  std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+  file->Open(file_name, last_dot && StrCaseCmp(last_dot, ".wav") == 0);
+  LoadImpl(file_name, do_unpack, nullptr, std::move(file));
+}
+
+void Sound::LoadFromFile(const char *file_name, bool do_unpack,
+    std::shared_ptr<MappedFile> file) {
+  Check(!!file, "Error in Sound::LoadFromFile, file is nullptr.");
+  LoadImpl(file_name, do_unpack, nullptr, std::move(file));
+}
+
+void Sound::LoadImpl(const char *file_name, bool do_unpack,
+    std::vector<Ui8> *in_data, std::shared_ptr<MappedFile> file) {
   Clear();
-  std::vector<Ui8> loaded_data;
   file_name_ = std::make_shared<std::string>(file_name);
   Check(!!file_name, "Error in Sound::Load, file_name is nullptr.");
   const char *last_dot = strrchr(file_name, '.');
   Check(!!last_dot, "Error in Sound::Load, file_name has no extension.", file_name);
+  const Ui8 *data = nullptr;
+  size_t size = 0;
+  if (in_data) {
+    data = in_data->data();
+    size = in_data->size();
+  } else if (file->IsOpen()) {
+    data = file->Data();
+    size = static_cast<size_t>(file->Size());
+  }
   if (StrCaseCmp(last_dot, ".wav") == 0) {
-    if (!in_data) {
-      loaded_data = ReadFile(file_name, true);
-      in_data = &loaded_data;
-    }
-    if (in_data->empty()) {
+    if (!size) {
       Log("Error in Sound::Load, loading empty or missing file \"", file_name, "\"");
     } else {
-      sound_instance_ = LoadWav(in_data->data(), static_cast<Si64>(in_data->size()));
+      sound_instance_ = file ? LoadWav(std::move(file)) :
+        LoadWav(data, static_cast<Si64>(size));
       if (sound_instance_ == nullptr) {
         Log("Error in Sound::Load, parsing file \"", file_name, "\"");
       }
     }
   } else if (StrCaseCmp(last_dot, ".ogg") == 0) {
-    if (!in_data) {
-      loaded_data = ReadFile(file_name, true);
-      in_data = &loaded_data;
-    }
-    if (!in_data->empty()) {
+    if (size) {
       if (do_unpack) {
         int error = 0;
-        vorbis_codec_ = stb_vorbis_open_memory(in_data->data(),
-          static_cast<int>(in_data->size()), &error, nullptr);
+        vorbis_codec_ = stb_vorbis_open_memory(data,
+          static_cast<int>(size), &error, nullptr);
         if (vorbis_codec_) {
-          Ui32 size = stb_vorbis_stream_length_in_samples(vorbis_codec_);
-          sound_instance_ = std::make_shared<SoundInstance>(size);
+          Ui32 samples = stb_vorbis_stream_length_in_samples(vorbis_codec_);
+          sound_instance_ = std::make_shared<SoundInstance>(samples);
           // int res =
           stb_vorbis_get_samples_short_interleaved(
             vorbis_codec_, 2,
-            sound_instance_->GetWavData(), static_cast<Si32>(size * 2));
+            sound_instance_->GetWavData(), static_cast<Si32>(samples * 2));
           // TODO(Huldra): if (res) {
           stb_vorbis_close(vorbis_codec_);
           vorbis_codec_ = nullptr;
         }
+      } else if (file) {
+        sound_instance_ = std::make_shared<SoundInstance>(std::move(file),
+          kSoundDataVorbis, 0, static_cast<Ui64>(size));
       } else {
         sound_instance_ = std::make_shared<SoundInstance>(*in_data);
       }
@@ -40,6 +40,9 @@ class Sound {
   std::shared_ptr<SoundInstance> sound_instance_;
   stb_vorbis *vorbis_codec_ = nullptr;
   std::shared_ptr<std::string> file_name_ = std::make_shared<std::string>("CLEAR");
+
+  void LoadImpl(const char *file_name, bool do_unpack,
+    std::vector<Ui8> *in_data, std::shared_ptr<MappedFile> file);
  public:
   /// @brief Loads a sound file with the option to unpack it
   /// @param file_name The name of the file to load
@@ -57,6 +60,14 @@ class Sound {
   /// @param do_unpack Whether to unpack the sound data
   void Load(const char *file_name, bool do_unpack);
 
+  /// @brief Loads a sound from a file opened by the caller
+  /// @param file_name The name of the file, its extension selects the format
+  /// @param do_unpack Whether to unpack the sound data
+  /// @param file The file, WAV files opened copy-on-write and packed Vorbis
+  ///   keep using it without a copy
+  void LoadFromFile(const char *file_name, bool do_unpack,
+    std::shared_ptr<MappedFile> file);
+
   /// @brief Loads a sound file
   /// @param file_name The name of the file to load
   void Load(const char *file_name);
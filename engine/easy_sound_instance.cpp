@@ -25,11 +25,14 @@
 
 #include "engine/easy_sound_instance.h"
 
+#include <cstdint>
 #include <cstring>
 #include <sstream>
+#include <utility>
 
 #include "engine/arctic_platform.h"
 #include "engine/log.h"
+#include "engine/mapped_file.h"
 
 namespace arctic {
 
@@ -76,29 +79,49 @@ SoundInstance::SoundInstance(Ui32 wav_samples) {
   format_ = kSoundDataWav;
   playing_count_ = 0;
   data_.resize(Ui64(wav_samples) * 2 * sizeof(Si16));
+  data_begin_ = data_.data();
+  data_size_ = data_.size();
 }
 
 SoundInstance::SoundInstance(std::vector<Ui8> vorbis_file) {
   format_ = kSoundDataVorbis;
   playing_count_ = 0;
-  data_.resize(vorbis_file.size());
-  std::memcpy(data_.data(), vorbis_file.data(), vorbis_file.size());
+  data_ = std::move(vorbis_file);
+  data_begin_ = data_.data();
+  data_size_ = data_.size();
+}
+
+SoundInstance::SoundInstance(std::shared_ptr<MappedFile> file,
+    SoundDataFormat format, Ui64 offset, Ui64 size) {
+  Check(file && offset + size <= file->Size(),
+    "Error in SoundInstance, the data is out of the file");
+  format_ = format;
+  playing_count_ = 0;
+  if (format == kSoundDataWav) {
+    data_begin_ = file->MutableData() + offset;
+    Check(reinterpret_cast<uintptr_t>(data_begin_) % alignof(Si16) == 0,
+      "Error in SoundInstance, WAV samples are not aligned");
+  } else {
+    data_begin_ = const_cast<Ui8*>(file->Data()) + offset;
+  }
+  data_size_ = size;
+  file_ = std::move(file);
 }
 
 Si16* SoundInstance::GetWavData() {
   if (format_ == kSoundDataWav) {
-    return static_cast<Si16*>(static_cast<void*>(data_.data()));
+    return static_cast<Si16*>(static_cast<void*>(data_begin_));
   } else {
     return nullptr;
   }
 }
 
 Ui8* SoundInstance::GetVorbisData() const {
-  return const_cast<Ui8*>(data_.data());
+  return data_begin_;
 }
 
 Si32 SoundInstance::GetVorbisSize() const {
-  return static_cast<Si32>(data_.size());
+  return static_cast<Si32>(data_size_);
 }
 
 SoundDataFormat SoundInstance::GetFormat() const {
@@ -107,31 +130,32 @@ SoundDataFormat SoundInstance::GetFormat() const {
 
 Si32 SoundInstance::GetDurationSamples() {
   if (format_ == kSoundDataWav) {
-    return static_cast<Si32>(data_.size() / 4);
+    return static_cast<Si32>(data_size_ / 4);
   } else {
     return 0;
   }
 }
 
-std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
-    const Si64 size) {
+static bool ParseWav(const Ui8 *data, const Si64 size,
+    const WaveSubchunkFmt **out_fmt, const Ui8 **out_sound_data,
+    Si64 *out_sound_data_size) {
   if (size < (Si64)sizeof(WaveHeader)) {
     *Log() << "Error in LoadWav, size is too small.";
-    return nullptr;
+    return false;
   }
   const WaveHeader *wav = static_cast<const WaveHeader*>(
       static_cast<const void*>(data));
   if (FromBe(wav->chunk_id.raw) != 0x52494646) {
     *Log() << "Error in LoadWav, chunk_id is not RIFF.";
-    return nullptr;
+    return false;
   }
   if (wav->chunk_size > size - 8) {
     *Log() << "Error in LoadWav, chunk_size is too large.";
-    return nullptr;
+    return false;
   }
   if (FromBe(wav->format.raw) != 0x57415645) {
     *Log() << "Error in LoadWav, format is not WAVE.";
-    return nullptr;
+    return false;
   }
 
   const WaveSubchunkFmt *fmt = nullptr;
@@ -146,13 +170,13 @@ std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
 
     if (hdr->subchunk_size > remaining_chunk_size - (Si64)sizeof(WaveSubchunkHeader)) {
       *Log() << "Error in LoadWav, subchunk_size is larger than the remaining part of the chunk.";
-      return nullptr;
+      return false;
     }
     switch (FromBe(hdr->subchunk_id.raw)) {
       case 0x666d7420: // "fmt"
         if (hdr->subchunk_size != 16) {
           *Log() << "Error in LoadWav, fmt subchunk_size is not 16.";
-          return nullptr;
+          return false;
         }
         fmt = static_cast<const WaveSubchunkFmt*>(static_cast<const void*>(cur_subchunk));
         break;
@@ -170,36 +194,50 @@ std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
   }
   if (!fmt) {
     *Log() << "Error in LoadWav, no fmt subchunk found.";
-    return nullptr;
+    return false;
   }
   if (!sound_data) {
     *Log() << "Error in LoadWav, no data subchunk found.";
-    return nullptr;
+    return false;
   }
 
   if (fmt->audio_format != 1) {
     *Log() << "Error in LoadWav, fmt audio_format is not 1 (PCM).";
-    return nullptr;
+    return false;
   }
   if (fmt->channels <= 0) {
     *Log() << "Error in LoadWav, fmt channels <= 0.";
-    return nullptr;
+    return false;
   }
   if ((fmt->bits_per_sample != 8) && (fmt->bits_per_sample != 16)) {
     *Log() << "Error in LoadWav, unsupported bits_per_sample.";
-    return nullptr;
+    return false;
   }
   if (fmt->block_align == 0) {
     *Log() << "Error in LoadWav, block_align cannot be 0.";
-    return nullptr;
+    return false;
   }
   if (fmt->sample_rate == 0) {
     *Log() << "Error in LoadWav, sample_rate cannot be 0.";
-    return nullptr;
+    return false;
   }
   if (fmt->sample_rate < 1000) {
     *Log() << "Error in LoadWav, sample_rate of " << fmt->sample_rate
       << " is too low, use at least 1000";
+    return false;
+  }
+  *out_fmt = fmt;
+  *out_sound_data = sound_data;
+  *out_sound_data_size = sound_data_size;
+  return true;
+}
+
+std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
+    const Si64 size) {
+  const WaveSubchunkFmt *fmt = nullptr;
+  const Ui8 *sound_data = nullptr;
+  Si64 sound_data_size = 0;
+  if (!ParseWav(data, size, &fmt, &sound_data, &sound_data_size)) {
     return nullptr;
   }
 
@@ -297,6 +335,30 @@ std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
   return sound;
 }
 
+std::shared_ptr<SoundInstance> LoadWav(std::shared_ptr<MappedFile> file) {
+  if (!file || !file->IsOpen()) {
+    *Log() << "Error in LoadWav, the file is not open.";
+    return nullptr;
+  }
+  const Ui8 *data = file->Data();
+  Si64 size = static_cast<Si64>(file->Size());
+  const WaveSubchunkFmt *fmt = nullptr;
+  const Ui8 *sound_data = nullptr;
+  Si64 sound_data_size = 0;
+  if (!ParseWav(data, size, &fmt, &sound_data, &sound_data_size)) {
+    return nullptr;
+  }
+  Ui64 offset = static_cast<Ui64>(sound_data - data);
+  if (file->IsCopyOnWrite() &&
+      fmt->sample_rate == 44100 && fmt->bits_per_sample == 16 &&
+      fmt->channels == 2 && fmt->block_align == 4 &&
+      reinterpret_cast<uintptr_t>(sound_data) % alignof(Si16) == 0) {
+    return std::make_shared<SoundInstance>(std::move(file), kSoundDataWav,
+      offset, static_cast<Ui64>(sound_data_size / 4 * 4));
+  }
+  return LoadWav(data, size);
+}
+
 bool SoundInstance::IsPlaying() {
   return (playing_count_.load() != 0);
 }
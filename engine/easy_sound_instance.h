@@ -31,6 +31,8 @@
 
 namespace arctic {
 
+class MappedFile;
+
 /// @addtogroup global_advanced
 /// @{
 
@@ -44,6 +46,10 @@ enum SoundDataFormat {
 class SoundInstance {
   SoundDataFormat format_;
   std::vector<Ui8> data_;
+  /// Keeps the mapping of sounds that use the file bytes as they are
+  std::shared_ptr<MappedFile> file_;
+  Ui8 *data_begin_ = nullptr;
+  Ui64 data_size_ = 0;
   std::atomic<Si32> playing_count_ = ATOMIC_VAR_INIT(0);
  public:
   /// @brief Constructor for WAV sound instance
@@ -54,6 +60,17 @@ class SoundInstance {
   /// @param vorbis_file Vector containing Vorbis file data
   explicit SoundInstance(std::vector<Ui8> vorbis_file);
 
+  /// @brief Constructor for a sound instance that uses a part of a mapped
+  /// file as it is, without copying
+  /// @param file The file, WAV data must be in a file opened copy-on-write
+  ///   since GetWavData allows changing the samples
+  /// @param format Format of the data
+  /// @param offset Offset of the data in the file, WAV samples must be
+  ///   2-byte aligned
+  /// @param size Size of the data in bytes
+  SoundInstance(std::shared_ptr<MappedFile> file, SoundDataFormat format,
+    Ui64 offset, Ui64 size);
+
   /// @brief Get pointer to WAV data
   /// @return Pointer to Si16 WAV data, nullptr if format is not WAV
   Si16* GetWavData();
@@ -93,6 +110,15 @@ class SoundInstance {
 std::shared_ptr<SoundInstance> LoadWav(const Ui8 *data,
     const Si64 size);
 
+/// @brief Creates a sound instance from a WAV file
+/// @details 16-bit stereo 44100 Hz PCM is the format sounds are played in,
+///   such files are used right from the mapping, so their samples are only
+///   read from the disk when played. Other formats are converted.
+/// @param file The file, read-only files are always converted since
+///   GetWavData allows changing the samples
+/// @return Shared pointer to created SoundInstance
+std::shared_ptr<SoundInstance> LoadWav(std::shared_ptr<MappedFile> file);
+
 /// @}
 
 }  // namespace arctic
@@ -36,8 +36,10 @@
 #include "engine/arctic_types.h"
 #include "engine/vec2f.h"
 #include "engine/log.h"
+#include "engine/mapped_file.h"
 #include "engine/easy_advanced.h"
 #include "engine/easy_files.h"
+#include "engine/profiler.h"
 #include "engine/rgba.h"
 
 namespace arctic {
@@ -401,6 +403,8 @@ void DrawTriangle(Sprite to_sprite,
   // Fill
   Si32 tex_stride = texture.StridePixels();
   const Rgba * const tex_data = texture.RgbaData();
+  const Si32 tex_max_x = texture.Width() - 1;
+  const Si32 tex_max_y = texture.Height() - 1;
   for (Si32 y = first_y; y <= last_y; ++y) {
     const Edge &edge_l = edge[y * 2];
     const Edge &edge_r = edge[y * 2 + 1];
@@ -441,13 +445,20 @@ void DrawTriangle(Sprite to_sprite,
         color = *(tex_data + ((tex1_x_16 + 32768) >> 16)
           + ((tex1_y_16 + 32768) >> 16) * tex_stride);
       } else if (kFilterMode == kFilterBilinear) {
-        const Rgba* t1 = tex_data + (tex1_x_16 >> 16)
-          + (tex1_y_16 >> 16) * tex_stride;
-
-        Rgba color00 = *(t1);
-        Rgba color01 = *(t1 + 1);
-        Rgba color10 = *(t1 + tex_stride);
-        Rgba color11 = *(t1 + 1 + tex_stride);
+        // Clamp to the edge, texture coordinates reach -0.5 and size - 0.5.
+        const Si32 tex_x = tex1_x_16 >> 16;
+        const Si32 tex_y = tex1_y_16 >> 16;
+        const Si32 tex_x0 = std::min(std::max(tex_x, 0), tex_max_x);
+        const Si32 tex_x1 = std::min(std::max(tex_x + 1, 0), tex_max_x);
+        const Rgba* row0 = tex_data
+          + std::min(std::max(tex_y, 0), tex_max_y) * tex_stride;
+        const Rgba* row1 = tex_data
+          + std::min(std::max(tex_y + 1, 0), tex_max_y) * tex_stride;
+
+        Rgba color00 = row0[tex_x0];
+        Rgba color01 = row0[tex_x1];
+        Rgba color10 = row1[tex_x0];
+        Rgba color11 = row1[tex_x1];
 
         Ui32 from_x_8 = ((tex1_x_16 >> 8) & 255);
         Ui32 from_y_8 = ((tex1_y_16 >> 8) & 255);
@@ -556,6 +567,7 @@ void DrawSprite(Sprite *to_sprite,
     const Sprite &from_sprite, const Si32 from_x, const Si32 from_y,
     const Si32 from_width, const Si32 from_height,
     Rgba in_color) {
+  ARCTIC_PROFILE_SCOPE("DrawSprite");
   if (!from_width || !from_height || !to_width || !to_height) {
     return;
   }
@@ -981,15 +993,15 @@ void Sprite::Load(const char *file_name) {
     return;
   }
   if (StrCaseCmp(last_dot, ".tga") == 0) {
-    std::vector<Ui8> data = ReadFile(file_name, true);
-    if (data.empty()) {
+    MappedFile file;
+    if (!file.Open(file_name) || !file.Size()) {
       *Log() << "Error in Sprite::Load, file: \""
         << file_name << "\" could not be loaded (data is empty)."
           " Not loading sprite.";
       return;
     }
     pivot_ = Vec2Si32(0, 0);
-    sprite_instance_ = LoadTga(data.data(), static_cast<Si64>(data.size()), &pivot_);
+    sprite_instance_ = LoadTga(file.Data(), static_cast<Si64>(file.Size()), &pivot_);
     ref_pos_ = Vec2Si32(0, 0);
     ref_size_ = sprite_instance_ ? Vec2Si32(sprite_instance_->width(),
       sprite_instance_->height()) : Vec2Si32(0, 0);
@@ -1309,6 +1321,7 @@ void Sprite::Draw(const float to_x, const float to_y, float to_width, float to_h
   if (!sprite_instance_) {
     return;
   }
+  ARCTIC_PROFILE_SCOPE("DrawSprite rotated");
   Vec2F pivot = Vec2F(to_x, to_y);
   float sin_a = sinf(angle_radians);
   float cos_a = cosf(angle_radians);
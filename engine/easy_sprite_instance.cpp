@@ -32,6 +32,7 @@
 
 #include "engine/arctic_platform.h"
 #include "engine/log.h"
+#include "engine/profiler.h"
 #include "engine/rgba.h"
 #include "engine/vec2si32.h"
 
@@ -99,6 +100,7 @@ struct TgaHeader {
 
 
   std::shared_ptr<SpriteInstance> LoadTga(const Ui8 *data, const Si64 size, Vec2Si32 *out_origin) {
+    ARCTIC_PROFILE_SCOPE("LoadTga");
     if (out_origin) {
       *out_origin = Vec2Si32(0, 0);
     }
@@ -54,6 +54,12 @@ void SetInverseY(bool is_inverse);
 /// @return Time in seconds as a double
 double Time();
 
+/// @brief Seeds the random number generators of the calling thread, the
+/// Random functions called on this thread then return the same numbers for
+/// the same seed
+/// @param seed The seed
+void SeedRandom(Ui64 seed);
+
 /// @brief Returns a random number in range [min,max]
 /// @param min The minimum value of the range (inclusive)
 /// @param max The maximum value of the range (inclusive)
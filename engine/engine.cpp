@@ -34,6 +34,7 @@
 #include "engine/arctic_math.h"
 #include "engine/unicode.h"
 #include "engine/gl_state.h"
+#include "engine/profiler.h"
 
 namespace arctic {
 
@@ -94,10 +95,14 @@ void Engine::InitThreadLocalRng() {
   Si64 ms = std::chrono::high_resolution_clock::now().time_since_epoch().count();
   
   // Initialize thread-local random number generators with time-based seed
-  rnd_8_.seed(static_cast<Ui64>(ms));
-  rnd_16_.seed(static_cast<Ui64>(ms + 1));
-  rnd_32_.seed(static_cast<Ui64>(ms + 2));
-  rnd_64_.seed(static_cast<Ui64>(ms + 3));
+  SeedRandom(static_cast<Ui64>(ms));
+}
+
+void Engine::SeedRandom(Ui64 seed) {
+  rnd_8_.seed(seed);
+  rnd_16_.seed(seed + 1);
+  rnd_32_.seed(seed + 2);
+  rnd_64_.seed(seed + 3);
   is_rng_initialized_ = true;
 }
 
@@ -266,6 +271,7 @@ struct Vertex {
 };
 
 void Engine::Draw2d() {
+  ARCTIC_PROFILE_SCOPE("Draw2d");
   gl_backbuffer_texture_.UpdateData(backbuffer_texture_.RawData());
 
   // render
@@ -490,7 +496,8 @@ void Engine::Draw2d() {
       }
     }
   }
-  hw_sprite_drawing_.clear();
+  // The storage is in the frame arena that is reset by ShowFrame().
+  FrameVector<HwSpriteDrawing>().swap(hw_sprite_drawing_);
 
   if (is_sw_renderer_enabled_) {
     mesh_.mVertexData.mVertexArray[0].mNum = 4;
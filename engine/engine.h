@@ -33,6 +33,7 @@
 #include "engine/arctic_platform.h"
 #include "engine/easy_sprite.h"
 #include "engine/easy_hw_sprite.h"
+#include "engine/frame_arena.h"
 #include "engine/vec2f.h"
 #include "engine/opengl.h"
 #include "engine/gl_texture2d.h"
@@ -63,7 +64,7 @@ class Engine {
   HwSprite hw_backbuffer_texture_;
 
   Mesh mesh_;
-  std::vector<HwSpriteDrawing> hw_sprite_drawing_;
+  FrameVector<HwSpriteDrawing> hw_sprite_drawing_;
 
   GlBuffer vbo_;
   GlBuffer ebo_;
@@ -161,6 +162,13 @@ class Engine {
   /// @return The current time as a double.
   double GetTime();
 
+  /// @brief Seeds the random number generators of the calling thread.
+  /// @details Each thread has its own generators, seeded from the clock on
+  ///   first use. Seeding them makes the following numbers of this thread
+  ///   depend on the seed only.
+  /// @param seed The seed.
+  void SeedRandom(Ui64 seed);
+
   /// @brief Generates a random integer within the specified range. The range is not expected to be larger than 58 bit, larger ranges may caluse integer overflow or bad random distribution.
   /// @param min The minimum value of the range (inclusive).
   /// @param max The maximum value of the range (inclusive).
@@ -0,0 +1,198 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/event_scheduler.h"
+
+#include <algorithm>
+
+#include "engine/arctic_platform_fatal.h"
+
+namespace arctic {
+
+const size_t EventScheduler::kMaxEventSize;
+const Ui32 EventScheduler::kNone;
+const size_t EventScheduler::kArity;
+
+EventScheduler::EventScheduler() {
+}
+
+EventHandle EventScheduler::Push(double time, Ui32 handler,
+    const void *event, size_t size) {
+  Check(handler < handlers_.size(), "EventScheduler: unknown event type");
+  Ui32 index = free_head_;
+  if (index != kNone) {
+    free_head_ = nodes_[index].next_free;
+  } else {
+    index = static_cast<Ui32>(nodes_.size());
+    nodes_.emplace_back();
+  }
+  Node &node = nodes_[index];
+  node.handler = handler;
+  node.is_scheduled = true;
+  std::memcpy(node.event, event, size);
+  HeapEntry entry;
+  entry.time = time;
+  entry.sequence = next_sequence_++;
+  entry.node = index;
+  entry.generation = node.generation;
+  heap_.push_back(entry);
+  SiftUp(heap_.size() - 1);
+  EventHandle handle;
+  handle.index = index;
+  handle.generation = node.generation;
+  return handle;
+}
+
+void EventScheduler::SiftUp(size_t pos) {
+  HeapEntry entry = heap_[pos];
+  while (pos > 0) {
+    size_t parent = (pos - 1) / kArity;
+    if (!IsEarlier(entry, heap_[parent])) {
+      break;
+    }
+    heap_[pos] = heap_[parent];
+    pos = parent;
+  }
+  heap_[pos] = entry;
+}
+
+void EventScheduler::SiftDown(size_t pos) {
+  HeapEntry entry = heap_[pos];
+  size_t size = heap_.size();
+  while (true) {
+    size_t first = pos * kArity + 1;
+    if (first >= size) {
+      break;
+    }
+    size_t last = std::min(first + kArity, size);
+    size_t best = first;
+    for (size_t child = first + 1; child < last; ++child) {
+      if (IsEarlier(heap_[child], heap_[best])) {
+        best = child;
+      }
+    }
+    if (!IsEarlier(heap_[best], entry)) {
+      break;
+    }
+    heap_[pos] = heap_[best];
+    pos = best;
+  }
+  heap_[pos] = entry;
+}
+
+void EventScheduler::PopTop() {
+  heap_[0] = heap_.back();
+  heap_.pop_back();
+  if (!heap_.empty()) {
+    SiftDown(0);
+  }
+}
+
+void EventScheduler::DropCancelledTop() {
+  while (!heap_.empty() && IsCancelled(heap_[0])) {
+    PopTop();
+    --cancelled_count_;
+  }
+}
+
+void EventScheduler::Compact() {
+  size_t kept = 0;
+  for (size_t pos = 0; pos < heap_.size(); ++pos) {
+    if (!IsCancelled(heap_[pos])) {
+      heap_[kept] = heap_[pos];
+      ++kept;
+    }
+  }
+  heap_.resize(kept);
+  cancelled_count_ = 0;
+  for (size_t pos = kept / kArity + 1; pos > 0; --pos) {
+    if (pos - 1 < kept) {
+      SiftDown(pos - 1);
+    }
+  }
+}
+
+void EventScheduler::Release(Ui32 index) {
+  Node &node = nodes_[index];
+  node.is_scheduled = false;
+  ++node.generation;
+  node.next_free = free_head_;
+  free_head_ = index;
+}
+
+bool EventScheduler::Cancel(EventHandle handle) {
+  if (!IsScheduled(handle)) {
+    return false;
+  }
+  Release(handle.index);
+  ++cancelled_count_;
+  if (cancelled_count_ * 2 > heap_.size()) {
+    Compact();
+  } else {
+    DropCancelledTop();
+  }
+  return true;
+}
+
+bool EventScheduler::Step() {
+  if (heap_.empty()) {
+    return false;
+  }
+  HeapEntry top = heap_[0];
+  PopTop();
+  DropCancelledTop();
+  if (top.time > time_) {
+    time_ = top.time;
+  }
+  Handler handler = handlers_[nodes_[top.node].handler];
+  Release(top.node);
+  ++processed_count_;
+  // Invoke copies the event out before the handler can schedule new events
+  // into the released node or grow the pool
+  handler.invoke(handler.context, handler.function, nodes_[top.node].event);
+  return true;
+}
+
+Ui64 EventScheduler::RunUntil(double end_time, Ui64 max_events) {
+  Ui64 count = 0;
+  while (count < max_events && !heap_.empty() &&
+      heap_[0].time <= end_time) {
+    Step();
+    ++count;
+  }
+  if (count < max_events && end_time > time_) {
+    time_ = end_time;
+  }
+  return count;
+}
+
+void EventScheduler::Clear() {
+  for (const HeapEntry &entry : heap_) {
+    if (!IsCancelled(entry)) {
+      Release(entry.node);
+    }
+  }
+  heap_.clear();
+  cancelled_count_ = 0;
+}
+
+}  // namespace arctic
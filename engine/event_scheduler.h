@@ -0,0 +1,231 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_EVENT_SCHEDULER_H_
+#define ENGINE_EVENT_SCHEDULER_H_
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "engine/arctic_types.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Identifies a scheduled event, stays safe to use after the event
+/// has run or was cancelled
+struct EventHandle {
+  Ui32 index = 0xffffffffu;
+  Ui32 generation = 0;
+};
+
+/// @brief Typed token returned by EventScheduler::AddHandler
+template <typename Event>
+struct EventType {
+  Ui32 handler = 0xffffffffu;
+};
+
+/// @brief Discrete event simulation kernel
+///
+/// Keeps future events in a 4-ary heap of (time, sequence, node) keys over
+/// pooled event nodes, so scheduling and running an event is O(log n),
+/// cancelling is O(1) and nothing is allocated once the pool has grown to
+/// the peak number of pending events. Cancelled keys stay in the heap until
+/// they reach the top or make up half of it. Time jumps straight to the
+/// next event. Events scheduled for the same time run in the order they were
+/// scheduled.
+///
+/// Events are small trivially copyable structs stored inside the heap
+/// nodes, each event type is bound to a handler function and a context
+/// pointer with AddHandler.
+/// Example:
+/// @code
+///   struct Arrival { Si32 packet; };
+///   static void OnArrival(Model *model, const Arrival &event);
+///   ...
+///   EventScheduler scheduler;
+///   EventType<Arrival> arrival = scheduler.AddHandler(&model, OnArrival);
+///   EventHandle timer = scheduler.ScheduleAfter(0.25, arrival, Arrival{7});
+///   scheduler.Cancel(timer);
+///   scheduler.RunUntil(60.0);
+/// @endcode
+/// Handlers may schedule and cancel events. Not thread safe.
+class EventScheduler {
+ public:
+  /// Largest event struct that can be scheduled
+  static const size_t kMaxEventSize = 48;
+
+  EventScheduler();
+  EventScheduler(const EventScheduler &other) = delete;
+  EventScheduler &operator=(const EventScheduler &other) = delete;
+
+  /// @brief Binds events of type Event to a handler
+  /// @param context The first argument passed to the handler
+  /// @param handler Function called when an event of this type runs
+  /// @return The token to schedule events of this type with
+  template <typename Context, typename Event>
+  EventType<Event> AddHandler(Context *context,
+      void (*handler)(Context *context, const Event &event)) {
+    static_assert(sizeof(Event) <= kMaxEventSize,
+      "Event is larger than EventScheduler::kMaxEventSize");
+    static_assert(alignof(Event) <= alignof(double),
+      "Event alignment is larger than EventScheduler supports");
+    static_assert(std::is_trivially_copyable<Event>::value,
+      "Event must be trivially copyable");
+    Handler entry;
+    entry.context = context;
+    entry.function = reinterpret_cast<void (*)()>(handler);
+    entry.invoke = &Invoke<Context, Event>;
+    handlers_.push_back(entry);
+    EventType<Event> type;
+    type.handler = static_cast<Ui32>(handlers_.size() - 1);
+    return type;
+  }
+
+  /// @brief Schedules an event at an absolute time, times in the past run
+  /// next
+  template <typename Event>
+  EventHandle Schedule(double time, EventType<Event> type,
+      const Event &event) {
+    return Push(time, type.handler, &event, sizeof(Event));
+  }
+
+  /// @brief Schedules an event delay seconds after the current time
+  template <typename Event>
+  EventHandle ScheduleAfter(double delay, EventType<Event> type,
+      const Event &event) {
+    return Push(time_ + delay, type.handler, &event, sizeof(Event));
+  }
+
+  /// @brief Removes a pending event
+  /// @return False if the event has already run or was cancelled
+  bool Cancel(EventHandle handle);
+
+  /// @brief Returns true if the event is still pending
+  bool IsScheduled(EventHandle handle) const {
+    return handle.index < nodes_.size() &&
+      nodes_[handle.index].generation == handle.generation &&
+      nodes_[handle.index].is_scheduled;
+  }
+
+  /// @brief Advances time to the next event and runs it
+  /// @return False if there are no pending events
+  bool Step();
+
+  /// @brief Runs every event up to and including end_time, then sets the
+  /// current time to end_time
+  /// @param end_time The time to advance to
+  /// @param max_events Stop early after running this many events
+  /// @return The number of events run
+  Ui64 RunUntil(double end_time, Ui64 max_events = ~0ull);
+
+  /// @brief Drops every pending event, keeps the time and the handlers
+  void Clear();
+
+  double GetTime() const {
+    return time_;
+  }
+  /// @brief Returns the time of the next pending event or the current time
+  /// if there is none
+  double GetNextEventTime() const {
+    return heap_.empty() ? time_ : heap_[0].time;
+  }
+  size_t GetPendingCount() const {
+    return heap_.size() - cancelled_count_;
+  }
+  /// @brief Returns the number of events run since construction
+  Ui64 GetProcessedCount() const {
+    return processed_count_;
+  }
+
+ private:
+  static const Ui32 kNone = 0xffffffffu;
+  static const size_t kArity = 4;
+
+  struct Handler {
+    void *context = nullptr;
+    void (*function)() = nullptr;
+    void (*invoke)(void *context, void (*function)(),
+      const void *event) = nullptr;
+  };
+
+  struct Node {
+    Ui32 generation = 0;
+    Ui32 handler = 0;
+    Ui32 next_free = kNone;
+    bool is_scheduled = false;
+    alignas(double) Ui8 event[kMaxEventSize];
+  };
+
+  /// Heap keys are kept apart from the nodes so that sifting touches a
+  /// compact array only. An entry whose generation differs from its node
+  /// was cancelled.
+  struct HeapEntry {
+    double time;
+    Ui64 sequence;
+    Ui32 node;
+    Ui32 generation;
+  };
+
+  template <typename Context, typename Event>
+  static void Invoke(void *context, void (*function)(), const void *event) {
+    Event typed_event;
+    std::memcpy(&typed_event, event, sizeof(Event));
+    reinterpret_cast<void (*)(Context*, const Event&)>(function)(
+      static_cast<Context*>(context), typed_event);
+  }
+
+  EventHandle Push(double time, Ui32 handler, const void *event,
+    size_t size);
+  static bool IsEarlier(const HeapEntry &lhs, const HeapEntry &rhs) {
+    return lhs.time < rhs.time ||
+      (lhs.time == rhs.time && lhs.sequence < rhs.sequence);
+  }
+  bool IsCancelled(const HeapEntry &entry) const {
+    return nodes_[entry.node].generation != entry.generation;
+  }
+  void SiftUp(size_t pos);
+  void SiftDown(size_t pos);
+  void PopTop();
+  void DropCancelledTop();
+  void Compact();
+  void Release(Ui32 index);
+
+  std::vector<Node> nodes_;
+  std::vector<HeapEntry> heap_;
+  std::vector<Handler> handlers_;
+  Ui32 free_head_ = kNone;
+  size_t cancelled_count_ = 0;
+  Ui64 next_sequence_ = 0;
+  Ui64 processed_count_ = 0;
+  double time_ = 0.0;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_EVENT_SCHEDULER_H_
@@ -35,6 +35,7 @@
 #include "engine/easy_advanced.h"
 #include "engine/easy_files.h"
 #include "engine/log.h"
+#include "engine/mapped_file.h"
 #include "engine/unicode.h"
 #include "engine/pugixml.h"
 
@@ -318,9 +319,36 @@ void FontInstance::Load(const char *file_name) {
   Fatal("Error in FontInstance::Load, file_name has an unknown extension: ", file_name);
 }
 
+void FontInstance::LoadFromData(const Ui8 *data, Ui64 size,
+    const char *file_name) {
+  Check(!!file_name,
+    "Error in FontInstance::LoadFromData, file_name is nullptr.");
+  const char *last_dot = strrchr(file_name, '.');
+  if (!last_dot || StrCaseCmp(last_dot, ".fnt") == 0) {
+    LoadBinaryFntFromData(data, size, file_name);
+    return;
+  }
+  if (StrCaseCmp(last_dot, ".xml") == 0) {
+    LoadXmlFromData(data, size, file_name);
+    return;
+  }
+  Fatal("Error in FontInstance::LoadFromData, file_name has an unknown extension: ",
+    file_name);
+}
+
 void FontInstance::LoadXml(const char *file_name) {
+  MappedFile file;
+  if (!file.Open(file_name)) {
+    Fatal("Error loading FontInstance, can't open file: ", file_name);
+  }
+  LoadXmlFromData(file.Data(), file.Size(), file_name);
+}
+
+void FontInstance::LoadXmlFromData(const Ui8 *data, Ui64 size,
+    const char *file_name) {
   pugi::XmlDocument doc;
-  pugi::XmlParseResult parse_result = doc.load_file(file_name);
+  pugi::XmlParseResult parse_result = doc.load_buffer(data,
+    static_cast<size_t>(size));
   if (parse_result.status != pugi::status_ok) {
     std::stringstream str;
     str << "Error loading " << file_name << " FontInstance, at offset " << parse_result.offset << " (line " << parse_result.line;
@@ -417,11 +445,17 @@ void FontInstance::LoadAsciiSquare(const char *file_name, bool is_dense) {
 }
 
 void FontInstance::LoadBinaryFnt(const char *file_name) {
+  std::vector<Ui8> file = ReadFile(file_name);
+  LoadBinaryFntFromData(file.data(), file.size(), file_name);
+}
+
+void FontInstance::LoadBinaryFntFromData(const Ui8 *file, Ui64 size,
+    const char *file_name) {
   codepoint_.clear();
   glyph_.clear();
 
-  std::vector<Ui8> file = ReadFile(file_name);
-  Si32 file_size = static_cast<Si32>(file.size());
+  Check(size <= 0x7fffffffull, "Font file is too large: ", file_name);
+  Si32 file_size = static_cast<Si32>(size);
   Si32 pos = 0;
   // BmFontBinHeader *header = reinterpret_cast<BmFontBinHeader*>(&file[pos]);
   // header->Log();
@@ -444,7 +478,7 @@ void FontInstance::LoadBinaryFnt(const char *file_name) {
   BmFontBinInfo info;
   memcpy(&info, &file[static_cast<size_t>(pos)],
     sizeof(info) - sizeof(info.font_name));
-  info.font_name = reinterpret_cast<char*>(
+  info.font_name = reinterpret_cast<const char*>(
     &file[static_cast<size_t>(pos) + sizeof(info) - sizeof(info.font_name)]);
   outline_ = info.outline;
   // info.Log();
@@ -488,7 +522,7 @@ void FontInstance::LoadBinaryFnt(const char *file_name) {
   for (Si32 id = 0; id < common.pages; ++id) {
     BmFontBinPages page;
     page.page_name =
-      reinterpret_cast<char*>(&file[static_cast<size_t>(inner_pos)]);
+      reinterpret_cast<const char*>(&file[static_cast<size_t>(inner_pos)]);
     // page.Log(id);
 
     char path[8 << 10];
@@ -707,15 +741,15 @@ void FontInstance::LoadTtf(const char *file_name, float pixel_height,
     utf8_chars = default_chars;
   }
 
-  std::vector<Ui8> ttf_data = ReadFile(file_name);
-  Check(!ttf_data.empty(),
+  MappedFile ttf_file;
+  Check(ttf_file.Open(file_name) && ttf_file.Size() > 0,
     "Error in FontInstance::LoadTtf, could not read file: ", file_name);
 
   stbtt_fontinfo font_info;
-  int font_offset = stbtt_GetFontOffsetForIndex(ttf_data.data(), font_index);
+  int font_offset = stbtt_GetFontOffsetForIndex(ttf_file.Data(), font_index);
   Check(font_offset >= 0,
     "Error in FontInstance::LoadTtf, font_index out of range: ", file_name);
-  int init_result = stbtt_InitFont(&font_info, ttf_data.data(), font_offset);
+  int init_result = stbtt_InitFont(&font_info, ttf_file.Data(), font_offset);
   Check(init_result != 0,
     "Error in FontInstance::LoadTtf, failed to parse font: ", file_name);
 
@@ -972,6 +1006,7 @@ void Font::Draw(const char *text, const Si32 x, const Si32 y,
     const DrawBlendingMode blending_mode,
     const DrawFilterMode filter_mode,
     const Rgba color) {
+  ARCTIC_PROFILE_SCOPE("Font::Draw");
   font_instance_->DrawEvaluateSizeImpl(GetEngine()->GetBackbuffer(),
       text, false, x, y, origin, alignment,
       blending_mode, filter_mode, color,
@@ -984,6 +1019,7 @@ void Font::Draw(const char *text, const Si32 x, const Si32 y,
     const DrawBlendingMode blending_mode,
     const DrawFilterMode filter_mode,
     const std::vector<Rgba> &palete) {
+  ARCTIC_PROFILE_SCOPE("Font::Draw");
   Rgba color = palete.empty() ? Rgba(0xffffffff) : palete[0];
   font_instance_->DrawEvaluateSizeImpl(GetEngine()->GetBackbuffer(),
       text, false, x, y, origin, alignment,
@@ -29,6 +29,7 @@
 
 #include "engine/arctic_types.h"
 #include "engine/easy_sprite.h"
+#include "engine/profiler.h"
 
 namespace arctic {
 
@@ -77,7 +78,7 @@ struct BmFontBinInfo {
   Ui8 spacing_horiz;
   Ui8 spacing_vert;
   Ui8 outline;
-  char *font_name;  // n+1 string
+  const char *font_name;  // n+1 string
   // 14 null terminated string with length n
   // This structure gives the layout of the fields.
   // Remember that there should be no padding between members.
@@ -110,7 +111,7 @@ struct BmFontBinCommon {
 
 /// @brief Structure representing the BMFont binary pages block
 struct BmFontBinPages {
-  char *page_name;  // p*(n+1) strings 0 p null terminated strings,
+  const char *page_name;  // p*(n+1) strings 0 p null terminated strings,
                     // each with length n
   // This block gives the name of each texture file with the image data
   // for the characters. The string pageNames holds the names separated
@@ -292,6 +293,13 @@ public:
   /// @throws Fatal error if the file extension is not recognized or the file cannot be loaded
   void Load(const char *file_name);
 
+  /// @brief Loads a font from the contents of its file, see Load
+  /// @param [in] data File contents
+  /// @param [in] size Size of the contents in bytes
+  /// @param [in] file_name Path to the file, selects the format and locates
+  ///   the texture files
+  void LoadFromData(const Ui8 *data, Ui64 size, const char *file_name);
+
   /// @brief Loads a font from an XML file
   /// @param [in] file_name Path to the XML font file
   void LoadXml(const char *file_name);
@@ -305,6 +313,13 @@ public:
   /// @param [in] file_name Path to the binary BMFont file
   void LoadBinaryFnt(const char *file_name);
 
+  /// @brief Loads a binary BMFont file from its contents
+  void LoadBinaryFntFromData(const Ui8 *file, Ui64 size,
+    const char *file_name);
+
+  /// @brief Loads an XML font file from its contents
+  void LoadXmlFromData(const Ui8 *data, Ui64 size, const char *file_name);
+
   /// @brief Loads a font from a horizontal stripe of glyphs
   /// @param [in] sprite Sprite containing the glyph stripe
   /// @param [in] utf8_letters UTF-8 encoded string of letters in the sprite
@@ -607,6 +622,15 @@ class Font {
     font_instance_->Load(file_name);
   }
 
+  /// @brief Loads a font from the contents of its file, see Load
+  /// @param [in] data File contents
+  /// @param [in] size Size of the contents in bytes
+  /// @param [in] file_name Path to the file, selects the format and locates
+  ///   the texture files
+  void LoadFromData(const Ui8 *data, Ui64 size, const char *file_name) {
+    font_instance_->LoadFromData(data, size, file_name);
+  }
+
   /// @brief Loads a font from an XML file
   /// @param [in] file_name Path to the XML font file
   void LoadXml(const char *file_name) {
@@ -812,6 +836,7 @@ class Font {
       const DrawBlendingMode blending_mode = kDrawBlendingModeAlphaBlend,
       const DrawFilterMode filter_mode = kFilterNearest,
       const Rgba color = Rgba(0xffffffff)) {
+    ARCTIC_PROFILE_SCOPE("Font::Draw");
     font_instance_->DrawEvaluateSizeImpl(to_sprite,
                                          text, false, x, y, origin, alignment, blending_mode, filter_mode, color,
                                          std::vector<Rgba>(), true, nullptr, false, nullptr, nullptr);
@@ -841,6 +866,7 @@ class Font {
       const DrawBlendingMode blending_mode,
       const DrawFilterMode filter_mode,
       const std::vector<Rgba> &palete) {
+    ARCTIC_PROFILE_SCOPE("Font::Draw");
     Rgba color = palete.empty() ? Rgba(0xffffffff) : palete[0];
     font_instance_->DrawEvaluateSizeImpl(to_sprite,
                                          text, false, x, y, origin, alignment, blending_mode, filter_mode, color,
@@ -0,0 +1,159 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/frame_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>  // NOLINT
+
+#include "engine/arctic_platform_fatal.h"
+
+namespace arctic {
+
+namespace {
+
+struct FrameArenaRegistry {
+  std::mutex mutex;
+  std::vector<FrameArena*> arenas;
+  FrameArenaStats stats;
+};
+
+// Intentionally leaked, worker threads may outlive static destructors.
+FrameArenaRegistry &Registry() {
+  static FrameArenaRegistry *registry = new FrameArenaRegistry();
+  return *registry;
+}
+
+std::atomic<Ui64> g_frame_arena_epoch = ATOMIC_VAR_INIT(0);
+
+}  // namespace
+
+constexpr size_t FrameArena::kDefaultBlockSize;
+
+FrameArena::FrameArena()
+    : epoch_(g_frame_arena_epoch.load(std::memory_order_relaxed))
+    , used_bytes_(0)
+    , reserved_bytes_(0) {
+  FrameArenaRegistry &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.arenas.push_back(this);
+}
+
+FrameArena::~FrameArena() {
+  FrameArenaRegistry &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.arenas.erase(
+    std::remove(registry.arenas.begin(), registry.arenas.end(), this),
+    registry.arenas.end());
+}
+
+FrameArena &FrameArena::ThisThread() {
+  static thread_local FrameArena arena;
+  return arena;
+}
+
+void *FrameArena::Allocate(size_t size, size_t alignment) {
+  if (epoch_.load(std::memory_order_relaxed) !=
+      g_frame_arena_epoch.load(std::memory_order_relaxed)) {
+    Reset();
+  }
+  if (block_idx_ < blocks_.size()) {
+    Block &block = blocks_[block_idx_];
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+    uintptr_t p = (base + offset_ + alignment - 1) &
+      ~static_cast<uintptr_t>(alignment - 1);
+    if (p + size <= base + block.size) {
+      offset_ = static_cast<size_t>(p + size - base);
+      used_bytes_.store(used_before_block_ + offset_, std::memory_order_relaxed);
+      return reinterpret_cast<void*>(p);
+    }
+  }
+  return AllocateSlow(size, alignment);
+}
+
+void *FrameArena::AllocateSlow(size_t size, size_t alignment) {
+  Check(alignment != 0 && (alignment & (alignment - 1)) == 0,
+    "FrameArena alignment must be a power of two");
+  if (block_idx_ < blocks_.size()) {
+    used_before_block_ += offset_;
+    ++block_idx_;
+    offset_ = 0;
+  }
+  size_t required = size + alignment;
+  if (block_idx_ == blocks_.size() || blocks_[block_idx_].size < required) {
+    // Blocks that are too small stay behind the new one and are reused
+    // by the following frames.
+    Block block;
+    block.size = std::max(kDefaultBlockSize, required);
+    block.data.reset(new Ui8[block.size]);
+    reserved_bytes_.store(reserved_bytes_.load(std::memory_order_relaxed) +
+      block.size, std::memory_order_relaxed);
+    blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(block_idx_),
+      std::move(block));
+  }
+  return Allocate(size, alignment);
+}
+
+void FrameArena::Reset() {
+  epoch_.store(g_frame_arena_epoch.load(std::memory_order_relaxed),
+    std::memory_order_relaxed);
+  block_idx_ = 0;
+  offset_ = 0;
+  used_before_block_ = 0;
+  used_bytes_.store(0, std::memory_order_relaxed);
+}
+
+void *FrameAllocBytes(size_t size, size_t alignment) {
+  return FrameArena::ThisThread().Allocate(size, alignment);
+}
+
+void ResetFrameArena() {
+  FrameArenaRegistry &registry = Registry();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    Ui64 epoch = g_frame_arena_epoch.load(std::memory_order_relaxed);
+    Ui64 frame_bytes = 0;
+    Ui64 reserved_bytes = 0;
+    for (FrameArena *arena : registry.arenas) {
+      if (arena->Epoch() == epoch) {
+        frame_bytes += arena->UsedBytes();
+      }
+      reserved_bytes += arena->ReservedBytes();
+    }
+    registry.stats.frame_idx = epoch + 1;
+    registry.stats.last_frame_bytes = frame_bytes;
+    registry.stats.peak_frame_bytes =
+      std::max(registry.stats.peak_frame_bytes, frame_bytes);
+    registry.stats.reserved_bytes = reserved_bytes;
+    g_frame_arena_epoch.store(epoch + 1, std::memory_order_relaxed);
+  }
+  FrameArena::ThisThread().Reset();
+}
+
+FrameArenaStats GetFrameArenaStats() {
+  FrameArenaRegistry &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.stats;
+}
+
+}  // namespace arctic
@@ -0,0 +1,175 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_FRAME_ARENA_H_
+#define ENGINE_FRAME_ARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "engine/arctic_types.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Per-frame memory usage statistics of the frame arena
+struct FrameArenaStats {
+  Ui64 frame_idx = 0;  ///< Number of ShowFrame() calls so far
+  Ui64 last_frame_bytes = 0;  ///< Bytes allocated by all threads during the last frame
+  Ui64 peak_frame_bytes = 0;  ///< Maximum of last_frame_bytes over all frames
+  Ui64 reserved_bytes = 0;  ///< Bytes currently reserved by all thread sub-arenas
+};
+
+/// @brief Linear (bump) allocator for data that lives no longer than a frame
+///
+/// Each thread gets its own sub-arena, so allocation never takes a lock.
+/// All sub-arenas are reset in O(1) by ShowFrame(): the main thread sub-arena
+/// is rewound immediately, worker thread sub-arenas are rewound on their
+/// first allocation in the new frame. Memory blocks are kept between frames,
+/// so at steady state the arena does not touch the heap at all.
+class FrameArena {
+  struct Block {
+    std::unique_ptr<Ui8[]> data;
+    size_t size = 0;
+  };
+
+  std::vector<Block> blocks_;
+  size_t block_idx_ = 0;
+  size_t offset_ = 0;
+  std::atomic<Ui64> epoch_;
+  Ui64 used_before_block_ = 0;
+  std::atomic<Ui64> used_bytes_;
+  std::atomic<Ui64> reserved_bytes_;
+
+  void *AllocateSlow(size_t size, size_t alignment);
+
+ public:
+  static constexpr size_t kDefaultBlockSize = 1 << 20;
+
+  FrameArena();
+  ~FrameArena();
+  FrameArena(const FrameArena&) = delete;
+  FrameArena &operator=(const FrameArena&) = delete;
+
+  /// @brief Returns the sub-arena of the calling thread
+  static FrameArena &ThisThread();
+
+  /// @brief Allocates uninitialized memory valid until the next ShowFrame()
+  /// @param size Size in bytes
+  /// @param alignment Alignment in bytes, must be a power of two
+  void *Allocate(size_t size, size_t alignment);
+
+  /// @brief Rewinds the sub-arena, all memory allocated from it becomes invalid
+  void Reset();
+
+  /// @brief Returns the number of bytes allocated since the last reset
+  Ui64 UsedBytes() const {
+    return used_bytes_.load(std::memory_order_relaxed);
+  }
+
+  /// @brief Returns the epoch (frame index) this sub-arena was last reset at
+  Ui64 Epoch() const {
+    return epoch_.load(std::memory_order_relaxed);
+  }
+
+  /// @brief Returns the number of bytes reserved in memory blocks
+  Ui64 ReservedBytes() const {
+    return reserved_bytes_.load(std::memory_order_relaxed);
+  }
+};
+
+/// @brief Allocates uninitialized memory from the frame arena of the calling thread
+/// @param size Size in bytes
+/// @param alignment Alignment in bytes, must be a power of two
+/// @return Pointer to the memory valid until the next ShowFrame() call
+void *FrameAllocBytes(size_t size, size_t alignment = alignof(std::max_align_t));
+
+/// @brief Allocates an array of value-initialized objects from the frame arena
+/// @param count Number of objects
+/// @return Pointer to the first object, valid until the next ShowFrame() call
+/// @details Destructors are never called, so T must be trivially destructible.
+///  Use FrameVector for non-trivial types.
+template <class T>
+T *FrameAlloc(size_t count) {
+  static_assert(std::is_trivially_destructible<T>::value,
+    "FrameAlloc can only be used with trivially destructible types");
+  T *p = static_cast<T*>(FrameAllocBytes(sizeof(T) * count, alignof(T)));
+  for (size_t i = 0; i < count; ++i) {
+    new (p + i) T();
+  }
+  return p;
+}
+
+/// @brief STL-compatible allocator that takes memory from the frame arena
+/// @details Deallocation is a no-op, memory is reclaimed by ShowFrame().
+///  A container using this allocator must be cleared (or swapped with an
+///  empty one) before the next ShowFrame() call.
+template <class T>
+class FrameAllocator {
+ public:
+  typedef T value_type;
+
+  FrameAllocator() noexcept = default;
+  template <class U>
+  FrameAllocator(const FrameAllocator<U>&) noexcept {  // NOLINT
+  }
+
+  T *allocate(size_t count) {
+    return static_cast<T*>(FrameAllocBytes(sizeof(T) * count, alignof(T)));
+  }
+
+  void deallocate(T*, size_t) noexcept {
+  }
+
+  template <class U>
+  bool operator==(const FrameAllocator<U>&) const noexcept {
+    return true;
+  }
+
+  template <class U>
+  bool operator!=(const FrameAllocator<U>&) const noexcept {
+    return false;
+  }
+};
+
+/// @brief std::vector with storage in the frame arena
+template <class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+/// @brief Resets the frame arenas of all threads in O(1)
+/// @note Called automatically by ShowFrame(), after the frame is presented.
+void ResetFrameArena();
+
+/// @brief Returns frame arena usage statistics
+FrameArenaStats GetFrameArenaStats();
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_FRAME_ARENA_H_
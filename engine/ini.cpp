@@ -20,15 +20,99 @@
 // FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
 // AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
-// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
-// IN THE SOFTWARE.
 
 #include "ini.h"
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 
 namespace arctic {
 
+namespace {
+
+bool IsIniSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void TrimRange(const char **begin, const char **end) {
+  while (*begin < *end && IsIniSpace(**begin)) {
+    ++*begin;
+  }
+  while (*end > *begin && IsIniSpace((*end)[-1])) {
+    --*end;
+  }
+}
+
+bool IsIniWord(const std::string &text, const char *word) {
+  return StrCaseCmp(text.c_str(), word) == 0;
+}
+
+// Parses the whole text in one pass, accepting what stream parsing accepts
+bool ParseIniInt(const std::string &text, Si32 *out_value) {
+  const char *begin = text.c_str();
+  char *end = nullptr;
+  errno = 0;
+  long long value = std::strtoll(begin, &end, 10);  // NOLINT
+  if (end == begin || end != begin + text.size() || errno == ERANGE ||
+      value < std::numeric_limits<Si32>::min() ||
+      value > std::numeric_limits<Si32>::max()) {
+    return false;
+  }
+  *out_value = static_cast<Si32>(value);
+  return true;
+}
+
+bool ParseIniFloat(const std::string &text, float *out_value) {
+  const char *begin = text.c_str();
+  // Stream parsing takes neither hexadecimal floats nor inf and nan
+  for (const char *p = begin; *p; ++p) {
+    if (!IsIniSpace(*p) && !std::isdigit(static_cast<unsigned char>(*p)) &&
+        !std::strchr("+-.eE", *p)) {
+      return false;
+    }
+  }
+  char *end = nullptr;
+  errno = 0;
+  float value = std::strtof(begin, &end);
+  if (end == begin || end != begin + text.size() ||
+      (errno == ERANGE && std::fabs(value) == HUGE_VALF)) {
+    return false;
+  }
+  *out_value = value;
+  return true;
+}
+
+}  // namespace
+
+// IniValue implementation
+
+void IniValue::SetText(const std::string &in_text) {
+  text = in_text;
+  failed = 0;
+  if (IsIniWord(text, "true") || IsIniWord(text, "yes") ||
+      IsIniWord(text, "on") || text == "1") {
+    bool_value = true;
+  } else if (IsIniWord(text, "false") || IsIniWord(text, "no") ||
+      IsIniWord(text, "off") || text == "0") {
+    bool_value = false;
+  } else {
+    bool_value = false;
+    failed |= kIniFailedBool;
+  }
+  if (!ParseIniInt(text, &int_value)) {
+    int_value = 0;
+    failed |= kIniFailedInt;
+  }
+  if (!ParseIniFloat(text, &float_value)) {
+    float_value = 0.0f;
+    failed |= kIniFailedFloat;
+  }
+}
+
 // IniSection implementation
 
 IniSection::IniSection(const std::string &name) : name_(name) {
@@ -46,7 +130,16 @@ Ui64 IniSection::Size() const {
 }
 
 void IniSection::SetValue(const std::string &key, const std::string &value) {
-  values_[key] = value;
+  // The entry stays in place so that resolved keys see the new value
+  values_[key].SetText(value);
+}
+
+IniKey IniSection::GetKey(const std::string &key) {
+  auto it = values_.find(key);
+  if (it == values_.end()) {
+    return IniKey();
+  }
+  return IniKey(this, &it->second);
 }
 
 const std::string IniSection::GetString(const std::string &key, const std::string &default_value) const {
@@ -54,7 +147,7 @@ const std::string IniSection::GetString(const std::string &key, const std::strin
   if (it == values_.end()) {
     return default_value;
   }
-  return it->second;
+  return it->second.text;
 }
 
 bool IniSection::GetBool(const std::string &key, bool default_value) const {
@@ -62,17 +155,7 @@ bool IniSection::GetBool(const std::string &key, bool default_value) const {
   if (it == values_.end()) {
     return default_value;
   }
-  
-  std::string value = it->second;
-  std::transform(value.begin(), value.end(), value.begin(), ::tolower);
-  
-  if (value == "true" || value == "yes" || value == "on" || value == "1") {
-    return true;
-  } else if (value == "false" || value == "no" || value == "off" || value == "0") {
-    return false;
-  }
-  
-  return default_value;
+  return it->second.GetBool(default_value);
 }
 
 Si32 IniSection::GetInt(const std::string &key, Si32 default_value) const {
@@ -87,12 +170,28 @@ bool IniSection::HasKey(const std::string &key) const {
   return values_.find(key) != values_.end();
 }
 
+std::vector<const std::pair<const std::string, IniValue>*>
+    IniSection::GetSortedValues() const {
+  std::vector<const std::pair<const std::string, IniValue>*> sorted;
+  sorted.reserve(values_.size());
+  for (const auto &pair : values_) {
+    sorted.push_back(&pair);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+    [](const std::pair<const std::string, IniValue> *a,
+        const std::pair<const std::string, IniValue> *b) {
+      return a->first < b->first;
+    });
+  return sorted;
+}
+
 std::vector<std::string> IniSection::GetKeys() const {
   std::vector<std::string> keys;
   keys.reserve(values_.size());
   for (const auto &pair : values_) {
     keys.push_back(pair.first);
   }
+  std::sort(keys.begin(), keys.end());
   return keys;
 }
 
@@ -104,19 +203,14 @@ std::ostream& operator<<(std::ostream& os, const IniSection &section) {
   if (!section.name_.empty()) {
     os << "[" << section.name_ << "]" << std::endl;
   }
-  for (const auto &pair : section.values_) {
-    os << pair.first << "=" << pair.second << std::endl;
+  for (const auto *pair : section.GetSortedValues()) {
+    os << pair->first << "=" << pair->second.text << std::endl;
   }
   return os;
 }
 
 std::ofstream& operator<<(std::ofstream& os, const IniSection &section) {
-  if (!section.name_.empty()) {
-    os << "[" << section.name_ << "]" << std::endl;
-  }
-  for (const auto &pair : section.values_) {
-    os << pair.first << "=" << pair.second << std::endl;
-  }
+  static_cast<std::ostream&>(os) << section;
   return os;
 }
 
@@ -138,34 +232,31 @@ bool IniFile::LoadFile(const std::string &filename) {
   filename_ = filename;
   type_ = kIniSourceFile;
   
-  std::ifstream file(filename);
+  std::ifstream file(filename, std::ios_base::in | std::ios_base::binary);
   if (!file.is_open()) {
     error_description_ = "Cannot open file: " + filename;
     return false;
   }
   
-  lines_.clear();
-  std::string line;
-  while (std::getline(file, line)) {
-    lines_.push_back(line);
+  // The whole file is read into one buffer and parsed in place
+  std::string content;
+  file.seekg(0, std::ios_base::end);
+  std::streamoff size = file.tellg();
+  file.seekg(0, std::ios_base::beg);
+  if (size > 0) {
+    content.resize(static_cast<size_t>(size));
+    file.read(&content[0], size);
+    content.resize(static_cast<size_t>(file.gcount()));
   }
   file.close();
   
-  return ParseContent();
+  return ParseContent(content.data(), content.data() + content.size());
 }
 
 bool IniFile::LoadString(const std::string &input) {
   filename_.clear();
   type_ = kIniSourcePure;
-  
-  lines_.clear();
-  std::stringstream ss(input);
-  std::string line;
-  while (std::getline(ss, line)) {
-    lines_.push_back(line);
-  }
-  
-  return ParseContent();
+  return ParseContent(input.data(), input.data() + input.size());
 }
 
 IniSection *IniFile::GetSection(const std::string &section_name) const {
@@ -188,16 +279,31 @@ Ui64 IniFile::SectionCount() const {
   return count;
 }
 
+std::vector<const std::pair<const std::string, IniSection*>*>
+    IniFile::GetSortedSections() const {
+  std::vector<const std::pair<const std::string, IniSection*>*> sorted;
+  sorted.reserve(sections_.size());
+  for (const auto &pair : sections_) {
+    sorted.push_back(&pair);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+    [](const std::pair<const std::string, IniSection*> *a,
+        const std::pair<const std::string, IniSection*> *b) {
+      return a->first < b->first;
+    });
+  return sorted;
+}
+
 std::vector<std::string> IniFile::GetSectionNames() const {
   std::vector<std::string> names;
-  names.reserve(sections_.size());
+  names.reserve(sections_.size() + 1);
   
   if (global_section_ && global_section_->Size() > 0) {
     names.push_back("");  // Empty name for global section
   }
   
-  for (const auto &pair : sections_) {
-    names.push_back(pair.first);
+  for (const auto *pair : GetSortedSections()) {
+    names.push_back(pair->first);
   }
   return names;
 }
@@ -267,8 +373,8 @@ bool IniFile::SaveFile(const std::string &filename) const {
   }
   
   // Write named sections
-  for (const auto &pair : sections_) {
-    file << *pair.second << std::endl;
+  for (const auto *pair : GetSortedSections()) {
+    file << *pair->second << std::endl;
   }
   
   file.close();
@@ -307,6 +413,14 @@ float IniFile::GetFloat(const std::string &section_name, const std::string &key,
   return section->GetFloat(key, default_value);
 }
 
+IniKey IniFile::GetKey(const std::string &section_name, const std::string &key) const {
+  IniSection *section = GetSection(section_name);
+  if (section == nullptr) {
+    return IniKey();
+  }
+  return section->GetKey(key);
+}
+
 IniSection *IniFile::operator[](const std::string &section_name) const {
   return GetSection(section_name);
 }
@@ -315,7 +429,7 @@ std::string IniFile::GetErrorDescription() const {
   return error_description_;
 }
 
-bool IniFile::ParseContent() {
+bool IniFile::ParseContent(const char *begin, const char *end) {
   // Clear existing data
   for (auto &pair : sections_) {
     delete pair.second;
@@ -328,23 +442,37 @@ bool IniFile::ParseContent() {
   }
   
   IniSection *current_section = nullptr;
+  std::string key;
+  std::string value;
   
-  for (const std::string &line : lines_) {
-    std::string trimmed = Trim(line);
+  while (begin < end) {
+    const char *line_end = static_cast<const char*>(
+      std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+    if (!line_end) {
+      line_end = end;
+    }
+    const char *first = begin;
+    const char *last = line_end;
+    begin = line_end + (line_end < end ? 1 : 0);
+    TrimRange(&first, &last);
     
     // Skip empty lines and comments
-    if (trimmed.empty() || IsComment(trimmed)) {
+    if (first == last || *first == ';' || *first == '#') {
       continue;
     }
     
     // Check if it's a section header
-    if (trimmed.front() == '[' && trimmed.back() == ']') {
-      std::string section_name = ExtractSectionName(trimmed);
-      if (section_name.empty() && trimmed.size() > 2) {
-        error_description_ = "Invalid section header: " + trimmed;
+    if (*first == '[' && last[-1] == ']' && last - first >= 2) {
+      const char *name_first = first + 1;
+      const char *name_last = last - 1;
+      TrimRange(&name_first, &name_last);
+      if (name_first == name_last && last - first > 2) {
+        error_description_ = "Invalid section header: " +
+          std::string(first, last);
         return false;
       }
       
+      std::string section_name(name_first, name_last);
       current_section = AddSection(section_name);
       if (!current_section) {
         current_section = GetSection(section_name);  // Section already exists, use it
@@ -353,67 +481,41 @@ bool IniFile::ParseContent() {
     }
     
     // Parse key-value pair
-    std::string key, value;
-    if (ParseKeyValue(trimmed, key, value)) {
-      if (!current_section) {
-        // Create global section if we don't have one
-        current_section = AddSection("");
-      }
-      current_section->SetValue(key, value);
-    } else {
-      error_description_ = "Invalid key-value pair: " + trimmed;
+    const char *separator = static_cast<const char*>(
+      std::memchr(first, '=', static_cast<size_t>(last - first)));
+    if (!separator) {
+      separator = static_cast<const char*>(
+        std::memchr(first, ':', static_cast<size_t>(last - first)));
+    }
+    const char *key_first = first;
+    const char *key_last = separator ? separator : first;
+    TrimRange(&key_first, &key_last);
+    if (key_first == key_last) {
+      error_description_ = "Invalid key-value pair: " +
+        std::string(first, last);
       return false;
     }
-  }
-  
-  return true;
-}
-
-std::string IniFile::Trim(const std::string &str) const {
-  size_t start = str.find_first_not_of(" \t\r\n");
-  if (start == std::string::npos) {
-    return "";
-  }
-  
-  size_t end = str.find_last_not_of(" \t\r\n");
-  return str.substr(start, end - start + 1);
-}
-
-bool IniFile::IsComment(const std::string &line) const {
-  return !line.empty() && (line[0] == ';' || line[0] == '#');
-}
-
-std::string IniFile::ExtractSectionName(const std::string &line) const {
-  if (line.size() < 2 || line.front() != '[' || line.back() != ']') {
-    return "";
-  }
-  
-  std::string section_name = line.substr(1, line.size() - 2);
-  return Trim(section_name);
-}
-
-bool IniFile::ParseKeyValue(const std::string &line, std::string &key, std::string &value) const {
-  size_t pos = line.find('=');
-  if (pos == std::string::npos) {
-    pos = line.find(':');
-  }
-  
-  if (pos == std::string::npos) {
-    return false;
-  }
-  
-  key = Trim(line.substr(0, pos));
-  value = Trim(line.substr(pos + 1));
-  
-  // Remove quotes if present
-  if (value.size() >= 2) {
-    if ((value.front() == '"' && value.back() == '"') ||
-        (value.front() == '\'' && value.back() == '\'')) {
-      value = value.substr(1, value.size() - 2);
+    const char *value_first = separator + 1;
+    const char *value_last = last;
+    TrimRange(&value_first, &value_last);
+    // Remove quotes if present
+    if (value_last - value_first >= 2 &&
+        ((*value_first == '"' && value_last[-1] == '"') ||
+         (*value_first == '\'' && value_last[-1] == '\''))) {
+      ++value_first;
+      --value_last;
     }
+    
+    if (!current_section) {
+      // Create global section if we don't have one
+      current_section = AddSection("");
+    }
+    key.assign(key_first, key_last);
+    value.assign(value_first, value_last);
+    current_section->SetValue(key, value);
   }
   
-  return !key.empty();
+  return true;
 }
 
 }  // namespace arctic
@@ -23,8 +23,8 @@
 #ifndef ENGINE_INI_H_
 #define ENGINE_INI_H_
 
-#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <fstream>
@@ -36,11 +36,130 @@ namespace arctic {
 /// @addtogroup global_utility
 /// @{
 
+/// @brief Converts the whole text of a value with stream parsing.
+/// @return False if the text is not a complete value of the type.
+template<typename T>
+bool ParseIniText(const std::string &text, T *out_value) {
+  std::stringstream ss(text);
+  ss >> *out_value;
+  return !ss.fail() && ss.peek() == std::iostream::traits_type::eof();
+}
+
+/// @brief A value of an INI key with its typed conversions.
+///
+/// The conversions are done once when the text is set, so reading a const
+/// value from several threads is safe.
+struct IniValue {
+  std::string text;
+  /// Conversions that failed, kIniFailed* flags
+  Ui8 failed = 0;
+  bool bool_value = false;
+  Si32 int_value = 0;
+  float float_value = 0.0f;
+
+  enum FailedFlags {
+    kIniFailedBool = 1,
+    kIniFailedInt = 2,
+    kIniFailedFloat = 4
+  };
+
+  /// @brief Sets the text and converts it to each of the types.
+  void SetText(const std::string &in_text);
+  /// @brief Gets the boolean value or the default value.
+  bool GetBool(bool default_value) const {
+    return (failed & kIniFailedBool) ? default_value : bool_value;
+  }
+  /// @brief Gets the integer value or the default value.
+  Si32 GetInt(Si32 default_value) const {
+    return (failed & kIniFailedInt) ? default_value : int_value;
+  }
+  /// @brief Gets the float value or the default value.
+  float GetFloat(float default_value) const {
+    return (failed & kIniFailedFloat) ? default_value : float_value;
+  }
+};
+
+class IniSection;
+
+/// @brief A pre-resolved section and key.
+///
+/// Reading through a key skips the name lookups and the conversion. Keys
+/// stay valid while values are changed with SetValue and until their
+/// section is removed or the file is loaded again.
+/// Example:
+/// @code
+///   IniKey aggression = ini.GetKey("ai", "aggression");
+///   ...
+///   float value = aggression.GetFloat(0.5f);  // no lookup, no allocation
+/// @endcode
+class IniKey {
+ public:
+  IniKey() = default;
+  IniKey(IniSection *section, IniValue *value)
+      : section_(section)
+      , value_(value) {
+  }
+
+  /// @brief Checks if the key was found when resolved.
+  bool IsValid() const {
+    return value_ != nullptr;
+  }
+
+  /// @brief Gets the section of the key, nullptr if not found.
+  IniSection *GetSection() const {
+    return section_;
+  }
+
+  /// @brief Gets the string value or the default value if not found.
+  std::string GetString(const std::string &default_value = "") const {
+    return value_ ? value_->text : default_value;
+  }
+
+  /// @brief Gets the boolean value or the default value.
+  bool GetBool(bool default_value = false) const {
+    return value_ ? value_->GetBool(default_value) : default_value;
+  }
+
+  /// @brief Gets the integer value or the default value.
+  Si32 GetInt(Si32 default_value = 0) const {
+    return value_ ? value_->GetInt(default_value) : default_value;
+  }
+
+  /// @brief Gets the float value or the default value.
+  float GetFloat(float default_value = 0.0f) const {
+    return value_ ? value_->GetFloat(default_value) : default_value;
+  }
+
+ private:
+  IniSection *section_ = nullptr;
+  IniValue *value_ = nullptr;
+};
+
 /// @brief Represents a section in an INI file.
+///
+/// Keys are hashed, each name is stored once in the hash table and the
+/// typed values are converted when the value is set.
 class IniSection {
  private:
   std::string name_;
-  std::map<std::string, std::string> values_;
+  std::unordered_map<std::string, IniValue> values_;
+
+  std::vector<const std::pair<const std::string, IniValue>*>
+    GetSortedValues() const;
+
+  template<typename T>
+  static T ConvertValue(const IniValue &value, T default_value) {
+    T res;
+    return ParseIniText(value.text, &res) ? res : default_value;
+  }
+
+  static Si32 ConvertValue(const IniValue &value, Si32 default_value) {
+    return value.GetInt(default_value);
+  }
+
+  static float ConvertValue(const IniValue &value, float default_value) {
+    return value.GetFloat(default_value);
+  }
 
  public:
   /// @brief Constructs an IniSection with the given name.
@@ -63,6 +182,11 @@ class IniSection {
   /// @param value The value to be set.
   void SetValue(const std::string &key, const std::string &value);
 
+  /// @brief Resolves a key for repeated reads.
+  /// @param key The key name.
+  /// @return The key, not valid if the key is not found.
+  IniKey GetKey(const std::string &key);
+
   /// @brief Gets a value from the section by key and converts it to the specified type.
   /// @tparam T The type to convert the value to.
   /// @param key The key name.
@@ -74,17 +198,7 @@ class IniSection {
     if (it == values_.end()) {
       return default_value;
     }
-    
-    T res;
-    std::stringstream ss(it->second);
-    ss >> res;
-    if (ss.fail()) {
-      return default_value;
-    }
-    if (ss.peek() == std::iostream::traits_type::eof()) {
-      return res;
-    }
-    return default_value;
+    return ConvertValue(it->second, default_value);
   }
 
   /// @brief Gets a string value from the section by key.
@@ -117,7 +231,7 @@ class IniSection {
   bool HasKey(const std::string &key) const;
 
   /// @brief Gets all keys in the section.
-  /// @return A vector of all key names.
+  /// @return A vector of all key names, sorted.
   std::vector<std::string> GetKeys() const;
 
   /// @brief Accesses a value in the section by key.
@@ -167,7 +281,7 @@ class IniFile {
   Ui64 SectionCount() const;
 
   /// @brief Gets all section names.
-  /// @return A vector of section names.
+  /// @return A vector of section names, sorted.
   std::vector<std::string> GetSectionNames() const;
 
   /// @brief Gets the filename of the INI file.
@@ -237,6 +351,12 @@ class IniFile {
   /// @return The float value or the default value.
   float GetFloat(const std::string &section_name, const std::string &key, float default_value = 0.0f) const;
 
+  /// @brief Resolves a section and key for repeated reads.
+  /// @param section_name The name of the section.
+  /// @param key The key name.
+  /// @return The key, not valid if the section or the key is not found.
+  IniKey GetKey(const std::string &section_name, const std::string &key) const;
+
   /// @brief Accesses a section in the file by name.
   /// @param section_name The name of the section.
   /// @return A pointer to the IniSection, or nullptr if not found.
@@ -247,37 +367,20 @@ class IniFile {
   std::string GetErrorDescription() const;
 
  protected:
-  /// @brief Parses the content of the INI.
+  /// @brief Parses the content of the INI in place, copying only the
+  /// section names, keys and values.
+  /// @param begin The first character of the content.
+  /// @param end The character after the last one.
   /// @return True if the content was parsed successfully, false otherwise.
-  bool ParseContent();
-
-  /// @brief Trims whitespace from both ends of a string.
-  /// @param str The string to trim.
-  /// @return The trimmed string.
-  std::string Trim(const std::string &str) const;
-
-  /// @brief Checks if a line is a comment.
-  /// @param line The line to check.
-  /// @return True if the line is a comment, false otherwise.
-  bool IsComment(const std::string &line) const;
-
-  /// @brief Extracts section name from a section header line.
-  /// @param line The line containing the section header.
-  /// @return The section name, or empty string if invalid.
-  std::string ExtractSectionName(const std::string &line) const;
-
-  /// @brief Parses a key-value pair from a line.
-  /// @param line The line to parse.
-  /// @param key Output parameter for the key.
-  /// @param value Output parameter for the value.
-  /// @return True if parsing was successful, false otherwise.
-  bool ParseKeyValue(const std::string &line, std::string &key, std::string &value) const;
+  bool ParseContent(const char *begin, const char *end);
 
  private:
+  std::vector<const std::pair<const std::string, IniSection*>*>
+    GetSortedSections() const;
+
   std::string filename_;
   IniSourceType type_ = kIniSourcePure;
-  std::vector<std::string> lines_;
-  std::map<std::string, IniSection*> sections_;
+  std::unordered_map<std::string, IniSection*> sections_;
   IniSection *global_section_;  // For key-value pairs before any section
   std::string error_description_;
 };
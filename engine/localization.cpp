@@ -25,10 +25,15 @@
 
 #include "engine/localization.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 #include "engine/csv.h"
+#include "engine/easy_files.h"
+#include "engine/mapped_file.h"
 
 namespace arctic {
 
@@ -62,6 +67,39 @@ std::string LocValue::AsString() const {
   return "";
 }
 
+// Writes the decimal digits of n, returns the length
+static size_t FormatLocInt(Si64 n, char* out) {
+  char digits[24];
+  size_t count = 0;
+  Ui64 value = n < 0 ? 0 - static_cast<Ui64>(n) : static_cast<Ui64>(n);
+  do {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+  size_t size = 0;
+  if (n < 0) out[size++] = '-';
+  while (count) out[size++] = digits[--count];
+  return size;
+}
+
+// Writes an int or double value the way std::ostream does, returns the length
+static size_t FormatLocNumber(const LocValue& value, char (&out)[32]) {
+  if (value.type == LocValue::kDouble) {
+    int size = std::snprintf(out, sizeof(out), "%g", value.double_value);
+    return size > 0 ? static_cast<size_t>(size) : 0;
+  }
+  return FormatLocInt(value.int_value, out);
+}
+
+void LocValue::AppendTo(std::string* out) const {
+  if (type == kString) {
+    out->append(string_value);
+    return;
+  }
+  char buffer[32];
+  out->append(buffer, FormatLocNumber(*this, buffer));
+}
+
 // ============================================================================
 // ICU MessageFormat Parser - Recursive Descent
 // ============================================================================
@@ -69,12 +107,10 @@ std::string LocValue::AsString() const {
 // Parser state
 struct ParserState {
   const std::string& input;
-  const LocArgs& args;
-  const std::string& locale;
   size_t pos;
   
-  ParserState(const std::string& in, const LocArgs& a, const std::string& loc)
-      : input(in), args(a), locale(loc), pos(0) {}
+  explicit ParserState(const std::string& in)
+      : input(in), pos(0) {}
   
   bool AtEnd() const { return pos >= input.size(); }
   char Peek() const { return AtEnd() ? '\0' : input[pos]; }
@@ -86,69 +122,90 @@ struct ParserState {
       Advance();
     }
   }
-  
-  const LocValue* FindArg(const std::string& name) const {
-    for (size_t i = 0; i < args.size(); ++i) {
-      if (args[i].first == name) {
-        return &args[i].second;
-      }
-    }
-    return nullptr;
-  }
 };
 
-// Forward declarations
-static std::string ParseMessage(ParserState& state);
-static std::string ParseArgument(ParserState& state);
+// Plural categories, in the order of kPluralCategoryNames
+enum PluralCategory {
+  kPluralOne = 0,
+  kPluralTwo,
+  kPluralFew,
+  kPluralMany,
+  kPluralOther,
+  kPluralCategoryCount
+};
+
+static const char* const kPluralCategoryNames[kPluralCategoryCount] = {
+  "one", "two", "few", "many", "other"
+};
+
+// Plural rule families, selected once per Format call
+enum PluralRules {
+  kPluralRulesDefault,
+  kPluralRulesEnglish,
+  kPluralRulesEastSlavic,
+  kPluralRulesPolish,
+  kPluralRulesCzech
+};
+
+static PluralRules GetPluralRules(const std::string& locale) {
+  if (locale == "en") return kPluralRulesEnglish;
+  // Russian, Ukrainian, Belarusian
+  if (locale == "ru" || locale == "uk" || locale == "be") {
+    return kPluralRulesEastSlavic;
+  }
+  if (locale == "pl") return kPluralRulesPolish;
+  if (locale == "cs" || locale == "sk") return kPluralRulesCzech;
+  return kPluralRulesDefault;
+}
 
 // Get plural category for a number based on locale
-static std::string GetPluralCategory(Si64 n, const std::string& locale) {
+static PluralCategory GetPluralCategory(Si64 n, PluralRules rules) {
   Si64 abs_n = n < 0 ? -n : n;
   Si64 mod10 = abs_n % 10;
   Si64 mod100 = abs_n % 100;
   
   // Russian, Ukrainian, Belarusian
-  if (locale == "ru" || locale == "uk" || locale == "be") {
-    if (mod10 == 1 && mod100 != 11) return "one";
-    if (mod10 >= 2 && mod10 <= 4 && (mod100 < 12 || mod100 > 14)) return "few";
-    return "many";
+  if (rules == kPluralRulesEastSlavic) {
+    if (mod10 == 1 && mod100 != 11) return kPluralOne;
+    if (mod10 >= 2 && mod10 <= 4 && (mod100 < 12 || mod100 > 14)) return kPluralFew;
+    return kPluralMany;
   }
   
   // Polish
-  if (locale == "pl") {
-    if (n == 1) return "one";
-    if (mod10 >= 2 && mod10 <= 4 && (mod100 < 12 || mod100 > 14)) return "few";
-    return "many";
+  if (rules == kPluralRulesPolish) {
+    if (n == 1) return kPluralOne;
+    if (mod10 >= 2 && mod10 <= 4 && (mod100 < 12 || mod100 > 14)) return kPluralFew;
+    return kPluralMany;
   }
   
   // Czech, Slovak
-  if (locale == "cs" || locale == "sk") {
-    if (n == 1) return "one";
-    if (n >= 2 && n <= 4) return "few";
-    return "other";
+  if (rules == kPluralRulesCzech) {
+    if (n == 1) return kPluralOne;
+    if (n >= 2 && n <= 4) return kPluralFew;
+    return kPluralOther;
   }
   
   // German, English, Spanish, Italian, Portuguese, etc. (simple plural)
-  if (abs_n == 1) return "one";
-  return "other";
+  if (abs_n == 1) return kPluralOne;
+  return kPluralOther;
 }
 
 // Get ordinal category for a number based on locale
-static std::string GetOrdinalCategory(Si64 n, const std::string& locale) {
+static PluralCategory GetOrdinalCategory(Si64 n, PluralRules rules) {
   Si64 abs_n = n < 0 ? -n : n;
   Si64 mod10 = abs_n % 10;
   Si64 mod100 = abs_n % 100;
   
   // English ordinals
-  if (locale == "en") {
-    if (mod10 == 1 && mod100 != 11) return "one";
-    if (mod10 == 2 && mod100 != 12) return "two";
-    if (mod10 == 3 && mod100 != 13) return "few";
-    return "other";
+  if (rules == kPluralRulesEnglish) {
+    if (mod10 == 1 && mod100 != 11) return kPluralOne;
+    if (mod10 == 2 && mod100 != 12) return kPluralTwo;
+    if (mod10 == 3 && mod100 != 13) return kPluralFew;
+    return kPluralOther;
   }
   
   // Most languages don't have special ordinal forms
-  return "other";
+  return kPluralOther;
 }
 
 // Parse identifier (variable name or keyword)
@@ -278,116 +335,132 @@ static std::vector<PluralOption> ParsePluralOptions(ParserState& state) {
   return options;
 }
 
-// Process plural argument
-static std::string ProcessPlural(ParserState& state, const std::string& var_name,
-                                  const std::string& options_str, bool is_ordinal) {
-  const LocValue* value = state.FindArg(var_name);
-  if (!value) return "";
-  
-  Si64 n = value->AsInt();
-  
-  // Parse options from the options string
-  ParserState opt_state(options_str, state.args, state.locale);
+// ============================================================================
+// Pattern compiler, mirrors the parser structure: option texts are extracted
+// the same way and compiled recursively
+// ============================================================================
+
+// Compiles a message until the end of the input or an unmatched '}'.
+static void CompileMessage(const std::string& input, LocMessage* message,
+                           Ui32* out_begin, Ui32* out_end);
+
+static Ui32 AddText(LocMessage* message, const std::string& text) {
+  Ui32 offset = static_cast<Ui32>(message->text.size());
+  message->text += text;
+  return offset;
+}
+
+static LocMessage::Op MakeOp(LocMessage::OpKind kind, LocMessage* message,
+                             const std::string& text) {
+  LocMessage::Op op;
+  op.kind = kind;
+  op.offset = AddText(message, text);
+  op.size = static_cast<Ui32>(text.size());
+  op.first_branch = 0;
+  op.branch_count = 0;
+  return op;
+}
+
+static LocMessage::Branch MakeBranch(LocMessage::BranchKind kind,
+                                     Si64 value, LocMessage* message,
+                                     const PluralOption& option) {
+  LocMessage::Branch branch;
+  branch.kind = kind;
+  branch.is_empty = option.content.empty() ? 1 : 0;
+  branch.value = value;
+  branch.key_offset = 0;
+  branch.key_size = 0;
+  CompileMessage(option.content, message, &branch.op_begin, &branch.op_end);
+  return branch;
+}
+
+// Compiles plural and selectordinal options
+static LocMessage::Op CompilePlural(LocMessage* message,
+                                    const std::string& var_name,
+                                    const std::string& options_str,
+                                    bool is_ordinal) {
+  ParserState opt_state(options_str);
   std::vector<PluralOption> options = ParsePluralOptions(opt_state);
   
-  // First, check for exact match
-  for (size_t i = 0; i < options.size(); ++i) {
-    if (options[i].is_exact && options[i].exact_value == n) {
-      // Process the content, replacing # with the number
-      std::string content = options[i].content;
-      ParserState content_state(content, state.args, state.locale);
-      std::string result = ParseMessage(content_state);
-      
-      // Replace # with the number
-      std::ostringstream num_ss;
-      num_ss << n;
-      std::string num_str = num_ss.str();
-      
-      size_t hash_pos = 0;
-      while ((hash_pos = result.find('#', hash_pos)) != std::string::npos) {
-        result.replace(hash_pos, 1, num_str);
-        hash_pos += num_str.size();
-      }
-      return result;
-    }
+  // Exact matches are tried in order, the last option of a category wins
+  std::vector<LocMessage::Branch> branches;
+  Si32 category_option[kPluralCategoryCount];
+  for (Si32 c = 0; c < kPluralCategoryCount; ++c) {
+    category_option[c] = -1;
   }
-  
-  // Get the plural/ordinal category
-  std::string category = is_ordinal 
-      ? GetOrdinalCategory(n, state.locale)
-      : GetPluralCategory(n, state.locale);
-  
-  // Find matching category
-  std::string selected_content;
-  std::string other_content;
-  
   for (size_t i = 0; i < options.size(); ++i) {
-    if (!options[i].is_exact) {
-      if (options[i].key == category) {
-        selected_content = options[i].content;
-      }
-      if (options[i].key == "other") {
-        other_content = options[i].content;
+    if (options[i].is_exact) {
+      branches.push_back(MakeBranch(LocMessage::kBranchExact,
+                                    options[i].exact_value, message, options[i]));
+      continue;
+    }
+    for (Si32 c = 0; c < kPluralCategoryCount; ++c) {
+      if (options[i].key == kPluralCategoryNames[c]) {
+        category_option[c] = static_cast<Si32>(i);
       }
     }
   }
-  
-  // Use category match or fall back to "other"
-  std::string content = selected_content.empty() ? other_content : selected_content;
-  
-  // Process the content
-  ParserState content_state(content, state.args, state.locale);
-  std::string result = ParseMessage(content_state);
-  
-  // Replace # with the number
-  std::ostringstream num_ss;
-  num_ss << n;
-  std::string num_str = num_ss.str();
-  
-  size_t hash_pos = 0;
-  while ((hash_pos = result.find('#', hash_pos)) != std::string::npos) {
-    result.replace(hash_pos, 1, num_str);
-    hash_pos += num_str.size();
+  for (Si32 c = 0; c < kPluralCategoryCount; ++c) {
+    if (category_option[c] >= 0) {
+      branches.push_back(MakeBranch(LocMessage::kBranchCategory, c, message,
+                                    options[static_cast<size_t>(category_option[c])]));
+    }
   }
   
-  return result;
+  LocMessage::Op op = MakeOp(is_ordinal ? LocMessage::kOpOrdinal
+                             : LocMessage::kOpPlural, message, var_name);
+  op.first_branch = static_cast<Ui32>(message->branches.size());
+  op.branch_count = static_cast<Ui32>(branches.size());
+  message->branches.insert(message->branches.end(),
+                           branches.begin(), branches.end());
+  return op;
 }
 
-// Process select argument
-static std::string ProcessSelect(ParserState& state, const std::string& var_name,
-                                  const std::string& options_str) {
-  const LocValue* value = state.FindArg(var_name);
-  if (!value) return "";
-  
-  std::string select_value = value->AsString();
-  
-  // Parse options
-  ParserState opt_state(options_str, state.args, state.locale);
+// Compiles select options
+static LocMessage::Op CompileSelect(LocMessage* message,
+                                    const std::string& var_name,
+                                    const std::string& options_str) {
+  ParserState opt_state(options_str);
   std::vector<PluralOption> options = ParsePluralOptions(opt_state);
   
-  // Find matching option
-  std::string selected_content;
-  std::string other_content;
-  
+  // The last option with a given key wins
+  std::vector<LocMessage::Branch> branches;
   for (size_t i = 0; i < options.size(); ++i) {
-    if (options[i].key == select_value) {
-      selected_content = options[i].content;
-    }
-    if (options[i].key == "other") {
-      other_content = options[i].content;
+    bool is_overridden = false;
+    for (size_t j = i + 1; j < options.size(); ++j) {
+      is_overridden = is_overridden || options[j].key == options[i].key;
     }
+    if (is_overridden) continue;
+    LocMessage::Branch branch = MakeBranch(LocMessage::kBranchKey, 0,
+                                           message, options[i]);
+    branch.key_offset = AddText(message, options[i].key);
+    branch.key_size = static_cast<Ui32>(options[i].key.size());
+    branches.push_back(branch);
   }
   
-  std::string content = selected_content.empty() ? other_content : selected_content;
-  
-  // Process the content recursively
-  ParserState content_state(content, state.args, state.locale);
-  return ParseMessage(content_state);
+  LocMessage::Op op = MakeOp(LocMessage::kOpSelect, message, var_name);
+  op.first_branch = static_cast<Ui32>(message->branches.size());
+  op.branch_count = static_cast<Ui32>(branches.size());
+  message->branches.insert(message->branches.end(),
+                           branches.begin(), branches.end());
+  return op;
 }
 
-// Parse an argument expression: {name} or {name, type, options}
-static std::string ParseArgument(ParserState& state) {
-  if (state.Peek() != '{') return "";
+// Skips to the brace closing the current argument
+static void SkipArgument(ParserState& state) {
+  int depth = 1;
+  while (!state.AtEnd() && depth > 0) {
+    if (state.Peek() == '{') depth++;
+    else if (state.Peek() == '}') depth--;
+    state.Advance();
+  }
+}
+
+// Compiles an argument expression: {name} or {name, type, options}.
+// Adds nothing for expressions that format to an empty string.
+static void CompileArgument(ParserState& state, LocMessage* message,
+                            std::vector<LocMessage::Op>* ops) {
+  if (state.Peek() != '{') return;
   state.Advance(); // skip '{'
   
   state.SkipWhitespace();
@@ -400,23 +473,13 @@ static std::string ParseArgument(ParserState& state) {
   // Check if this is a simple substitution or has type/options
   if (state.Peek() == '}') {
     state.Advance(); // skip '}'
-    // Simple substitution
-    const LocValue* value = state.FindArg(var_name);
-    if (value) {
-      return value->AsString();
-    }
-    return "{" + var_name + "}";
+    ops->push_back(MakeOp(LocMessage::kOpArgument, message, var_name));
+    return;
   }
   
   if (state.Peek() != ',') {
-    // Skip to closing brace
-    int depth = 1;
-    while (!state.AtEnd() && depth > 0) {
-      if (state.Peek() == '{') depth++;
-      else if (state.Peek() == '}') depth--;
-      state.Advance();
-    }
-    return "";
+    SkipArgument(state);
+    return;
   }
   
   state.Advance(); // skip ','
@@ -430,21 +493,13 @@ static std::string ParseArgument(ParserState& state) {
   // For simple types like number/date, we might have format specifier or just closing brace
   if (state.Peek() == '}') {
     state.Advance();
-    const LocValue* value = state.FindArg(var_name);
-    if (value) {
-      return value->AsString();
-    }
-    return "";
+    ops->push_back(MakeOp(LocMessage::kOpValue, message, var_name));
+    return;
   }
   
   if (state.Peek() != ',') {
-    int depth = 1;
-    while (!state.AtEnd() && depth > 0) {
-      if (state.Peek() == '{') depth++;
-      else if (state.Peek() == '}') depth--;
-      state.Advance();
-    }
-    return "";
+    SkipArgument(state);
+    return;
   }
   
   state.Advance(); // skip ','
@@ -469,46 +524,49 @@ static std::string ParseArgument(ParserState& state) {
     }
   }
   
-  // Process based on type
+  // Compile based on type
   if (type == "plural") {
-    return ProcessPlural(state, var_name, options, false);
+    ops->push_back(CompilePlural(message, var_name, options, false));
   } else if (type == "selectordinal") {
-    return ProcessPlural(state, var_name, options, true);
+    ops->push_back(CompilePlural(message, var_name, options, true));
   } else if (type == "select") {
-    return ProcessSelect(state, var_name, options);
+    ops->push_back(CompileSelect(message, var_name, options));
   } else if (type == "number") {
-    const LocValue* value = state.FindArg(var_name);
-    if (value) {
-      return value->AsString();
-    }
+    ops->push_back(MakeOp(LocMessage::kOpValue, message, var_name));
   }
-  
-  return "";
 }
 
-// Parse the full message, handling plain text and argument expressions
-static std::string ParseMessage(ParserState& state) {
-  std::string result;
+static void CompileMessage(const std::string& input, LocMessage* message,
+                           Ui32* out_begin, Ui32* out_end) {
+  // Nested messages are appended first, so the ops of this one stay
+  // contiguous
+  ParserState state(input);
+  std::vector<LocMessage::Op> ops;
+  std::string literal;
   
   while (!state.AtEnd()) {
     char c = state.Peek();
     
     if (c == '{') {
-      result += ParseArgument(state);
+      if (!literal.empty()) {
+        ops.push_back(MakeOp(LocMessage::kOpLiteral, message, literal));
+        literal.clear();
+      }
+      CompileArgument(state, message, &ops);
     } else if (c == '\'') {
       // ICU quoted literal handling
       state.Advance(); // skip opening quote
       if (state.Peek() == '\'') {
         // Escaped single quote ''
-        result += '\'';
+        literal += '\'';
         state.Advance();
       } else if (state.Peek() == '{' || state.Peek() == '}' || state.Peek() == '#') {
         // Single character escape
-        result += state.Advance();
+        literal += state.Advance();
       } else {
         // Quoted section - everything until closing quote
         while (!state.AtEnd() && state.Peek() != '\'') {
-          result += state.Advance();
+          literal += state.Advance();
         }
         if (!state.AtEnd()) state.Advance(); // skip closing quote
       }
@@ -516,17 +574,412 @@ static std::string ParseMessage(ParserState& state) {
       // End of a nested message
       break;
     } else {
-      result += state.Advance();
+      literal += state.Advance();
     }
   }
+  if (!literal.empty()) {
+    ops.push_back(MakeOp(LocMessage::kOpLiteral, message, literal));
+  }
   
-  return result;
+  *out_begin = static_cast<Ui32>(message->ops.size());
+  message->ops.insert(message->ops.end(), ops.begin(), ops.end());
+  *out_end = static_cast<Ui32>(message->ops.size());
+}
+
+// ============================================================================
+// Compiled message formatting
+// ============================================================================
+
+static const LocValue* FindArg(const LocArgs& args, const char* name,
+                               Ui32 size) {
+  for (size_t i = 0; i < args.size(); ++i) {
+    const std::string& arg_name = args[i].first;
+    if (arg_name.size() == size &&
+        std::memcmp(arg_name.data(), name, size) == 0) {
+      return &args[i].second;
+    }
+  }
+  return nullptr;
+}
+
+// Replaces every # appended after begin with the number
+static void ReplaceHashes(std::string* out, size_t begin, Si64 n) {
+  size_t count = static_cast<size_t>(
+    std::count(out->begin() + static_cast<std::ptrdiff_t>(begin), out->end(), '#'));
+  if (count == 0) return;
+  char digits[32];
+  size_t digit_count = FormatLocInt(n, digits);
+  size_t old_size = out->size();
+  out->resize(old_size + count * (digit_count - 1));
+  // Moving from the back, the destination never overtakes the source
+  char* data = &(*out)[0];
+  size_t dst = out->size();
+  for (size_t src = old_size; src > begin;) {
+    char c = data[--src];
+    if (c == '#') {
+      dst -= digit_count;
+      std::memcpy(data + dst, digits, digit_count);
+    } else {
+      data[--dst] = c;
+    }
+  }
+}
+
+// Compiled instructions, either of a LocMessage or of a mapped table
+struct LocProgram {
+  const char* text;
+  const LocMessage::Op* ops;
+  const LocMessage::Branch* branches;
+};
+
+static void RunOps(const LocProgram& program, Ui32 begin, Ui32 end,
+                   const LocArgs& args, PluralRules rules, std::string* out) {
+  const char* text = program.text;
+  for (Ui32 op_idx = begin; op_idx < end; ++op_idx) {
+    const LocMessage::Op& op = program.ops[op_idx];
+    if (op.kind == LocMessage::kOpLiteral) {
+      out->append(text + op.offset, op.size);
+      continue;
+    }
+    const LocValue* value = FindArg(args, text + op.offset, op.size);
+    if (op.kind == LocMessage::kOpArgument && !value) {
+      out->push_back('{');
+      out->append(text + op.offset, op.size);
+      out->push_back('}');
+      continue;
+    }
+    if (!value) continue;
+    
+    const LocMessage::Branch* first = program.branches + op.first_branch;
+    const LocMessage::Branch* last = first + op.branch_count;
+    const LocMessage::Branch* selected = nullptr;
+    const LocMessage::Branch* other = nullptr;
+    switch (op.kind) {
+      case LocMessage::kOpArgument:
+      case LocMessage::kOpValue:
+        value->AppendTo(out);
+        continue;
+      case LocMessage::kOpPlural:
+      case LocMessage::kOpOrdinal: {
+        Si64 n = value->AsInt();
+        for (const LocMessage::Branch* b = first; b != last && !selected; ++b) {
+          if (b->kind == LocMessage::kBranchExact && b->value == n) {
+            selected = b;
+          }
+        }
+        if (!selected) {
+          Si64 category = op.kind == LocMessage::kOpOrdinal
+              ? GetOrdinalCategory(n, rules)
+              : GetPluralCategory(n, rules);
+          for (const LocMessage::Branch* b = first; b != last; ++b) {
+            if (b->kind == LocMessage::kBranchCategory) {
+              if (b->value == category && !b->is_empty) selected = b;
+              if (b->value == kPluralOther) other = b;
+            }
+          }
+          if (!selected) selected = other;
+        }
+        size_t start = out->size();
+        if (selected) {
+          RunOps(program, selected->op_begin, selected->op_end, args, rules, out);
+        }
+        ReplaceHashes(out, start, n);
+        continue;
+      }
+      case LocMessage::kOpSelect: {
+        char number[32];
+        const char* select_value = number;
+        size_t select_size = 0;
+        if (value->type == LocValue::kString) {
+          select_value = value->string_value.data();
+          select_size = value->string_value.size();
+        } else {
+          select_size = FormatLocNumber(*value, number);
+        }
+        for (const LocMessage::Branch* b = first; b != last; ++b) {
+          const char* key = text + b->key_offset;
+          if (b->key_size == select_size && !b->is_empty &&
+              std::memcmp(key, select_value, select_size) == 0) {
+            selected = b;
+          }
+          if (b->key_size == 5 && std::memcmp(key, "other", 5) == 0) {
+            other = b;
+          }
+        }
+        if (!selected) selected = other;
+        if (selected) {
+          RunOps(program, selected->op_begin, selected->op_end, args, rules, out);
+        }
+        continue;
+      }
+      case LocMessage::kOpLiteral:
+        continue;
+    }
+  }
+}
+
+void LocMessage::Compile(const std::string& pattern) {
+  text.clear();
+  ops.clear();
+  branches.clear();
+  CompileMessage(pattern, this, &root_begin, &root_end);
+}
+
+void LocMessage::FormatTo(const LocArgs& args, const std::string& locale_code,
+                          std::string* out) const {
+  LocProgram program = {text.data(), ops.data(), branches.data()};
+  RunOps(program, root_begin, root_end, args, GetPluralRules(locale_code), out);
+}
+
+// ============================================================================
+// Binary string tables
+// ============================================================================
+
+// File layout: header, branches, ops, entries, seeds, pool. Offsets in the
+// header are from the file start, text offsets in entries, ops and branches
+// are from the pool start. Numbers are stored in native (little-endian)
+// byte order.
+static const char kLocTableMagic[4] = {'A', 'L', 'O', 'C'};
+static const Ui32 kLocTableVersion = 1;
+
+struct LocTableHeader {
+  char magic[4];
+  Ui32 version;
+  Ui32 string_count;
+  Ui32 bucket_count;
+  Ui32 locale_offset;
+  Ui32 locale_size;
+  Ui32 branches_offset;
+  Ui32 branch_count;
+  Ui32 ops_offset;
+  Ui32 op_count;
+  Ui32 entries_offset;
+  Ui32 seeds_offset;
+  Ui32 pool_offset;
+  Ui32 pool_size;
+};
+
+struct LocTableEntry {
+  Ui32 key_offset;
+  Ui32 key_size;
+  Ui32 text_offset;
+  Ui32 text_size;
+  Ui32 op_begin;
+  Ui32 op_end;
+};
+
+static_assert(sizeof(LocTableHeader) % 8 == 0, "Branches must stay aligned");
+static_assert(sizeof(LocMessage::Branch) == 32, "Branch layout is stored");
+static_assert(sizeof(LocMessage::Op) == 20, "Op layout is stored");
+
+static Ui64 HashLocKey(const char* data, size_t size) {
+  Ui64 hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ static_cast<Ui8>(data[i])) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Derives an independent hash for each displacement seed
+static Ui64 MixLocHash(Ui64 hash, Ui32 seed) {
+  Ui64 x = hash ^ (static_cast<Ui64>(seed) * 0x9E3779B97F4A7C15ull);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+// Builds a minimal perfect hash with hash-and-displace: keys are grouped
+// into buckets, the largest buckets are placed first by searching for a seed
+// that sends all their keys to free slots, single-key buckets take the
+// remaining slots directly (stored as -slot - 1).
+static bool BuildLocPerfectHash(const std::vector<Ui64>& hashes,
+                                std::vector<Si32>* out_seeds,
+                                std::vector<Ui32>* out_slots) {
+  const Ui32 count = static_cast<Ui32>(hashes.size());
+  const Ui32 bucket_count = count / 2 + 1;
+  std::vector<std::vector<Ui32>> buckets(bucket_count);
+  for (Ui32 i = 0; i < count; ++i) {
+    buckets[MixLocHash(hashes[i], 0) % bucket_count].push_back(i);
+  }
+  std::vector<Ui32> order(bucket_count);
+  for (Ui32 i = 0; i < bucket_count; ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&buckets](Ui32 a, Ui32 b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+  
+  out_seeds->assign(bucket_count, 0);
+  out_slots->assign(count, 0);
+  std::vector<bool> is_taken(count, false);
+  std::vector<Ui32> slots;
+  Ui32 free_slot = 0;
+  for (Ui32 bucket_idx : order) {
+    const std::vector<Ui32>& bucket = buckets[bucket_idx];
+    if (bucket.empty()) {
+      break;
+    }
+    if (bucket.size() == 1) {
+      while (is_taken[free_slot]) {
+        ++free_slot;
+      }
+      is_taken[free_slot] = true;
+      (*out_slots)[bucket[0]] = free_slot;
+      (*out_seeds)[bucket_idx] = -static_cast<Si32>(free_slot) - 1;
+      continue;
+    }
+    bool is_placed = false;
+    for (Ui32 seed = 1; seed < (1u << 24) && !is_placed; ++seed) {
+      slots.clear();
+      is_placed = true;
+      for (Ui32 key_idx : bucket) {
+        Ui32 slot = static_cast<Ui32>(MixLocHash(hashes[key_idx], seed) % count);
+        if (is_taken[slot] ||
+            std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+          is_placed = false;
+          break;
+        }
+        slots.push_back(slot);
+      }
+      if (is_placed) {
+        for (size_t i = 0; i < bucket.size(); ++i) {
+          is_taken[slots[i]] = true;
+          (*out_slots)[bucket[i]] = slots[i];
+        }
+        (*out_seeds)[bucket_idx] = static_cast<Si32>(seed);
+      }
+    }
+    if (!is_placed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct Localization::Table {
+  MappedFile file;
+  LocTableHeader header;
+  const Si32* seeds = nullptr;
+  const LocTableEntry* entries = nullptr;
+  const char* pool = nullptr;
+  LocProgram program;
+  std::string locale;
+  // Strings returned by Get, one per slot
+  std::vector<std::string> strings;
+  
+  bool Open(const std::string& path);
+  
+  // Returns the slot of the key or -1
+  Si64 Find(const std::string& key) const {
+    if (header.string_count == 0) return -1;
+    Ui64 hash = HashLocKey(key.data(), key.size());
+    Si32 seed = seeds[MixLocHash(hash, 0) % header.bucket_count];
+    Ui64 slot = seed < 0 ? static_cast<Ui64>(-static_cast<Si64>(seed) - 1)
+        : MixLocHash(hash, static_cast<Ui32>(seed)) % header.string_count;
+    if (slot >= header.string_count) return -1;
+    const LocTableEntry& entry = entries[slot];
+    if (entry.key_size != key.size() ||
+        std::memcmp(pool + entry.key_offset, key.data(), key.size()) != 0) {
+      return -1;
+    }
+    return static_cast<Si64>(slot);
+  }
+  
+  LocStringView Text(Ui32 slot) const {
+    LocStringView view;
+    view.data = pool + entries[slot].text_offset;
+    view.size = entries[slot].text_size;
+    return view;
+  }
+};
+
+static bool IsLocRangeValid(Ui64 offset, Ui64 size, Ui64 limit) {
+  return offset <= limit && size <= limit - offset;
+}
+
+bool Localization::Table::Open(const std::string& path) {
+  if (!file.Open(path.c_str()) || file.Size() < sizeof(LocTableHeader)) {
+    return false;
+  }
+  const Ui8* data = file.Data();
+  const Ui64 size = file.Size();
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kLocTableMagic, 4) != 0 ||
+      header.version != kLocTableVersion ||
+      header.bucket_count == 0 ||
+      header.branches_offset % 8 != 0 || header.ops_offset % 4 != 0 ||
+      header.entries_offset % 4 != 0 || header.seeds_offset % 4 != 0 ||
+      !IsLocRangeValid(header.branches_offset,
+                       Ui64(header.branch_count) * sizeof(LocMessage::Branch), size) ||
+      !IsLocRangeValid(header.ops_offset,
+                       Ui64(header.op_count) * sizeof(LocMessage::Op), size) ||
+      !IsLocRangeValid(header.entries_offset,
+                       Ui64(header.string_count) * sizeof(LocTableEntry), size) ||
+      !IsLocRangeValid(header.seeds_offset,
+                       Ui64(header.bucket_count) * sizeof(Si32), size) ||
+      !IsLocRangeValid(header.pool_offset, header.pool_size, size) ||
+      !IsLocRangeValid(header.locale_offset, header.locale_size,
+                       header.pool_size)) {
+    return false;
+  }
+  seeds = reinterpret_cast<const Si32*>(data + header.seeds_offset);
+  entries = reinterpret_cast<const LocTableEntry*>(data + header.entries_offset);
+  pool = reinterpret_cast<const char*>(data + header.pool_offset);
+  program.text = pool;
+  program.ops = reinterpret_cast<const LocMessage::Op*>(data + header.ops_offset);
+  program.branches = reinterpret_cast<const LocMessage::Branch*>(
+      data + header.branches_offset);
+  locale.assign(pool + header.locale_offset, header.locale_size);
+  
+  // Instructions are checked once, entries and seeds on lookup. Branches
+  // only point to instructions placed before their op, so formatting
+  // always terminates.
+  for (Ui32 i = 0; i < header.op_count; ++i) {
+    const LocMessage::Op& op = program.ops[i];
+    if (op.kind > LocMessage::kOpSelect ||
+        !IsLocRangeValid(op.offset, op.size, header.pool_size) ||
+        !IsLocRangeValid(op.first_branch, op.branch_count, header.branch_count)) {
+      return false;
+    }
+    for (Ui32 b = op.first_branch; b < op.first_branch + op.branch_count; ++b) {
+      const LocMessage::Branch& branch = program.branches[b];
+      if (branch.kind > LocMessage::kBranchKey ||
+          branch.op_begin > branch.op_end || branch.op_end > i ||
+          !IsLocRangeValid(branch.key_offset, branch.key_size,
+                           header.pool_size)) {
+        return false;
+      }
+    }
+  }
+  strings.reserve(header.string_count);
+  for (Ui32 i = 0; i < header.string_count; ++i) {
+    const LocTableEntry& entry = entries[i];
+    // Texts are followed by the terminating zero
+    if (!IsLocRangeValid(entry.key_offset, entry.key_size, header.pool_size) ||
+        !IsLocRangeValid(entry.text_offset, Ui64(entry.text_size) + 1,
+                         header.pool_size) ||
+        pool[Ui64(entry.text_offset) + entry.text_size] != '\0' ||
+        entry.op_begin > entry.op_end || entry.op_end > header.op_count) {
+      return false;
+    }
+    strings.emplace_back(pool + entry.text_offset, entry.text_size);
+  }
+  return true;
 }
 
 // ============================================================================
 // Localization class implementation
 // ============================================================================
 
+Localization::Localization() {
+}
+
+Localization::~Localization() {
+}
+
 Localization& Localization::Instance() {
   static Localization instance;
   return instance;
@@ -562,7 +1015,10 @@ bool Localization::Load(const std::string& path,
       std::string text = (*row)[locale_code];
       
       if (!text.empty()) {
-        strings_[locale_code][id] = text;
+        Entry& entry = strings_[locale_code][id];
+        entry.text = text;
+        entry.message.reset(new LocMessage());
+        entry.message->Compile(entry.text);
       }
     }
   }
@@ -572,93 +1028,178 @@ bool Localization::Load(const std::string& path,
 
 void Localization::SetLocale(const std::string& locale_code) {
   locale_ = locale_code;
+  UpdateMappedTables();
 }
 
 void Localization::SetFallbackLocale(const std::string& locale_code) {
   fallback_locale_ = locale_code;
+  UpdateMappedTables();
 }
 
-const std::string* Localization::FindString(const std::string& key, 
-                                             const std::string& locale_code) const {
+bool Localization::Find(const std::string& key, const std::string& locale_code,
+                        Found* found) const {
   auto locale_it = strings_.find(locale_code);
   if (locale_it != strings_.end()) {
     auto key_it = locale_it->second.find(key);
     if (key_it != locale_it->second.end()) {
-      return &key_it->second;
+      found->entry = &key_it->second;
+      found->table = nullptr;
+      found->text.data = key_it->second.text.c_str();
+      found->text.size = key_it->second.text.size();
+      return true;
     }
   }
-  return nullptr;
+  auto table_it = tables_.find(locale_code);
+  if (table_it != tables_.end()) {
+    Si64 slot = table_it->second->Find(key);
+    if (slot >= 0) {
+      found->entry = nullptr;
+      found->table = table_it->second.get();
+      found->slot = static_cast<Ui32>(slot);
+      found->text = found->table->Text(found->slot);
+      return true;
+    }
+  }
+  return false;
 }
 
-const std::string& Localization::Get(const std::string& key) const {
-  // Try current locale
-  const std::string* result = FindString(key, locale_);
-  if (result) {
-    return *result;
+bool Localization::FindWithFallback(const std::string& key,
+                                    const std::string& locale_code,
+                                    Found* found) const {
+  if (Find(key, locale_code, found)) {
+    return true;
   }
-  
-  // Try fallback locale
-  if (locale_ != fallback_locale_) {
-    result = FindString(key, fallback_locale_);
-    if (result) {
-      return *result;
-    }
+  return locale_code != fallback_locale_ &&
+      Find(key, fallback_locale_, found);
+}
+
+const std::string& Localization::FoundString(const Found& found) const {
+  if (found.entry) {
+    return found.entry->text;
   }
-  
+  return found.table->strings[found.slot];
+}
+
+const std::string& Localization::MissingString(const std::string& key) const {
   // Return the key wrapped in markers
   missing_string_buffer_ = missing_key_prefix_ + key + missing_key_suffix_;
   return missing_string_buffer_;
 }
 
+const std::string& Localization::Get(const std::string& key) const {
+  Found found;
+  if (FindWithFallback(key, locale_, &found)) {
+    return FoundString(found);
+  }
+  return MissingString(key);
+}
+
 const std::string& Localization::Get(const std::string& key, 
                                       const std::string& locale_code) const {
-  const std::string* result = FindString(key, locale_code);
-  if (result) {
-    return *result;
+  Found found;
+  if (FindWithFallback(key, locale_code, &found)) {
+    return FoundString(found);
   }
-  
-  // Try fallback locale
-  if (locale_code != fallback_locale_) {
-    result = FindString(key, fallback_locale_);
-    if (result) {
-      return *result;
-    }
+  return MissingString(key);
+}
+
+LocStringView Localization::GetView(const std::string& key) const {
+  Found found;
+  if (FindWithFallback(key, locale_, &found)) {
+    return found.text;
   }
-  
-  // Return the key wrapped in markers
-  missing_string_buffer_ = missing_key_prefix_ + key + missing_key_suffix_;
-  return missing_string_buffer_;
+  const std::string& missing = MissingString(key);
+  LocStringView view;
+  view.data = missing.c_str();
+  view.size = missing.size();
+  return view;
 }
 
 std::string Localization::Format(const std::string& key, const LocArgs& args) const {
-  return FormatPattern(Get(key), args);
+  std::string result;
+  FormatTo(key, args, &result);
+  return result;
+}
+
+void Localization::FormatTo(const std::string& key, const LocArgs& args,
+                            std::string* out) const {
+  Found found;
+  if (!FindWithFallback(key, locale_, &found)) {
+    FormatPatternTo(missing_key_prefix_ + key + missing_key_suffix_, args,
+                    out);
+    return;
+  }
+  if (found.table) {
+    const LocTableEntry& entry = found.table->entries[found.slot];
+    RunOps(found.table->program, entry.op_begin, entry.op_end, args,
+           GetPluralRules(locale_), out);
+    return;
+  }
+  found.entry->message->FormatTo(args, locale_, out);
 }
 
 std::string Localization::FormatPattern(const std::string& pattern, 
                                          const LocArgs& args) const {
-  ParserState state(pattern, args, locale_);
-  return ParseMessage(state);
+  std::string result;
+  FormatPatternTo(pattern, args, &result);
+  return result;
+}
+
+void Localization::FormatPatternTo(const std::string& pattern,
+                                   const LocArgs& args,
+                                   std::string* out) const {
+  // Bounds the cache when patterns are built at runtime
+  const size_t kMaxCachedPatterns = 256;
+  std::shared_ptr<const LocMessage> message;
+  {
+    std::lock_guard<std::mutex> lock(pattern_cache_mutex_);
+    auto it = pattern_cache_.find(pattern);
+    if (it != pattern_cache_.end()) {
+      message = it->second;
+    }
+  }
+  if (!message) {
+    std::shared_ptr<LocMessage> compiled = std::make_shared<LocMessage>();
+    compiled->Compile(pattern);
+    message = compiled;
+    std::lock_guard<std::mutex> lock(pattern_cache_mutex_);
+    if (pattern_cache_.size() >= kMaxCachedPatterns) {
+      pattern_cache_.clear();
+    }
+    pattern_cache_.emplace(pattern, message);
+  }
+  message->FormatTo(args, locale_, out);
 }
 
 bool Localization::HasKey(const std::string& key) const {
-  return FindString(key, locale_) != nullptr;
+  Found found;
+  return Find(key, locale_, &found);
 }
 
 bool Localization::HasKey(const std::string& key, const std::string& locale_code) const {
-  return FindString(key, locale_code) != nullptr;
+  Found found;
+  return Find(key, locale_code, &found);
 }
 
 std::vector<std::string> Localization::GetAvailableLocales() const {
   std::vector<std::string> locales;
-  locales.reserve(strings_.size());
+  locales.reserve(strings_.size() + tables_.size());
   for (auto it = strings_.begin(); it != strings_.end(); ++it) {
     locales.push_back(it->first);
   }
+  for (auto it = tables_.begin(); it != tables_.end(); ++it) {
+    if (strings_.find(it->first) == strings_.end()) {
+      locales.push_back(it->first);
+    }
+  }
   return locales;
 }
 
 void Localization::Clear() {
   strings_.clear();
+  tables_.clear();
+  std::lock_guard<std::mutex> lock(pattern_cache_mutex_);
+  pattern_cache_.clear();
 }
 
 void Localization::Clear(const std::string& locale_code) {
@@ -666,22 +1207,190 @@ void Localization::Clear(const std::string& locale_code) {
   if (it != strings_.end()) {
     it->second.clear();
   }
+  tables_.erase(locale_code);
 }
 
 Ui64 Localization::Count() const {
-  auto it = strings_.find(locale_);
-  if (it != strings_.end()) {
-    return static_cast<Ui64>(it->second.size());
-  }
-  return 0;
+  return Count(locale_);
 }
 
 Ui64 Localization::Count(const std::string& locale_code) const {
+  Ui64 count = 0;
+  auto table_it = tables_.find(locale_code);
+  const Table* table = table_it != tables_.end() ? table_it->second.get()
+                                                 : nullptr;
+  if (table) {
+    count = table->header.string_count;
+  }
   auto it = strings_.find(locale_code);
   if (it != strings_.end()) {
-    return static_cast<Ui64>(it->second.size());
+    for (auto key_it = it->second.begin(); key_it != it->second.end(); ++key_it) {
+      if (!table || table->Find(key_it->first) < 0) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+// Appends a value to a byte buffer, the caller keeps the alignment
+template <typename T>
+static void AppendLocTableData(std::vector<Ui8>* data, const T* values,
+                               size_t count) {
+  const Ui8* bytes = reinterpret_cast<const Ui8*>(values);
+  data->insert(data->end(), bytes, bytes + sizeof(T) * count);
+}
+
+static void AlignLocTableData(std::vector<Ui8>* data, size_t alignment) {
+  while (data->size() % alignment != 0) {
+    data->push_back(0);
+  }
+}
+
+bool Localization::SaveTable(const std::string& locale_code,
+                             const std::string& path) const {
+  // Collect the texts, strings loaded from CSV files override the table
+  std::unordered_map<std::string, std::string> texts;
+  auto table_it = tables_.find(locale_code);
+  if (table_it != tables_.end()) {
+    const Table& table = *table_it->second;
+    for (Ui32 i = 0; i < table.header.string_count; ++i) {
+      const LocTableEntry& entry = table.entries[i];
+      texts[std::string(table.pool + entry.key_offset, entry.key_size)] =
+          table.Text(i).ToString();
+    }
+  }
+  auto locale_it = strings_.find(locale_code);
+  if (locale_it != strings_.end()) {
+    for (auto it = locale_it->second.begin(); it != locale_it->second.end(); ++it) {
+      texts[it->first] = it->second.text;
+    }
+  }
+  std::vector<std::string> keys;
+  keys.reserve(texts.size());
+  for (auto it = texts.begin(); it != texts.end(); ++it) {
+    keys.push_back(it->first);
+  }
+  std::sort(keys.begin(), keys.end());
+  
+  std::vector<Ui64> hashes(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    hashes[i] = HashLocKey(keys[i].data(), keys[i].size());
+  }
+  std::vector<Si32> seeds;
+  std::vector<Ui32> slots;
+  if (!BuildLocPerfectHash(hashes, &seeds, &slots)) {
+    return false;
+  }
+  
+  // Compile every string and move its instructions into the shared arrays
+  std::string pool;
+  std::vector<LocMessage::Op> ops;
+  std::vector<LocMessage::Branch> branches;
+  std::vector<LocTableEntry> entries(keys.size());
+  LocMessage message;
+  LocTableHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.locale_offset = 0;
+  header.locale_size = static_cast<Ui32>(locale_code.size());
+  pool.append(locale_code);
+  pool.push_back('\0');
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const std::string& text = texts[keys[i]];
+    LocTableEntry& entry = entries[slots[i]];
+    entry.key_offset = static_cast<Ui32>(pool.size());
+    entry.key_size = static_cast<Ui32>(keys[i].size());
+    pool.append(keys[i]);
+    pool.push_back('\0');
+    entry.text_offset = static_cast<Ui32>(pool.size());
+    entry.text_size = static_cast<Ui32>(text.size());
+    pool.append(text);
+    pool.push_back('\0');
+    
+    message.Compile(text);
+    Ui32 text_base = static_cast<Ui32>(pool.size());
+    Ui32 op_base = static_cast<Ui32>(ops.size());
+    Ui32 branch_base = static_cast<Ui32>(branches.size());
+    pool.append(message.text);
+    for (LocMessage::Op op : message.ops) {
+      op.offset += text_base;
+      op.first_branch += branch_base;
+      ops.push_back(op);
+    }
+    for (LocMessage::Branch branch : message.branches) {
+      branch.key_offset += text_base;
+      branch.op_begin += op_base;
+      branch.op_end += op_base;
+      branches.push_back(branch);
+    }
+    entry.op_begin = message.root_begin + op_base;
+    entry.op_end = message.root_end + op_base;
+  }
+  if (pool.size() > 0xffffffffull) {
+    return false;
+  }
+  
+  std::vector<Ui8> data(sizeof(header));
+  header.branches_offset = static_cast<Ui32>(data.size());
+  header.branch_count = static_cast<Ui32>(branches.size());
+  AppendLocTableData(&data, branches.data(), branches.size());
+  header.ops_offset = static_cast<Ui32>(data.size());
+  header.op_count = static_cast<Ui32>(ops.size());
+  AppendLocTableData(&data, ops.data(), ops.size());
+  AlignLocTableData(&data, 4);
+  header.entries_offset = static_cast<Ui32>(data.size());
+  header.string_count = static_cast<Ui32>(entries.size());
+  AppendLocTableData(&data, entries.data(), entries.size());
+  header.seeds_offset = static_cast<Ui32>(data.size());
+  header.bucket_count = static_cast<Ui32>(seeds.size());
+  AppendLocTableData(&data, seeds.data(), seeds.size());
+  header.pool_offset = static_cast<Ui32>(data.size());
+  header.pool_size = static_cast<Ui32>(pool.size());
+  AppendLocTableData(&data, pool.data(), pool.size());
+  std::memcpy(header.magic, kLocTableMagic, 4);
+  header.version = kLocTableVersion;
+  std::memcpy(data.data(), &header, sizeof(header));
+  
+  WriteFile(path.c_str(), data.data(), data.size());
+  return true;
+}
+
+bool Localization::LoadTable(const std::string& path) {
+  std::unique_ptr<Table> table(new Table());
+  if (!table->Open(path)) {
+    return false;
+  }
+  std::string locale_code = table->locale;
+  tables_[locale_code] = std::move(table);
+  return true;
+}
+
+void Localization::SetTableDirectory(const std::string& directory) {
+  table_directory_ = directory;
+  UpdateMappedTables();
+}
+
+void Localization::UpdateMappedTables() {
+  if (table_directory_.empty()) {
+    return;
+  }
+  for (auto it = tables_.begin(); it != tables_.end();) {
+    if (it->first != locale_ && it->first != fallback_locale_) {
+      it = tables_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  const std::string* locales[2] = {&locale_, &fallback_locale_};
+  for (const std::string* locale_code : locales) {
+    if (tables_.find(*locale_code) == tables_.end()) {
+      std::unique_ptr<Table> table(new Table());
+      if (table->Open(table_directory_ + "/" + *locale_code + ".loctable") &&
+          table->locale == *locale_code) {
+        tables_[*locale_code] = std::move(table);
+      }
+    }
   }
-  return 0;
 }
 
 // ============================================================================
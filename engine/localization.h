@@ -23,6 +23,8 @@
 #ifndef ENGINE_LOCALIZATION_H_
 #define ENGINE_LOCALIZATION_H_
 
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -54,14 +56,85 @@ struct LocValue {
   
   Si64 AsInt() const;
   std::string AsString() const;
+  /// @brief Appends the same text as AsString without a temporary string.
+  void AppendTo(std::string* out) const;
 };
 
 /// @brief Named arguments for localization formatting.
 using LocArgs = std::vector<std::pair<std::string, LocValue>>;
 
+/// @brief A view of a localized string. The data is NUL-terminated.
+struct LocStringView {
+  const char* data = "";
+  Ui64 size = 0;
+  
+  std::string ToString() const { return std::string(data, static_cast<size_t>(size)); }
+};
+
+/// @brief An ICU MessageFormat pattern compiled into a flat instruction list.
+/// Literal runs, argument names and select keys are stored in one text pool,
+/// nested plural/select branches are ranges of the same op list, so
+/// formatting is a single pass without parsing or temporary strings.
+struct LocMessage {
+  enum OpKind : Ui32 {
+    kOpLiteral = 0,   ///< Appends text.
+    kOpArgument = 1,  ///< {name}, appends the value or {name} if missing.
+    kOpValue = 2,     ///< {name, number}, appends the value if present.
+    kOpPlural = 3,    ///< {name, plural, ...}
+    kOpOrdinal = 4,   ///< {name, selectordinal, ...}
+    kOpSelect = 5     ///< {name, select, ...}
+  };
+
+  enum BranchKind : Ui32 {
+    kBranchExact = 0,     ///< =N, matched before the plural category.
+    kBranchCategory = 1,  ///< Plural category: one, two, few, many, other.
+    kBranchKey = 2        ///< Select key stored in the text pool.
+  };
+
+  /// @brief One instruction. Text and names are offset/size pairs into text.
+  struct Op {
+    OpKind kind;
+    Ui32 offset;
+    Ui32 size;
+    Ui32 first_branch;
+    Ui32 branch_count;
+  };
+
+  /// @brief One option of a plural or select instruction.
+  struct Branch {
+    BranchKind kind;
+    Ui32 is_empty;  ///< The option text is empty, "other" is used instead.
+    Si64 value;     ///< Exact number or plural category.
+    Ui32 key_offset;
+    Ui32 key_size;
+    Ui32 op_begin;  ///< Instructions of the option message.
+    Ui32 op_end;
+  };
+
+  std::string text;
+  std::vector<Op> ops;
+  std::vector<Branch> branches;
+  Ui32 root_begin = 0;
+  Ui32 root_end = 0;
+
+  /// @brief Compiles a pattern, replacing the current content.
+  /// @param pattern The ICU MessageFormat pattern.
+  void Compile(const std::string& pattern);
+
+  /// @brief Formats the message and appends the result.
+  /// @param args Named arguments for formatting.
+  /// @param locale_code The locale whose plural rules are used.
+  /// @param out The string to append to.
+  void FormatTo(const LocArgs& args, const std::string& locale_code,
+                std::string* out) const;
+};
+
 /// @brief Localization system with ICU MessageFormat support.
 /// Loads strings from UTF-8 CSV files and supports plural, select, and selectordinal.
 /// Supports loading multiple CSV files and merging them together.
+/// For large translation sets the strings of each locale can be converted at
+/// build time into a binary table (SaveTable) that is memory mapped at run
+/// time (LoadTable, SetTableDirectory) without parsing or per-string allocation.
 class Localization {
  public:
   /// @brief Returns the singleton instance.
@@ -102,18 +175,44 @@ class Localization {
   /// @return The localized string or the key itself if not found.
   const std::string& Get(const std::string& key, const std::string& locale_code) const;
   
+  /// @brief Gets a raw localized string by key without copying.
+  /// Strings of binary tables are returned as views into the mapped file,
+  /// Get copies them into a string on first use.
+  /// @param key The string identifier.
+  /// @return The localized string or the key in missing markers, valid until
+  ///   the strings are reloaded or cleared or the next missing key lookup.
+  LocStringView GetView(const std::string& key) const;
+  
   /// @brief Gets a formatted localized string.
   /// @param key The string identifier.
   /// @param args Named arguments for formatting.
   /// @return The formatted localized string.
   std::string Format(const std::string& key, const LocArgs& args) const;
   
+  /// @brief Appends a formatted localized string.
+  /// Patterns are compiled when the strings are loaded, so per-frame
+  /// formatting does no parsing and, with a reused out buffer, no
+  /// allocation. Safe to call from several threads.
+  /// @param key The string identifier.
+  /// @param args Named arguments for formatting.
+  /// @param out The string to append to.
+  void FormatTo(const std::string& key, const LocArgs& args,
+                std::string* out) const;
+  
   /// @brief Formats a pattern string directly (without lookup).
   /// @param pattern The ICU MessageFormat pattern.
   /// @param args Named arguments for formatting.
   /// @return The formatted string.
   std::string FormatPattern(const std::string& pattern, const LocArgs& args) const;
   
+  /// @brief Appends a pattern string formatted directly (without lookup).
+  /// Compiled patterns are cached by text, the cache is guarded by a mutex.
+  /// @param pattern The ICU MessageFormat pattern.
+  /// @param args Named arguments for formatting.
+  /// @param out The string to append to.
+  void FormatPatternTo(const std::string& pattern, const LocArgs& args,
+                       std::string* out) const;
+  
   /// @brief Checks if a key exists for the current locale.
   bool HasKey(const std::string& key) const;
   
@@ -135,15 +234,66 @@ class Localization {
   /// @brief Returns the number of loaded strings for a specific locale.
   Ui64 Count(const std::string& locale_code) const;
   
+  /// @brief Writes the strings of a locale into a binary table file.
+  /// The table holds a string pool, a minimal perfect hash over the string
+  /// ids and compiled patterns. Meant to run at build time after the CSV
+  /// files are loaded.
+  /// @param locale_code The locale to save.
+  /// @param path Path of the table file, conventionally <locale>.loctable.
+  /// @return True if the table was written.
+  bool SaveTable(const std::string& locale_code, const std::string& path) const;
+  
+  /// @brief Maps a binary table written by SaveTable.
+  /// Replaces the previous table of the same locale. Strings loaded from CSV
+  /// files take precedence over the table.
+  /// @param path Path to the table file.
+  /// @return True if the file is a valid table.
+  bool LoadTable(const std::string& path);
+  
+  /// @brief Sets the directory of binary tables named <locale>.loctable.
+  /// SetLocale and SetFallbackLocale then map the tables of the current and
+  /// fallback locales and unmap all other tables.
+  /// @param directory The directory, empty to turn automatic mapping off.
+  void SetTableDirectory(const std::string& directory);
+  
  private:
-  Localization() = default;
+  Localization();
+  ~Localization();
   Localization(const Localization&) = delete;
   Localization& operator=(const Localization&) = delete;
   
-  const std::string* FindString(const std::string& key, const std::string& locale_code) const;
+  struct Entry {
+    std::string text;
+    std::unique_ptr<LocMessage> message;  // Compiled when the text is set
+  };
+  
+  struct Table;
+  
+  // A string found either in strings_ or in a table
+  struct Found {
+    LocStringView text;
+    const Entry* entry = nullptr;
+    const Table* table = nullptr;
+    Ui32 slot = 0;
+  };
+  
+  bool Find(const std::string& key, const std::string& locale_code, Found* found) const;
+  bool FindWithFallback(const std::string& key, const std::string& locale_code,
+                        Found* found) const;
+  const std::string& FoundString(const Found& found) const;
+  const std::string& MissingString(const std::string& key) const;
+  void UpdateMappedTables();
   
   // Map: locale_code -> (key -> text)
-  std::unordered_map<std::string, std::unordered_map<std::string, std::string>> strings_;
+  std::unordered_map<std::string, std::unordered_map<std::string, Entry>> strings_;
+  // Map: locale_code -> mapped binary table
+  std::unordered_map<std::string, std::unique_ptr<Table>> tables_;
+  std::string table_directory_;
+  // Patterns formatted with FormatPatternTo, shared so that clearing the
+  // cache does not free a pattern another thread is formatting
+  mutable std::mutex pattern_cache_mutex_;
+  mutable std::unordered_map<std::string, std::shared_ptr<const LocMessage>>
+      pattern_cache_;
   std::string locale_ = "en";
   std::string fallback_locale_ = "en";
   std::string missing_key_prefix_ = "[?";
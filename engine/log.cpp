@@ -25,17 +25,20 @@
 
 #include "engine/log.h"
 
-#include <condition_variable>  // NOLINT
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <mutex>  // NOLINT
 #include <sstream>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
+#include "engine/mtq_blocking_queue.h"
 #include "engine/mtq_mpsc_vinfarr.h"
 #include "engine/arctic_platform.h"
 #include "engine/arctic_platform_def.h"
+#include "engine/miniz.h"
 
 #ifdef ARCTIC_PLATFORM_MACOSX
 #include <os/log.h>
@@ -43,69 +46,23 @@
 
 namespace arctic {
 
-template <class TQueue, class TItem>
-class SyncQueue{
-  std::atomic<bool> is_going_to_sleep = ATOMIC_VAR_INIT(false);
-  std::atomic<Ui64> wakeup_call_idx = ATOMIC_VAR_INIT(0);
-  std::mutex sleep_mutex;
-  std::condition_variable sleep_condvar;
-  TQueue queue;
-
- public:
-  void Enqueue(TItem *item) {
-    queue.enqueue(item);
-    if (is_going_to_sleep.load()) {
-      {
-        std::unique_lock<std::mutex> lock(sleep_mutex);
-        wakeup_call_idx.fetch_add(1);
-      }
-      sleep_condvar.notify_one();
-    }
-  }
-
-  TItem* TryDequeue() {
-    return queue.dequeue();
-  }
-
-  TItem* SyncDequeue() {
-    TItem *item = queue.dequeue();
-    if (item) {
-      return item;
-    }
-    is_going_to_sleep.store(true);
-    {
-      while (true) {
-        Ui64 last_wakeup_call = wakeup_call_idx;
-        item = queue.dequeue();
-        if (item) {
-          is_going_to_sleep.store(false);
-          return item;
-        }
-        {
-          std::unique_lock<std::mutex> lock(sleep_mutex);
-          if (last_wakeup_call == wakeup_call_idx) {
-            sleep_condvar.wait(lock);
-          }
-        }
-      }
-    }
-  }
-};
-
 static std::atomic<bool> g_is_log_enabled = ATOMIC_VAR_INIT(false);
-static SyncQueue<
-  MpscVirtInfArray<std::string*, TuneDeletePayloadFlag<true>, TuneChunkSize<4000>>,
-  std::string> g_logger_queue;
+static BlockingQueue<
+  MpscVirtInfArray<std::string*, TuneDeletePayloadFlag<true>, TuneChunkSize<4000>>>
+  g_logger_queue;
 static std::thread g_logger_thread;
 static std::string *g_quit_item = nullptr;
 static std::mutex g_quit_mutex;
+static std::atomic<Ui64> g_log_max_file_size = ATOMIC_VAR_INIT(0);
+static std::atomic<Si32> g_log_max_file_count = ATOMIC_VAR_INIT(5);
+static std::atomic<bool> g_is_log_compression_enabled = ATOMIC_VAR_INIT(false);
 
 #ifdef ARCTIC_PLATFORM_WEB
   void LoggerThreadFunction() {
     while (true) {
       std::string *message = g_logger_queue.TryDequeue();
       if (!message) {
-        message = g_logger_queue.SyncDequeue();
+        message = g_logger_queue.Dequeue();
       }
       if (message == g_quit_item) {
         delete message;
@@ -116,33 +73,150 @@ static std::mutex g_quit_mutex;
     }
   }
 #else  // ARCTIC_PLATFORM_WEB
+  static const size_t kLogBatchBytes = 64 << 10;
+  static const char *kLogFileName = "log.txt";
+
+  static std::string RotatedLogFileName(Si32 idx, bool is_compressed) {
+    std::string name = "log.";
+    name.append(std::to_string(idx));
+    name.append(is_compressed ? ".txt.gz" : ".txt");
+    return name;
+  }
+
+  // Writes the file as a single-member gzip stream (raw deflate + crc32).
+  static bool GzipFile(const std::string &from_name, const std::string &to_name) {
+    std::ifstream in(from_name, std::ios_base::binary | std::ios_base::in);
+    if (!in) {
+      return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+    in.close();
+    size_t packed_size = 0;
+    void *packed = tdefl_compress_mem_to_heap(data.data(), data.size(),
+      &packed_size, static_cast<int>(
+        tdefl_create_comp_flags_from_zip_params(MZ_DEFAULT_LEVEL, -MZ_DEFAULT_WINDOW_BITS,
+          MZ_DEFAULT_STRATEGY)));
+    if (!packed) {
+      return false;
+    }
+    Ui32 crc = static_cast<Ui32>(mz_crc32(MZ_CRC32_INIT,
+      reinterpret_cast<const unsigned char*>(data.data()), data.size()));
+    Ui32 size = static_cast<Ui32>(data.size());
+    const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    char trailer[8];
+    for (Si32 i = 0; i < 4; ++i) {
+      trailer[i] = static_cast<char>((crc >> (i * 8)) & 0xff);
+      trailer[4 + i] = static_cast<char>((size >> (i * 8)) & 0xff);
+    }
+    std::ofstream out(to_name,
+      std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    out.write(header, sizeof(header));
+    out.write(static_cast<const char*>(packed),
+      static_cast<std::streamsize>(packed_size));
+    out.write(trailer, sizeof(trailer));
+    mz_free(packed);
+    out.close();
+    return !(out.rdstate() & (std::ios_base::failbit | std::ios_base::badbit));
+  }
+
+  class LogFileWriter {
+    std::ofstream out_;
+    std::string batch_;
+    Ui64 file_size_ = 0;
+
+   public:
+    void Open(bool is_truncate) {
+      out_.open(kLogFileName, std::ios_base::binary | std::ios_base::out |
+        (is_truncate ? std::ios_base::trunc : std::ios_base::app));
+      Check(!(out_.rdstate() & std::ios_base::failbit),
+        "Error in LoggerThreadFunction. Can't create/open the file, file_name: ",
+        kLogFileName);
+      out_.exceptions(std::ios_base::goodbit);
+      out_.seekp(0, std::ios_base::end);
+      std::streamoff pos = out_.tellp();
+      file_size_ = pos > 0 ? static_cast<Ui64>(pos) : 0ull;
+      batch_.reserve(kLogBatchBytes + 4096);
+    }
+
+    // Returns true if the batch is large enough to be written right away.
+    bool Append(const std::string &message) {
+      batch_.append(message);
+      batch_.append("\r\n", 2);
+      return batch_.size() >= kLogBatchBytes;
+    }
+
+    void Write() {
+      if (batch_.empty()) {
+        return;
+      }
+      Ui64 max_file_size = g_log_max_file_size.load();
+      if (max_file_size && file_size_ &&
+          file_size_ + batch_.size() > max_file_size) {
+        Rotate();
+      }
+      out_.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+      Check(!(out_.rdstate() & std::ios_base::badbit),
+        "Error in LoggerThreadFunction. Can't write the file, file_name: ",
+        kLogFileName);
+      file_size_ += batch_.size();
+      batch_.clear();
+    }
+
+    void Flush() {
+      out_.flush();
+    }
+
+    void Close() {
+      out_.close();
+      Check(!(out_.rdstate() & std::ios_base::failbit),
+        "Error in LoggerThreadFunction. Can't close the file, file_name: ",
+        kLogFileName);
+    }
+
+    // log.txt -> log.1.txt -> ... -> log.N.txt, the oldest file is removed.
+    void Rotate() {
+      Close();
+      Si32 count = g_log_max_file_count.load();
+      bool is_compressed = g_is_log_compression_enabled.load();
+      if (count > 0) {
+        std::remove(RotatedLogFileName(count, false).c_str());
+        std::remove(RotatedLogFileName(count, true).c_str());
+        for (Si32 idx = count - 1; idx >= 1; --idx) {
+          std::rename(RotatedLogFileName(idx, false).c_str(),
+            RotatedLogFileName(idx + 1, false).c_str());
+          std::rename(RotatedLogFileName(idx, true).c_str(),
+            RotatedLogFileName(idx + 1, true).c_str());
+        }
+        std::string rotated_name = RotatedLogFileName(1, false);
+        std::rename(kLogFileName, rotated_name.c_str());
+        if (is_compressed &&
+            GzipFile(rotated_name, RotatedLogFileName(1, true))) {
+          std::remove(rotated_name.c_str());
+        }
+      }
+      Open(true);
+    }
+  };
+
   void LoggerThreadFunction() {
-    const char *file_name = "log.txt";
-    const char *newline = "\r\n";
-    std::ofstream out(file_name,
-      std::ios_base::binary | std::ios_base::out | std::ios_base::app);
-    Check(!(out.rdstate() & std::ios_base::failbit),
-      "Error in LoggerThreadFunction. Can't create/open the file, file_name: ",
-      file_name);
-    out.exceptions(std::ios_base::goodbit);
+    LogFileWriter writer;
+    writer.Open(false);
     bool is_flush_needed = false;
     while (true) {
       std::string *message = g_logger_queue.TryDequeue();
       if (!message) {
         if (is_flush_needed) {
-          out.flush();
+          writer.Write();
+          writer.Flush();
           is_flush_needed = false;
         }
-        message = g_logger_queue.SyncDequeue();
+        message = g_logger_queue.Dequeue();
       }
       if (message == g_quit_item) {
-        if (is_flush_needed) {
-          out.flush();
-        }
-        out.close();
-        Check(!(out.rdstate() & std::ios_base::failbit),
-          "Error in LoggerThreadFunction. Can't close the file, file_name: ",
-          file_name);
+        writer.Write();
+        writer.Flush();
+        writer.Close();
         delete message;
         return;
       }
@@ -150,14 +224,9 @@ static std::mutex g_quit_mutex;
   #ifdef ARCTIC_PLATFORM_MACOSX
       os_log_info(OS_LOG_DEFAULT, "%{public}s", message->c_str());
   #endif
-      out.write(message->data(), static_cast<std::streamsize>(message->size()));
-      Check(!(out.rdstate() & std::ios_base::badbit),
-        "Error in LoggerThreadFunction. Can't write the file, file_name: ",
-        file_name);
-      out.write(newline, 2);
-      Check(!(out.rdstate() & std::ios_base::badbit),
-        "Error in LoggerThreadFunction. Can't write the file, file_name: ",
-        file_name);
+      if (writer.Append(*message)) {
+        writer.Write();
+      }
       delete message;
     }
   }
@@ -202,6 +271,13 @@ static std::mutex g_quit_mutex;
       (new std::ostringstream, LogAndDelete);
   }
 
+  void SetLogRotation(Ui64 max_file_size, Si32 max_file_count,
+      bool is_compression_enabled) {
+    g_log_max_file_size.store(max_file_size);
+    g_log_max_file_count.store(max_file_count < 0 ? 0 : max_file_count);
+    g_is_log_compression_enabled.store(is_compression_enabled);
+  }
+
   void StartLogger() {
     std::lock_guard<std::mutex> lock(g_quit_mutex);
     Check(g_quit_item == nullptr,
@@ -62,6 +62,18 @@ void Log(const char *text1, const char *text2);
 /// @param text3 The third text message to be logged
 void Log(const char *text1, const char *text2, const char *text3);
 
+/// @brief Configures size-based rotation of the log.txt file
+/// @param max_file_size Size in bytes after which log.txt is rotated, 0 disables rotation
+/// @param max_file_count Number of rotated files to keep (log.1.txt is the newest),
+///  0 means that log.txt is just truncated
+/// @param is_compression_enabled If true, rotated files are gzip-compressed
+///  with miniz and named log.N.txt.gz
+///
+/// Messages are written in batches by the logger thread, so the log.txt size
+/// may exceed max_file_size by one batch (about 64 KiB). Can be called at any time.
+void SetLogRotation(Ui64 max_file_size, Si32 max_file_count,
+    bool is_compression_enabled = false);
+
 /// @brief Starts the logger
 /// 
 /// @note This function is called automatically by the engine before EasyMain is called.
@@ -0,0 +1,198 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/mapped_file.h"
+
+#include <fstream>
+#include <utility>
+
+#include "engine/arctic_platform_def.h"
+#include "engine/asset_pack.h"
+#include "engine/arctic_platform_fatal.h"
+
+#if defined(ARCTIC_PLATFORM_WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif !defined(ARCTIC_PLATFORM_WEB)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ARCTIC_MAPPED_FILE_POSIX
+#endif
+
+namespace arctic {
+
+MappedFile::MappedFile(MappedFile &&other) noexcept {
+  MoveFrom(&other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Close();
+    MoveFrom(&other);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+void MappedFile::MoveFrom(MappedFile *other) {
+  data_ = other->data_;
+  size_ = other->size_;
+  is_open_ = other->is_open_;
+  is_copy_on_write_ = other->is_copy_on_write_;
+  mapping_ = other->mapping_;
+  mapping_handle_ = other->mapping_handle_;
+  pack_ = std::move(other->pack_);
+  copy_ = std::move(other->copy_);
+  if (!mapping_ && !pack_) {
+    data_ = copy_.data();
+  }
+  other->data_ = nullptr;
+  other->size_ = 0;
+  other->is_open_ = false;
+  other->is_copy_on_write_ = false;
+  other->mapping_ = nullptr;
+  other->mapping_handle_ = nullptr;
+  other->copy_.clear();
+}
+
+bool MappedFile::Open(const char *file_name, bool is_copy_on_write) {
+  Close();
+  is_copy_on_write_ = is_copy_on_write;
+  Ui32 entry = 0;
+  std::shared_ptr<AssetPack> pack = FindMountedAsset(file_name, &entry);
+  if (pack) {
+    if (!pack->IsDeflated(entry) && !is_copy_on_write) {
+      pack_ = std::move(pack);
+      data_ = pack_->GetStoredData(entry);
+      size_ = pack_->GetSize(entry);
+    } else if (pack->Read(entry, &copy_)) {
+      data_ = copy_.data();
+      size_ = copy_.size();
+    } else {
+      return false;
+    }
+    is_open_ = true;
+    return true;
+  }
+#if defined(ARCTIC_PLATFORM_WINDOWS)
+  HANDLE file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+      HANDLE handle = CreateFileMappingA(file, nullptr,
+        is_copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+      if (handle) {
+        void *view = MapViewOfFile(handle,
+          is_copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+        if (view) {
+          mapping_ = view;
+          mapping_handle_ = handle;
+          data_ = static_cast<const Ui8*>(view);
+          size_ = static_cast<Ui64>(size.QuadPart);
+          is_open_ = true;
+        } else {
+          CloseHandle(handle);
+        }
+      }
+    }
+    // The mapping keeps its own reference to the file
+    CloseHandle(file);
+    if (is_open_) {
+      return true;
+    }
+  }
+#elif defined(ARCTIC_MAPPED_FILE_POSIX)
+  int fd = open(file_name, O_RDONLY);
+  if (fd >= 0) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *view = mmap(nullptr, static_cast<size_t>(st.st_size),
+        is_copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ,
+        MAP_PRIVATE, fd, 0);
+      if (view != MAP_FAILED) {
+        mapping_ = view;
+        data_ = static_cast<const Ui8*>(view);
+        size_ = static_cast<Ui64>(st.st_size);
+        is_open_ = true;
+      }
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (is_open_) {
+      return true;
+    }
+  }
+#endif  // ARCTIC_PLATFORM_WINDOWS
+  std::ifstream in(file_name, std::ios_base::in | std::ios_base::binary);
+  if (!in.is_open()) {
+    return false;
+  }
+  in.seekg(0, std::ios_base::end);
+  std::streamoff size = in.tellg();
+  in.seekg(0, std::ios_base::beg);
+  if (size < 0) {
+    return false;
+  }
+  copy_.resize(static_cast<size_t>(size));
+  if (size > 0 && !in.read(reinterpret_cast<char*>(copy_.data()), size)) {
+    copy_.clear();
+    return false;
+  }
+  data_ = copy_.data();
+  size_ = static_cast<Ui64>(size);
+  is_open_ = true;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (mapping_) {
+#if defined(ARCTIC_PLATFORM_WINDOWS)
+    UnmapViewOfFile(mapping_);
+    CloseHandle(static_cast<HANDLE>(mapping_handle_));
+#elif defined(ARCTIC_MAPPED_FILE_POSIX)
+    munmap(mapping_, static_cast<size_t>(size_));
+#endif  // ARCTIC_PLATFORM_WINDOWS
+  }
+  data_ = nullptr;
+  size_ = 0;
+  is_open_ = false;
+  is_copy_on_write_ = false;
+  mapping_ = nullptr;
+  mapping_handle_ = nullptr;
+  pack_ = nullptr;
+  std::vector<Ui8>().swap(copy_);
+}
+
+Ui8 *MappedFile::MutableData() {
+  Check(is_copy_on_write_,
+    "MappedFile::MutableData Error. The file is not opened copy-on-write.");
+  return const_cast<Ui8*>(data_);
+}
+
+}  // namespace arctic
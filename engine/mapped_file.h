@@ -0,0 +1,111 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_MAPPED_FILE_H_
+#define ENGINE_MAPPED_FILE_H_
+
+#include <memory>
+#include <vector>
+
+#include "engine/arctic_types.h"
+
+namespace arctic {
+
+class AssetPack;
+
+/// @addtogroup global_files
+/// @{
+
+/// @brief Read-only view of a whole file mapped into memory
+///
+/// Uses mmap on Linux and macOS and a file mapping on Windows, pages are
+/// read on first access. Where mapping is not available, or the file is
+/// empty, the file is read into memory instead. A file opened copy-on-write
+/// can be modified in memory, the changes never reach the disk. Files in
+/// the mounted asset packs are found first, the entries stored as they are
+/// are used from the mapping of the pack.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile &operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  ~MappedFile();
+
+  /// @brief Maps a file, closing the previously mapped one
+  /// @param file_name Path to the file
+  /// @param is_copy_on_write If true, MutableData may be used
+  /// @return True on success
+  bool Open(const char *file_name, bool is_copy_on_write = false);
+
+  /// @brief Unmaps the file
+  void Close();
+
+  /// @brief Returns true if a file is open
+  bool IsOpen() const {
+    return is_open_;
+  }
+
+  /// @brief Returns true if the file is opened copy-on-write
+  bool IsCopyOnWrite() const {
+    return is_copy_on_write_;
+  }
+
+  /// @brief Returns true if the data is a mapping rather than a copy
+  bool IsMapped() const {
+    return mapping_ != nullptr || pack_ != nullptr;
+  }
+
+  /// @brief Returns the file contents, valid until Close
+  const Ui8 *Data() const {
+    return data_;
+  }
+
+  /// @brief Returns the writable private copy of the file contents,
+  /// the file must be opened copy-on-write
+  Ui8 *MutableData();
+
+  /// @brief Returns the file size in bytes
+  Ui64 Size() const {
+    return size_;
+  }
+
+ private:
+  void MoveFrom(MappedFile *other);
+
+  const Ui8 *data_ = nullptr;
+  Ui64 size_ = 0;
+  bool is_open_ = false;
+  bool is_copy_on_write_ = false;
+  void *mapping_ = nullptr;
+  void *mapping_handle_ = nullptr;
+  /// Keeps the pack mapped while the data points into it
+  std::shared_ptr<AssetPack> pack_;
+  std::vector<Ui8> copy_;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_MAPPED_FILE_H_
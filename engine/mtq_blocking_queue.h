@@ -0,0 +1,119 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+//
+// BlockingQueue wraps any mtq queue with a pointer dequeue API
+// (dequeue() returns nullptr when empty) or a bool dequeue(Item*) API
+// and lets consumers sleep while the queue is empty.
+//
+// Usage example:
+//   BlockingQueue<MpscVirtInfArray<Job*>> queue;
+//   queue.Enqueue(job);          // producer, no syscall if nobody sleeps
+//   Job *job = queue.Dequeue();  // consumer, sleeps until a job arrives
+//
+
+#ifndef ENGINE_MTQ_BLOCKING_QUEUE_H_
+#define ENGINE_MTQ_BLOCKING_QUEUE_H_
+
+#include <utility>
+
+#include "engine/mtq_event_count.h"
+
+namespace arctic {
+
+template <class TQueue>
+class BlockingQueue {
+  TQueue queue_;
+  EventCount event_count_;
+
+  struct NotifyOnExit {
+    EventCount &event_count;
+    ~NotifyOnExit() {
+      event_count.Notify();
+    }
+  };
+
+ public:
+  template <class... Args>
+  explicit BlockingQueue(Args&&... args)
+    : queue_(std::forward<Args>(args)...) {
+  }
+
+  /// @brief Enqueues the item and wakes up one sleeping consumer
+  /// @return Whatever the underlying queue enqueue returns
+  template <class TItem>
+  decltype(auto) Enqueue(TItem &&item) {
+    NotifyOnExit notify{event_count_};
+    return queue_.enqueue(std::forward<TItem>(item));
+  }
+
+  /// @brief Dequeues an item without blocking (pointer API)
+  /// @return The item or nullptr if the queue is empty
+  auto TryDequeue() {
+    return queue_.dequeue();
+  }
+
+  /// @brief Dequeues an item without blocking (bool API)
+  template <class TItem>
+  bool TryDequeue(TItem *item) {
+    return queue_.dequeue(item);
+  }
+
+  /// @brief Dequeues an item, sleeps while the queue is empty (pointer API)
+  auto Dequeue() {
+    while (true) {
+      auto item = queue_.dequeue();
+      if (item) {
+        return item;
+      }
+      Ui32 key = event_count_.PrepareWait();
+      item = queue_.dequeue();
+      if (item) {
+        event_count_.CancelWait();
+        return item;
+      }
+      event_count_.CommitWait(key);
+    }
+  }
+
+  /// @brief Dequeues an item, sleeps while the queue is empty (bool API)
+  template <class TItem>
+  void Dequeue(TItem *item) {
+    while (!queue_.dequeue(item)) {
+      Ui32 key = event_count_.PrepareWait();
+      if (queue_.dequeue(item)) {
+        event_count_.CancelWait();
+        return;
+      }
+      event_count_.CommitWait(key);
+    }
+  }
+
+  /// @brief Returns the underlying queue
+  TQueue &Queue() {
+    return queue_;
+  }
+};
+
+}  // namespace arctic
+
+#endif  // ENGINE_MTQ_BLOCKING_QUEUE_H_
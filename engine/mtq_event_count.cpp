@@ -0,0 +1,82 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/mtq_event_count.h"
+
+#include <climits>
+
+#ifdef ARCTIC_PLATFORM_PI
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // ARCTIC_PLATFORM_PI
+
+namespace arctic {
+
+#ifdef ARCTIC_PLATFORM_PI
+
+static_assert(sizeof(std::atomic<Ui32>) == sizeof(Ui32),
+  "futex requires a plain 32-bit atomic");
+
+void EventCount::CommitWait(Ui32 key) noexcept {
+  while (epoch_.load(MO_ACQUIRE) == key) {
+    // Returns immediately with EAGAIN if the epoch has already changed.
+    syscall(SYS_futex, reinterpret_cast<Ui32*>(&epoch_),
+      FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+  }
+  waiters_.fetch_sub(1, MO_SEQUENCE);
+}
+
+void EventCount::DoNotify(bool is_all) noexcept {
+  epoch_.fetch_add(1, MO_ACQUIRE_RELEASE);
+  syscall(SYS_futex, reinterpret_cast<Ui32*>(&epoch_),
+    FUTEX_WAKE_PRIVATE, is_all ? INT_MAX : 1, nullptr, nullptr, 0);
+}
+
+#else  // ARCTIC_PLATFORM_PI
+
+void EventCount::CommitWait(Ui32 key) noexcept {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (epoch_.load(MO_ACQUIRE) == key) {
+      condvar_.wait(lock);
+    }
+  }
+  waiters_.fetch_sub(1, MO_SEQUENCE);
+}
+
+void EventCount::DoNotify(bool is_all) noexcept {
+  {
+    // Taking the mutex orders the epoch change with the waiter's check.
+    std::lock_guard<std::mutex> lock(mutex_);
+    epoch_.fetch_add(1, MO_ACQUIRE_RELEASE);
+  }
+  if (is_all) {
+    condvar_.notify_all();
+  } else {
+    condvar_.notify_one();
+  }
+}
+
+#endif  // ARCTIC_PLATFORM_PI
+
+}  // namespace arctic
@@ -0,0 +1,95 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+//
+// EventCount is a condition variable for lock-free data structures.
+// A consumer that found the queue empty calls PrepareWait(), checks the
+// queue again and then either calls CancelWait() or CommitWait(key).
+// Notify() costs one fence and one load when there are no waiters,
+// so producers never make a syscall on the fast path.
+//
+
+#ifndef ENGINE_MTQ_EVENT_COUNT_H_
+#define ENGINE_MTQ_EVENT_COUNT_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <mutex>  // NOLINT
+
+#include "engine/arctic_platform_def.h"
+#include "engine/mtq_base_common.h"
+
+namespace arctic {
+
+class EventCount {
+ public:
+  EventCount() = default;
+  EventCount(const EventCount&) = delete;
+  EventCount &operator=(const EventCount&) = delete;
+
+  /// @brief Registers the calling thread as a waiter
+  /// @return The key to pass to CommitWait
+  Ui32 PrepareWait() noexcept {
+    waiters_.fetch_add(1, MO_SEQUENCE);
+    std::atomic_thread_fence(MO_SEQUENCE);
+    return epoch_.load(MO_ACQUIRE);
+  }
+
+  /// @brief Unregisters the calling thread, the awaited condition became true
+  void CancelWait() noexcept {
+    waiters_.fetch_sub(1, MO_SEQUENCE);
+  }
+
+  /// @brief Blocks until Notify or NotifyAll is called after PrepareWait
+  /// @param key The value returned by PrepareWait
+  void CommitWait(Ui32 key) noexcept;
+
+  /// @brief Wakes up one waiting thread, if any
+  void Notify() noexcept {
+    std::atomic_thread_fence(MO_SEQUENCE);
+    if (waiters_.load(MO_RELAXED) != 0) {
+      DoNotify(false);
+    }
+  }
+
+  /// @brief Wakes up all waiting threads
+  void NotifyAll() noexcept {
+    std::atomic_thread_fence(MO_SEQUENCE);
+    if (waiters_.load(MO_RELAXED) != 0) {
+      DoNotify(true);
+    }
+  }
+
+ private:
+  void DoNotify(bool is_all) noexcept;
+
+  std::atomic<Ui32> epoch_ = ATOMIC_VAR_INIT(0);
+  std::atomic<Ui32> waiters_ = ATOMIC_VAR_INIT(0);
+#ifndef ARCTIC_PLATFORM_PI
+  std::mutex mutex_;
+  std::condition_variable condvar_;
+#endif  // ARCTIC_PLATFORM_PI
+};
+
+}  // namespace arctic
+
+#endif  // ENGINE_MTQ_EVENT_COUNT_H_
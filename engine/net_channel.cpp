@@ -0,0 +1,534 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/net_channel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "engine/arctic_platform_fatal.h"
+
+namespace arctic {
+
+namespace {
+
+const double kInitialResendTimeout = 0.25;
+const double kMinResendTimeout = 0.02;
+const double kMaxResendTimeout = 1.0;
+// Set in the ack bits word once the sender has received any packet
+const Ui32 kHasAckFlag = 0x80000000u;
+// Received packet ring entries are the sequence and these flags
+const Ui32 kReceivedFlag = 0x10000u;
+const Ui32 kAckedFlag = 0x20000u;
+const Ui32 kMaxMtu = 16383;
+
+bool IsSequenceNewer(Ui16 lhs, Ui16 rhs) {
+  return lhs != rhs && static_cast<Ui16>(lhs - rhs) < 0x8000u;
+}
+
+void PutUint16(Ui16 value, Ui8 *out) {
+  out[0] = static_cast<Ui8>(value);
+  out[1] = static_cast<Ui8>(value >> 8);
+}
+
+void PutUint32(Ui32 value, Ui8 *out) {
+  out[0] = static_cast<Ui8>(value);
+  out[1] = static_cast<Ui8>(value >> 8);
+  out[2] = static_cast<Ui8>(value >> 16);
+  out[3] = static_cast<Ui8>(value >> 24);
+}
+
+Ui16 GetUint16(const Ui8 *in) {
+  return static_cast<Ui16>(in[0] | (in[1] << 8));
+}
+
+Ui32 GetUint32(const Ui8 *in) {
+  return static_cast<Ui32>(in[0]) | (static_cast<Ui32>(in[1]) << 8) |
+    (static_cast<Ui32>(in[2]) << 16) | (static_cast<Ui32>(in[3]) << 24);
+}
+
+}  // namespace
+
+NetConnection::NetConnection(Ui32 mtu)
+    : mtu_(mtu)
+    , sent_ring_(kWindowSize)
+    , received_ring_(kWindowSize) {
+  Check(mtu >= 64 && mtu <= kMaxMtu,
+    "NetConnection mtu must be in 64 to 16383 range");
+}
+
+Si32 NetConnection::AddChannel(NetDelivery delivery) {
+  Check(channels_.size() < 256, "NetConnection supports up to 256 channels");
+  channels_.emplace_back();
+  Channel &channel = channels_.back();
+  channel.delivery = delivery;
+  channel.send_ring.resize(kWindowSize);
+  if (IsReliable(delivery)) {
+    channel.receive_ring.resize(kWindowSize);
+  }
+  return static_cast<Si32>(channels_.size() - 1);
+}
+
+Ui32 NetConnection::GetMaxMessageSize() const {
+  // Channel byte, two byte size and two byte id
+  return mtu_ - kHeaderSize - 5;
+}
+
+Ui32 NetConnection::GetMessageOverhead(const Channel &channel,
+    Ui32 size) const {
+  return 1 + (size < 0x80 ? 1 : 2) + (IsReliable(channel.delivery) ? 2 : 0);
+}
+
+bool NetConnection::Send(Si32 channel_idx, const void *data, Ui32 size) {
+  Check(channel_idx >= 0 && channel_idx < static_cast<Si32>(channels_.size()),
+    "NetConnection::Send channel index is out of range");
+  if (size > GetMaxMessageSize()) {
+    return false;
+  }
+  Channel &channel = channels_[static_cast<size_t>(channel_idx)];
+  const Ui8 *bytes = static_cast<const Ui8*>(data);
+  if (IsReliable(channel.delivery)) {
+    if (static_cast<Ui16>(channel.next_send_id - channel.oldest_unacked_id)
+        >= kWindowSize) {
+      return false;
+    }
+    SendEntry &entry = channel.send_ring[channel.next_send_id % kWindowSize];
+    entry.data.assign(bytes, bytes + size);
+    entry.id = channel.next_send_id;
+    entry.is_pending = true;
+    entry.last_sent_time = -1.0;
+    ++channel.next_send_id;
+    return true;
+  }
+  if (channel.queue_tail - channel.queue_head >= kWindowSize) {
+    return false;
+  }
+  SendEntry &entry = channel.send_ring[channel.queue_tail % kWindowSize];
+  entry.data.assign(bytes, bytes + size);
+  ++channel.queue_tail;
+  return true;
+}
+
+void NetConnection::WriteMessage(Ui32 channel_idx, Ui16 id,
+    const std::vector<Ui8> &data, std::vector<Ui8> *out_packet) const {
+  Ui32 size = static_cast<Ui32>(data.size());
+  out_packet->push_back(static_cast<Ui8>(channel_idx));
+  if (size < 0x80) {
+    out_packet->push_back(static_cast<Ui8>(size));
+  } else {
+    out_packet->push_back(static_cast<Ui8>(0x80 | (size & 0x7f)));
+    out_packet->push_back(static_cast<Ui8>(size >> 7));
+  }
+  if (IsReliable(channels_[channel_idx].delivery)) {
+    out_packet->push_back(static_cast<Ui8>(id));
+    out_packet->push_back(static_cast<Ui8>(id >> 8));
+  }
+  out_packet->insert(out_packet->end(), data.begin(), data.end());
+}
+
+bool NetConnection::WritePacket(double time, std::vector<Ui8> *out_packet) {
+  out_packet->resize(kHeaderSize);
+  Ui16 sequence = next_sequence_;
+  SentPacket &sent = sent_ring_[sequence % kWindowSize];
+  sent.messages.clear();
+  bool has_messages = false;
+  const double resend_timeout = GetResendTimeout();
+  const double reordering_timeout = std::min(resend_timeout, rtt_ * 1.25);
+
+  // Reliable messages first, a resend is due when the packet it went in
+  // wasn't acked in time or a later packet was
+  for (Ui32 channel_idx = 0; channel_idx < channels_.size(); ++channel_idx) {
+    Channel &channel = channels_[channel_idx];
+    if (!IsReliable(channel.delivery)) {
+      continue;
+    }
+    for (Ui16 id = channel.oldest_unacked_id; id != channel.next_send_id &&
+        out_packet->size() + 4 < mtu_; ++id) {
+      SendEntry &entry = channel.send_ring[id % kWindowSize];
+      if (!entry.is_pending) {
+        continue;
+      }
+      if (entry.last_sent_time >= 0.0) {
+        double age = time - entry.last_sent_time;
+        if (age < reordering_timeout || (age < resend_timeout &&
+            (!has_rtt_ || !IsSequenceNewer(newest_acked_sequence_,
+              entry.packet_sequence)))) {
+          continue;
+        }
+      }
+      Ui32 size = static_cast<Ui32>(entry.data.size());
+      if (out_packet->size() + GetMessageOverhead(channel, size) + size >
+          mtu_) {
+        continue;
+      }
+      if (entry.last_sent_time >= 0.0) {
+        ++stats_.messages_resent;
+      }
+      WriteMessage(channel_idx, id, entry.data, out_packet);
+      entry.last_sent_time = time;
+      entry.packet_sequence = sequence;
+      sent.messages.push_back(MessageRef{static_cast<Ui16>(channel_idx), id});
+      ++stats_.messages_sent;
+      has_messages = true;
+    }
+  }
+
+  for (Ui32 channel_idx = 0; channel_idx < channels_.size(); ++channel_idx) {
+    Channel &channel = channels_[channel_idx];
+    if (IsReliable(channel.delivery)) {
+      continue;
+    }
+    while (channel.queue_head != channel.queue_tail) {
+      SendEntry &entry = channel.send_ring[channel.queue_head % kWindowSize];
+      Ui32 size = static_cast<Ui32>(entry.data.size());
+      if (out_packet->size() + GetMessageOverhead(channel, size) + size >
+          mtu_) {
+        break;
+      }
+      WriteMessage(channel_idx, 0, entry.data, out_packet);
+      ++channel.queue_head;
+      ++stats_.messages_sent;
+      has_messages = true;
+    }
+  }
+
+  bool is_ack_pending = HasUnackedReceived();
+  if (!has_messages && !is_ack_pending) {
+    out_packet->clear();
+    return false;
+  }
+  Ui16 ack = remote_sequence_;
+  if (is_ack_pending &&
+      static_cast<Ui16>(remote_sequence_ - ack_cursor_) > 31) {
+    // Older packets of a burst first, the next packet acks the rest
+    ack = static_cast<Ui16>(ack_cursor_ + 31);
+    while (!IsReceived(ack)) {
+      --ack;
+    }
+  }
+  Ui32 ack_bits = 0;
+  if (has_received_) {
+    ack_bits = kHasAckFlag;
+    received_ring_[ack % kWindowSize] |= kAckedFlag;
+    for (Ui32 bit = 0; bit < 31; ++bit) {
+      Ui16 acked = static_cast<Ui16>(ack - 1 - bit);
+      if (IsReceived(acked)) {
+        ack_bits |= 1u << bit;
+        received_ring_[acked % kWindowSize] |= kAckedFlag;
+      }
+    }
+  }
+  Ui8 *header = out_packet->data();
+  PutUint16(sequence, header);
+  PutUint16(ack, header + 2);
+  PutUint32(ack_bits, header + 4);
+  sent.sequence = sequence;
+  sent.time = time;
+  sent.is_valid = true;
+  ++next_sequence_;
+  ++stats_.packets_sent;
+  return true;
+}
+
+bool NetConnection::IsReceived(Ui16 sequence) const {
+  return (received_ring_[sequence % kWindowSize] & ~kAckedFlag) ==
+    (kReceivedFlag | sequence);
+}
+
+bool NetConnection::HasUnackedReceived() {
+  if (!has_received_) {
+    return false;
+  }
+  Ui16 end = static_cast<Ui16>(remote_sequence_ + 1);
+  while (ack_cursor_ != end) {
+    Ui32 entry = received_ring_[ack_cursor_ % kWindowSize];
+    if (IsReceived(ack_cursor_) && !(entry & kAckedFlag)) {
+      return true;
+    }
+    ++ack_cursor_;
+  }
+  return false;
+}
+
+bool NetConnection::ReadPacket(double time, const Ui8 *data, size_t size) {
+  if (size < kHeaderSize || size > kMaxMtu) {
+    return false;
+  }
+  Ui16 sequence = GetUint16(data);
+  Ui16 ack = GetUint16(data + 2);
+  Ui32 ack_bits = GetUint32(data + 4);
+
+  // Parse everything first so that a malformed packet changes nothing
+  parsed_.clear();
+  size_t pos = kHeaderSize;
+  while (pos < size) {
+    ParsedMessage message;
+    message.channel = data[pos++];
+    if (message.channel >= channels_.size() || pos >= size) {
+      return false;
+    }
+    message.size = data[pos++];
+    if (message.size & 0x80) {
+      if (pos >= size) {
+        return false;
+      }
+      message.size = (message.size & 0x7f) |
+        (static_cast<Ui32>(data[pos++]) << 7);
+    }
+    message.id = 0;
+    if (IsReliable(channels_[message.channel].delivery)) {
+      if (pos + 2 > size) {
+        return false;
+      }
+      message.id = GetUint16(data + pos);
+      pos += 2;
+    }
+    if (message.size > size - pos) {
+      return false;
+    }
+    message.data = data + pos;
+    pos += message.size;
+    parsed_.push_back(message);
+  }
+
+  bool is_stale = false;
+  if (!has_received_) {
+    has_received_ = true;
+    remote_sequence_ = sequence;
+    ack_cursor_ = sequence;
+  } else if (IsSequenceNewer(sequence, remote_sequence_)) {
+    remote_sequence_ = sequence;
+    if (static_cast<Ui16>(remote_sequence_ - ack_cursor_) >= kWindowSize) {
+      ack_cursor_ = static_cast<Ui16>(remote_sequence_ - kWindowSize + 1);
+    }
+  } else if (IsReceived(sequence)) {
+    return false;
+  } else if (static_cast<Ui16>(remote_sequence_ - sequence) >= kWindowSize) {
+    // Too old to ack or to tell from a duplicate, reliable messages are
+    // still useful as they are checked by id
+    is_stale = true;
+  }
+  if (!is_stale) {
+    // Packets without messages need no ack
+    received_ring_[sequence % kWindowSize] = kReceivedFlag | sequence |
+      (parsed_.empty() ? kAckedFlag : 0u);
+    if (!parsed_.empty() && IsSequenceNewer(ack_cursor_, sequence)) {
+      ack_cursor_ = sequence;
+    }
+  }
+  ++stats_.packets_received;
+
+  if (ack_bits & kHasAckFlag) {
+    AckPacket(time, ack);
+    for (Ui32 bit = 0; bit < 31; ++bit) {
+      if (ack_bits & (1u << bit)) {
+        AckPacket(time, static_cast<Ui16>(ack - 1 - bit));
+      }
+    }
+  }
+
+  for (const ParsedMessage &message : parsed_) {
+    if (IsReliable(channels_[message.channel].delivery)) {
+      DeliverReliable(message.channel, message.id, message.data,
+        message.size);
+    } else if (!is_stale) {
+      PushDelivered(message.channel).assign(message.data,
+        message.data + message.size);
+    }
+  }
+  return true;
+}
+
+void NetConnection::AckPacket(double time, Ui16 sequence) {
+  SentPacket &sent = sent_ring_[sequence % kWindowSize];
+  if (!sent.is_valid || sent.sequence != sequence) {
+    return;
+  }
+  sent.is_valid = false;
+  ++stats_.packets_acked;
+
+  double sample = std::max(0.0, time - sent.time);
+  if (!has_rtt_ || IsSequenceNewer(sequence, newest_acked_sequence_)) {
+    newest_acked_sequence_ = sequence;
+  }
+  if (!has_rtt_) {
+    has_rtt_ = true;
+    rtt_ = sample;
+    rtt_variance_ = sample * 0.5;
+  } else {
+    rtt_variance_ = 0.75 * rtt_variance_ + 0.25 * std::fabs(rtt_ - sample);
+    rtt_ = 0.875 * rtt_ + 0.125 * sample;
+  }
+
+  for (const MessageRef &ref : sent.messages) {
+    Channel &channel = channels_[ref.channel];
+    SendEntry &entry = channel.send_ring[ref.id % kWindowSize];
+    if (entry.is_pending && entry.id == ref.id) {
+      entry.is_pending = false;
+    }
+    while (channel.oldest_unacked_id != channel.next_send_id &&
+        !channel.send_ring[channel.oldest_unacked_id % kWindowSize]
+          .is_pending) {
+      ++channel.oldest_unacked_id;
+    }
+  }
+}
+
+void NetConnection::DeliverReliable(Ui32 channel_idx, Ui16 id,
+    const Ui8 *data, Ui32 size) {
+  Channel &channel = channels_[channel_idx];
+  // Older ids are delivered already, the sender never gets further ahead
+  if (static_cast<Ui16>(id - channel.next_receive_id) >= kWindowSize) {
+    return;
+  }
+  ReceiveEntry &entry = channel.receive_ring[id % kWindowSize];
+  if (entry.is_received) {
+    return;
+  }
+  if (channel.delivery == NetDelivery::kReliableOrdered) {
+    if (id != channel.next_receive_id) {
+      entry.data.assign(data, data + size);
+      entry.is_received = true;
+      return;
+    }
+    PushDelivered(channel_idx).assign(data, data + size);
+    ++channel.next_receive_id;
+    while (true) {
+      ReceiveEntry &next =
+        channel.receive_ring[channel.next_receive_id % kWindowSize];
+      if (!next.is_received) {
+        break;
+      }
+      std::swap(PushDelivered(channel_idx), next.data);
+      next.is_received = false;
+      ++channel.next_receive_id;
+    }
+    return;
+  }
+  PushDelivered(channel_idx).assign(data, data + size);
+  entry.is_received = true;
+  while (true) {
+    ReceiveEntry &next =
+      channel.receive_ring[channel.next_receive_id % kWindowSize];
+    if (!next.is_received) {
+      break;
+    }
+    next.is_received = false;
+    ++channel.next_receive_id;
+  }
+}
+
+std::vector<Ui8> &NetConnection::PushDelivered(Ui32 channel_idx) {
+  if (delivered_head_ == delivered_tail_) {
+    delivered_head_ = 0;
+    delivered_tail_ = 0;
+  }
+  if (delivered_tail_ == delivered_.size()) {
+    delivered_.emplace_back();
+  }
+  Delivered &delivered = delivered_[delivered_tail_++];
+  delivered.channel = static_cast<Si32>(channel_idx);
+  ++stats_.messages_received;
+  return delivered.data;
+}
+
+bool NetConnection::Receive(Si32 *out_channel, std::vector<Ui8> *out_data) {
+  if (delivered_head_ == delivered_tail_) {
+    return false;
+  }
+  Delivered &delivered = delivered_[delivered_head_++];
+  *out_channel = delivered.channel;
+  std::swap(*out_data, delivered.data);
+  return true;
+}
+
+double NetConnection::GetResendTimeout() const {
+  if (!has_rtt_) {
+    return kInitialResendTimeout;
+  }
+  return std::min(kMaxResendTimeout,
+    std::max(kMinResendTimeout, rtt_ + 4.0 * rtt_variance_));
+}
+
+Ui32 NetConnection::GetUnackedCount(Si32 channel_idx) const {
+  const Channel &channel = channels_[static_cast<size_t>(channel_idx)];
+  return static_cast<Ui16>(channel.next_send_id - channel.oldest_unacked_id);
+}
+
+NetLinkSimulator::NetLinkSimulator(const NetLinkConfig &config, Ui64 seed)
+    : config_(config)
+    , random_state_(seed * 0x9E3779B97F4A7C15ull | 1ull) {
+}
+
+bool NetLinkSimulator::IsLaterArrival(const InFlight &lhs,
+    const InFlight &rhs) {
+  return lhs.arrival_time > rhs.arrival_time ||
+    (lhs.arrival_time == rhs.arrival_time && lhs.order > rhs.order);
+}
+
+double NetLinkSimulator::NextRandom() {
+  random_state_ ^= random_state_ >> 12;
+  random_state_ ^= random_state_ << 25;
+  random_state_ ^= random_state_ >> 27;
+  Ui64 value = random_state_ * 0x2545F4914F6CDD1Dull;
+  return static_cast<double>(value >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void NetLinkSimulator::Push(double arrival_time, const Ui8 *data,
+    size_t size) {
+  in_flight_.emplace_back();
+  InFlight &packet = in_flight_.back();
+  packet.arrival_time = arrival_time;
+  packet.order = next_order_++;
+  if (!free_buffers_.empty()) {
+    packet.data = std::move(free_buffers_.back());
+    free_buffers_.pop_back();
+  }
+  packet.data.assign(data, data + size);
+  std::push_heap(in_flight_.begin(), in_flight_.end(), IsLaterArrival);
+}
+
+void NetLinkSimulator::Send(double time, const Ui8 *data, size_t size) {
+  if (NextRandom() < config_.loss) {
+    return;
+  }
+  Si32 copies = NextRandom() < config_.duplicate ? 2 : 1;
+  for (Si32 idx = 0; idx < copies; ++idx) {
+    double delay = config_.latency +
+      config_.jitter * (NextRandom() * 2.0 - 1.0);
+    Push(time + std::max(0.0, delay), data, size);
+  }
+}
+
+bool NetLinkSimulator::Receive(double time, std::vector<Ui8> *out_packet) {
+  if (in_flight_.empty() || in_flight_.front().arrival_time > time) {
+    return false;
+  }
+  std::pop_heap(in_flight_.begin(), in_flight_.end(), IsLaterArrival);
+  std::swap(*out_packet, in_flight_.back().data);
+  free_buffers_.push_back(std::move(in_flight_.back().data));
+  in_flight_.pop_back();
+  return true;
+}
+
+}  // namespace arctic
@@ -0,0 +1,277 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_NET_CHANNEL_H_
+#define ENGINE_NET_CHANNEL_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "engine/arctic_types.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Delivery guarantee of a NetConnection channel
+enum class NetDelivery {
+  kUnreliable = 0,  ///< Delivered at most once, may be lost or reordered
+  kReliableUnordered = 1,  ///< Delivered exactly once as soon as it arrives
+  kReliableOrdered = 2  ///< Delivered exactly once in the order sent
+};
+
+struct NetConnectionStats {
+  Ui64 packets_sent = 0;
+  Ui64 packets_received = 0;
+  Ui64 packets_acked = 0;
+  Ui64 messages_sent = 0;  ///< Messages written to packets, resends included
+  Ui64 messages_resent = 0;
+  Ui64 messages_received = 0;  ///< Messages delivered to Receive
+};
+
+/// @brief One end of a message connection over an unreliable datagram
+/// transport
+///
+/// Does no IO, the caller moves packets between WritePacket/ReadPacket and
+/// a DatagramSocket or a NetLinkSimulator. Messages of all channels are
+/// coalesced into packets of up to mtu bytes. Every packet carries a
+/// sequence number and acks for 32 packets received, reliable
+/// messages are sent again when the packet they went in isn't acked within
+/// the resend timeout derived from the measured round trip time, or
+/// sooner when a packet sent later was acked and a quarter of the round
+/// trip time has passed since it should have been. Sent
+/// packets, reliable messages and out of order arrivals are kept in ring
+/// buffers of kWindowSize entries, so handling an ack is O(1). A burst of
+/// more than 32 packets is acked by several packets.
+/// Example:
+/// @code
+///   NetConnection connection;
+///   Si32 chat = connection.AddChannel(NetDelivery::kReliableOrdered);
+///   connection.Send(chat, text.data(), text.size());
+///   while (connection.WritePacket(time, &packet)) {
+///     socket.SendTo(peer, packet.data(), packet.size(), &size);
+///   }
+///   ... connection.ReadPacket(time, data, size) for every datagram
+///   while (connection.Receive(&channel, &message)) { ... }
+/// @endcode
+/// Both ends must add the same channels in the same order.
+class NetConnection {
+ public:
+  /// Reliable messages in flight per channel and packets tracked for acks
+  static const Ui32 kWindowSize = 1024;
+  /// Packet header, sequence, latest ack and a word of 31 more ack bits
+  /// with the top bit set once anything was received
+  static const Ui32 kHeaderSize = 8;
+
+  /// @param mtu The largest packet written, 1200 bytes passes practically
+  /// every path on the internet
+  explicit NetConnection(Ui32 mtu = 1200);
+
+  /// @brief Adds a channel and returns its index
+  Si32 AddChannel(NetDelivery delivery);
+
+  /// @brief Returns the largest message Send accepts
+  Ui32 GetMaxMessageSize() const;
+
+  /// @brief Queues a message
+  /// @return False if the message is too large or the channel has
+  /// kWindowSize messages waiting for acks
+  bool Send(Si32 channel, const void *data, Ui32 size);
+
+  /// @brief Writes the next packet to send
+  /// @param time The current time in seconds
+  /// @param out_packet The packet, up to mtu bytes
+  /// @return False if there is nothing to send, call until it returns false
+  bool WritePacket(double time, std::vector<Ui8> *out_packet);
+
+  /// @brief Processes a received packet
+  /// @param time The current time in seconds
+  /// @return False if the packet is malformed or a duplicate. Packets more
+  /// than 31 behind the newest one deliver only their reliable messages.
+  bool ReadPacket(double time, const Ui8 *data, size_t size);
+
+  /// @brief Pops a delivered message
+  /// @param out_channel The channel the message was sent on
+  /// @param out_data The message, its storage is swapped with an internal
+  /// buffer to avoid copying
+  /// @return False if there are no messages
+  bool Receive(Si32 *out_channel, std::vector<Ui8> *out_data);
+
+  /// @brief Returns the smoothed round trip time in seconds, 0 before the
+  /// first ack
+  double GetRtt() const {
+    return rtt_;
+  }
+
+  /// @brief Returns the time after which an unacked message is resent
+  double GetResendTimeout() const;
+
+  /// @brief Returns the number of reliable messages in the send window,
+  /// from the oldest one not acked yet to the newest one
+  Ui32 GetUnackedCount(Si32 channel) const;
+
+  const NetConnectionStats &GetStats() const {
+    return stats_;
+  }
+
+ private:
+  struct SendEntry {
+    std::vector<Ui8> data;
+    double last_sent_time = -1.0;
+    Ui16 id = 0;
+    Ui16 packet_sequence = 0;  ///< The packet it was last sent in
+    bool is_pending = false;
+  };
+
+  struct ReceiveEntry {
+    std::vector<Ui8> data;
+    bool is_received = false;
+  };
+
+  struct Channel {
+    NetDelivery delivery;
+    // Reliable messages in [oldest_unacked_id, next_send_id)
+    Ui16 next_send_id = 0;
+    Ui16 oldest_unacked_id = 0;
+    std::vector<SendEntry> send_ring;
+    // Unreliable messages in [queue_head, queue_tail)
+    Ui32 queue_head = 0;
+    Ui32 queue_tail = 0;
+    // Reliable messages received out of order in [next_receive_id, ...)
+    Ui16 next_receive_id = 0;
+    std::vector<ReceiveEntry> receive_ring;
+  };
+
+  struct MessageRef {
+    Ui16 channel;
+    Ui16 id;
+  };
+
+  struct SentPacket {
+    double time = 0.0;
+    Ui16 sequence = 0;
+    bool is_valid = false;
+    std::vector<MessageRef> messages;
+  };
+
+  struct ParsedMessage {
+    Ui32 channel;
+    Ui16 id;
+    const Ui8 *data;
+    Ui32 size;
+  };
+
+  struct Delivered {
+    Si32 channel;
+    std::vector<Ui8> data;
+  };
+
+  static bool IsReliable(NetDelivery delivery) {
+    return delivery != NetDelivery::kUnreliable;
+  }
+
+  Ui32 GetMessageOverhead(const Channel &channel, Ui32 size) const;
+  void WriteMessage(Ui32 channel_idx, Ui16 id, const std::vector<Ui8> &data,
+    std::vector<Ui8> *out_packet) const;
+  bool IsReceived(Ui16 sequence) const;
+  bool HasUnackedReceived();
+  void AckPacket(double time, Ui16 sequence);
+  void DeliverReliable(Ui32 channel_idx, Ui16 id, const Ui8 *data,
+    Ui32 size);
+  std::vector<Ui8> &PushDelivered(Ui32 channel_idx);
+
+  Ui32 mtu_;
+  std::vector<Channel> channels_;
+  std::vector<SentPacket> sent_ring_;
+  Ui16 next_sequence_ = 0;
+
+  bool has_received_ = false;
+  Ui16 remote_sequence_ = 0;
+  // Received packets that carried messages and weren't acked yet start here
+  Ui16 ack_cursor_ = 0;
+  std::vector<Ui32> received_ring_;
+
+  bool has_rtt_ = false;
+  Ui16 newest_acked_sequence_ = 0;
+  double rtt_ = 0.0;
+  double rtt_variance_ = 0.0;
+
+  std::vector<ParsedMessage> parsed_;
+  std::vector<Delivered> delivered_;
+  size_t delivered_head_ = 0;
+  size_t delivered_tail_ = 0;
+  NetConnectionStats stats_;
+};
+
+struct NetLinkConfig {
+  double loss = 0.0;  ///< Probability a packet is dropped, 0 to 1
+  double duplicate = 0.0;  ///< Probability a packet arrives twice
+  double latency = 0.0;  ///< One way delay in seconds
+  double jitter = 0.0;  ///< Random extra delay of up to +-jitter seconds
+};
+
+/// @brief One direction of a simulated lossy link for testing NetConnection
+/// without sockets
+///
+/// Packets are delivered in the order of their random arrival times, so
+/// jitter larger than the interval between packets reorders them.
+class NetLinkSimulator {
+ public:
+  explicit NetLinkSimulator(const NetLinkConfig &config, Ui64 seed = 1);
+
+  /// @brief Puts a packet on the link at the given time
+  void Send(double time, const Ui8 *data, size_t size);
+
+  /// @brief Takes a packet that has arrived by the given time
+  /// @return False if no packet has arrived
+  bool Receive(double time, std::vector<Ui8> *out_packet);
+
+  /// @brief Returns the number of packets on the link
+  size_t GetInFlightCount() const {
+    return in_flight_.size();
+  }
+
+ private:
+  struct InFlight {
+    double arrival_time;
+    Ui64 order;
+    std::vector<Ui8> data;
+  };
+
+  static bool IsLaterArrival(const InFlight &lhs, const InFlight &rhs);
+  double NextRandom();
+  void Push(double arrival_time, const Ui8 *data, size_t size);
+
+  NetLinkConfig config_;
+  Ui64 random_state_;
+  Ui64 next_order_ = 0;
+  // A min-heap by arrival time
+  std::vector<InFlight> in_flight_;
+  std::vector<std::vector<Ui8>> free_buffers_;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_NET_CHANNEL_H_
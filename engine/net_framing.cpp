@@ -0,0 +1,232 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/net_framing.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "engine/arctic_platform_fatal.h"
+
+namespace arctic {
+
+namespace {
+
+const size_t kFlushChunk = 64;
+
+}  // namespace
+
+const Ui32 FramedConnection::kPrefixSize;
+
+FrameBufferPool::FrameBufferPool(Ui32 block_size)
+    : block_size_(block_size) {
+  Check(block_size > 0, "FrameBufferPool block_size must be positive");
+}
+
+FrameBufferPool::Block *FrameBufferPool::Acquire() {
+  Block *block = free_head_;
+  if (block) {
+    free_head_ = block->next;
+    --free_count_;
+  } else {
+    blocks_.emplace_back(new Block());
+    block = blocks_.back().get();
+    block->data.reset(new Ui8[block_size_]);
+  }
+  block->begin = 0;
+  block->end = 0;
+  block->next = nullptr;
+  return block;
+}
+
+void FrameBufferPool::Release(Block *block) {
+  block->next = free_head_;
+  free_head_ = block;
+  ++free_count_;
+}
+
+FramedConnection::FramedConnection(ConnectionSocket &&socket,
+    const FramedConnectionConfig &config, FrameBufferPool *pool)
+    : socket_(std::move(socket))
+    , config_(config)
+    , pool_(pool) {
+  Check(pool != nullptr, "FramedConnection requires a FrameBufferPool");
+  Ui64 capacity = 1;
+  Ui64 min_capacity = std::max<Ui64>(config.receive_buffer_size,
+    static_cast<Ui64>(config.max_message_size) + kPrefixSize);
+  while (capacity < min_capacity) {
+    capacity *= 2;
+  }
+  ring_.resize(static_cast<size_t>(capacity));
+  ring_mask_ = capacity - 1;
+}
+
+FramedConnection::~FramedConnection() {
+  while (send_head_) {
+    FrameBufferPool::Block *block = send_head_;
+    send_head_ = block->next;
+    pool_->Release(block);
+  }
+}
+
+SocketResult FramedConnection::Receive(size_t *out_size) {
+  if (out_size) {
+    *out_size = 0;
+  }
+  if (is_malformed_) {
+    return SocketResult::kSocketError;
+  }
+  Ui64 capacity = ring_.size();
+  Ui64 space = capacity - (write_pos_ - read_pos_);
+  if (space == 0) {
+    return SocketResult::kSocketOk;
+  }
+  Ui64 start = write_pos_ & ring_mask_;
+  Ui64 first_size = std::min(space, capacity - start);
+  SocketBuffer buffers[2];
+  buffers[0].data = reinterpret_cast<char*>(ring_.data() + start);
+  buffers[0].size = static_cast<size_t>(first_size);
+  size_t count = 1;
+  if (space > first_size) {
+    buffers[1].data = reinterpret_cast<char*>(ring_.data());
+    buffers[1].size = static_cast<size_t>(space - first_size);
+    count = 2;
+  }
+  size_t size = 0;
+  SocketResult result = socket_.ReadVector(buffers, count, &size);
+  if (result != SocketResult::kSocketOk) {
+    last_error_ = socket_.GetLastError();
+    return result;
+  }
+  write_pos_ += size;
+  if (out_size) {
+    *out_size = size;
+  }
+  return SocketResult::kSocketOk;
+}
+
+bool FramedConnection::ReadMessage(FrameView *out_message) {
+  Ui64 available = write_pos_ - read_pos_;
+  if (is_malformed_ || available < kPrefixSize) {
+    return false;
+  }
+  Ui32 size = 0;
+  for (Ui32 idx = 0; idx < kPrefixSize; ++idx) {
+    size |= static_cast<Ui32>(ring_[(read_pos_ + idx) & ring_mask_]) <<
+      (idx * 8);
+  }
+  if (size > config_.max_message_size) {
+    is_malformed_ = true;
+    last_error_ = "Incoming message size exceeds max_message_size.";
+    return false;
+  }
+  if (available < kPrefixSize + static_cast<Ui64>(size)) {
+    return false;
+  }
+  Ui64 start = (read_pos_ + kPrefixSize) & ring_mask_;
+  Ui32 first_size = static_cast<Ui32>(
+    std::min<Ui64>(size, ring_.size() - start));
+  out_message->first = ring_.data() + start;
+  out_message->first_size = first_size;
+  out_message->second = first_size < size ? ring_.data() : nullptr;
+  out_message->second_size = size - first_size;
+  read_pos_ += kPrefixSize + static_cast<Ui64>(size);
+  return true;
+}
+
+void FramedConnection::Append(const Ui8 *data, Ui32 size) {
+  Ui32 block_size = pool_->GetBlockSize();
+  while (size) {
+    if (!send_tail_ || send_tail_->end == block_size) {
+      FrameBufferPool::Block *block = pool_->Acquire();
+      if (send_tail_) {
+        send_tail_->next = block;
+      } else {
+        send_head_ = block;
+      }
+      send_tail_ = block;
+    }
+    Ui32 chunk = std::min(size, block_size - send_tail_->end);
+    std::memcpy(send_tail_->data.get() + send_tail_->end, data, chunk);
+    send_tail_->end += chunk;
+    data += chunk;
+    size -= chunk;
+  }
+}
+
+bool FramedConnection::QueueMessage(const void *data, Ui32 size) {
+  if (!CanQueue(size)) {
+    return false;
+  }
+  Ui8 prefix[kPrefixSize];
+  for (Ui32 idx = 0; idx < kPrefixSize; ++idx) {
+    prefix[idx] = static_cast<Ui8>(size >> (idx * 8));
+  }
+  Append(prefix, kPrefixSize);
+  Append(static_cast<const Ui8*>(data), size);
+  queued_bytes_ += kPrefixSize + static_cast<Ui64>(size);
+  return true;
+}
+
+SocketResult FramedConnection::Flush() {
+  while (send_head_) {
+    SocketBuffer buffers[kFlushChunk];
+    size_t count = 0;
+    size_t requested = 0;
+    for (FrameBufferPool::Block *block = send_head_;
+        block && count < kFlushChunk; block = block->next) {
+      buffers[count].data = reinterpret_cast<char*>(
+        block->data.get() + block->begin);
+      buffers[count].size = block->end - block->begin;
+      requested += buffers[count].size;
+      ++count;
+    }
+    size_t written = 0;
+    SocketResult result = socket_.WriteVector(buffers, count, &written);
+    if (result != SocketResult::kSocketOk) {
+      last_error_ = socket_.GetLastError();
+      return result;
+    }
+    queued_bytes_ -= written;
+    size_t left = written;
+    while (left) {
+      FrameBufferPool::Block *block = send_head_;
+      Ui32 chunk = static_cast<Ui32>(
+        std::min<size_t>(left, block->end - block->begin));
+      block->begin += chunk;
+      left -= chunk;
+      if (block->begin == block->end) {
+        send_head_ = block->next;
+        if (!send_head_) {
+          send_tail_ = nullptr;
+        }
+        pool_->Release(block);
+      }
+    }
+    if (written < requested) {
+      break;
+    }
+  }
+  return SocketResult::kSocketOk;
+}
+
+}  // namespace arctic
@@ -0,0 +1,220 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_NET_FRAMING_H_
+#define ENGINE_NET_FRAMING_H_
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/arctic_platform_tcpip.h"
+#include "engine/arctic_types.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief A free list of fixed size write buffers shared by FramedConnection
+/// instances
+///
+/// Buffers are allocated on demand and never freed before the pool is
+/// destroyed, so once the pool has grown to the peak amount of queued data
+/// queueing messages does not allocate. Not thread safe, the pool must
+/// outlive every connection that uses it.
+class FrameBufferPool {
+ public:
+  struct Block {
+    std::unique_ptr<Ui8[]> data;
+    Ui32 begin = 0;  ///< Offset of the first byte not yet written to the socket
+    Ui32 end = 0;  ///< Offset past the last byte queued
+    Block *next = nullptr;
+  };
+
+  explicit FrameBufferPool(Ui32 block_size = 16384);
+  FrameBufferPool(const FrameBufferPool &other) = delete;
+  FrameBufferPool &operator=(const FrameBufferPool &other) = delete;
+
+  /// @brief Returns an empty block, allocating one if the free list is empty
+  Block *Acquire();
+  void Release(Block *block);
+
+  Ui32 GetBlockSize() const {
+    return block_size_;
+  }
+  /// @brief Returns the number of blocks ever allocated by the pool
+  size_t GetBlockCount() const {
+    return blocks_.size();
+  }
+  size_t GetFreeCount() const {
+    return free_count_;
+  }
+
+ private:
+  Ui32 block_size_;
+  std::vector<std::unique_ptr<Block>> blocks_;
+  Block *free_head_ = nullptr;
+  size_t free_count_ = 0;
+};
+
+/// @brief A received message that lives in the receive ring of a
+/// FramedConnection
+///
+/// A message that crosses the end of the ring is split in two spans, the
+/// second one starts at the beginning of the ring. Nothing is copied unless
+/// CopyTo is called.
+struct FrameView {
+  const Ui8 *first = nullptr;
+  Ui32 first_size = 0;
+  const Ui8 *second = nullptr;
+  Ui32 second_size = 0;
+
+  Ui32 GetSize() const {
+    return first_size + second_size;
+  }
+  bool IsContiguous() const {
+    return second_size == 0;
+  }
+  Ui8 operator[](Ui32 idx) const {
+    return idx < first_size ? first[idx] : second[idx - first_size];
+  }
+  /// @brief Copies the message to out_data, GetSize() bytes long
+  void CopyTo(void *out_data) const {
+    if (first_size) {
+      std::memcpy(out_data, first, first_size);
+    }
+    if (second_size) {
+      std::memcpy(static_cast<Ui8*>(out_data) + first_size, second,
+        second_size);
+    }
+  }
+};
+
+struct FramedConnectionConfig {
+  /// Receive ring size in bytes, rounded up to a power of two that fits
+  /// the largest message
+  Ui32 receive_buffer_size = 256 * 1024;
+  /// Largest message accepted either way, a larger incoming size prefix is
+  /// treated as a malformed stream
+  Ui32 max_message_size = 64 * 1024;
+  /// QueueMessage fails once this many bytes are waiting to be written
+  Ui64 max_queued_bytes = 1024 * 1024;
+};
+
+/// @brief Length prefixed messages over a TCP ConnectionSocket
+///
+/// Each message is sent as a 4 byte little endian size followed by the
+/// payload. Receive reads everything available into a ring buffer with one
+/// scatter read and ReadMessage hands out complete messages as FrameView
+/// spans of that ring. QueueMessage copies messages into blocks from a
+/// FrameBufferPool and Flush writes the queued blocks with one gather
+/// write. No memory is allocated per message once the pool has grown.
+/// Example:
+/// @code
+///   FramedConnection connection(listener.Accept(), config, &pool);
+///   connection.Receive(&size);
+///   FrameView message;
+///   while (connection.ReadMessage(&message)) {
+///     Handle(message);
+///     connection.QueueMessage(reply.data(), reply.size());
+///   }
+///   connection.Flush();
+/// @endcode
+/// Works with both blocking and non-blocking sockets, register GetSocket()
+/// with a SocketPoller to learn when to call Receive and Flush.
+class FramedConnection {
+ public:
+  FramedConnection(ConnectionSocket &&socket,
+    const FramedConnectionConfig &config, FrameBufferPool *pool);
+  FramedConnection(const FramedConnection &other) = delete;
+  FramedConnection &operator=(const FramedConnection &other) = delete;
+  ~FramedConnection();
+
+  /// @brief Reads available data from the socket into the receive ring
+  /// @param out_size Pointer to store the number of bytes read, may be null
+  /// @return The result of the read, kSocketError on a malformed stream
+  ///
+  /// Views returned by ReadMessage before the call become invalid. Reads
+  /// nothing while the ring is full of complete messages.
+  [[nodiscard]] SocketResult Receive(size_t *out_size = nullptr);
+
+  /// @brief Takes the next complete message out of the receive ring
+  /// @param out_message Set to the message, valid until the next Receive
+  /// @return False if no complete message has been received yet
+  bool ReadMessage(FrameView *out_message);
+
+  /// @brief Appends a message to the write queue
+  /// @return False if the message is larger than max_message_size or the
+  /// queue would exceed max_queued_bytes, nothing is queued then
+  bool QueueMessage(const void *data, Ui32 size);
+
+  /// @brief Writes as much of the write queue as the socket accepts
+  /// @return The result of the write operation
+  [[nodiscard]] SocketResult Flush();
+
+  /// @brief Returns true if QueueMessage would accept a message of size bytes
+  bool CanQueue(Ui32 size) const {
+    return size <= config_.max_message_size &&
+      queued_bytes_ + kPrefixSize + size <= config_.max_queued_bytes;
+  }
+  /// @brief Returns the number of bytes queued and not yet written
+  Ui64 GetQueuedBytes() const {
+    return queued_bytes_;
+  }
+  /// @brief Returns the number of received bytes not taken by ReadMessage
+  Ui64 GetReceivedBytes() const {
+    return write_pos_ - read_pos_;
+  }
+  ConnectionSocket &GetSocket() {
+    return socket_;
+  }
+  std::string GetLastError() const {
+    return last_error_;
+  }
+
+  static const Ui32 kPrefixSize = 4;
+
+ private:
+  void Append(const Ui8 *data, Ui32 size);
+
+  ConnectionSocket socket_;
+  FramedConnectionConfig config_;
+  FrameBufferPool *pool_;
+  std::vector<Ui8> ring_;
+  Ui64 ring_mask_ = 0;
+  Ui64 read_pos_ = 0;
+  Ui64 write_pos_ = 0;
+  FrameBufferPool::Block *send_head_ = nullptr;
+  FrameBufferPool::Block *send_tail_ = nullptr;
+  Ui64 queued_bytes_ = 0;
+  bool is_malformed_ = false;
+  std::string last_error_;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_NET_FRAMING_H_
@@ -0,0 +1,334 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/profiler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+
+#include "engine/easy_advanced.h"
+#include "engine/easy_files.h"
+#include "engine/font.h"
+
+namespace arctic {
+
+std::atomic<bool> g_is_profiler_enabled = ATOMIC_VAR_INIT(false);
+thread_local Ui32 g_profiler_depth = 0;
+
+namespace {
+
+const Ui64 kProfilerRingSize = 1 << 17;
+const Ui64 kProfilerRingMask = kProfilerRingSize - 1;
+
+// Fields are relaxed atomics so that readers may copy a slot while the
+// owning thread overwrites it; torn slots are detected by the write index.
+struct ProfilerEvent {
+  std::atomic<const char*> name;
+  std::atomic<Ui64> start_ns;
+  std::atomic<Ui64> end_ns;
+  std::atomic<Ui32> depth;
+};
+
+struct ProfilerEventCopy {
+  const char *name;
+  Ui64 start_ns;
+  Ui64 end_ns;
+  Ui32 depth;
+};
+
+// Single writer (the owning thread), any number of readers.
+struct ProfilerThread {
+  Ui32 tid = 0;
+  std::string name;
+  std::unique_ptr<ProfilerEvent[]> events;
+  std::atomic<Ui64> write_idx;
+  Ui64 frame_read_idx = 0;
+
+  ProfilerThread()
+      : events(new ProfilerEvent[kProfilerRingSize])
+      , write_idx(0) {
+  }
+
+  // Appends the events with index >= from_idx still present in the ring.
+  Ui64 CopyEvents(Ui64 from_idx, std::vector<ProfilerEventCopy> *out) const {
+    Ui64 end_idx = write_idx.load(std::memory_order_acquire);
+    Ui64 begin_idx = std::max(from_idx,
+      end_idx > kProfilerRingSize ? end_idx - kProfilerRingSize : Ui64(0));
+    size_t first = out->size();
+    for (Ui64 idx = begin_idx; idx < end_idx; ++idx) {
+      const ProfilerEvent &e = events[idx & kProfilerRingMask];
+      ProfilerEventCopy copy;
+      copy.name = e.name.load(std::memory_order_relaxed);
+      copy.start_ns = e.start_ns.load(std::memory_order_relaxed);
+      copy.end_ns = e.end_ns.load(std::memory_order_relaxed);
+      copy.depth = e.depth.load(std::memory_order_relaxed);
+      out->push_back(copy);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    Ui64 check_idx = write_idx.load(std::memory_order_relaxed);
+    // Slots of events older than check_idx + 1 - kProfilerRingSize may have
+    // been overwritten while they were copied.
+    if (check_idx + 1 > begin_idx + kProfilerRingSize) {
+      Ui64 overwritten = std::min(end_idx - begin_idx,
+        check_idx + 1 - kProfilerRingSize - begin_idx);
+      out->erase(out->begin() + static_cast<std::ptrdiff_t>(first),
+        out->begin() + static_cast<std::ptrdiff_t>(first + overwritten));
+    }
+    return end_idx;
+  }
+};
+
+// Node of the per-frame call tree, children form a singly linked list.
+struct ProfilerNode {
+  const char *name = nullptr;
+  size_t first_child = 0;
+  size_t next_sibling = 0;
+  Ui32 count = 0;
+  Ui64 total_ns = 0;
+};
+
+struct ProfilerRegistry {
+  std::mutex mutex;
+  std::vector<ProfilerThread*> threads;
+  // Rings of the threads that exited, reused by the threads started later.
+  std::vector<ProfilerThread*> free_threads;
+  std::vector<ProfilerZoneStats> frame_stats;
+  std::vector<ProfilerEventCopy> scratch;
+  std::vector<ProfilerNode> nodes;
+  std::vector<std::pair<size_t, Ui64>> stack;
+};
+
+// Intentionally leaked, rings outlive their threads so that they can be exported.
+ProfilerRegistry &Registry() {
+  static ProfilerRegistry *registry = new ProfilerRegistry();
+  return *registry;
+}
+
+// Hands the ring of an exiting thread back to the registry. The ring keeps
+// its events and its tid, the next thread to need a ring continues it.
+struct ProfilerThreadOwner {
+  ProfilerThread *thread = nullptr;
+
+  ~ProfilerThreadOwner() {
+    if (thread) {
+      ProfilerRegistry &registry = Registry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.free_threads.push_back(thread);
+      thread = nullptr;
+    }
+  }
+};
+
+ProfilerThread &ThisThread() {
+  static thread_local ProfilerThreadOwner owner;
+  if (!owner.thread) {
+    ProfilerRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (registry.free_threads.empty()) {
+      owner.thread = new ProfilerThread();
+      owner.thread->tid = static_cast<Ui32>(registry.threads.size());
+      registry.threads.push_back(owner.thread);
+    } else {
+      owner.thread = registry.free_threads.back();
+      registry.free_threads.pop_back();
+      owner.thread->name.clear();
+    }
+  }
+  return *owner.thread;
+}
+
+// Appends the subtree in depth-first order, siblings sorted by total time.
+void AppendNodeStats(const std::vector<ProfilerNode> &nodes, size_t parent,
+    Ui32 depth, std::vector<ProfilerZoneStats> *out) {
+  std::vector<size_t> children;
+  for (size_t idx = nodes[parent].first_child; idx;
+      idx = nodes[idx].next_sibling) {
+    children.push_back(idx);
+  }
+  std::sort(children.begin(), children.end(), [&nodes](size_t a, size_t b) {
+    return nodes[a].total_ns > nodes[b].total_ns;
+  });
+  for (size_t idx : children) {
+    ProfilerZoneStats stats;
+    stats.name = nodes[idx].name;
+    stats.depth = depth;
+    stats.count = nodes[idx].count;
+    stats.total_ms = static_cast<double>(nodes[idx].total_ns) * 1e-6;
+    out->push_back(stats);
+    AppendNodeStats(nodes, idx, depth + 1, out);
+  }
+}
+
+void AppendJsonString(const char *text, std::string *out) {
+  out->push_back('"');
+  for (const char *p = text; *p; ++p) {
+    if (*p == '"' || *p == '\\') {
+      out->push_back('\\');
+      out->push_back(*p);
+    } else if (static_cast<unsigned char>(*p) < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(*p));
+      out->append(buf);
+    } else {
+      out->push_back(*p);
+    }
+  }
+  out->push_back('"');
+}
+
+}  // namespace
+
+void SetProfilerEnabled(bool is_enabled) {
+  g_is_profiler_enabled.store(is_enabled);
+}
+
+void SetProfilerThreadName(const char *name) {
+  ProfilerThread &thread = ThisThread();
+  ProfilerRegistry &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  thread.name = name ? name : "";
+}
+
+Ui64 ProfilerNowNs() {
+  return static_cast<Ui64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void ProfilerRecordZone(const char *name, Ui64 start_ns, Ui64 end_ns, Ui32 depth) {
+  ProfilerThread &thread = ThisThread();
+  Ui64 idx = thread.write_idx.load(std::memory_order_relaxed);
+  ProfilerEvent &e = thread.events[idx & kProfilerRingMask];
+  e.name.store(name, std::memory_order_relaxed);
+  e.start_ns.store(start_ns, std::memory_order_relaxed);
+  e.end_ns.store(end_ns, std::memory_order_relaxed);
+  e.depth.store(depth, std::memory_order_relaxed);
+  thread.write_idx.store(idx + 1, std::memory_order_release);
+}
+
+void ProfilerFrameMark() {
+  ProfilerRegistry &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<ProfilerNode> &nodes = registry.nodes;
+  nodes.clear();
+  nodes.emplace_back();
+  for (ProfilerThread *thread : registry.threads) {
+    registry.scratch.clear();
+    thread->frame_read_idx = thread->CopyEvents(thread->frame_read_idx,
+      &registry.scratch);
+    // Zones are recorded when they end, so children precede their parents.
+    std::sort(registry.scratch.begin(), registry.scratch.end(),
+      [](const ProfilerEventCopy &a, const ProfilerEventCopy &b) {
+        return a.start_ns != b.start_ns ? a.start_ns < b.start_ns
+          : a.depth < b.depth;
+      });
+    // Stack of (node index, end_ns) of the zones enclosing the current one.
+    std::vector<std::pair<size_t, Ui64>> &stack = registry.stack;
+    stack.clear();
+    for (const ProfilerEventCopy &e : registry.scratch) {
+      while (!stack.empty() && (stack.size() > e.depth ||
+          stack.back().second < e.end_ns)) {
+        stack.pop_back();
+      }
+      size_t parent = stack.empty() ? 0 : stack.back().first;
+      size_t idx = nodes[parent].first_child;
+      while (idx && nodes[idx].name != e.name
+          && std::strcmp(nodes[idx].name, e.name) != 0) {
+        idx = nodes[idx].next_sibling;
+      }
+      if (!idx) {
+        idx = nodes.size();
+        nodes.emplace_back();
+        nodes[idx].name = e.name;
+        nodes[idx].next_sibling = nodes[parent].first_child;
+        nodes[parent].first_child = idx;
+      }
+      nodes[idx].count++;
+      nodes[idx].total_ns += e.end_ns - e.start_ns;
+      stack.emplace_back(idx, e.end_ns);
+    }
+  }
+  registry.frame_stats.clear();
+  AppendNodeStats(nodes, 0, 0, &registry.frame_stats);
+}
+
+const std::vector<ProfilerZoneStats> &GetProfilerFrameStats() {
+  return Registry().frame_stats;
+}
+
+void SaveProfilerTrace(const char *file_name) {
+  ProfilerRegistry &registry = Registry();
+  std::string json;
+  json.append("{\"traceEvents\":[\n");
+  bool is_first = true;
+  char buf[128];
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (ProfilerThread *thread : registry.threads) {
+      if (!thread->name.empty()) {
+        json.append(is_first ? "" : ",\n");
+        is_first = false;
+        snprintf(buf, sizeof(buf),
+          "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":",
+          thread->tid);
+        json.append(buf);
+        AppendJsonString(thread->name.c_str(), &json);
+        json.append("}}");
+      }
+      registry.scratch.clear();
+      thread->CopyEvents(0, &registry.scratch);
+      for (const ProfilerEventCopy &e : registry.scratch) {
+        json.append(is_first ? "" : ",\n");
+        is_first = false;
+        json.append("{\"name\":");
+        AppendJsonString(e.name, &json);
+        snprintf(buf, sizeof(buf),
+          ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+          thread->tid, static_cast<double>(e.start_ns) * 1e-3,
+          static_cast<double>(e.end_ns - e.start_ns) * 1e-3);
+        json.append(buf);
+      }
+    }
+  }
+  json.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+  WriteFile(file_name, reinterpret_cast<const Ui8*>(json.data()), json.size());
+}
+
+void DrawProfilerOverlay(Font &font, Si32 x, Si32 y) {
+  std::string text;
+  char buf[160];
+  for (const ProfilerZoneStats &s : GetProfilerFrameStats()) {
+    snprintf(buf, sizeof(buf), "%*s%s: %.3f ms (%u)\n",
+      static_cast<int>(s.depth * 2), "", s.name, s.total_ms, s.count);
+    text.append(buf);
+  }
+  if (!text.empty()) {
+    font.Draw(text.c_str(), x, y, kTextOriginTop);
+  }
+}
+
+}  // namespace arctic
@@ -0,0 +1,132 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_PROFILER_H_
+#define ENGINE_PROFILER_H_
+
+#include <atomic>
+#include <vector>
+
+#include "engine/arctic_types.h"
+
+namespace arctic {
+
+class Font;
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Time spent in one zone during the last frame
+struct ProfilerZoneStats {
+  const char *name = nullptr;  ///< Zone name as passed to ARCTIC_PROFILE_SCOPE
+  Ui32 depth = 0;  ///< Nesting depth in the call tree
+  Ui32 count = 0;  ///< Number of times the zone was entered
+  double total_ms = 0.0;  ///< Total time spent in the zone, milliseconds
+};
+
+extern std::atomic<bool> g_is_profiler_enabled;
+extern thread_local Ui32 g_profiler_depth;
+
+/// @brief Returns true if zones are being recorded
+inline bool IsProfilerEnabled() {
+  return g_is_profiler_enabled.load(std::memory_order_relaxed);
+}
+
+/// @brief Starts or stops recording of profiler zones (stopped by default)
+void SetProfilerEnabled(bool is_enabled);
+
+/// @brief Sets the name shown for the calling thread in the exported trace
+/// @param name Thread name, copied
+void SetProfilerThreadName(const char *name);
+
+/// @brief Returns the profiler clock value in nanoseconds
+Ui64 ProfilerNowNs();
+
+/// @brief Records a finished zone into the calling thread ring buffer
+/// @param name Zone name, must point to a string with static storage duration
+void ProfilerRecordZone(const char *name, Ui64 start_ns, Ui64 end_ns, Ui32 depth);
+
+/// @brief Collects the zones recorded since the previous call into frame stats
+/// @note Called automatically by ShowFrame().
+void ProfilerFrameMark();
+
+/// @brief Returns per-zone times of the last frame as a flattened call tree
+///   (depth-first, siblings sorted by total time), threads are merged
+const std::vector<ProfilerZoneStats> &GetProfilerFrameStats();
+
+/// @brief Writes the zones still present in the ring buffers of all threads
+///   as a Chrome trace-event JSON file (chrome://tracing, Perfetto)
+/// @param file_name Path to the output file
+void SaveProfilerTrace(const char *file_name);
+
+/// @brief Draws the per-zone times of the last frame to the backbuffer
+/// @param font Font to draw with
+/// @param x X screen coordinate of the top left corner
+/// @param y Y screen coordinate of the top left corner
+void DrawProfilerOverlay(Font &font, Si32 x, Si32 y);
+
+/// @brief Records the time between construction and destruction as a zone
+class ProfileScope {
+  const char *name_;
+  Ui64 start_ns_ = 0;
+  Ui32 depth_ = 0;
+  bool is_active_;
+
+ public:
+  explicit ProfileScope(const char *name)
+      : name_(name)
+      , is_active_(IsProfilerEnabled()) {
+    if (is_active_) {
+      depth_ = g_profiler_depth++;
+      start_ns_ = ProfilerNowNs();
+    }
+  }
+
+  ~ProfileScope() {
+    if (is_active_) {
+      ProfilerRecordZone(name_, start_ns_, ProfilerNowNs(), depth_);
+      --g_profiler_depth;
+    }
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope &operator=(const ProfileScope&) = delete;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#define ARCTIC_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ARCTIC_PROFILE_CONCAT(a, b) ARCTIC_PROFILE_CONCAT_IMPL(a, b)
+
+/// @brief Records the enclosing scope as a profiler zone
+/// @details The name must be a string literal. Define ARCTIC_NO_PROFILER to
+///  compile all zones out.
+#ifdef ARCTIC_NO_PROFILER
+#define ARCTIC_PROFILE_SCOPE(name) ((void)0)
+#else
+#define ARCTIC_PROFILE_SCOPE(name) \
+  ::arctic::ProfileScope ARCTIC_PROFILE_CONCAT(arctic_profile_scope_, __LINE__)(name)
+#endif  // ARCTIC_NO_PROFILER
+
+#endif  // ENGINE_PROFILER_H_
@@ -0,0 +1,266 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/resource_cache.h"
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#include "engine/arctic_platform.h"
+#include "engine/asset_pack.h"
+#include "engine/easy_sound_instance.h"
+#include "engine/easy_sprite_instance.h"
+
+namespace arctic {
+
+namespace {
+
+Ui64 SpriteInstanceBytes(const std::shared_ptr<SpriteInstance> &instance) {
+  if (!instance) {
+    return 0;
+  }
+  return static_cast<Ui64>(instance->width()) *
+    static_cast<Ui64>(instance->height()) * sizeof(Rgba) +
+    instance->Opaque().size() * sizeof(SpanSi32);
+}
+
+Ui64 ResourceBytes(const Sprite &sprite) {
+  return SpriteInstanceBytes(sprite.SpriteInstance());
+}
+
+Ui64 ResourceBytes(Sound &sound) {
+  std::shared_ptr<SoundInstance> instance = sound.GetInstance();
+  if (!instance) {
+    return 0;
+  }
+  if (instance->GetFormat() == kSoundDataWav) {
+    return static_cast<Ui64>(instance->GetDurationSamples()) * 2 *
+      sizeof(Si16);
+  }
+  return static_cast<Ui64>(instance->GetVorbisSize());
+}
+
+// Glyphs usually reference one atlas, each sprite instance is counted once
+Ui64 ResourceBytes(const Font &font) {
+  const FontInstance &instance = *font.FontInstance();
+  Ui64 bytes = instance.codepoint_.size() * sizeof(Glyph*) +
+    instance.glyph_.size() * sizeof(Glyph);
+  std::unordered_set<const SpriteInstance*> counted;
+  for (const Glyph &glyph : instance.glyph_) {
+    const std::shared_ptr<SpriteInstance> &sprite =
+      glyph.sprite.SpriteInstance();
+    if (sprite && counted.insert(sprite.get()).second) {
+      bytes += SpriteInstanceBytes(sprite);
+    }
+  }
+  return bytes;
+}
+
+std::shared_ptr<const void> ResourceInstance(const Sprite &sprite) {
+  return sprite.SpriteInstance();
+}
+
+std::shared_ptr<const void> ResourceInstance(Sound &sound) {
+  return sound.GetInstance();
+}
+
+std::shared_ptr<const void> ResourceInstance(const Font &font) {
+  return font.FontInstance();
+}
+
+std::string ResourceKey(char kind, const char *file_name,
+    const std::string &options) {
+  Check(!!file_name, "ResourceCache error, file_name is nullptr");
+  std::string path = CanonicalizePath(file_name);
+  if (path.empty()) {
+    path = NormalizeAssetPath(file_name);
+  }
+  std::string key(1, kind);
+  key += options;
+  key.push_back('|');
+  key += path;
+  return key;
+}
+
+}  // namespace
+
+template <class TValue>
+struct ResourceCache::TypedEntry : public ResourceCache::Entry {
+  TValue value;
+  /// Counts the users of the value, the entry holds two references
+  std::shared_ptr<const void> instance;
+
+  bool IsReferenced() const override {
+    return instance.use_count() > 2;
+  }
+};
+
+template <class TValue>
+TValue ResourceCache::Get(ResourceKind kind, const std::string &key,
+    const std::function<TValue()> &load) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      ++stats_.hits;
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return static_cast<TypedEntry<TValue>&>(*lru_.front()).value;
+    }
+    ++stats_.misses;
+  }
+  std::unique_ptr<TypedEntry<TValue>> entry(new TypedEntry<TValue>());
+  entry->value = load();
+  entry->instance = ResourceInstance(entry->value);
+  entry->bytes = ResourceBytes(entry->value);
+  if (!entry->bytes) {
+    return entry->value;
+  }
+  entry->key = key;
+  entry->kind = kind;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Loaded by another thread in the meantime, share that one
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return static_cast<TypedEntry<TValue>&>(*lru_.front()).value;
+  }
+  TValue value = entry->value;
+  stats_.resident_bytes += entry->bytes;
+  stats_.resident_bytes_by_kind[kind] += entry->bytes;
+  ++stats_.entry_count;
+  lru_.push_front(std::move(entry));
+  index_[key] = lru_.begin();
+  EvictLocked();
+  return value;
+}
+
+void ResourceCache::EvictLocked() {
+  auto it = lru_.end();
+  while (stats_.resident_bytes > budget_ && it != lru_.begin()) {
+    --it;
+    if ((*it)->IsReferenced()) {
+      continue;
+    }
+    stats_.resident_bytes -= (*it)->bytes;
+    stats_.resident_bytes_by_kind[(*it)->kind] -= (*it)->bytes;
+    --stats_.entry_count;
+    ++stats_.evictions;
+    index_.erase((*it)->key);
+    it = lru_.erase(it);
+  }
+}
+
+Sprite ResourceCache::GetSprite(const char *file_name) {
+  std::string name(file_name ? file_name : "");
+  return Get<Sprite>(kResourceSprite, ResourceKey('S', file_name, ""),
+    [&name]() {
+      Sprite sprite;
+      sprite.Load(name.c_str());
+      return sprite;
+    });
+}
+
+Sound ResourceCache::GetSound(const char *file_name, bool do_unpack) {
+  std::string name(file_name ? file_name : "");
+  return Get<Sound>(kResourceSound,
+    ResourceKey('A', file_name, do_unpack ? "unpack" : "packed"),
+    [&name, do_unpack]() {
+      Sound sound;
+      sound.Load(name.c_str(), do_unpack);
+      return sound;
+    });
+}
+
+Font ResourceCache::GetFont(const char *file_name) {
+  std::string name(file_name ? file_name : "");
+  return Get<Font>(kResourceFont, ResourceKey('F', file_name, ""),
+    [&name]() {
+      Font font;
+      font.Load(name.c_str());
+      return font;
+    });
+}
+
+Font ResourceCache::GetTtfFont(const char *file_name, float pixel_height,
+    const char *utf8_chars, Si32 font_index) {
+  std::string name(file_name ? file_name : "");
+  std::string options = std::to_string(pixel_height) + "," +
+    std::to_string(font_index);
+  if (utf8_chars) {
+    options += ",";
+    options += utf8_chars;
+  }
+  return Get<Font>(kResourceFont, ResourceKey('T', file_name, options),
+    [&name, pixel_height, utf8_chars, font_index]() {
+      Font font;
+      font.LoadTtf(name.c_str(), pixel_height, utf8_chars, font_index);
+      return font;
+    });
+}
+
+void ResourceCache::SetMemoryBudget(Ui64 bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  budget_ = bytes;
+  EvictLocked();
+}
+
+Ui64 ResourceCache::GetMemoryBudget() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return budget_;
+}
+
+void ResourceCache::Trim() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  EvictLocked();
+}
+
+void ResourceCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lru_.clear();
+  index_.clear();
+  stats_.entry_count = 0;
+  stats_.resident_bytes = 0;
+  for (Ui64 &bytes : stats_.resident_bytes_by_kind) {
+    bytes = 0;
+  }
+}
+
+ResourceCacheStats ResourceCache::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void ResourceCache::ResetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.hits = 0;
+  stats_.misses = 0;
+  stats_.evictions = 0;
+}
+
+ResourceCache &GetResourceCache() {
+  static ResourceCache cache;
+  return cache;
+}
+
+}  // namespace arctic
@@ -0,0 +1,137 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_RESOURCE_CACHE_H_
+#define ENGINE_RESOURCE_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "engine/arctic_types.h"
+#include "engine/easy_sound.h"
+#include "engine/easy_sprite.h"
+#include "engine/font.h"
+
+namespace arctic {
+
+/// @addtogroup global_files
+/// @{
+
+/// @brief Kind of a resource kept in the ResourceCache
+enum ResourceKind {
+  kResourceSprite = 0,
+  kResourceSound = 1,
+  kResourceFont = 2,
+  kResourceKindCount = 3
+};
+
+/// @brief Counters of a ResourceCache
+struct ResourceCacheStats {
+  Ui64 hits = 0;
+  Ui64 misses = 0;
+  Ui64 evictions = 0;
+  Ui64 entry_count = 0;
+  Ui64 resident_bytes = 0;
+  Ui64 resident_bytes_by_kind[kResourceKindCount] = {0, 0, 0};
+};
+
+/// @brief Shares loaded sprites, sounds and fonts between their users
+///
+/// Resources are keyed by the canonical path of the file and the load
+/// options, so "data/hero.tga" and "./data/../data/hero.tga" load once.
+/// The cache hands out the usual Sprite, Sound and Font values that share
+/// one instance. Entries no one else holds are evicted least recently used
+/// first when the resident bytes exceed the memory budget. Entries in use
+/// stay, so the budget can be exceeded while they are held.
+/// Cached resources are shared: Clone a sprite before drawing into it.
+/// Safe to use from several threads, loads run outside of the lock.
+class ResourceCache {
+ public:
+  ResourceCache() = default;
+  ResourceCache(const ResourceCache&) = delete;
+  ResourceCache &operator=(const ResourceCache&) = delete;
+
+  /// @brief Returns the sprite, loading it with Sprite::Load on a miss
+  /// @note Failed loads are not cached.
+  Sprite GetSprite(const char *file_name);
+  /// @brief Returns the sound, loading it with Sound::Load on a miss
+  Sound GetSound(const char *file_name, bool do_unpack = true);
+  /// @brief Returns the font, loading it with Font::Load on a miss
+  Font GetFont(const char *file_name);
+  /// @brief Returns the font rasterized with Font::LoadTtf
+  Font GetTtfFont(const char *file_name, float pixel_height,
+    const char *utf8_chars = nullptr, Si32 font_index = 0);
+
+  /// @brief Sets the budget for the resident bytes of all kinds and evicts
+  /// the unused entries over it
+  /// @param bytes Budget in bytes, 0 evicts every unused entry
+  void SetMemoryBudget(Ui64 bytes);
+  /// @brief Returns the memory budget, 256 MiB by default
+  Ui64 GetMemoryBudget();
+  /// @brief Evicts unused entries until the cache is within the budget
+  void Trim();
+  /// @brief Forgets every entry, the values handed out stay valid
+  void Clear();
+
+  /// @brief Returns the hit, miss and eviction counters and resident bytes
+  ResourceCacheStats GetStats();
+  /// @brief Resets the hit, miss and eviction counters
+  void ResetStats();
+
+ private:
+  struct Entry {
+    virtual ~Entry() = default;
+    /// True if a value handed out is still held outside of the cache
+    virtual bool IsReferenced() const = 0;
+    std::string key;
+    ResourceKind kind = kResourceSprite;
+    Ui64 bytes = 0;
+  };
+  template <class TValue>
+  struct TypedEntry;
+
+  template <class TValue>
+  TValue Get(ResourceKind kind, const std::string &key,
+    const std::function<TValue()> &load);
+  void EvictLocked();
+
+  std::mutex mutex_;
+  /// Most recently used first
+  std::list<std::unique_ptr<Entry>> lru_;
+  std::unordered_map<std::string,
+    std::list<std::unique_ptr<Entry>>::iterator> index_;
+  Ui64 budget_ = 256ull << 20;
+  ResourceCacheStats stats_;
+};
+
+/// @brief Returns the resource cache shared by the whole game
+ResourceCache &GetResourceCache();
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_RESOURCE_CACHE_H_
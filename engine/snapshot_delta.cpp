@@ -0,0 +1,475 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "engine/snapshot_delta.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "engine/arctic_platform_fatal.h"
+
+namespace arctic {
+
+namespace {
+
+const Ui32 kMaxSnapshotCapacity = 1u << 24;
+
+Ui32 LowBitsMask(Ui32 bits) {
+  return bits >= 32 ? 0xffffffffu : ((1u << bits) - 1u);
+}
+
+Ui32 BitsForValue(Ui64 value) {
+  Ui32 bits = 1;
+  while (bits < 64 && (value >> bits)) {
+    ++bits;
+  }
+  return bits;
+}
+
+// Elias gamma code, 1 is written as a single bit.
+void WriteGamma(Ui32 value, BitStream *out) {
+  Ui32 bits = BitsForValue(value);
+  out->Write(0, bits - 1);
+  out->Write(value, bits);
+}
+
+bool ReadGamma(BitStream *in, Ui32 *out_value) {
+  Ui32 zeros = 0;
+  while (in->ReadBit() == 0) {
+    ++zeros;
+    if (zeros > 31 || in->ReadBitsLeft() == 0) {
+      return false;
+    }
+  }
+  *out_value = static_cast<Ui32>((1ull << zeros) | in->Read(zeros));
+  return true;
+}
+
+bool IsEntityChanged(const Snapshot *baseline, const Snapshot &current,
+    Ui32 id, Ui32 field_count) {
+  bool is_in_baseline = baseline && baseline->Has(id);
+  bool is_in_current = current.Has(id);
+  if (is_in_baseline != is_in_current) {
+    return true;
+  }
+  return is_in_current && std::memcmp(baseline->GetValues(id),
+    current.GetValues(id), field_count * sizeof(Ui32)) != 0;
+}
+
+}  // namespace
+
+SnapshotSchema::SnapshotSchema(Ui32 struct_size)
+    : struct_size_(struct_size) {
+}
+
+void SnapshotSchema::AddField(const Field &field) {
+  Check(field.size == 1 || field.size == 2 || field.size == 4,
+    "SnapshotSchema field size must be 1, 2 or 4 bytes");
+  Check(field.offset + field.size <= struct_size_,
+    "SnapshotSchema field is outside of the struct");
+  Check(field.bits >= 1 && field.bits <= 32,
+    "SnapshotSchema field must take 1 to 32 bits");
+  fields_.push_back(field);
+}
+
+void SnapshotSchema::AddUint(Ui32 offset, Ui32 size, Ui32 bits) {
+  Field field;
+  field.kind = kFieldUint;
+  field.offset = offset;
+  field.size = size;
+  field.bits = bits;
+  field.min_value = 0.f;
+  field.max_value = 0.f;
+  field.precision = 0.f;
+  field.max_quantized = LowBitsMask(bits);
+  AddField(field);
+}
+
+void SnapshotSchema::AddSint(Ui32 offset, Ui32 size, Ui32 bits) {
+  AddUint(offset, size, bits);
+  fields_.back().kind = kFieldSint;
+}
+
+void SnapshotSchema::AddFloat(Ui32 offset, float min_value, float max_value,
+    float precision) {
+  Check(precision > 0.f && max_value > min_value,
+    "SnapshotSchema float field needs a positive range and precision");
+  double levels = std::ceil((static_cast<double>(max_value) - min_value)
+    / precision);
+  Check(levels < 4294967296.0,
+    "SnapshotSchema float field needs more than 32 bits");
+  Field field;
+  field.kind = kFieldFloat;
+  field.offset = offset;
+  field.size = sizeof(float);
+  field.max_quantized = static_cast<Ui32>(levels);
+  field.bits = BitsForValue(field.max_quantized);
+  field.min_value = min_value;
+  field.max_value = max_value;
+  field.precision = precision;
+  AddField(field);
+}
+
+Ui32 SnapshotSchema::Quantize(Ui32 field_idx, const void *entity) const {
+  const Field &field = fields_[field_idx];
+  const Ui8 *p = static_cast<const Ui8*>(entity) + field.offset;
+  if (field.kind == kFieldFloat) {
+    float value;
+    std::memcpy(&value, p, sizeof(value));
+    if (!(value > field.min_value)) {
+      return 0;
+    }
+    double q = std::floor((static_cast<double>(value) - field.min_value)
+      / field.precision + 0.5);
+    return q < field.max_quantized ? static_cast<Ui32>(q)
+      : field.max_quantized;
+  }
+  Ui32 value;
+  if (field.size == 1) {
+    Ui8 v;
+    std::memcpy(&v, p, 1);
+    value = (field.kind == kFieldSint)
+      ? static_cast<Ui32>(static_cast<Si32>(static_cast<Si8>(v))) : v;
+  } else if (field.size == 2) {
+    Ui16 v;
+    std::memcpy(&v, p, 2);
+    value = (field.kind == kFieldSint)
+      ? static_cast<Ui32>(static_cast<Si32>(static_cast<Si16>(v))) : v;
+  } else {
+    std::memcpy(&value, p, 4);
+  }
+  return value & field.max_quantized;
+}
+
+void SnapshotSchema::Dequantize(Ui32 field_idx, Ui32 value,
+    void *entity) const {
+  const Field &field = fields_[field_idx];
+  Ui8 *p = static_cast<Ui8*>(entity) + field.offset;
+  if (field.kind == kFieldFloat) {
+    float result = (value >= field.max_quantized) ? field.max_value
+      : static_cast<float>(field.min_value
+        + static_cast<double>(value) * field.precision);
+    std::memcpy(p, &result, sizeof(result));
+    return;
+  }
+  if (field.kind == kFieldSint && field.bits < 32
+      && (value >> (field.bits - 1))) {
+    value |= ~field.max_quantized;
+  }
+  if (field.size == 1) {
+    Ui8 v = static_cast<Ui8>(value);
+    std::memcpy(p, &v, 1);
+  } else if (field.size == 2) {
+    Ui16 v = static_cast<Ui16>(value);
+    std::memcpy(p, &v, 2);
+  } else {
+    std::memcpy(p, &value, 4);
+  }
+}
+
+Snapshot::Snapshot() {
+}
+
+Snapshot::Snapshot(const SnapshotSchema *schema)
+    : schema_(schema)
+    , field_count_(schema->GetFieldCount()) {
+}
+
+void Snapshot::Clear() {
+  values_.clear();
+  is_present_.clear();
+}
+
+void Snapshot::Reserve(Ui32 capacity) {
+  Check(capacity <= kMaxSnapshotCapacity, "Snapshot entity id is too large");
+  values_.resize(static_cast<std::size_t>(capacity) * field_count_, 0);
+  is_present_.resize(capacity, 0);
+}
+
+void Snapshot::Set(Ui32 entity_id, const void *entity) {
+  if (entity_id >= GetCapacity()) {
+    Reserve(entity_id + 1);
+  }
+  Ui32 *values = values_.data() + static_cast<std::size_t>(entity_id) * field_count_;
+  for (Ui32 idx = 0; idx < field_count_; ++idx) {
+    values[idx] = schema_->Quantize(idx, entity);
+  }
+  is_present_[entity_id] = 1;
+}
+
+void Snapshot::Remove(Ui32 entity_id) {
+  if (!Has(entity_id)) {
+    return;
+  }
+  is_present_[entity_id] = 0;
+  std::fill_n(values_.begin() + static_cast<std::size_t>(entity_id) * field_count_,
+    field_count_, 0u);
+}
+
+bool Snapshot::Get(Ui32 entity_id, void *out_entity) const {
+  if (!Has(entity_id)) {
+    return false;
+  }
+  const Ui32 *values = GetValues(entity_id);
+  for (Ui32 idx = 0; idx < field_count_; ++idx) {
+    schema_->Dequantize(idx, values[idx], out_entity);
+  }
+  return true;
+}
+
+bool Snapshot::IsSame(const Snapshot &other) const {
+  Ui32 capacity = std::max(GetCapacity(), other.GetCapacity());
+  for (Ui32 id = 0; id < capacity; ++id) {
+    if (IsEntityChanged(this, other, id, field_count_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void EncodeSnapshotDelta(const Snapshot *baseline, const Snapshot &current,
+    BitStream *out) {
+  const SnapshotSchema &schema = *current.GetSchema();
+  Check(!baseline || baseline->GetSchema() == &schema,
+    "EncodeSnapshotDelta snapshots must share the schema");
+  const Ui32 field_count = schema.GetFieldCount();
+  const Ui32 id_end = std::max(current.GetCapacity(),
+    baseline ? baseline->GetCapacity() : 0);
+
+  Ui32 changed_count = 0;
+  for (Ui32 id = 0; id < id_end; ++id) {
+    changed_count += IsEntityChanged(baseline, current, id, field_count);
+  }
+  out->WriteVarUint(current.GetCapacity());
+  out->WriteVarUint(changed_count);
+
+  Ui32 next_id = 0;
+  for (Ui32 id = 0; id < id_end && changed_count; ++id) {
+    if (!IsEntityChanged(baseline, current, id, field_count)) {
+      continue;
+    }
+    --changed_count;
+    WriteGamma(id - next_id + 1, out);
+    next_id = id + 1;
+    if (!current.Has(id)) {
+      out->PushBit(0);
+      continue;
+    }
+    out->PushBit(1);
+    const Ui32 *values = current.GetValues(id);
+    if (!baseline || !baseline->Has(id)) {
+      for (Ui32 idx = 0; idx < field_count; ++idx) {
+        out->Write(values[idx], schema.GetField(idx).bits);
+      }
+      continue;
+    }
+    const Ui32 *base_values = baseline->GetValues(id);
+    for (Ui32 idx = 0; idx < field_count; ++idx) {
+      if (values[idx] == base_values[idx]) {
+        out->PushBit(0);
+        continue;
+      }
+      out->PushBit(1);
+      const Ui32 bits = schema.GetField(idx).bits;
+      if (bits > 2) {
+        // A change of +-1 is written as 0, the small range is half the width.
+        const Ui32 small_bits = bits / 2;
+        Ui64 zigzag = BitStream::ZigZagEncode(static_cast<Si64>(values[idx])
+          - static_cast<Si64>(base_values[idx])) - 1;
+        if (zigzag < (1ull << small_bits)) {
+          out->Write((1ull << small_bits) | zigzag, small_bits + 1);
+          continue;
+        }
+        out->PushBit(0);
+      }
+      out->Write(values[idx], bits);
+    }
+  }
+}
+
+bool DecodeSnapshotDelta(const Snapshot *baseline, BitStream *in,
+    Snapshot *out) {
+  const SnapshotSchema &schema = *out->GetSchema();
+  Check(baseline != out, "DecodeSnapshotDelta can't decode into baseline");
+  Check(!baseline || baseline->GetSchema() == &schema,
+    "DecodeSnapshotDelta snapshots must share the schema");
+  const Ui32 field_count = schema.GetFieldCount();
+  Ui64 capacity = in->ReadVarUint();
+  Ui64 changed_count = in->ReadVarUint();
+  const Ui32 baseline_capacity = baseline ? baseline->GetCapacity() : 0;
+  if (capacity > kMaxSnapshotCapacity
+      || changed_count > std::max<Ui64>(capacity, baseline_capacity)) {
+    return false;
+  }
+  if (baseline) {
+    out->values_ = baseline->values_;
+    out->is_present_ = baseline->is_present_;
+  } else {
+    out->Clear();
+  }
+  out->Reserve(static_cast<Ui32>(std::max<Ui64>(capacity, baseline_capacity)));
+
+  Ui64 next_id = 0;
+  for (Ui64 entity_idx = 0; entity_idx < changed_count; ++entity_idx) {
+    Ui32 gap;
+    if (in->ReadBitsLeft() < 2 || !ReadGamma(in, &gap)
+        || in->IsReadPastEnd()) {
+      return false;
+    }
+    Ui64 id = next_id + gap - 1;
+    if (id >= out->GetCapacity()) {
+      return false;
+    }
+    next_id = id + 1;
+    const bool is_in_baseline = baseline && baseline->Has(
+      static_cast<Ui32>(id));
+    if (!in->ReadBit()) {
+      if (!is_in_baseline) {
+        return false;
+      }
+      out->Remove(static_cast<Ui32>(id));
+      continue;
+    }
+    if (id >= capacity) {
+      return false;
+    }
+    Ui32 *values = out->values_.data() + id * field_count;
+    out->is_present_[id] = 1;
+    for (Ui32 idx = 0; idx < field_count; ++idx) {
+      const SnapshotSchema::Field &field = schema.GetField(idx);
+      if (is_in_baseline) {
+        if (!in->ReadBit()) {
+          continue;
+        }
+        if (field.bits > 2 && in->ReadBit()) {
+          const Ui32 small_bits = field.bits / 2;
+          Ui64 zigzag = in->Read(small_bits) + 1;
+          values[idx] = static_cast<Ui32>(static_cast<Si64>(values[idx])
+            + BitStream::ZigZagDecode(zigzag));
+          if (values[idx] > field.max_quantized) {
+            return false;
+          }
+          continue;
+        }
+      }
+      values[idx] = static_cast<Ui32>(in->Read(field.bits));
+      if (values[idx] > field.max_quantized) {
+        return false;
+      }
+    }
+  }
+  if (in->IsReadPastEnd()) {
+    return false;
+  }
+  out->values_.resize(static_cast<std::size_t>(capacity) * field_count);
+  out->is_present_.resize(static_cast<std::size_t>(capacity));
+  return true;
+}
+
+SnapshotSender::SnapshotSender(const SnapshotSchema *schema,
+    Ui32 history_size)
+    : schema_(schema)
+    , history_(std::max<Ui32>(history_size, 1), Snapshot(schema))
+    , is_sent_(history_.size(), false) {
+}
+
+const Snapshot *SnapshotSender::FindSent(Ui32 tick) const {
+  std::size_t slot = tick % history_.size();
+  if (is_sent_[slot] && history_[slot].GetTick() == tick) {
+    return &history_[slot];
+  }
+  return nullptr;
+}
+
+void SnapshotSender::Encode(const Snapshot &current, BitStream *out) {
+  Check(current.GetSchema() == schema_,
+    "SnapshotSender snapshot has a different schema");
+  const Ui32 tick = current.GetTick();
+  const Snapshot *baseline = has_ack_ ? FindSent(acked_tick_) : nullptr;
+  Check(!baseline || tick > acked_tick_,
+    "SnapshotSender ticks must grow");
+  out->WriteVarUint(tick);
+  out->WriteVarUint(baseline ? tick - acked_tick_ : 0);
+  EncodeSnapshotDelta(baseline, current, out);
+
+  std::size_t slot = tick % history_.size();
+  history_[slot] = current;
+  is_sent_[slot] = true;
+}
+
+void SnapshotSender::Ack(Ui32 tick) {
+  if (has_ack_ && tick <= acked_tick_) {
+    return;
+  }
+  if (FindSent(tick)) {
+    acked_tick_ = tick;
+    has_ack_ = true;
+  }
+}
+
+Ui32 SnapshotSender::GetBaselineTick() const {
+  return (has_ack_ && FindSent(acked_tick_)) ? acked_tick_ : 0;
+}
+
+void SnapshotSender::Reset() {
+  has_ack_ = false;
+  acked_tick_ = 0;
+  std::fill(is_sent_.begin(), is_sent_.end(), false);
+}
+
+SnapshotReceiver::SnapshotReceiver(const SnapshotSchema *schema,
+    Ui32 history_size)
+    : schema_(schema)
+    , history_(std::max<Ui32>(history_size, 1), Snapshot(schema))
+    , is_received_(history_.size(), false) {
+}
+
+bool SnapshotReceiver::Decode(BitStream *in, Snapshot *out) {
+  Check(out->GetSchema() == schema_,
+    "SnapshotReceiver snapshot has a different schema");
+  Ui64 tick = in->ReadVarUint();
+  Ui64 baseline_delta = in->ReadVarUint();
+  if (tick > 0xffffffffull || baseline_delta > tick) {
+    return false;
+  }
+  const Snapshot *baseline = nullptr;
+  if (baseline_delta) {
+    Ui32 baseline_tick = static_cast<Ui32>(tick - baseline_delta);
+    std::size_t slot = baseline_tick % history_.size();
+    if (!is_received_[slot] || history_[slot].GetTick() != baseline_tick) {
+      return false;
+    }
+    baseline = &history_[slot];
+  }
+  if (!DecodeSnapshotDelta(baseline, in, out)) {
+    return false;
+  }
+  out->SetTick(static_cast<Ui32>(tick));
+  std::size_t slot = tick % history_.size();
+  history_[slot] = *out;
+  is_received_[slot] = true;
+  last_tick_ = std::max(last_tick_, static_cast<Ui32>(tick));
+  return true;
+}
+
+}  // namespace arctic
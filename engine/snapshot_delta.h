@@ -0,0 +1,267 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef ENGINE_SNAPSHOT_DELTA_H_
+#define ENGINE_SNAPSHOT_DELTA_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/bitstream.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Layout of a replicated POD entity struct
+///
+/// Every field is stored as an unsigned integer of a few bits: integers
+/// keep their low bits, floats are quantized to a range and precision.
+/// Example:
+/// @code
+///   SnapshotSchema schema(sizeof(Unit));
+///   schema.AddFloat(offsetof(Unit, x), -1024.f, 1024.f, 0.01f);
+///   schema.AddUint(offsetof(Unit, hp), sizeof(Unit::hp), 10);
+/// @endcode
+class SnapshotSchema {
+ public:
+  enum FieldKind {
+    kFieldUint = 0,
+    kFieldSint = 1,
+    kFieldFloat = 2
+  };
+
+  struct Field {
+    FieldKind kind;
+    Ui32 offset;
+    Ui32 size;  ///< Size in the struct in bytes
+    Ui32 bits;  ///< Size in the snapshot in bits, 1 to 32
+    float min_value;
+    float max_value;
+    float precision;
+    Ui32 max_quantized;  ///< The largest valid quantized value
+  };
+
+  /// @param struct_size Size of the entity struct in bytes
+  explicit SnapshotSchema(Ui32 struct_size);
+
+  /// @brief Adds an unsigned integer field of 1, 2 or 4 bytes
+  /// @param offset Offset of the field in the struct, offsetof(...)
+  /// @param size Size of the field in bytes
+  /// @param bits Number of low bits replicated, 1 to 32
+  void AddUint(Ui32 offset, Ui32 size, Ui32 bits);
+
+  /// @brief Adds a signed integer field of 1, 2 or 4 bytes
+  /// @param offset Offset of the field in the struct, offsetof(...)
+  /// @param size Size of the field in bytes
+  /// @param bits Number of bits replicated, values must fit in them
+  void AddSint(Ui32 offset, Ui32 size, Ui32 bits);
+
+  /// @brief Adds a float field quantized to a range
+  /// @param offset Offset of the field in the struct, offsetof(...)
+  /// @param min_value Smaller values are clamped
+  /// @param max_value Larger values are clamped
+  /// @param precision The step values are rounded to
+  void AddFloat(Ui32 offset, float min_value, float max_value,
+    float precision);
+
+  Ui32 GetStructSize() const {
+    return struct_size_;
+  }
+
+  Ui32 GetFieldCount() const {
+    return static_cast<Ui32>(fields_.size());
+  }
+
+  const Field &GetField(Ui32 idx) const {
+    return fields_[idx];
+  }
+
+  /// @brief Returns the quantized value of a field of an entity
+  Ui32 Quantize(Ui32 field_idx, const void *entity) const;
+
+  /// @brief Stores a quantized value into a field of an entity
+  void Dequantize(Ui32 field_idx, Ui32 value, void *entity) const;
+
+ private:
+  void AddField(const Field &field);
+
+  Ui32 struct_size_;
+  std::vector<Field> fields_;
+};
+
+/// @brief Quantized state of all entities at one tick
+///
+/// Entities are addressed by dense ids, absent entities cost one bit in
+/// the first full update and nothing afterwards.
+class Snapshot {
+ public:
+  Snapshot();
+  explicit Snapshot(const SnapshotSchema *schema);
+
+  const SnapshotSchema *GetSchema() const {
+    return schema_;
+  }
+
+  Ui32 GetTick() const {
+    return tick_;
+  }
+
+  void SetTick(Ui32 tick) {
+    tick_ = tick;
+  }
+
+  /// @brief Removes all entities
+  void Clear();
+
+  /// @brief Stores an entity, quantizing its fields
+  /// @param entity_id The id, snapshots grow to hold it
+  /// @param entity Pointer to the entity struct
+  void Set(Ui32 entity_id, const void *entity);
+
+  /// @brief Removes an entity
+  void Remove(Ui32 entity_id);
+
+  /// @brief Returns true if the entity is present
+  bool Has(Ui32 entity_id) const {
+    return entity_id < is_present_.size() && is_present_[entity_id];
+  }
+
+  /// @brief Writes the fields of an entity into a struct, rounded to the
+  /// schema precision. Bytes not described by the schema are left as is.
+  /// @return False if the entity is not present
+  bool Get(Ui32 entity_id, void *out_entity) const;
+
+  /// @brief Returns the largest entity id plus one
+  Ui32 GetCapacity() const {
+    return static_cast<Ui32>(is_present_.size());
+  }
+
+  /// @brief Returns the quantized fields of an entity
+  const Ui32 *GetValues(Ui32 entity_id) const {
+    return values_.data() + static_cast<std::size_t>(entity_id) * field_count_;
+  }
+
+  /// @brief Returns true if both hold the same entities with equal values
+  bool IsSame(const Snapshot &other) const;
+
+ private:
+  friend bool DecodeSnapshotDelta(const Snapshot *baseline, BitStream *in,
+    Snapshot *out);
+
+  void Reserve(Ui32 capacity);
+
+  const SnapshotSchema *schema_ = nullptr;
+  Ui32 field_count_ = 0;
+  Ui32 tick_ = 0;
+  std::vector<Ui32> values_;
+  std::vector<Ui8> is_present_;
+};
+
+/// @brief Writes the difference between two snapshots
+///
+/// Only entities that appeared, disappeared or changed are written. Changed
+/// entities carry one bit per field and the changed fields, small changes
+/// as a delta of half the field width.
+/// @param baseline The snapshot the receiver has, nullptr for a full update
+/// @param current The snapshot to send
+/// @param out The stream to append to
+void EncodeSnapshotDelta(const Snapshot *baseline, const Snapshot &current,
+  BitStream *out);
+
+/// @brief Rebuilds a snapshot written by EncodeSnapshotDelta
+/// @param baseline The baseline used for encoding, nullptr for a full update
+/// @param in The stream to read from
+/// @param out The decoded snapshot
+/// @return False if the data is malformed
+bool DecodeSnapshotDelta(const Snapshot *baseline, BitStream *in,
+  Snapshot *out);
+
+/// @brief Sending side of snapshot replication over one connection
+///
+/// Keeps the recently sent snapshots and encodes each new one against the
+/// newest snapshot the receiver acknowledged.
+class SnapshotSender {
+ public:
+  /// @param schema The entity layout
+  /// @param history_size Number of sent snapshots kept as possible baselines
+  explicit SnapshotSender(const SnapshotSchema *schema,
+    Ui32 history_size = 32);
+
+  /// @brief Writes a packet with the tick, the baseline tick and the delta
+  /// @param current The snapshot to send, its tick must grow with each call
+  /// @param out The stream to append to
+  void Encode(const Snapshot &current, BitStream *out);
+
+  /// @brief Marks a sent tick as received
+  void Ack(Ui32 tick);
+
+  /// @brief Returns the baseline of the next packet, 0 if there is none
+  Ui32 GetBaselineTick() const;
+
+  /// @brief Forgets the acknowledged state, the next packet is a full update
+  void Reset();
+
+ private:
+  const Snapshot *FindSent(Ui32 tick) const;
+
+  const SnapshotSchema *schema_;
+  std::vector<Snapshot> history_;
+  std::vector<bool> is_sent_;
+  Ui32 acked_tick_ = 0;
+  bool has_ack_ = false;
+};
+
+/// @brief Receiving side of snapshot replication over one connection
+class SnapshotReceiver {
+ public:
+  /// @param schema The entity layout
+  /// @param history_size Number of received snapshots kept as baselines,
+  /// must not be smaller than the sender's
+  explicit SnapshotReceiver(const SnapshotSchema *schema,
+    Ui32 history_size = 32);
+
+  /// @brief Decodes a packet written by SnapshotSender::Encode
+  /// @param in The stream to read from
+  /// @param out The decoded snapshot
+  /// @return False if the baseline is unknown or the data is malformed
+  bool Decode(BitStream *in, Snapshot *out);
+
+  /// @brief Returns the tick to acknowledge, 0 before the first packet
+  Ui32 GetLastTick() const {
+    return last_tick_;
+  }
+
+ private:
+  const SnapshotSchema *schema_;
+  std::vector<Snapshot> history_;
+  std::vector<bool> is_received_;
+  Ui32 last_tick_ = 0;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // ENGINE_SNAPSHOT_DELTA_H_
@@ -0,0 +1,2160 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Headless software-renderer benchmark. Runs a fixed, seeded catalog of
+// scenes into the engine backbuffer without opening a window and reports
+// ns/pixel, frames/s and a hash of the resulting image as JSON. CsvTable
+// parsing of a generated file is measured in GB/s for 1, 2, 4 ... threads,
+// BitStream writes and reads of mixed-width fields in GB/s as well.
+// Snapshot replication of a 1000 entity world reports bytes per tick
+// against the raw entity state and encode/decode time per tick.
+// CompressedDataWriter/Reader report MB/s, the compression ratio and the
+// rate the writing thread sees with compression in the background.
+// SocketPoller drains 2000 mostly idle loopback connections and reports
+// events/s and CPU time per event against reading every socket in turn.
+// DatagramSocket reports loopback packets/s for one call per datagram
+// against sendmmsg/recvmmsg batches and UDP segmentation offload.
+// NetConnection streams ordered messages over a simulated link with 50 ms
+// latency at 0, 5 and 20% loss and over loopback, reporting throughput,
+// latency, bytes on the wire and CPU time per message.
+// FramedConnection streams length prefixed messages over loopback TCP and
+// reports messages/s and heap allocations per message against framing by
+// hand with a std::vector per message.
+// NetSim runs the client/router/server network model on the EventScheduler
+// with 5 and 10000 clients and reports events/s and simulated seconds per
+// wall clock second.
+// Asset loading reads 2000 small files loose and from a mounted AssetPack,
+// stored, deflated and through MappedFile, and reports the open+read
+// latency per file.
+// Async loading decodes 2000 generated TGA sprites and WAV sounds on the
+// main thread and through LoadSpriteAsync/LoadSoundAsync with 1 and with
+// the default number of decode threads, and reports loads/s, the speedup
+// and the longest main thread stall per frame.
+//
+// Usage: headless_benchmark [--out result.json] [--baseline result.json]
+//                           [--min-time seconds] [--filter substring]
+//                           [--csv-mb megabytes]
+// With --baseline the image hashes are compared against a previous run and
+// the process exits with code 1 if any scene renders differently. CSV runs
+// must produce the same table for every thread count, BitStream reads must
+// return the written values, snapshot receivers must rebuild the sent world,
+// compressed files must read back the written data, the poller must
+// see every byte sent, datagrams must arrive complete and in order and
+// so must every NetConnection stream and every framed TCP stream. NetSim
+// runs must complete at least as many level downloads as there are
+// clients. Every asset read must return the same bytes and every async load
+// must decode the same pixels and samples as the synchronous one.
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include <chrono>  // NOLINT
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "engine/arctic_platform.h"
+#include "engine/arctic_platform_tcpip.h"
+#include "engine/asset_pack.h"
+#include "engine/async_loader.h"
+#include "engine/bitstream.h"
+#include "engine/compressed_data.h"
+#include "engine/csv.h"
+#include "engine/easy.h"
+#include "engine/easy_files.h"
+#include "engine/gui.h"
+#include "engine/json.h"
+#include "engine/net_channel.h"
+#include "engine/net_framing.h"
+#include "engine/snapshot_delta.h"
+#include "template_project_name/net_sim.h"
+
+using namespace arctic;  // NOLINT
+using json = nlohmann::json;
+
+// Every heap allocation in the process is counted so that a benchmark can
+// report allocations per operation, the relaxed increment costs next to
+// nothing compared to malloc itself.
+std::atomic<Ui64> g_allocation_count(0);
+
+void *operator new(std::size_t size) {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void *result = std::malloc(size ? size : 1);
+  if (!result) {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+const Si32 kWidth = 1280;
+const Si32 kHeight = 720;
+const Si32 kWarmupFrames = 3;
+const Si32 kMinFrames = 5;
+
+struct Scene {
+  std::string name;
+  std::function<void()> draw;
+  Ui64 pixels_per_frame = 0;
+};
+
+struct SceneResult {
+  std::string name;
+  Si64 frames = 0;
+  double ns_per_pixel = 0.0;
+  double fps = 0.0;
+  Ui64 hash = 0;
+};
+
+// Deterministic generator, the engine RNG is seeded from the clock.
+class SceneRandom {
+  Ui64 state_;
+
+ public:
+  explicit SceneRandom(Ui64 seed)
+      : state_(seed * 0x9E3779B97F4A7C15ull + 1) {
+  }
+
+  Ui32 Next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return static_cast<Ui32>(state_ >> 32);
+  }
+
+  Si32 Range(Si32 min, Si32 max) {
+    return min + static_cast<Si32>(Next() % static_cast<Ui32>(max - min + 1));
+  }
+
+  float Unit() {
+    return static_cast<float>(Next() >> 8) / 16777216.f;
+  }
+
+  Rgba Color(Ui8 alpha) {
+    Ui32 v = Next();
+    return Rgba(static_cast<Ui8>(v), static_cast<Ui8>(v >> 8),
+      static_cast<Ui8>(v >> 16), alpha);
+  }
+};
+
+struct Placement {
+  Vec2Si32 pos;
+  Vec2Si32 size;
+  float angle = 0.f;
+  Rgba color;
+};
+
+Font g_font;
+Sprite g_sprites[4];
+std::vector<std::shared_ptr<Panel>> g_gui_roots;
+
+Sprite MakeTestSprite(Si32 width, Si32 height, Ui64 seed) {
+  SceneRandom rnd(seed);
+  Sprite sprite;
+  sprite.Create(width, height);
+  Rgba base = rnd.Color(255);
+  for (Si32 y = 0; y < height; ++y) {
+    Rgba *row = sprite.RgbaData() + y * sprite.StridePixels();
+    for (Si32 x = 0; x < width; ++x) {
+      Si32 dx = x * 2 - width;
+      Si32 dy = y * 2 - height;
+      Si32 d = (dx * dx + dy * dy) * 255 / (width * width);
+      Ui8 alpha = static_cast<Ui8>(d >= 255 ? 0 : 255 - d);
+      Ui8 noise = static_cast<Ui8>(rnd.Next() & 31);
+      row[x] = Rgba(static_cast<Ui8>(base.r ^ noise),
+        static_cast<Ui8>(base.g ^ (x * 4)), static_cast<Ui8>(base.b ^ (y * 4)),
+        alpha);
+    }
+  }
+  return sprite;
+}
+
+std::vector<Placement> MakePlacements(Ui64 seed, Si32 count,
+    Si32 min_size, Si32 max_size) {
+  SceneRandom rnd(seed);
+  std::vector<Placement> placements(static_cast<size_t>(count));
+  for (Placement &p : placements) {
+    p.size.x = rnd.Range(min_size, max_size);
+    p.size.y = rnd.Range(min_size, max_size);
+    p.pos.x = rnd.Range(-p.size.x / 2, kWidth - p.size.x / 2);
+    p.pos.y = rnd.Range(-p.size.y / 2, kHeight - p.size.y / 2);
+    p.angle = rnd.Unit() * 6.2831853f;
+    p.color = rnd.Color(static_cast<Ui8>(rnd.Range(64, 255)));
+  }
+  return placements;
+}
+
+Ui64 TotalArea(const std::vector<Placement> &placements) {
+  Ui64 area = 0;
+  for (const Placement &p : placements) {
+    area += static_cast<Ui64>(p.size.x) * static_cast<Ui64>(p.size.y);
+  }
+  return area;
+}
+
+Ui64 HashBackbuffer() {
+  Sprite &backbuffer = GetEngine()->GetBackbuffer();
+  Ui64 hash = 0xcbf29ce484222325ull;
+  for (Si32 y = 0; y < backbuffer.Height(); ++y) {
+    const Ui8 *row = reinterpret_cast<const Ui8*>(
+      backbuffer.RgbaData() + y * backbuffer.StridePixels());
+    for (Si32 i = 0; i < backbuffer.Width() * 4; ++i) {
+      hash = (hash ^ row[i]) * 0x100000001b3ull;
+    }
+  }
+  return hash;
+}
+
+const char *BlendingModeName(DrawBlendingMode mode) {
+  switch (mode) {
+    case kDrawBlendingModeCopyRgba: return "copy";
+    case kDrawBlendingModeAlphaBlend: return "alpha";
+    case kDrawBlendingModeColorize: return "colorize";
+    case kDrawBlendingModeAdd: return "add";
+    case kDrawBlendingModeSolidColor: return "solid";
+    case kDrawBlendingModePremultipliedAlphaBlend: return "premultiplied";
+  }
+  return "unknown";
+}
+
+void AddSpriteScenes(std::vector<Scene> *scenes) {
+  const DrawBlendingMode kModes[] = {
+    kDrawBlendingModeCopyRgba,
+    kDrawBlendingModeAlphaBlend,
+    kDrawBlendingModeColorize,
+    kDrawBlendingModeAdd,
+    kDrawBlendingModeSolidColor,
+    kDrawBlendingModePremultipliedAlphaBlend
+  };
+  const DrawFilterMode kFilters[] = {kFilterNearest, kFilterBilinear};
+  for (DrawBlendingMode mode : kModes) {
+    Scene scene;
+    scene.name = std::string("blit_") + BlendingModeName(mode);
+    auto placements = std::make_shared<std::vector<Placement>>(
+      MakePlacements(100 + mode, 400, 64, 64));
+    scene.pixels_per_frame = TotalArea(*placements);
+    scene.draw = [placements, mode]() {
+      Sprite &backbuffer = GetEngine()->GetBackbuffer();
+      Si32 idx = 0;
+      for (const Placement &p : *placements) {
+        g_sprites[idx++ & 3].Draw(backbuffer, p.pos, mode, kFilterNearest,
+          p.color);
+      }
+    };
+    scenes->push_back(scene);
+  }
+  for (DrawFilterMode filter : kFilters) {
+    Scene scene;
+    scene.name = std::string("blit_scaled_") +
+      (filter == kFilterNearest ? "nearest" : "bilinear");
+    auto placements = std::make_shared<std::vector<Placement>>(
+      MakePlacements(200 + filter, 200, 24, 160));
+    scene.pixels_per_frame = TotalArea(*placements);
+    scene.draw = [placements, filter]() {
+      Sprite &backbuffer = GetEngine()->GetBackbuffer();
+      Si32 idx = 0;
+      for (const Placement &p : *placements) {
+        Sprite &sprite = g_sprites[idx++ & 3];
+        sprite.Draw(backbuffer, p.pos.x, p.pos.y, p.size.x, p.size.y,
+          0, 0, sprite.Width(), sprite.Height(),
+          kDrawBlendingModeAlphaBlend, filter, p.color);
+      }
+    };
+    scenes->push_back(scene);
+  }
+  for (DrawFilterMode filter : kFilters) {
+    Scene scene;
+    scene.name = std::string("rotated_") +
+      (filter == kFilterNearest ? "nearest" : "bilinear");
+    auto placements = std::make_shared<std::vector<Placement>>(
+      MakePlacements(300 + filter, 200, 24, 160));
+    scene.pixels_per_frame = TotalArea(*placements);
+    scene.draw = [placements, filter]() {
+      Sprite &backbuffer = GetEngine()->GetBackbuffer();
+      Si32 idx = 0;
+      for (const Placement &p : *placements) {
+        g_sprites[idx++ & 3].Draw(static_cast<float>(p.pos.x),
+          static_cast<float>(p.pos.y),
+          static_cast<float>(p.size.x), static_cast<float>(p.size.y),
+          p.angle, backbuffer, kDrawBlendingModeAlphaBlend, filter, p.color);
+      }
+    };
+    scenes->push_back(scene);
+  }
+}
+
+void AddTextScene(std::vector<Scene> *scenes) {
+  Scene scene;
+  scene.name = "text";
+  auto placements = std::make_shared<std::vector<Placement>>(
+    MakePlacements(400, 300, 8, 8));
+  auto lines = std::make_shared<std::vector<std::string>>();
+  SceneRandom rnd(401);
+  for (Placement &p : *placements) {
+    std::string line;
+    Si32 length = rnd.Range(8, 48);
+    for (Si32 i = 0; i < length; ++i) {
+      line.push_back(static_cast<char>(rnd.Range(0, 5) ? rnd.Range('a', 'z') : ' '));
+    }
+    p.size = g_font.EvaluateSize(line.c_str(), false);
+    lines->push_back(line);
+  }
+  scene.pixels_per_frame = TotalArea(*placements);
+  scene.draw = [placements, lines]() {
+    for (size_t i = 0; i < placements->size(); ++i) {
+      const Placement &p = (*placements)[i];
+      g_font.Draw((*lines)[i].c_str(), p.pos.x, p.pos.y, kTextOriginBottom,
+        kTextAlignmentLeft, kDrawBlendingModeColorize, kFilterNearest,
+        p.color);
+    }
+  };
+  scenes->push_back(scene);
+}
+
+void AddShapeScenes(std::vector<Scene> *scenes) {
+  {
+    Scene scene;
+    scene.name = "ovals";
+    auto placements = std::make_shared<std::vector<Placement>>(
+      MakePlacements(500, 300, 8, 120));
+    for (Placement &p : *placements) {
+      scene.pixels_per_frame += static_cast<Ui64>(
+        3.14159265 * p.size.x * p.size.y);
+    }
+    scene.draw = [placements]() {
+      Sprite &backbuffer = GetEngine()->GetBackbuffer();
+      for (const Placement &p : *placements) {
+        DrawOval(backbuffer, p.pos, p.size, p.color);
+      }
+    };
+    scenes->push_back(scene);
+  }
+  {
+    Scene scene;
+    scene.name = "blocks";
+    auto placements = std::make_shared<std::vector<Placement>>(
+      MakePlacements(600, 300, 16, 200));
+    scene.pixels_per_frame = TotalArea(*placements);
+    scene.draw = [placements]() {
+      Sprite &backbuffer = GetEngine()->GetBackbuffer();
+      for (const Placement &p : *placements) {
+        float radius = static_cast<float>(std::min(p.size.x, p.size.y)) * 0.25f;
+        DrawBlock(backbuffer, Vec2F(p.pos), Vec2F(p.size), radius, p.color,
+          2.f, Rgba(0, 0, 0, 255));
+      }
+    };
+    scenes->push_back(scene);
+  }
+}
+
+Ui64 AddGuiChildren(std::shared_ptr<Panel> parent, Vec2Si32 size, Si32 depth,
+    SceneRandom *rnd, Ui64 *tag) {
+  Ui64 area = 0;
+  if (depth == 0) {
+    return area;
+  }
+  const Si32 kColumns = 3;
+  const Si32 kRows = 2;
+  Vec2Si32 cell(size.x / kColumns, size.y / kRows);
+  for (Si32 y = 0; y < kRows; ++y) {
+    for (Si32 x = 0; x < kColumns; ++x) {
+      Vec2Si32 child_size = cell - Vec2Si32(8, 8);
+      Sprite background = g_sprites[rnd->Range(0, 3)];
+      Ui64 panel_tag = (*tag)++;
+      Ui64 text_tag = (*tag)++;
+      auto child = std::make_shared<Panel>(panel_tag,
+        Vec2Si32(x * cell.x + 4, y * cell.y + 4), child_size, 0, background);
+      area += static_cast<Ui64>(child_size.x) * static_cast<Ui64>(child_size.y);
+      auto text = std::make_shared<Text>(text_tag, Vec2Si32(4, 4),
+        Vec2Si32(child_size.x - 8, 12), 0, g_font, kTextOriginBottom,
+        rnd->Color(255), "Panel " + std::to_string(text_tag));
+      child->AddChild(text);
+      area += AddGuiChildren(child, child_size, depth - 1, rnd, tag);
+      parent->AddChild(child);
+    }
+  }
+  return area;
+}
+
+void AddGuiScene(std::vector<Scene> *scenes) {
+  Scene scene;
+  scene.name = "gui_tree";
+  SceneRandom rnd(700);
+  Ui64 tag = 1;
+  auto root = std::make_shared<Panel>(tag++, Vec2Si32(0, 0),
+    Vec2Si32(kWidth, kHeight), 0, g_sprites[0]);
+  scene.pixels_per_frame = static_cast<Ui64>(kWidth) * kHeight +
+    AddGuiChildren(root, Vec2Si32(kWidth, kHeight), 3, &rnd, &tag);
+  g_gui_roots.push_back(root);
+  scene.draw = [root]() {
+    root->Draw(Vec2Si32(0, 0));
+  };
+  scenes->push_back(scene);
+}
+
+SceneResult RunScene(const Scene &scene, double min_time) {
+  SceneResult result;
+  result.name = scene.name;
+  for (Si32 i = 0; i < kWarmupFrames; ++i) {
+    Clear(Rgba(16, 16, 16, 255));
+    scene.draw();
+  }
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0.0;
+  while (result.frames < kMinFrames || elapsed < min_time) {
+    Clear(Rgba(16, 16, 16, 255));
+    scene.draw();
+    ++result.frames;
+    elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  }
+  result.hash = HashBackbuffer();
+  result.fps = static_cast<double>(result.frames) / elapsed;
+  result.ns_per_pixel = elapsed * 1e9 /
+    (static_cast<double>(result.frames) *
+     static_cast<double>(std::max(scene.pixels_per_frame, Ui64(1))));
+  return result;
+}
+
+std::string HashToString(Ui64 hash) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+  return buf;
+}
+
+// Seeded CSV with numbers, plain text and quoted cells holding separators,
+// escaped quotes and line breaks.
+std::string MakeCsvData(Ui64 seed, Ui64 size) {
+  SceneRandom rnd(seed);
+  std::string data = "id,x,y,name,comment\n";
+  data.reserve(static_cast<size_t>(size + 256));
+  char buf[96];
+  for (Ui64 id = 0; data.size() < size; ++id) {
+    snprintf(buf, sizeof(buf), "%llu,%d,%.4f,name%u,",
+      static_cast<unsigned long long>(id), rnd.Range(-100000, 100000),
+      rnd.Unit() * 1000.f, rnd.Next() % 1000);
+    data += buf;
+    switch (rnd.Next() % 4) {
+      case 0: data += "\"quoted, with \"\"escapes\"\"\"\n"; break;
+      case 1: data += "\"two\nlines\"\n"; break;
+      default: data += "plain comment text\n"; break;
+    }
+  }
+  return data;
+}
+
+struct CsvResult {
+  std::string name;
+  Ui32 threads = 1;
+  Si64 runs = 0;
+  double gb_per_s = 0.0;
+  Ui64 rows = 0;
+  Ui64 hash = 0;
+};
+
+CsvResult RunCsvParse(const std::string &data, Ui32 threads, double min_time) {
+  CsvResult result;
+  result.name = "csv_parse_t" + std::to_string(threads);
+  result.threads = threads;
+  CsvTable table;
+  table.SetParallelism(threads);
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0.0;
+  while (result.runs < kMinFrames || elapsed < min_time) {
+    table.LoadString(data);
+    ++result.runs;
+    elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  }
+  result.gb_per_s = static_cast<double>(data.size()) *
+    static_cast<double>(result.runs) / elapsed / 1e9;
+  result.rows = table.RowCount();
+  result.hash = 0xcbf29ce484222325ull;
+  for (Ui64 row = 0; row < table.RowCount(); ++row) {
+    for (Ui64 column = 0; column < table.ColumnCount(); ++column) {
+      CsvCell cell = table.GetCell(row, column);
+      for (Ui64 i = 0; i < cell.size; ++i) {
+        result.hash = (result.hash ^ static_cast<Ui8>(cell.data[i])) *
+          0x100000001b3ull;
+      }
+      result.hash = (result.hash ^ 0xff) * 0x100000001b3ull;
+    }
+  }
+  return result;
+}
+
+struct BitStreamResult {
+  std::string name;
+  Si64 runs = 0;
+  double write_gb_per_s = 0.0;
+  double read_gb_per_s = 0.0;
+  bool is_correct = true;
+};
+
+// Fields of 1 to max_bits bits, the widths a snapshot or entropy coder
+// produces.
+BitStreamResult RunBitStream(Ui32 max_bits, double min_time) {
+  const size_t kFieldCount = 1 << 22;
+  BitStreamResult result;
+  result.name = "bitstream_" + std::to_string(max_bits);
+  SceneRandom rnd(max_bits);
+  std::vector<Ui64> values(kFieldCount);
+  std::vector<Ui32> widths(kFieldCount);
+  Ui64 bit_count = 0;
+  for (size_t i = 0; i < kFieldCount; ++i) {
+    widths[i] = 1 + rnd.Next() % max_bits;
+    values[i] = ((static_cast<Ui64>(rnd.Next()) << 32) | rnd.Next()) &
+      (~0ull >> (64 - widths[i]));
+    bit_count += widths[i];
+  }
+  BitStream stream;
+  stream.Reserve(bit_count / 8 + 1);
+  double write_time = 0.0;
+  double read_time = 0.0;
+  while (result.runs < kMinFrames || write_time + read_time < min_time) {
+    stream.Clear();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kFieldCount; ++i) {
+      stream.Write(values[i], widths[i]);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    stream.BeginRead();
+    Ui64 mismatch = 0;
+    for (size_t i = 0; i < kFieldCount; ++i) {
+      mismatch |= stream.Read(widths[i]) ^ values[i];
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.is_correct = result.is_correct && mismatch == 0;
+    write_time += std::chrono::duration<double>(middle - start).count();
+    read_time += std::chrono::duration<double>(end - middle).count();
+    ++result.runs;
+  }
+  double bytes = static_cast<double>(bit_count) / 8.0 *
+    static_cast<double>(result.runs);
+  result.write_gb_per_s = bytes / write_time / 1e9;
+  result.read_gb_per_s = bytes / read_time / 1e9;
+  return result;
+}
+
+struct SnapshotUnit {
+  float x;
+  float y;
+  float z;
+  float yaw;
+  Ui16 hp;
+  Ui8 state;
+};
+
+struct SnapshotResult {
+  std::string name;
+  Si64 runs = 0;
+  double bytes_per_tick = 0.0;
+  double raw_bytes_per_tick = 0.0;
+  double encode_us = 0.0;
+  double decode_us = 0.0;
+  bool is_correct = true;
+};
+
+// A world of kEntityCount units where a fifth moves every tick, a few take
+// damage and some respawn. Acks arrive kAckLatency ticks after the packet,
+// lost packets are never acked.
+SnapshotResult RunSnapshot(Ui32 loss_percent, double min_time) {
+  const Ui32 kEntityCount = 1000;
+  const Ui32 kTickCount = 300;
+  const Ui32 kAckLatency = 3;
+  SnapshotResult result;
+  result.name = "snapshot_1000_loss" + std::to_string(loss_percent);
+  SnapshotSchema schema(sizeof(SnapshotUnit));
+  schema.AddFloat(offsetof(SnapshotUnit, x), -4096.f, 4096.f, 1.f / 64.f);
+  schema.AddFloat(offsetof(SnapshotUnit, y), -4096.f, 4096.f, 1.f / 64.f);
+  schema.AddFloat(offsetof(SnapshotUnit, z), -256.f, 256.f, 1.f / 64.f);
+  schema.AddFloat(offsetof(SnapshotUnit, yaw), 0.f, 6.2832f, 0.01f);
+  schema.AddUint(offsetof(SnapshotUnit, hp), 2, 10);
+  schema.AddUint(offsetof(SnapshotUnit, state), 1, 3);
+
+  SceneRandom rnd(1000 + loss_percent);
+  std::vector<SnapshotUnit> units(kEntityCount);
+  for (SnapshotUnit &unit : units) {
+    unit.x = static_cast<float>(rnd.Next() % 4000);
+    unit.y = static_cast<float>(rnd.Next() % 4000);
+    unit.z = 0.f;
+    unit.yaw = 0.f;
+    unit.hp = 1000;
+    unit.state = 0;
+  }
+  std::vector<Snapshot> ticks(kTickCount, Snapshot(&schema));
+  for (Ui32 tick = 0; tick < kTickCount; ++tick) {
+    Snapshot &snapshot = ticks[tick];
+    snapshot.SetTick(tick + 1);
+    for (Ui32 id = 0; id < kEntityCount; ++id) {
+      SnapshotUnit &unit = units[id];
+      Ui32 roll = rnd.Next() % 100;
+      if (roll < 20) {
+        unit.yaw = static_cast<float>(rnd.Next() % 628) * 0.01f;
+        unit.x += std::cos(unit.yaw) * 0.25f;
+        unit.y += std::sin(unit.yaw) * 0.25f;
+        unit.state = 1;
+      } else if (roll < 22) {
+        unit.hp = static_cast<Ui16>(unit.hp > 10 ? unit.hp - 10 : 1000);
+        unit.state = 2;
+      } else if (roll < 24) {
+        unit.state = 0;
+      }
+      if (roll == 99 && rnd.Next() % 4 == 0) {
+        continue;  // Despawned for this tick
+      }
+      snapshot.Set(id, &unit);
+    }
+  }
+  result.raw_bytes_per_tick = static_cast<double>(kEntityCount)
+    * sizeof(SnapshotUnit);
+
+  Ui64 total_bits = 0;
+  double encode_time = 0.0;
+  double decode_time = 0.0;
+  BitStream packet;
+  Snapshot decoded(&schema);
+  while (result.runs < kMinFrames || encode_time + decode_time < min_time) {
+    SnapshotSender sender(&schema);
+    SnapshotReceiver receiver(&schema);
+    std::vector<Ui32> acks(kTickCount + kAckLatency, 0);
+    for (Ui32 tick = 0; tick < kTickCount; ++tick) {
+      if (acks[tick]) {
+        sender.Ack(acks[tick]);
+      }
+      packet.Clear();
+      auto start = std::chrono::steady_clock::now();
+      sender.Encode(ticks[tick], &packet);
+      packet.GetData();
+      auto middle = std::chrono::steady_clock::now();
+      total_bits += packet.BitCount();
+      encode_time += std::chrono::duration<double>(middle - start).count();
+      if (rnd.Next() % 100 < loss_percent) {
+        continue;
+      }
+      middle = std::chrono::steady_clock::now();
+      packet.BeginRead();
+      bool is_ok = receiver.Decode(&packet, &decoded);
+      auto end = std::chrono::steady_clock::now();
+      decode_time += std::chrono::duration<double>(end - middle).count();
+      result.is_correct = result.is_correct && is_ok &&
+        decoded.IsSame(ticks[tick]);
+      acks[tick + kAckLatency] = receiver.GetLastTick();
+    }
+    ++result.runs;
+  }
+  double tick_count = static_cast<double>(kTickCount) *
+    static_cast<double>(result.runs);
+  result.bytes_per_tick = static_cast<double>(total_bits) / 8.0 / tick_count;
+  result.encode_us = encode_time * 1e6 / tick_count;
+  result.decode_us = decode_time * 1e6 / tick_count;
+  return result;
+}
+
+struct CompressionResult {
+  std::string name;
+  Si64 runs = 0;
+  double compress_mb_per_s = 0.0;
+  double caller_mb_per_s = 0.0;
+  double decompress_mb_per_s = 0.0;
+  double ratio = 0.0;
+  bool is_correct = true;
+};
+
+// A save-game-like stream of records with small integers, coordinates
+// and flags, or random bytes that don't compress at all.
+std::vector<Ui32> MakeSaveData(Ui64 seed, Ui64 size, bool is_noise) {
+  SceneRandom rnd(seed);
+  std::vector<Ui32> words(static_cast<size_t>(size / 4));
+  for (size_t i = 0; i < words.size(); i += 8) {
+    for (size_t j = i; j < std::min(words.size(), i + 8); ++j) {
+      words[j] = is_noise ? rnd.Next()
+        : (j == i ? static_cast<Ui32>(i / 8)
+        : j < i + 4 ? 1000 + rnd.Next() % 4000
+        : rnd.Next() % 16);
+    }
+  }
+  return words;
+}
+
+CompressionResult RunCompression(const std::vector<Ui32> &words,
+    const char *name, Si32 level, double min_time) {
+  const char *path = "headless_benchmark_compressed.tmp";
+  const size_t kRecordWords = 8;
+  CompressionResult result;
+  result.name = name;
+  const double megabytes = static_cast<double>(words.size()) * 4.0 / 1e6;
+  double compress_time = 0.0;
+  double caller_time = 0.0;
+  double decompress_time = 0.0;
+  std::vector<Ui32> record(kRecordWords);
+  while (result.runs < 1 || compress_time + decompress_time < min_time) {
+    CompressedDataWriter writer;
+    auto start = std::chrono::steady_clock::now();
+    writer.Open(path, level);
+    for (size_t i = 0; i < words.size(); i += kRecordWords) {
+      writer.WriteArray(words.data() + i,
+        std::min(kRecordWords, words.size() - i));
+    }
+    auto written = std::chrono::steady_clock::now();
+    result.is_correct = writer.Close() && result.is_correct;
+    auto closed = std::chrono::steady_clock::now();
+    result.ratio = static_cast<double>(writer.GetCompressedSize()) /
+      static_cast<double>(writer.GetRawSize());
+
+    CompressedDataReader reader;
+    reader.Open(path);
+    bool is_same = true;
+    for (size_t i = 0; i < words.size(); i += kRecordWords) {
+      size_t count = std::min(kRecordWords, words.size() - i);
+      reader.ReadUInt32array(record.data(), count);
+      is_same = is_same && std::memcmp(record.data(), words.data() + i,
+        count * 4) == 0;
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.is_correct = result.is_correct && is_same && reader.IsOk();
+    caller_time += std::chrono::duration<double>(written - start).count();
+    compress_time += std::chrono::duration<double>(closed - start).count();
+    decompress_time += std::chrono::duration<double>(end - closed).count();
+    ++result.runs;
+  }
+  std::remove(path);
+  const double total = megabytes * static_cast<double>(result.runs);
+  result.compress_mb_per_s = total / compress_time;
+  result.caller_mb_per_s = total / caller_time;
+  result.decompress_mb_per_s = total / decompress_time;
+  return result;
+}
+
+struct PollerResult {
+  std::string name;
+  Si64 connections = 0;
+  Si64 rounds = 0;
+  double events_per_s = 0.0;
+  double cpu_us_per_event = 0.0;
+  bool is_correct = true;
+};
+
+double ThreadCpuSeconds() {
+  timespec time{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return static_cast<double>(time.tv_sec) +
+    static_cast<double>(time.tv_nsec) * 1e-9;
+}
+
+// Loopback client/server socket pairs, each pair costs two descriptors so
+// the count is capped by RLIMIT_NOFILE after raising it as far as allowed.
+struct LoopbackConnections {
+  ListenerSocket listener;
+  std::vector<ConnectionSocket> clients;
+  std::vector<ConnectionSocket> servers;
+
+  bool Open(Si64 count) {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+      limit.rlim_cur = limit.rlim_max;
+      setrlimit(RLIMIT_NOFILE, &limit);
+      getrlimit(RLIMIT_NOFILE, &limit);
+      count = std::min(count, static_cast<Si64>(limit.rlim_cur / 2) - 32);
+    }
+    listener = ListenerSocket(AddressFamily::kIpV4, SocketProtocol::kTcp);
+    if (listener.Bind("127.0.0.1", 0, 1024) != SocketResult::kSocketOk) {
+      return false;
+    }
+    uint16_t port = listener.GetLocalPort();
+    for (Si64 i = 0; i < count; ++i) {
+      ConnectionSocket client(AddressFamily::kIpV4, SocketProtocol::kTcp);
+      if (client.Connect("127.0.0.1", port) !=
+          SocketConnectResult::kSocketOk) {
+        break;
+      }
+      ConnectionSocket server = listener.Accept();
+      if (!server.IsValid() ||
+          server.SetSoNonblocking(true) != SocketResult::kSocketOk) {
+        break;
+      }
+      clients.push_back(std::move(client));
+      servers.push_back(std::move(server));
+    }
+    return !servers.empty();
+  }
+};
+
+// Each round a few random clients send a byte, the server side finds and
+// drains them either with SocketPoller or by reading every socket in turn.
+// Only the server side is timed.
+PollerResult RunPoller(LoopbackConnections *connections, const char *name,
+    bool is_busy_poll, double min_time) {
+  const Si64 kActivePerRound = 16;
+  PollerResult result;
+  result.name = name;
+  result.connections = static_cast<Si64>(connections->servers.size());
+  SocketPoller poller;
+  for (size_t i = 0; i < connections->servers.size() && !is_busy_poll; ++i) {
+    result.is_correct = result.is_correct &&
+      poller.Add(connections->servers[i], kSocketEventRead, i) ==
+        SocketResult::kSocketOk;
+  }
+  SceneRandom rnd(1100);
+  std::vector<SocketEvent> events(static_cast<size_t>(kActivePerRound));
+  std::vector<bool> is_sent(connections->servers.size());
+  double wall_time = 0.0;
+  double cpu_time = 0.0;
+  Si64 event_count = 0;
+  char buffer[256];
+  while (result.rounds < kMinFrames || wall_time < min_time) {
+    Si64 expected = 0;
+    for (Si64 i = 0; i < kActivePerRound; ++i) {
+      size_t idx = rnd.Next() % connections->clients.size();
+      size_t size = 0;
+      if (!is_sent[idx] &&
+          connections->clients[idx].Write("x", 1, &size) ==
+            SocketResult::kSocketOk && size == 1) {
+        is_sent[idx] = true;
+        ++expected;
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    double cpu_start = ThreadCpuSeconds();
+    Si64 received = 0;
+    for (Si32 attempt = 0; received < expected && attempt < 1000;
+        ++attempt) {
+      if (is_busy_poll) {
+        for (size_t idx = 0; idx < connections->servers.size(); ++idx) {
+          size_t size = 0;
+          if (connections->servers[idx].Read(buffer, sizeof(buffer), &size)
+              == SocketResult::kSocketOk && size) {
+            is_sent[idx] = false;
+            ++received;
+          }
+        }
+        continue;
+      }
+      size_t count = 0;
+      if (poller.Wait(events.data(), events.size(), 100, &count) !=
+          SocketResult::kSocketOk) {
+        break;
+      }
+      for (size_t e = 0; e < count; ++e) {
+        size_t idx = static_cast<size_t>(events[e].token);
+        size_t size = 0;
+        // Drain the socket, edge-triggered events come once per arrival
+        while (connections->servers[idx].Read(buffer, sizeof(buffer), &size)
+            == SocketResult::kSocketOk && size) {
+          if (is_sent[idx]) {
+            is_sent[idx] = false;
+            ++received;
+          }
+        }
+      }
+    }
+    cpu_time += ThreadCpuSeconds() - cpu_start;
+    wall_time += std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    result.is_correct = result.is_correct && received == expected;
+    event_count += received;
+    ++result.rounds;
+  }
+  result.events_per_s = static_cast<double>(event_count) / wall_time;
+  result.cpu_us_per_event = cpu_time * 1e6 /
+    static_cast<double>(std::max<Si64>(event_count, 1));
+  return result;
+}
+
+struct DatagramResult {
+  std::string name;
+  Si64 packets = 0;
+  double packets_per_s = 0.0;
+  bool is_supported = true;
+  bool is_correct = true;
+};
+
+enum DatagramMode {
+  kDatagramSingle = 0,
+  kDatagramBatch = 1,
+  kDatagramGso = 2
+};
+
+// Rounds of 64 datagrams go over loopback, every datagram carries its
+// sequence number, sending and receiving are timed together.
+DatagramResult RunDatagram(const char *name, DatagramMode mode,
+    size_t packet_size, double min_time) {
+  const size_t kPerRound = 64;
+  DatagramResult result;
+  result.name = name;
+  DatagramSocket receiver(AddressFamily::kIpV4);
+  DatagramSocket sender(AddressFamily::kIpV4);
+  SocketAddress address;
+  result.is_correct = receiver.Bind("127.0.0.1", 0) ==
+      SocketResult::kSocketOk &&
+    receiver.SetSoNonblocking(true) == SocketResult::kSocketOk &&
+    receiver.SetSoReceiveBufferSize(4 << 20) == SocketResult::kSocketOk &&
+    address.Resolve("127.0.0.1", receiver.GetLocalPort());
+  if (mode == kDatagramGso) {
+    result.is_supported = sender.SetUdpSegmentSize(
+      static_cast<uint16_t>(packet_size)) == SocketResult::kSocketOk;
+  }
+  if (!result.is_correct || !result.is_supported) {
+    return result;
+  }
+  // A single send is limited to 64 KiB
+  const size_t gso_step = std::min(kPerRound, 65000 / packet_size) *
+    packet_size;
+  DatagramPacketPool outgoing(kPerRound, packet_size);
+  DatagramPacketPool incoming(kPerRound, packet_size);
+  std::vector<Ui8> gso_buffer(kPerRound * packet_size);
+  Ui32 next_sent = 0;
+  Ui32 next_received = 0;
+  double time = 0.0;
+  Si64 rounds = 0;
+  while (rounds < kMinFrames || time < min_time) {
+    for (size_t i = 0; i < kPerRound; ++i) {
+      Ui32 seq = next_sent + static_cast<Ui32>(i);
+      outgoing[i].address = address;
+      outgoing[i].size = packet_size;
+      std::memset(outgoing[i].data, static_cast<int>(seq), packet_size);
+      std::memcpy(outgoing[i].data, &seq, sizeof(seq));
+      std::memcpy(gso_buffer.data() + i * packet_size, outgoing[i].data,
+        packet_size);
+    }
+    next_sent += static_cast<Ui32>(kPerRound);
+    auto start = std::chrono::steady_clock::now();
+    size_t size = 0;
+    if (mode == kDatagramSingle) {
+      for (size_t i = 0; i < kPerRound; ++i) {
+        result.is_correct = sender.SendTo(address, outgoing[i].data,
+          packet_size, &size) == SocketResult::kSocketOk &&
+          size == packet_size && result.is_correct;
+      }
+    } else if (mode == kDatagramBatch) {
+      result.is_correct = sender.SendBatch(outgoing.GetPackets(), kPerRound,
+        &size) == SocketResult::kSocketOk && size == kPerRound &&
+        result.is_correct;
+    } else {
+      for (size_t offset = 0; offset < gso_buffer.size();
+          offset += gso_step) {
+        size_t length = std::min(gso_step, gso_buffer.size() - offset);
+        result.is_correct = sender.SendTo(address,
+          gso_buffer.data() + offset, length, &size) ==
+          SocketResult::kSocketOk && size == length && result.is_correct;
+      }
+    }
+    size_t received = 0;
+    for (Si32 attempt = 0; received < kPerRound && attempt < 1000;
+        ++attempt) {
+      size_t count = 0;
+      if (mode == kDatagramSingle) {
+        SocketAddress from;
+        result.is_correct = receiver.ReceiveFrom(incoming[0].data,
+          packet_size, &from, &incoming[0].size) ==
+          SocketResult::kSocketOk && result.is_correct;
+        count = incoming[0].size ? 1 : 0;
+      } else {
+        result.is_correct = receiver.ReceiveBatch(incoming.GetPackets(),
+          kPerRound - received, &count) == SocketResult::kSocketOk &&
+          result.is_correct;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        Ui32 seq = 0;
+        std::memcpy(&seq, incoming[i].data, sizeof(seq));
+        result.is_correct = result.is_correct && seq == next_received &&
+          incoming[i].size == packet_size;
+        ++next_received;
+      }
+      received += count;
+    }
+    time += std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    result.is_correct = result.is_correct && received == kPerRound;
+    result.packets += static_cast<Si64>(received);
+    ++rounds;
+  }
+  result.packets_per_s = static_cast<double>(result.packets) / time;
+  return result;
+}
+
+struct NetChannelResult {
+  std::string name;
+  Si64 messages = 0;
+  double messages_per_s = 0.0;
+  double latency_ms = 0.0;
+  double latency_p99_ms = 0.0;
+  double wire_bytes_per_message = 0.0;
+  double cpu_us_per_message = 0.0;
+  Si64 resent = 0;
+  bool is_correct = true;
+};
+
+// Counts a received message of the ordered stream, every message starts
+// with its index and the time it was sent.
+void TakeStreamMessage(const std::vector<Ui8> &message, double time,
+    Ui32 *next_index, std::vector<double> *latencies,
+    NetChannelResult *result) {
+  Ui32 index = 0;
+  double sent_time = 0.0;
+  std::memcpy(&index, message.data(), sizeof(index));
+  std::memcpy(&sent_time, message.data() + 4, sizeof(sent_time));
+  result->is_correct = result->is_correct && index == *next_index;
+  ++*next_index;
+  latencies->push_back(time - sent_time);
+}
+
+void SummarizeLatencies(std::vector<double> *latencies,
+    NetChannelResult *result) {
+  if (latencies->empty()) {
+    result->is_correct = false;
+    return;
+  }
+  double sum = 0.0;
+  for (double latency : *latencies) {
+    sum += latency;
+  }
+  std::sort(latencies->begin(), latencies->end());
+  result->latency_ms = sum * 1000.0 / static_cast<double>(latencies->size());
+  result->latency_p99_ms = 1000.0 *
+    (*latencies)[latencies->size() * 99 / 100];
+}
+
+// A 60 Hz simulation sends 50 ordered messages of 100 bytes per tick over
+// a NetLinkSimulator for 10 simulated seconds, messages that don't fit
+// into the send window wait for the next tick. Messages still in flight
+// at the end are not counted.
+NetChannelResult RunNetChannelSim(const char *name, double loss) {
+  const double kTick = 1.0 / 60.0;
+  const Si32 kTicks = 600;
+  const Ui32 kPerTick = 50;
+  NetChannelResult result;
+  result.name = name;
+  NetConnection client;
+  NetConnection server;
+  Si32 channel = client.AddChannel(NetDelivery::kReliableOrdered);
+  server.AddChannel(NetDelivery::kReliableOrdered);
+  NetLinkConfig config;
+  config.loss = loss;
+  config.latency = 0.05;
+  config.jitter = 0.01;
+  NetLinkSimulator to_server(config, 1200);
+  NetLinkSimulator to_client(config, 1201);
+  std::vector<Ui8> packet;
+  std::vector<Ui8> message(100);
+  std::vector<double> latencies;
+  Ui32 next_sent = 0;
+  Ui32 next_received = 0;
+  double wire_bytes = 0.0;
+  double cpu_start = ThreadCpuSeconds();
+  for (Si32 tick = 0; tick < kTicks * 2; ++tick) {
+    double time = tick * kTick;
+    while (tick < kTicks && next_sent < static_cast<Ui32>(tick + 1) * kPerTick) {
+      std::memcpy(message.data(), &next_sent, 4);
+      std::memcpy(message.data() + 4, &time, sizeof(time));
+      if (!client.Send(channel, message.data(), 100)) {
+        break;
+      }
+      ++next_sent;
+    }
+    while (client.WritePacket(time, &packet)) {
+      wire_bytes += static_cast<double>(packet.size());
+      to_server.Send(time, packet.data(), packet.size());
+    }
+    // The server runs at a finer step so latency isn't rounded to ticks
+    for (Si32 sub = 0; sub < 4; ++sub) {
+      double sub_time = time + sub * kTick * 0.25;
+      while (to_server.Receive(sub_time, &packet)) {
+        server.ReadPacket(sub_time, packet.data(), packet.size());
+      }
+      Si32 received_channel = 0;
+      while (server.Receive(&received_channel, &message)) {
+        TakeStreamMessage(message, sub_time, &next_received, &latencies,
+          &result);
+      }
+      message.resize(100);
+      while (server.WritePacket(sub_time, &packet)) {
+        wire_bytes += static_cast<double>(packet.size());
+        to_client.Send(sub_time, packet.data(), packet.size());
+      }
+      while (to_client.Receive(sub_time, &packet)) {
+        client.ReadPacket(sub_time, packet.data(), packet.size());
+      }
+    }
+  }
+  double cpu_time = ThreadCpuSeconds() - cpu_start;
+  result.messages = next_received;
+  result.messages_per_s = next_received / (kTicks * kTick);
+  result.wire_bytes_per_message = wire_bytes / std::max(1u, next_received);
+  result.cpu_us_per_message = cpu_time * 1e6 / std::max(1u, next_received);
+  result.resent = static_cast<Si64>(client.GetStats().messages_resent);
+  SummarizeLatencies(&latencies, &result);
+  return result;
+}
+
+// The same ordered stream as fast as possible over two DatagramSockets on
+// loopback, in wall clock time.
+NetChannelResult RunNetChannelLoopback(const char *name, double min_time) {
+  NetChannelResult result;
+  result.name = name;
+  DatagramSocket client_socket(AddressFamily::kIpV4);
+  DatagramSocket server_socket(AddressFamily::kIpV4);
+  SocketAddress client_address;
+  SocketAddress server_address;
+  result.is_correct = client_socket.Bind("127.0.0.1", 0) ==
+      SocketResult::kSocketOk &&
+    server_socket.Bind("127.0.0.1", 0) == SocketResult::kSocketOk &&
+    client_socket.SetSoNonblocking(true) == SocketResult::kSocketOk &&
+    server_socket.SetSoNonblocking(true) == SocketResult::kSocketOk &&
+    client_socket.SetSoReceiveBufferSize(4 << 20) ==
+      SocketResult::kSocketOk &&
+    server_socket.SetSoReceiveBufferSize(4 << 20) ==
+      SocketResult::kSocketOk &&
+    client_address.Resolve("127.0.0.1", client_socket.GetLocalPort()) &&
+    server_address.Resolve("127.0.0.1", server_socket.GetLocalPort());
+  if (!result.is_correct) {
+    return result;
+  }
+  NetConnection client;
+  NetConnection server;
+  Si32 channel = client.AddChannel(NetDelivery::kReliableOrdered);
+  server.AddChannel(NetDelivery::kReliableOrdered);
+  DatagramPacketPool pool(64, 1500);
+  std::vector<Ui8> packet;
+  std::vector<Ui8> message(100);
+  std::vector<double> latencies;
+  Ui32 next_sent = 0;
+  Ui32 next_received = 0;
+  double wire_bytes = 0.0;
+  size_t size = 0;
+  auto start = std::chrono::steady_clock::now();
+  double cpu_start = ThreadCpuSeconds();
+  double time = 0.0;
+  while (time < min_time) {
+    time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    for (Si32 i = 0; i < 64; ++i, ++next_sent) {
+      std::memcpy(message.data(), &next_sent, 4);
+      std::memcpy(message.data() + 4, &time, sizeof(time));
+      if (!client.Send(channel, message.data(), 100)) {
+        break;
+      }
+    }
+    while (client.WritePacket(time, &packet)) {
+      wire_bytes += static_cast<double>(packet.size());
+      result.is_correct = client_socket.SendTo(server_address,
+        packet.data(), packet.size(), &size) == SocketResult::kSocketOk &&
+        result.is_correct;
+    }
+    size_t count = 0;
+    result.is_correct = server_socket.ReceiveBatch(pool.GetPackets(),
+      pool.GetCount(), &count) == SocketResult::kSocketOk &&
+      result.is_correct;
+    time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    for (size_t i = 0; i < count; ++i) {
+      server.ReadPacket(time, pool[i].data, pool[i].size);
+    }
+    Si32 received_channel = 0;
+    while (server.Receive(&received_channel, &message)) {
+      TakeStreamMessage(message, time, &next_received, &latencies, &result);
+    }
+    message.resize(100);
+    while (server.WritePacket(time, &packet)) {
+      wire_bytes += static_cast<double>(packet.size());
+      result.is_correct = server_socket.SendTo(client_address,
+        packet.data(), packet.size(), &size) == SocketResult::kSocketOk &&
+        result.is_correct;
+    }
+    result.is_correct = client_socket.ReceiveBatch(pool.GetPackets(),
+      pool.GetCount(), &count) == SocketResult::kSocketOk &&
+      result.is_correct;
+    for (size_t i = 0; i < count; ++i) {
+      client.ReadPacket(time, pool[i].data, pool[i].size);
+    }
+  }
+  double cpu_time = ThreadCpuSeconds() - cpu_start;
+  result.messages = next_received;
+  result.messages_per_s = next_received / time;
+  result.wire_bytes_per_message = wire_bytes / std::max(1u, next_received);
+  result.cpu_us_per_message = cpu_time * 1e6 / std::max(1u, next_received);
+  result.resent = static_cast<Si64>(client.GetStats().messages_resent);
+  SummarizeLatencies(&latencies, &result);
+  return result;
+}
+
+struct FramingResult {
+  std::string name;
+  Si64 messages = 0;
+  double messages_per_s = 0.0;
+  double allocations_per_message = 0.0;
+  bool is_correct = true;
+};
+
+// Rounds of 64 messages go from the client to the server over loopback TCP,
+// each message starts with its sequence number. FramedConnection is
+// compared to framing by hand the way applications do it with Read/Write:
+// a std::vector per message on the sending side and one per message cut out
+// of the stream on the receiving side. Sending and receiving are timed
+// together, allocations are counted after a warm-up round.
+FramingResult RunFraming(const char *name, bool is_framed, Ui32 message_size,
+    double min_time) {
+  const Si32 kBatch = 64;
+  FramingResult result;
+  result.name = name;
+  ListenerSocket listener(AddressFamily::kIpV4, SocketProtocol::kTcp);
+  ConnectionSocket client(AddressFamily::kIpV4, SocketProtocol::kTcp);
+  result.is_correct = listener.Bind("127.0.0.1", 0) ==
+      SocketResult::kSocketOk &&
+    client.Connect("127.0.0.1", listener.GetLocalPort()) ==
+      SocketConnectResult::kSocketOk;
+  ConnectionSocket server = listener.Accept();
+  result.is_correct = result.is_correct && server.IsValid() &&
+    client.SetSoNonblocking(true) == SocketResult::kSocketOk &&
+    server.SetSoNonblocking(true) == SocketResult::kSocketOk &&
+    client.SetTcpNoDelay(true) == SocketResult::kSocketOk;
+  if (!result.is_correct) {
+    return result;
+  }
+  FrameBufferPool pool;
+  FramedConnection framed_client(std::move(client), FramedConnectionConfig(),
+    &pool);
+  FramedConnection framed_server(std::move(server), FramedConnectionConfig(),
+    &pool);
+  ConnectionSocket &client_socket = framed_client.GetSocket();
+  ConnectionSocket &server_socket = framed_server.GetSocket();
+  std::vector<Ui8> payload(message_size);
+  std::vector<Ui8> stream;
+  std::vector<Ui8> chunk(64 * 1024);
+  Ui32 next_sent = 0;
+  Ui32 next_received = 0;
+  auto take_message = [&](const Ui8 *first, Ui32 size) {
+    Ui32 sequence = 0;
+    std::memcpy(&sequence, first, 4);
+    result.is_correct = result.is_correct && size == message_size &&
+      sequence == next_received;
+    ++next_received;
+  };
+  auto receive = [&]() {
+    if (is_framed) {
+      result.is_correct = framed_server.Receive() ==
+        SocketResult::kSocketOk && result.is_correct;
+      FrameView message;
+      while (framed_server.ReadMessage(&message)) {
+        Ui8 head[4];
+        for (Ui32 i = 0; i < 4; ++i) {
+          head[i] = message[i];
+        }
+        take_message(head, message.GetSize());
+      }
+      return;
+    }
+    size_t size = 0;
+    result.is_correct = server_socket.Read(
+      reinterpret_cast<char*>(chunk.data()), chunk.size(), &size) ==
+      SocketResult::kSocketOk && result.is_correct;
+    stream.insert(stream.end(), chunk.begin(), chunk.begin() + size);
+    size_t offset = 0;
+    while (stream.size() - offset >= 4) {
+      Ui32 message_size = 0;
+      std::memcpy(&message_size, stream.data() + offset, 4);
+      if (stream.size() - offset - 4 < message_size) {
+        break;
+      }
+      std::vector<Ui8> message(stream.begin() + offset + 4,
+        stream.begin() + offset + 4 + message_size);
+      take_message(message.data(), static_cast<Ui32>(message.size()));
+      offset += 4 + message_size;
+    }
+    stream.erase(stream.begin(), stream.begin() + offset);
+  };
+  auto send = [&]() {
+    std::memcpy(payload.data(), &next_sent, 4);
+    if (is_framed) {
+      while (!framed_client.QueueMessage(payload.data(), message_size)) {
+        result.is_correct = framed_client.Flush() ==
+          SocketResult::kSocketOk && result.is_correct;
+        receive();
+      }
+    } else {
+      std::vector<Ui8> packet(4 + message_size);
+      std::memcpy(packet.data(), &message_size, 4);
+      std::memcpy(packet.data() + 4, payload.data(), message_size);
+      size_t offset = 0;
+      while (offset < packet.size() && result.is_correct) {
+        size_t size = 0;
+        result.is_correct = client_socket.Write(
+          reinterpret_cast<const char*>(packet.data()) + offset,
+          packet.size() - offset, &size) == SocketResult::kSocketOk;
+        offset += size;
+        if (!size) {
+          receive();
+        }
+      }
+    }
+    ++next_sent;
+  };
+  double time = 0.0;
+  Ui64 allocations = 0;
+  Si64 rounds = 0;
+  Ui32 measured_from = 0;
+  auto start = std::chrono::steady_clock::now();
+  while ((rounds <= kMinFrames || time < min_time) && result.is_correct) {
+    if (rounds == 1) {
+      start = std::chrono::steady_clock::now();
+      allocations = g_allocation_count.load();
+      measured_from = next_received;
+    }
+    for (Si32 i = 0; i < kBatch; ++i) {
+      send();
+    }
+    for (Si32 attempt = 0; next_received < next_sent && attempt < 100000 &&
+        result.is_correct; ++attempt) {
+      if (is_framed) {
+        result.is_correct = framed_client.Flush() == SocketResult::kSocketOk;
+      }
+      receive();
+    }
+    result.is_correct = result.is_correct && next_received == next_sent;
+    time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    ++rounds;
+  }
+  Ui32 measured = next_received - measured_from;
+  result.messages = measured;
+  result.messages_per_s = measured / std::max(time, 1e-9);
+  result.allocations_per_message =
+    static_cast<double>(g_allocation_count.load() - allocations) /
+    std::max(1u, measured);
+  return result;
+}
+
+struct DesResult {
+  std::string name;
+  Si32 clients = 0;
+  double sim_seconds = 0.0;
+  Ui64 events = 0;
+  double events_per_s = 0.0;
+  double sim_seconds_per_s = 0.0;
+  Si64 levels_completed = 0;
+  double world_state_latency_ms = 0.0;
+  bool is_correct = true;
+};
+
+// Simulates the clients of the discrete event sim sample for a fixed model
+// time. Large runs get a short level, a fast server link and a bigger
+// router so that the network does not collapse and every client finishes
+// the download, idle runs exchange world state once a second instead of 20
+// times.
+DesResult RunDes(const char *name, Si32 clients, double sim_seconds,
+    bool is_large, double update_period) {
+  DesResult result;
+  result.name = name;
+  result.clients = clients;
+  result.sim_seconds = sim_seconds;
+  NetSimConfig config;
+  if (is_large) {
+    config.level_size_packets = 20;
+    config.server_link_bits_per_second = 1e9;
+    config.router_memory_bytes = 64 << 20;
+    config.server_buffer_limit = 16 << 20;
+  }
+  config.update_period = update_period;
+  auto start = std::chrono::steady_clock::now();
+  NetSim sim(config);
+  for (Si32 i = 0; i < clients; ++i) {
+    sim.AddClient();
+  }
+  result.events = sim.RunUntil(sim_seconds);
+  double time = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  const NetSimStats &stats = sim.GetStats();
+  result.events_per_s = result.events / std::max(time, 1e-9);
+  result.sim_seconds_per_s = sim_seconds / std::max(time, 1e-9);
+  result.levels_completed = stats.levels_completed;
+  result.world_state_latency_ms = stats.world_states_received ?
+    1000.0 * stats.world_state_latency_sum / stats.world_states_received :
+    0.0;
+  result.is_correct = stats.levels_completed >= clients;
+  return result;
+}
+
+struct AssetResult {
+  std::string name;
+  Ui64 files = 0;
+  Si64 reads = 0;
+  double open_read_us = 0.0;
+  double open_read_p99_us = 0.0;
+  double mb_per_s = 0.0;
+  double mount_ms = 0.0;
+  Ui64 pack_bytes = 0;
+  Ui64 hash = 0;
+  bool is_correct = true;
+};
+
+struct AssetTree {
+  std::string directory;
+  std::vector<std::string> names;
+};
+
+// 2000 files of 1 to 64 KiB in 20 directories, the .txt half deflates well,
+// the .bin half is noise like compressed audio and is stored as is
+AssetTree MakeAssetTree(const char *directory, Ui64 seed) {
+  AssetTree tree;
+  tree.directory = directory;
+  MakeDirectory(directory);
+  Ui64 state = seed;
+  auto next = [&state]() {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return state >> 33;
+  };
+  for (Si32 dir = 0; dir < 20; ++dir) {
+    std::string dir_name = "dir" + std::to_string(dir);
+    MakeDirectory(GluePath(directory, dir_name.c_str()).c_str());
+    for (Si32 i = 0; i < 100; ++i) {
+      std::string name = dir_name + "/file" + std::to_string(i) +
+        (i % 2 ? ".bin" : ".txt");
+      std::vector<Ui8> data(1024 + next() % (63 * 1024));
+      for (Ui8 &byte : data) {
+        byte = static_cast<Ui8>(i % 2 ? next() : "hero,orc,10\n"[next() % 12]);
+      }
+      WriteFile(GluePath(directory, name.c_str()).c_str(), data.data(),
+        data.size());
+      tree.names.push_back(name);
+    }
+  }
+  return tree;
+}
+
+void RemoveAssetTree(const AssetTree &tree) {
+  for (const std::string &name : tree.names) {
+    std::remove(GluePath(tree.directory.c_str(), name.c_str()).c_str());
+  }
+  for (Si32 dir = 0; dir < 20; ++dir) {
+    std::string dir_name = "dir" + std::to_string(dir);
+    std::remove(GluePath(tree.directory.c_str(), dir_name.c_str()).c_str());
+  }
+  std::remove(tree.directory.c_str());
+}
+
+// Opens and reads every file of the tree in a shuffled order, timing each
+// open+read, until min_time passes. With a pack level the tree is packed
+// first and the pack is mounted over the directory, so the same paths are
+// read from the pack. Mapped reads open a MappedFile, stored entries are
+// then used from the mapping of the pack without a copy. The files were
+// just written, so the loose reads hit the page cache: the numbers show
+// the per-file overhead of the filesystem, not the disk.
+AssetResult RunAssets(const char *name, const AssetTree &tree,
+    Si32 pack_level, bool is_mapped, double min_time) {
+  AssetResult result;
+  result.name = name;
+  result.files = tree.names.size();
+  const std::string pack_path = tree.directory + ".pack";
+  if (pack_level >= 0) {
+    AssetPackWriter writer;
+    for (const std::string &file : tree.names) {
+      writer.AddFile(GluePath(tree.directory.c_str(), file.c_str()), file,
+        file.find(".bin") == std::string::npos);
+    }
+    result.is_correct = writer.Save(pack_path.c_str(), pack_level);
+    result.pack_bytes = writer.GetPackSize();
+    auto start = std::chrono::steady_clock::now();
+    result.is_correct = result.is_correct &&
+      MountAssetPack(pack_path.c_str(), tree.directory.c_str());
+    result.mount_ms = 1000.0 * std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  }
+  std::vector<size_t> order(tree.names.size());
+  std::vector<std::string> paths;
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+    paths.push_back(GluePath(tree.directory.c_str(), tree.names[i].c_str()));
+  }
+  Ui64 state = 77;
+  for (size_t i = order.size(); i > 1; --i) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    std::swap(order[i - 1], order[(state >> 33) % i]);
+  }
+  std::vector<double> latencies;
+  Ui64 bytes = 0;
+  double time = 0.0;
+  Si64 passes = 0;
+  while (passes < 2 || time < min_time) {
+    Ui64 hash = 0;
+    for (size_t index : order) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<Ui8> data;
+      MappedFile file;
+      const Ui8 *first = nullptr;
+      Ui64 size = 0;
+      if (is_mapped) {
+        result.is_correct = file.Open(paths[index].c_str()) &&
+          result.is_correct;
+        first = file.Data();
+        size = file.Size();
+      } else {
+        data = ReadFile(paths[index].c_str(), true);
+        first = data.data();
+        size = data.size();
+      }
+      double latency = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+      Ui64 file_hash = 0xcbf29ce484222325ull;
+      for (Ui64 i = 0; i < size; ++i) {
+        file_hash = (file_hash ^ first[i]) * 0x100000001b3ull;
+      }
+      hash += file_hash * (index + 1);
+      if (passes) {
+        latencies.push_back(latency);
+        time += latency;
+        bytes += size;
+      }
+    }
+    result.is_correct = result.is_correct && (!passes || hash == result.hash);
+    result.hash = hash;
+    ++passes;
+  }
+  UnmountAllAssetPacks();
+  std::remove(pack_path.c_str());
+  std::sort(latencies.begin(), latencies.end());
+  result.reads = static_cast<Si64>(latencies.size());
+  result.open_read_us = 1e6 * time / static_cast<double>(latencies.size());
+  result.open_read_p99_us = 1e6 * latencies[latencies.size() * 99 / 100];
+  result.mb_per_s = static_cast<double>(bytes) / std::max(time, 1e-9) /
+    1000000.0;
+  return result;
+}
+
+struct AsyncLoadResult {
+  std::string name;
+  Ui64 assets = 0;
+  double time_s = 0.0;
+  double loads_per_s = 0.0;
+  double speedup = 1.0;
+  double max_stall_ms = 0.0;
+  Ui32 hardware_threads = 0;
+  Ui64 hash = 0;
+  bool is_correct = true;
+};
+
+// 1000 64x64 TGA sprites and 1000 0.1 s 8-bit mono 22050 Hz WAV sounds, the
+// sounds are converted to 16-bit stereo 44100 Hz when loaded
+std::vector<std::string> MakeAsyncAssets(const char *directory) {
+  std::vector<std::string> names;
+  MakeDirectory(directory);
+  Sprite sprite;
+  sprite.Create(64, 64);
+  std::vector<Ui8> wav(44 + 2205);
+  const char header[] = "RIFF\0\0\0\0WAVEfmt \x10\0\0\0\x01\0\x01\0"
+    "\x22\x56\0\0\x22\x56\0\0\x01\0\x08\0data";
+  std::memcpy(wav.data(), header, 40);
+  Ui32 data_size = 2205;
+  Ui32 riff_size = 36 + data_size;
+  std::memcpy(wav.data() + 4, &riff_size, 4);
+  std::memcpy(wav.data() + 40, &data_size, 4);
+  for (Si32 i = 0; i < 1000; ++i) {
+    for (Si32 y = 0; y < 64; ++y) {
+      for (Si32 x = 0; x < 64; ++x) {
+        sprite.RgbaData()[y * 64 + x] = Rgba(static_cast<Ui8>(x * 4 + i),
+          static_cast<Ui8>(y * 4), static_cast<Ui8>(i), 255);
+      }
+    }
+    std::string name = GluePath(directory,
+      ("sprite" + std::to_string(i) + ".tga").c_str());
+    sprite.Save(name.c_str());
+    names.push_back(name);
+    for (Ui32 j = 0; j < data_size; ++j) {
+      wav[44 + j] = static_cast<Ui8>(128 + ((j * (i + 3)) & 63));
+    }
+    name = GluePath(directory, ("sound" + std::to_string(i) + ".wav").c_str());
+    WriteFile(name.c_str(), wav.data(), wav.size());
+    names.push_back(name);
+  }
+  return names;
+}
+
+void RemoveAsyncAssets(const char *directory,
+    const std::vector<std::string> &names) {
+  for (const std::string &name : names) {
+    std::remove(name.c_str());
+  }
+  std::remove(directory);
+}
+
+Ui64 HashSprite(Sprite &sprite) {
+  Ui64 hash = 0xcbf29ce484222325ull;
+  for (Si32 i = 0; i < sprite.Width() * sprite.Height(); ++i) {
+    hash = (hash ^ sprite.RgbaData()[i].rgba) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+Ui64 HashSound(Sound &sound) {
+  Ui64 hash = 0xcbf29ce484222325ull;
+  if (!sound.GetInstance()) {
+    return hash;
+  }
+  const Si16 *data = sound.GetInstance()->GetWavData();
+  for (Si32 i = 0; i < sound.DurationSamples() * 2; ++i) {
+    hash = (hash ^ static_cast<Ui16>(data[i])) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Loads every asset once. With decode_threads < 0 the assets are loaded with
+// Sprite::Load and Sound::Load one after another, which is the stall a level
+// load causes. Otherwise the async loads are started at once and completed
+// by a frame loop calling ProcessAsyncLoads, the longest call is the
+// longest main thread stall. The files were just written, so they are read
+// from the page cache and the time is mostly decoding.
+AsyncLoadResult RunAsyncLoad(const char *name,
+    const std::vector<std::string> &names, Si32 decode_threads) {
+  AsyncLoadResult result;
+  result.name = name;
+  result.assets = names.size();
+  result.hardware_threads = std::thread::hardware_concurrency();
+  std::vector<Ui64> hashes(names.size());
+  auto start = std::chrono::steady_clock::now();
+  if (decode_threads < 0) {
+    for (size_t i = 0; i < names.size(); i += 2) {
+      Sprite sprite;
+      sprite.Load(names[i]);
+      hashes[i] = HashSprite(sprite);
+      Sound sound;
+      sound.Load(names[i + 1]);
+      hashes[i + 1] = HashSound(sound);
+    }
+    result.time_s = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    result.max_stall_ms = 1000.0 * result.time_s;
+  } else {
+    SetAsyncLoadThreads(0, static_cast<Ui32>(decode_threads));
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < names.size(); i += 2) {
+      LoadSpriteAsync(names[i].c_str(), [&hashes, i](Sprite &sprite) {
+        hashes[i] = HashSprite(sprite);
+      });
+      LoadSoundAsync(names[i + 1].c_str(), true,
+        [&hashes, i](Sound &sound) {
+          hashes[i + 1] = HashSound(sound);
+        });
+    }
+    while (GetPendingAsyncLoadCount()) {
+      auto frame_start = std::chrono::steady_clock::now();
+      ProcessAsyncLoads();
+      auto frame_end = std::chrono::steady_clock::now();
+      result.max_stall_ms = std::max(result.max_stall_ms, 1000.0 *
+        std::chrono::duration<double>(frame_end - frame_start).count());
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    result.time_s = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    SetAsyncLoadThreads(0, 0);
+  }
+  result.loads_per_s = static_cast<double>(names.size()) /
+    std::max(result.time_s, 1e-9);
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    result.hash = result.hash * 31 + hashes[i];
+  }
+  return result;
+}
+
+int main(int argc, char **argv) {
+  const char *out_path = nullptr;
+  const char *baseline_path = nullptr;
+  const char *filter = nullptr;
+  double min_time = 0.5;
+  Ui64 csv_mb = 64;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baseline_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+      min_time = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (std::strcmp(argv[i], "--csv-mb") == 0 && i + 1 < argc) {
+      csv_mb = static_cast<Ui64>(std::atoll(argv[++i]));
+    } else {
+      fprintf(stderr, "Usage: %s [--out file] [--baseline file]"
+        " [--min-time seconds] [--filter substring] [--csv-mb megabytes]\n",
+        argv[0]);
+      return 2;
+    }
+  }
+
+  StartLogger();
+  HeadlessPlatformInit();
+  GetEngine()->SetArgcArgv(argc, const_cast<const char **>(argv));
+  GetEngine()->HeadlessInit();
+  GetEngine()->GetBackbuffer().Create(kWidth, kHeight);
+
+  g_font.LoadLetterBits(g_tiny_font_letters, 6, 8);
+  for (Si32 i = 0; i < 4; ++i) {
+    g_sprites[i] = MakeTestSprite(64, 64, static_cast<Ui64>(i + 1));
+  }
+
+  std::vector<Scene> scenes;
+  AddSpriteScenes(&scenes);
+  AddTextScene(&scenes);
+  AddShapeScenes(&scenes);
+  AddGuiScene(&scenes);
+
+  json baseline;
+  if (baseline_path) {
+    std::vector<Ui8> data = ReadFile(baseline_path);
+    baseline = json::parse(data.begin(), data.end());
+  }
+
+  json report;
+  report["width"] = kWidth;
+  report["height"] = kHeight;
+  report["scenes"] = json::array();
+  Si32 mismatch_count = 0;
+  for (const Scene &scene : scenes) {
+    if (filter && scene.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    SceneResult result = RunScene(scene, min_time);
+    json item;
+    item["name"] = result.name;
+    item["frames"] = result.frames;
+    item["ns_per_pixel"] = result.ns_per_pixel;
+    item["fps"] = result.fps;
+    item["hash"] = HashToString(result.hash);
+    if (baseline.is_object() && baseline.contains("scenes")) {
+      for (const json &old_item : baseline["scenes"]) {
+        if (old_item.value("name", "") == result.name) {
+          bool is_same = old_item.value("hash", "") == HashToString(result.hash);
+          item["hash_matches_baseline"] = is_same;
+          item["baseline_ns_per_pixel"] = old_item.value("ns_per_pixel", 0.0);
+          if (!is_same) {
+            fprintf(stderr, "Scene %s renders differently from the baseline\n",
+              result.name.c_str());
+            ++mismatch_count;
+          }
+        }
+      }
+    }
+    report["scenes"].push_back(item);
+  }
+
+  report["csv"] = json::array();
+  std::vector<Ui32> thread_counts;
+  const Ui32 hardware_threads =
+    std::max(1u, std::thread::hardware_concurrency());
+  for (Ui32 threads = 1; threads < hardware_threads; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(hardware_threads);
+  std::string csv_data;
+  Ui64 csv_hash = 0;
+  for (Ui32 threads : thread_counts) {
+    std::string name = "csv_parse_t" + std::to_string(threads);
+    if (!csv_mb || (filter && name.find(filter) == std::string::npos)) {
+      continue;
+    }
+    if (csv_data.empty()) {
+      csv_data = MakeCsvData(800, csv_mb << 20);
+    }
+    CsvResult result = RunCsvParse(csv_data, threads, min_time);
+    json item;
+    item["name"] = result.name;
+    item["threads"] = result.threads;
+    item["runs"] = result.runs;
+    item["gb_per_s"] = result.gb_per_s;
+    item["rows"] = result.rows;
+    item["hash"] = HashToString(result.hash);
+    if (csv_hash && result.hash != csv_hash) {
+      fprintf(stderr, "CSV parse with %u threads gives a different table\n",
+        threads);
+      ++mismatch_count;
+    }
+    csv_hash = result.hash;
+    report["csv"].push_back(item);
+  }
+
+  report["bitstream"] = json::array();
+  const Ui32 max_bits_list[] = {8, 32, 64};
+  for (Ui32 max_bits : max_bits_list) {
+    if (filter && std::string("bitstream_" + std::to_string(max_bits)).find(
+        filter) == std::string::npos) {
+      continue;
+    }
+    BitStreamResult result = RunBitStream(max_bits, min_time);
+    json item;
+    item["name"] = result.name;
+    item["runs"] = result.runs;
+    item["write_gb_per_s"] = result.write_gb_per_s;
+    item["read_gb_per_s"] = result.read_gb_per_s;
+    if (!result.is_correct) {
+      fprintf(stderr, "BitStream %s reads back different values\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    report["bitstream"].push_back(item);
+  }
+
+  report["snapshot"] = json::array();
+  const Ui32 loss_percent_list[] = {0, 10};
+  for (Ui32 loss_percent : loss_percent_list) {
+    if (filter && std::string("snapshot_1000_loss" +
+        std::to_string(loss_percent)).find(filter) == std::string::npos) {
+      continue;
+    }
+    SnapshotResult result = RunSnapshot(loss_percent, min_time);
+    json item;
+    item["name"] = result.name;
+    item["runs"] = result.runs;
+    item["bytes_per_tick"] = result.bytes_per_tick;
+    item["raw_bytes_per_tick"] = result.raw_bytes_per_tick;
+    item["encode_us"] = result.encode_us;
+    item["decode_us"] = result.decode_us;
+    if (!result.is_correct) {
+      fprintf(stderr, "Snapshot %s decodes a different world\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    report["snapshot"].push_back(item);
+  }
+
+  report["compression"] = json::array();
+  struct CompressionCase {
+    const char *name;
+    Si32 level;
+    bool is_noise;
+  };
+  const CompressionCase compression_cases[] = {
+    {"compress_save_l1", 1, false},
+    {"compress_save_l6", 6, false},
+    {"compress_save_l9", 9, false},
+    {"compress_noise_l6", 6, true},
+  };
+  std::vector<Ui32> save_words;
+  std::vector<Ui32> noise_words;
+  for (const CompressionCase &test : compression_cases) {
+    if (filter && std::string(test.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    std::vector<Ui32> &words = test.is_noise ? noise_words : save_words;
+    if (words.empty()) {
+      words = MakeSaveData(900, 8 << 20, test.is_noise);
+    }
+    CompressionResult result = RunCompression(words, test.name, test.level,
+      min_time);
+    json item;
+    item["name"] = result.name;
+    item["runs"] = result.runs;
+    item["compress_mb_per_s"] = result.compress_mb_per_s;
+    item["caller_mb_per_s"] = result.caller_mb_per_s;
+    item["decompress_mb_per_s"] = result.decompress_mb_per_s;
+    item["ratio"] = result.ratio;
+    if (!result.is_correct) {
+      fprintf(stderr, "Compressed %s reads back different data\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    report["compression"].push_back(item);
+  }
+
+  report["poller"] = json::array();
+  const char *poller_names[] = {"poller_wait_2000", "poller_busy_2000"};
+  LoopbackConnections connections;
+  for (Si32 i = 0; i < 2; ++i) {
+    if (filter && std::string(poller_names[i]).find(filter) ==
+        std::string::npos) {
+      continue;
+    }
+    if (connections.servers.empty() && !connections.Open(2000)) {
+      fprintf(stderr, "Failed to open loopback connections\n");
+      ++mismatch_count;
+      break;
+    }
+    PollerResult result = RunPoller(&connections, poller_names[i], i == 1,
+      min_time);
+    json item;
+    item["name"] = result.name;
+    item["connections"] = result.connections;
+    item["rounds"] = result.rounds;
+    item["events_per_s"] = result.events_per_s;
+    item["cpu_us_per_event"] = result.cpu_us_per_event;
+    if (!result.is_correct) {
+      fprintf(stderr, "Poller %s missed events\n", result.name.c_str());
+      ++mismatch_count;
+    }
+    report["poller"].push_back(item);
+  }
+
+  report["datagram"] = json::array();
+  struct DatagramCase {
+    const char *name;
+    DatagramMode mode;
+    size_t packet_size;
+  };
+  const DatagramCase datagram_cases[] = {
+    {"udp_single_64", kDatagramSingle, 64},
+    {"udp_batch_64", kDatagramBatch, 64},
+    {"udp_gso_64", kDatagramGso, 64},
+    {"udp_single_1200", kDatagramSingle, 1200},
+    {"udp_batch_1200", kDatagramBatch, 1200},
+    {"udp_gso_1200", kDatagramGso, 1200},
+  };
+  for (const DatagramCase &test : datagram_cases) {
+    if (filter && std::string(test.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    DatagramResult result = RunDatagram(test.name, test.mode,
+      test.packet_size, min_time);
+    if (!result.is_supported) {
+      continue;
+    }
+    json item;
+    item["name"] = result.name;
+    item["packets"] = result.packets;
+    item["packets_per_s"] = result.packets_per_s;
+    if (!result.is_correct) {
+      fprintf(stderr, "Datagram %s lost or reordered packets\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    report["datagram"].push_back(item);
+  }
+
+  report["netchannel"] = json::array();
+  struct NetChannelCase {
+    const char *name;
+    double loss;
+  };
+  const NetChannelCase netchannel_cases[] = {
+    {"net_sim_loss0", 0.0},
+    {"net_sim_loss5", 0.05},
+    {"net_sim_loss20", 0.2},
+    {"net_loopback", -1.0},
+  };
+  for (const NetChannelCase &test : netchannel_cases) {
+    if (filter && std::string(test.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    NetChannelResult result = test.loss < 0.0 ?
+      RunNetChannelLoopback(test.name, min_time) :
+      RunNetChannelSim(test.name, test.loss);
+    json item;
+    item["name"] = result.name;
+    item["messages"] = result.messages;
+    item["messages_per_s"] = result.messages_per_s;
+    item["latency_ms"] = result.latency_ms;
+    item["latency_p99_ms"] = result.latency_p99_ms;
+    item["wire_bytes_per_message"] = result.wire_bytes_per_message;
+    item["cpu_us_per_message"] = result.cpu_us_per_message;
+    item["resent"] = result.resent;
+    if (!result.is_correct) {
+      fprintf(stderr, "NetConnection %s lost or reordered messages\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    report["netchannel"].push_back(item);
+  }
+
+  report["framing"] = json::array();
+  struct FramingCase {
+    const char *name;
+    bool is_framed;
+    Ui32 message_size;
+  };
+  const FramingCase framing_cases[] = {
+    {"tcp_vector_64", false, 64},
+    {"tcp_framed_64", true, 64},
+    {"tcp_vector_1024", false, 1024},
+    {"tcp_framed_1024", true, 1024},
+  };
+  for (const FramingCase &test : framing_cases) {
+    if (filter && std::string(test.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    FramingResult result = RunFraming(test.name, test.is_framed,
+      test.message_size, min_time);
+    json item;
+    item["name"] = result.name;
+    item["messages"] = result.messages;
+    item["messages_per_s"] = result.messages_per_s;
+    item["allocations_per_message"] = result.allocations_per_message;
+    if (!result.is_correct) {
+      fprintf(stderr, "Framing %s lost or reordered messages\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    report["framing"].push_back(item);
+  }
+
+  report["des"] = json::array();
+  struct DesCase {
+    const char *name;
+    Si32 clients;
+    double sim_seconds;
+    bool is_large;
+    double update_period;
+  };
+  const DesCase des_cases[] = {
+    {"des_5_clients", 5, 60.0, false, 0.05},
+    {"des_10000_clients", 10000, 8.0, true, 0.05},
+    {"des_10000_idle_clients", 10000, 30.0, true, 1.0},
+  };
+  for (const DesCase &test : des_cases) {
+    if (filter && std::string(test.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    DesResult result = RunDes(test.name, test.clients, test.sim_seconds,
+      test.is_large, test.update_period);
+    json item;
+    item["name"] = result.name;
+    item["clients"] = result.clients;
+    item["sim_seconds"] = result.sim_seconds;
+    item["events"] = result.events;
+    item["events_per_s"] = result.events_per_s;
+    item["sim_seconds_per_s"] = result.sim_seconds_per_s;
+    item["levels_completed"] = result.levels_completed;
+    item["world_state_latency_ms"] = result.world_state_latency_ms;
+    if (!result.is_correct) {
+      fprintf(stderr, "NetSim %s clients did not get the level\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    report["des"].push_back(item);
+  }
+
+  report["assets"] = json::array();
+  struct AssetCase {
+    const char *name;
+    Si32 pack_level;
+    bool is_mapped;
+  };
+  const AssetCase asset_cases[] = {
+    {"assets_loose", -1, false},
+    {"assets_pack_stored", 0, false},
+    {"assets_pack_deflated", 6, false},
+    {"assets_pack_mapped", 0, true},
+  };
+  AssetTree asset_tree;
+  Ui64 asset_hash = 0;
+  for (const AssetCase &test : asset_cases) {
+    if (filter && std::string(test.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    if (asset_tree.names.empty()) {
+      asset_tree = MakeAssetTree("headless_benchmark_assets", 1000);
+    }
+    AssetResult result = RunAssets(test.name, asset_tree, test.pack_level,
+      test.is_mapped, min_time);
+    json item;
+    item["name"] = result.name;
+    item["files"] = result.files;
+    item["reads"] = result.reads;
+    item["open_read_us"] = result.open_read_us;
+    item["open_read_p99_us"] = result.open_read_p99_us;
+    item["mb_per_s"] = result.mb_per_s;
+    item["mount_ms"] = result.mount_ms;
+    item["pack_bytes"] = result.pack_bytes;
+    if (!result.is_correct || (asset_hash && result.hash != asset_hash)) {
+      fprintf(stderr, "Assets %s read different data\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    asset_hash = result.hash;
+    report["assets"].push_back(item);
+  }
+  if (!asset_tree.names.empty()) {
+    RemoveAssetTree(asset_tree);
+  }
+
+  report["async"] = json::array();
+  struct AsyncCase {
+    const char *name;
+    Si32 decode_threads;
+  };
+  const AsyncCase async_cases[] = {
+    {"async_sync", -1},
+    {"async_1_thread", 1},
+    {"async_default_threads", 0},
+  };
+  const char *async_directory = "headless_benchmark_async";
+  std::vector<std::string> async_names;
+  Ui64 async_hash = 0;
+  double async_sync_time = 0.0;
+  for (const AsyncCase &test : async_cases) {
+    if (filter && std::string(test.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    if (async_names.empty()) {
+      async_names = MakeAsyncAssets(async_directory);
+    }
+    AsyncLoadResult result = RunAsyncLoad(test.name, async_names,
+      test.decode_threads);
+    if (test.decode_threads < 0) {
+      async_sync_time = result.time_s;
+    } else if (async_sync_time > 0.0) {
+      result.speedup = async_sync_time / std::max(result.time_s, 1e-9);
+    }
+    json item;
+    item["name"] = result.name;
+    item["assets"] = result.assets;
+    item["time_s"] = result.time_s;
+    item["loads_per_s"] = result.loads_per_s;
+    item["speedup"] = result.speedup;
+    item["max_stall_ms"] = result.max_stall_ms;
+    item["hardware_threads"] = result.hardware_threads;
+    if (!result.is_correct || (async_hash && result.hash != async_hash)) {
+      fprintf(stderr, "Async load %s decoded different data\n",
+        result.name.c_str());
+      ++mismatch_count;
+    }
+    async_hash = result.hash;
+    report["async"].push_back(item);
+  }
+  if (!async_names.empty()) {
+    RemoveAsyncAssets(async_directory, async_names);
+  }
+
+  std::string text = report.dump(2);
+  text.push_back('\n');
+  fputs(text.c_str(), stdout);
+  if (out_path) {
+    WriteFile(out_path, reinterpret_cast<const Ui8*>(text.data()),
+      text.size());
+  }
+
+  g_gui_roots.clear();
+  StopLogger();
+  return mismatch_count ? 1 : 0;
+}
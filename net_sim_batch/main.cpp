@@ -0,0 +1,161 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Headless batch runner for the network model of the discrete event sim
+// sample. Runs the parameter grid of client counts, client link loss and
+// server buffer limits, every point with a number of seeds, as independent
+// NetSim runs on all cores and writes one CSV row per run. The table does
+// not depend on the thread count, running a grid again with the same seeds
+// writes the same file byte for byte.
+//
+// Usage: net_sim_batch [--out results.csv] [--clients 5,50,500]
+//                      [--loss 0.01,0.02] [--server-limit -1,1000000]
+//                      [--seeds count] [--first-seed seed]
+//                      [--sim-time seconds] [--level-packets count]
+//                      [--threads count]
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "engine/arctic_platform.h"
+#include "engine/csv.h"
+#include "engine/easy.h"
+#include "net_sim_batch/net_sim_batch.h"
+
+using namespace arctic;  // NOLINT
+
+namespace {
+
+std::vector<double> ParseList(const char *text) {
+  std::vector<double> values;
+  while (*text) {
+    char *end = nullptr;
+    values.push_back(std::strtod(text, &end));
+    if (end == text) {
+      return std::vector<double>();
+    }
+    text = (*end == ',') ? end + 1 : end;
+  }
+  return values;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const char *out_path = "net_sim_batch.csv";
+  std::vector<double> client_counts = {5, 50, 500};
+  std::vector<double> losses = {0.01};
+  std::vector<double> server_limits = {-1, 1000000};
+  Ui64 seed_count = 3;
+  Ui64 first_seed = 1;
+  double sim_time = 60.0;
+  Si32 level_packets = NetSimConfig().level_size_packets;
+  Ui32 thread_count = 0;
+  bool is_usage_ok = true;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--out") == 0 && has_value) {
+      out_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--clients") == 0 && has_value) {
+      client_counts = ParseList(argv[++i]);
+    } else if (std::strcmp(argv[i], "--loss") == 0 && has_value) {
+      losses = ParseList(argv[++i]);
+    } else if (std::strcmp(argv[i], "--server-limit") == 0 && has_value) {
+      server_limits = ParseList(argv[++i]);
+    } else if (std::strcmp(argv[i], "--seeds") == 0 && has_value) {
+      seed_count = static_cast<Ui64>(std::atoll(argv[++i]));
+    } else if (std::strcmp(argv[i], "--first-seed") == 0 && has_value) {
+      first_seed = static_cast<Ui64>(std::atoll(argv[++i]));
+    } else if (std::strcmp(argv[i], "--sim-time") == 0 && has_value) {
+      sim_time = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--level-packets") == 0 && has_value) {
+      level_packets = static_cast<Si32>(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+      thread_count = static_cast<Ui32>(std::atoi(argv[++i]));
+    } else {
+      is_usage_ok = false;
+    }
+  }
+  if (!is_usage_ok || client_counts.empty() || losses.empty() ||
+      server_limits.empty() || !seed_count || level_packets <= 0) {
+    fprintf(stderr, "Usage: %s [--out file] [--clients list] [--loss list]"
+      " [--server-limit list] [--seeds count] [--first-seed seed]"
+      " [--sim-time seconds] [--level-packets count] [--threads count]\n"
+      "Lists are comma separated, -1 means no server buffer limit.\n",
+      argv[0]);
+    return 2;
+  }
+
+  StartLogger();
+  HeadlessPlatformInit();
+  GetEngine()->SetArgcArgv(argc, const_cast<const char **>(argv));
+  GetEngine()->HeadlessInit();
+
+  std::vector<NetSimScenario> scenarios;
+  for (double clients : client_counts) {
+    for (double loss : losses) {
+      for (double limit : server_limits) {
+        for (Ui64 seed = first_seed; seed < first_seed + seed_count; ++seed) {
+          NetSimScenario scenario;
+          scenario.client_count = static_cast<Si32>(clients);
+          scenario.config.client_link_loss = loss;
+          scenario.config.server_buffer_limit = static_cast<Si64>(limit);
+          scenario.config.level_size_packets = level_packets;
+          scenario.sim_seconds = sim_time;
+          scenario.seed = seed;
+          scenarios.push_back(scenario);
+        }
+      }
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<NetSimScenarioResult> results =
+    RunNetSimBatch(scenarios, thread_count);
+  double wall = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+
+  Ui64 events = 0;
+  double run_seconds = 0.0;
+  for (const NetSimScenarioResult &result : results) {
+    events += result.events;
+    run_seconds += result.wall_seconds;
+  }
+  CsvTable table;
+  NetSimBatchToCsv(scenarios, results, &table);
+  bool is_saved = table.SaveFile(out_path);
+  printf("%zu runs, %.1f model s each, %llu events in %.3f s wall"
+    " (%.2f M events/s, %.1fx parallel speedup)\n",
+    scenarios.size(), sim_time, static_cast<unsigned long long>(events),
+    wall, static_cast<double>(events) / std::max(wall, 1e-9) / 1000000.0,
+    run_seconds / std::max(wall, 1e-9));
+  if (!is_saved) {
+    fprintf(stderr, "Can't write %s\n", out_path);
+  }
+
+  StopLogger();
+  return is_saved ? 0 : 1;
+}
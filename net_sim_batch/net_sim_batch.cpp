@@ -0,0 +1,144 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "net_sim_batch/net_sim_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "engine/arctic_platform_fatal.h"
+#include "engine/easy_util.h"
+
+namespace arctic {
+
+namespace {
+
+std::string FormatDouble(double value) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.17g", value);
+  return text;
+}
+
+}  // namespace
+
+NetSimScenarioResult RunNetSimScenario(const NetSimScenario &scenario) {
+  NetSimScenarioResult result;
+  auto start = std::chrono::steady_clock::now();
+  SeedRandom(scenario.seed);
+  NetSim sim(scenario.config);
+  for (Si32 i = 0; i < scenario.client_count; ++i) {
+    sim.AddClient();
+  }
+  result.events = sim.RunUntil(scenario.sim_seconds);
+  result.stats = sim.GetStats();
+  for (Si32 i = 0; i < sim.GetClientCount(); ++i) {
+    const NetSimClient &client = sim.GetClient(i);
+    if (client.is_active &&
+        client.level_obtained_count == scenario.config.level_size_packets) {
+      ++result.clients_with_level;
+    }
+  }
+  result.wall_seconds = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+std::vector<NetSimScenarioResult> RunNetSimBatch(
+    const std::vector<NetSimScenario> &scenarios, Ui32 thread_count) {
+  std::vector<NetSimScenarioResult> results(scenarios.size());
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  thread_count = static_cast<Ui32>(std::min<size_t>(thread_count,
+    scenarios.size()));
+  std::atomic<size_t> next_scenario(0);
+  auto work = [&]() {
+    while (true) {
+      size_t idx = next_scenario.fetch_add(1);
+      if (idx >= scenarios.size()) {
+        return;
+      }
+      results[idx] = RunNetSimScenario(scenarios[idx]);
+    }
+  };
+  if (thread_count <= 1) {
+    work();
+    return results;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (Ui32 i = 0; i < thread_count; ++i) {
+    threads.emplace_back(work);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  return results;
+}
+
+void NetSimBatchToCsv(const std::vector<NetSimScenario> &scenarios,
+    const std::vector<NetSimScenarioResult> &results, CsvTable *out_table) {
+  Check(out_table != nullptr, "NetSimBatchToCsv: out_table is null");
+  Check(scenarios.size() == results.size(),
+    "NetSimBatchToCsv: scenario and result counts differ");
+  out_table->Create({"clients", "server_buffer_limit", "client_link_loss",
+    "sim_seconds", "seed", "events", "sessions_started", "levels_completed",
+    "clients_with_level", "client_mbit_per_s", "server_sent_bytes",
+    "world_states_received", "world_state_latency_ms",
+    "world_state_latency_max_ms", "lost_packets", "server_dropped_bytes",
+    "router_dropped_bytes"});
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    const NetSimScenario &scenario = scenarios[i];
+    const NetSimScenarioResult &result = results[i];
+    const NetSimStats &stats = result.stats;
+    double latency = stats.world_states_received ?
+      stats.world_state_latency_sum /
+      static_cast<double>(stats.world_states_received) : 0.0;
+    double mbit_per_s = scenario.sim_seconds > 0.0 ?
+      static_cast<double>(stats.client_received_bytes) * 8.0 /
+      scenario.sim_seconds / 1000000.0 : 0.0;
+    out_table->AddRow(out_table->RowCount(), {
+      std::to_string(scenario.client_count),
+      std::to_string(scenario.config.server_buffer_limit),
+      FormatDouble(scenario.config.client_link_loss),
+      FormatDouble(scenario.sim_seconds),
+      std::to_string(scenario.seed),
+      std::to_string(result.events),
+      std::to_string(stats.sessions_started),
+      std::to_string(stats.levels_completed),
+      std::to_string(result.clients_with_level),
+      FormatDouble(mbit_per_s),
+      std::to_string(stats.server_sent_bytes),
+      std::to_string(stats.world_states_received),
+      FormatDouble(latency * 1000.0),
+      FormatDouble(stats.world_state_latency_max * 1000.0),
+      std::to_string(stats.lost_packets),
+      std::to_string(stats.server_dropped_bytes),
+      std::to_string(stats.router_dropped_bytes)});
+  }
+}
+
+}  // namespace arctic
@@ -0,0 +1,89 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef NET_SIM_BATCH_NET_SIM_BATCH_H_
+#define NET_SIM_BATCH_NET_SIM_BATCH_H_
+
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/csv.h"
+#include "template_project_name/net_sim.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief One independent NetSim run of a batch
+struct NetSimScenario {
+  NetSimConfig config;
+  Si32 client_count = 5;
+  /// Model time to simulate, in seconds
+  double sim_seconds = 60.0;
+  /// Seeds the random numbers of the run, same seed, same results
+  Ui64 seed = 1;
+};
+
+/// @brief Results of a NetSimScenario
+struct NetSimScenarioResult {
+  NetSimStats stats;
+  Ui64 events = 0;
+  /// Active clients holding the whole level at the end of the run
+  Si32 clients_with_level = 0;
+  /// Wall clock time of the run, the only value that depends on the machine
+  double wall_seconds = 0.0;
+};
+
+/// @brief Runs one scenario on the calling thread, seeding its random
+/// numbers with the scenario seed
+NetSimScenarioResult RunNetSimScenario(const NetSimScenario &scenario);
+
+/// @brief Runs independent scenarios in parallel, one NetSim per worker
+/// thread at a time
+/// @details Workers take the next scenario as soon as they finish one, so
+///   long and short runs even out. Every run seeds the random numbers of
+///   its thread, its results depend on the scenario only and not on the
+///   thread count or the order the runs finish in.
+/// @param scenarios The runs.
+/// @param thread_count The number of worker threads, 0 means one per
+///   hardware thread.
+/// @return The results in the order of the scenarios.
+std::vector<NetSimScenarioResult> RunNetSimBatch(
+  const std::vector<NetSimScenario> &scenarios, Ui32 thread_count = 0);
+
+/// @brief Fills a table with one row per scenario holding its parameters
+/// and the throughput, latency and drop statistics of its result
+/// @details Numbers are written with enough digits to read back the same
+///   doubles, the wall clock time is left out, so the table of a batch is
+///   the same byte for byte on every run.
+/// @param scenarios The runs.
+/// @param results The results of RunNetSimBatch.
+/// @param out_table The table to fill.
+void NetSimBatchToCsv(const std::vector<NetSimScenario> &scenarios,
+  const std::vector<NetSimScenarioResult> &results, CsvTable *out_table);
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // NET_SIM_BATCH_NET_SIM_BATCH_H_
@@ -0,0 +1,593 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "net_sim.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "engine/easy_util.h"
+
+namespace arctic {
+
+const Si32 NetSim::kRouterIp;
+const Si32 NetSim::kServerIp;
+const Si32 NetSim::kFirstClientIp;
+const Si32 NetSim::kPingWindow;
+
+double NetSim::Session::GetAvgPing() const {
+  double s = ping_window[0];
+  for (Si32 i = 1; i < kPingWindow; ++i) {
+    s = std::max(ping_window[i], s);
+  }
+  return s;
+}
+
+NetSim::NetSim(const NetSimConfig &config)
+    : config_(config) {
+  packet_arrival_ = scheduler_.AddHandler(this, OnPacketArrival);
+  output_wake_ = scheduler_.AddHandler(this, OnOutputWake);
+  client_timeout_ = scheduler_.AddHandler(this, OnClientTimeout);
+  client_controls_ = scheduler_.AddHandler(this, OnClientControls);
+  session_timeout_ = scheduler_.AddHandler(this, OnSessionTimeout);
+  session_retransmit_ = scheduler_.AddHandler(this, OnSessionRetransmit);
+  world_state_tick_ = scheduler_.AddHandler(this, OnWorldStateTick);
+
+  router_output_by_ip_.assign(kFirstClientIp, -1);
+  sessions_.resize(kFirstClientIp);
+  server_output_ = AddOutput(false);
+  Si32 router_to_server = AddOutput(true);
+  router_output_by_ip_[kServerIp] = router_to_server;
+  AddChannel(kRouterIp, kServerIp, config_.server_link_bits_per_second,
+    config_.server_link_delay, config_.server_link_loss, router_to_server);
+  AddChannel(kServerIp, kRouterIp, config_.server_link_bits_per_second,
+    config_.server_link_delay, config_.server_link_loss, server_output_);
+  WorldStateTick tick;
+  tick.unused = 0;
+  scheduler_.Schedule(0.0, world_state_tick_, tick);
+}
+
+Ui32 NetSim::NewPacket(NetSimPacket::Kind kind, Si32 source_ip,
+    Si32 destination_ip, Si32 size_bytes, Ui64 session_id) {
+  Ui32 idx;
+  if (free_packets_.empty()) {
+    idx = static_cast<Ui32>(packets_.size());
+    packets_.emplace_back();
+  } else {
+    idx = free_packets_.back();
+    free_packets_.pop_back();
+  }
+  NetSimPacket &packet = packets_[idx];
+  packet = NetSimPacket();
+  packet.kind = kind;
+  packet.source_ip = source_ip;
+  packet.destination_ip = destination_ip;
+  packet.size_bytes = size_bytes;
+  packet.session_id = session_id;
+  return idx;
+}
+
+void NetSim::FreePacket(Ui32 packet) {
+  packets_[packet].is_in_flight = false;
+  free_packets_.push_back(packet);
+}
+
+Si32 NetSim::AddOutput(bool is_router) {
+  outputs_.emplace_back();
+  outputs_.back().is_router = is_router;
+  return static_cast<Si32>(outputs_.size() - 1);
+}
+
+Si32 NetSim::AddChannel(Si32 in_ip, Si32 out_ip, double bits_per_second,
+    double delay, double loss_probability, Si32 output) {
+  NetSimChannel channel;
+  channel.in_ip = in_ip;
+  channel.out_ip = out_ip;
+  channel.bits_per_second = bits_per_second;
+  channel.delay = delay;
+  channel.loss_probability = loss_probability;
+  channel.busy_until = scheduler_.GetTime();
+  channel.output = output;
+  channels_.push_back(channel);
+  Si32 idx = static_cast<Si32>(channels_.size() - 1);
+  outputs_[static_cast<size_t>(output)].channel = idx;
+  return idx;
+}
+
+void NetSim::Enqueue(Si32 output, Ui32 packet) {
+  OutputQueue &queue = outputs_[static_cast<size_t>(output)];
+  if (queue.count == queue.ring.size()) {
+    // Grow the ring and unwrap it
+    std::vector<Ui32> ring(std::max<size_t>(16, queue.ring.size() * 2));
+    for (size_t i = 0; i < queue.count; ++i) {
+      ring[i] = queue.ring[(queue.head + i) % queue.ring.size()];
+    }
+    queue.ring.swap(ring);
+    queue.head = 0;
+  }
+  queue.ring[(queue.head + queue.count) % queue.ring.size()] = packet;
+  ++queue.count;
+  Si32 size = packets_[packet].size_bytes;
+  queue.used_memory += size;
+  if (queue.is_router) {
+    router_used_memory_ += size;
+  }
+  Pump(output);
+}
+
+void NetSim::Pump(Si32 output) {
+  OutputQueue &queue = outputs_[static_cast<size_t>(output)];
+  if (queue.channel < 0 || queue.is_wake_scheduled) {
+    return;
+  }
+  double now = scheduler_.GetTime();
+  NetSimChannel &channel = channels_[static_cast<size_t>(queue.channel)];
+  while (queue.count && channel.busy_until <= now) {
+    Ui32 packet = queue.ring[queue.head];
+    queue.head = (queue.head + 1) % queue.ring.size();
+    --queue.count;
+    Si32 size = packets_[packet].size_bytes;
+    queue.used_memory -= size;
+    queue.sent_bytes += size;
+    if (queue.is_router) {
+      router_used_memory_ -= size;
+    }
+    Transmit(queue.channel, packet);
+  }
+  if (queue.count) {
+    // The channel is busy sending, come back once it is free
+    queue.is_wake_scheduled = true;
+    OutputWake wake;
+    wake.output = output;
+    scheduler_.Schedule(channel.busy_until, output_wake_, wake);
+  }
+}
+
+void NetSim::ClearOutput(Si32 output) {
+  OutputQueue &queue = outputs_[static_cast<size_t>(output)];
+  while (queue.count) {
+    FreePacket(queue.ring[queue.head]);
+    queue.head = (queue.head + 1) % queue.ring.size();
+    --queue.count;
+  }
+  if (queue.is_router) {
+    router_used_memory_ -= queue.used_memory;
+  }
+  queue.used_memory = 0;
+}
+
+void NetSim::ApplyServerLimit() {
+  if (config_.server_buffer_limit < 0) {
+    return;
+  }
+  OutputQueue &queue = outputs_[static_cast<size_t>(server_output_)];
+  while (queue.used_memory > config_.server_buffer_limit) {
+    --queue.count;
+    Ui32 packet = queue.ring[(queue.head + queue.count) % queue.ring.size()];
+    Si32 size = packets_[packet].size_bytes;
+    queue.used_memory -= size;
+    queue.dropped_bytes += size;
+    stats_.server_dropped_bytes += size;
+    FreePacket(packet);
+  }
+}
+
+void NetSim::Transmit(Si32 channel_idx, Ui32 packet_idx) {
+  double now = scheduler_.GetTime();
+  NetSimChannel &channel = channels_[static_cast<size_t>(channel_idx)];
+  NetSimPacket &packet = packets_[packet_idx];
+  double busy_duration = packet.size_bytes * 8.0 / channel.bits_per_second;
+  channel.busy_until = std::max(now, channel.busy_until) + busy_duration;
+  double transfer_duration =
+    channel.delay * (1.0 + 0.01 * static_cast<double>(Random(0, 100))) +
+    busy_duration;
+  packet.channel = channel_idx;
+  packet.is_in_flight = true;
+  packet.t_in = now;
+  packet.t_out = now + transfer_duration;
+  packet.is_lost = channel.loss_probability * 10000.0 >
+    static_cast<double>(Random(0, 10000));
+  if (channel.in_ip == kServerIp) {
+    stats_.server_sent_bytes += packet.size_bytes;
+  }
+  PacketArrival arrival;
+  arrival.packet = packet_idx;
+  scheduler_.Schedule(packet.t_out, packet_arrival_, arrival);
+}
+
+void NetSim::OnPacketArrival(NetSim *sim, const PacketArrival &event) {
+  NetSimPacket &packet = sim->packets_[event.packet];
+  packet.is_in_flight = false;
+  if (packet.is_lost) {
+    ++sim->stats_.lost_packets;
+    sim->FreePacket(event.packet);
+    return;
+  }
+  Si32 out_ip = sim->channels_[static_cast<size_t>(packet.channel)].out_ip;
+  if (out_ip == kRouterIp) {
+    sim->RouterReceive(event.packet);
+  } else if (out_ip == kServerIp) {
+    sim->ServerReceive(event.packet);
+  } else {
+    sim->ClientReceive(out_ip - kFirstClientIp, event.packet);
+  }
+}
+
+void NetSim::OnOutputWake(NetSim *sim, const OutputWake &event) {
+  sim->outputs_[static_cast<size_t>(event.output)].is_wake_scheduled = false;
+  sim->Pump(event.output);
+}
+
+void NetSim::RouterReceive(Ui32 packet_idx) {
+  const NetSimPacket &packet = packets_[packet_idx];
+  Si32 destination = packet.destination_ip;
+  Si32 output = destination >= 0 &&
+    destination < static_cast<Si32>(router_output_by_ip_.size()) ?
+    router_output_by_ip_[static_cast<size_t>(destination)] : -1;
+  if (output < 0 ||
+      router_used_memory_ + packet.size_bytes > config_.router_memory_bytes) {
+    stats_.router_dropped_bytes += packet.size_bytes;
+    FreePacket(packet_idx);
+    return;
+  }
+  // The packet moves on by index, nothing is copied
+  Enqueue(output, packet_idx);
+}
+
+void NetSim::SendLevelPart(Session *session, Si32 ip, Si32 part,
+    NetSimPacket::Kind kind) {
+  double now = scheduler_.GetTime();
+  Ui32 packet_idx = NewPacket(kind, kServerIp, ip,
+    config_.data_packet_bytes, session->session_id);
+  NetSimPacket &packet = packets_[packet_idx];
+  packet.part_idx = part;
+  packet.server_t0 = now;
+  session->unconfirmed_send_t[static_cast<size_t>(part)] = now;
+  Enqueue(server_output_, packet_idx);
+}
+
+void NetSim::ServerReceive(Ui32 packet_idx) {
+  double now = scheduler_.GetTime();
+  NetSimPacket packet = packets_[packet_idx];
+  FreePacket(packet_idx);
+  Si32 ip = packet.source_ip;
+  if (ip < kFirstClientIp || ip >= static_cast<Si32>(sessions_.size())) {
+    return;
+  }
+  Session &session = sessions_[static_cast<size_t>(ip)];
+  if (!session.is_active) {
+    if (packet.kind != NetSimPacket::Kind::kConnectionRequest) {
+      return;
+    }
+    // Establish a new session and send the level data
+    session.is_active = true;
+    session.session_id = packet.session_id;
+    session.t_last_received = now;
+    session.next_ping_idx = 0;
+    for (Si32 i = 0; i < kPingWindow; ++i) {
+      session.ping_window[i] = 0.5;
+    }
+    ++stats_.sessions_started;
+    session.unconfirmed_send_t.assign(
+      static_cast<size_t>(config_.level_size_packets), now);
+    session.unconfirmed_count = config_.level_size_packets;
+    for (Si32 i = 0; i < config_.level_size_packets; ++i) {
+      SendLevelPart(&session, ip, i, NetSimPacket::Kind::kData);
+    }
+    ApplyServerLimit();
+    SessionTimer timer;
+    timer.ip = ip;
+    timer.session_id = session.session_id;
+    session.timeout_timer = scheduler_.Schedule(
+      now + config_.session_timeout, session_timeout_, timer);
+    if (session.unconfirmed_count) {
+      session.retransmit_timer = scheduler_.Schedule(
+        now + session.GetAvgPing(), session_retransmit_, timer);
+    }
+    return;
+  }
+  if (packet.session_id != session.session_id) {
+    // There is a different session present, ignore
+    return;
+  }
+  session.t_last_received = now;
+  if (packet.kind == NetSimPacket::Kind::kDataAck) {
+    session.ping_window[session.next_ping_idx] = now - packet.server_t0;
+    session.next_ping_idx = (session.next_ping_idx + 1) % kPingWindow;
+    double &send_t =
+      session.unconfirmed_send_t[static_cast<size_t>(packet.part_idx)];
+    if (send_t >= 0.0) {
+      send_t = -1.0;
+      --session.unconfirmed_count;
+    }
+  }
+}
+
+void NetSim::OnSessionTimeout(NetSim *sim, const SessionTimer &event) {
+  Session &session = sim->sessions_[static_cast<size_t>(event.ip)];
+  if (!session.is_active || session.session_id != event.session_id) {
+    return;
+  }
+  double deadline = session.t_last_received + sim->config_.session_timeout;
+  if (deadline <= sim->scheduler_.GetTime()) {
+    session.is_active = false;
+    sim->scheduler_.Cancel(session.retransmit_timer);
+    return;
+  }
+  // Something arrived since the timer was set, wait for the new deadline
+  session.timeout_timer = sim->scheduler_.Schedule(deadline,
+    sim->session_timeout_, event);
+}
+
+void NetSim::OnSessionRetransmit(NetSim *sim, const SessionTimer &event) {
+  Session &session = sim->sessions_[static_cast<size_t>(event.ip)];
+  if (!session.is_active || session.session_id != event.session_id ||
+      !session.unconfirmed_count) {
+    return;
+  }
+  double now = sim->scheduler_.GetTime();
+  double ping = session.GetAvgPing();
+  double next_t = std::numeric_limits<double>::infinity();
+  for (Si32 i = 0; i < sim->config_.level_size_packets; ++i) {
+    double send_t = session.unconfirmed_send_t[static_cast<size_t>(i)];
+    if (send_t < 0.0) {
+      continue;
+    }
+    // Same expression as the next timer below, so a part due at the timer
+    // time is always resent
+    if (send_t + ping <= now) {
+      sim->SendLevelPart(&session, event.ip, i,
+        NetSimPacket::Kind::kDataRetransmitt);
+      send_t = now;
+    }
+    next_t = std::min(next_t, send_t);
+  }
+  sim->ApplyServerLimit();
+  session.retransmit_timer = sim->scheduler_.Schedule(next_t + ping,
+    sim->session_retransmit_, event);
+}
+
+void NetSim::OnWorldStateTick(NetSim *sim, const WorldStateTick &event) {
+  double now = sim->scheduler_.GetTime();
+  for (size_t ip = kFirstClientIp; ip < sim->sessions_.size(); ++ip) {
+    Session &session = sim->sessions_[ip];
+    if (!session.is_active || session.unconfirmed_count) {
+      continue;
+    }
+    Ui32 packet_idx = sim->NewPacket(NetSimPacket::Kind::kWorldState,
+      kServerIp, static_cast<Si32>(ip), sim->config_.data_packet_bytes,
+      session.session_id);
+    sim->packets_[packet_idx].server_t0 = now;
+    sim->Enqueue(sim->server_output_, packet_idx);
+  }
+  sim->ApplyServerLimit();
+  sim->scheduler_.Schedule(now + sim->config_.update_period,
+    sim->world_state_tick_, event);
+}
+
+void NetSim::ClientReceive(Si32 client_idx, Ui32 packet_idx) {
+  double now = scheduler_.GetTime();
+  NetSimPacket packet = packets_[packet_idx];
+  FreePacket(packet_idx);
+  NetSimClient &client = clients_[static_cast<size_t>(client_idx)];
+  if (!client.is_active) {
+    return;
+  }
+  client.received_bytes += packet.size_bytes;
+  stats_.client_received_bytes += packet.size_bytes;
+  if (packet.session_id != client.session_id) {
+    return;
+  }
+  client.last_receive_t = now;
+  client.last_delay = now - packet.server_t0;
+  if (packet.kind == NetSimPacket::Kind::kData ||
+      packet.kind == NetSimPacket::Kind::kDataRetransmitt) {
+    Ui8 &is_obtained =
+      client.level_obtained[static_cast<size_t>(packet.part_idx)];
+    if (!is_obtained) {
+      is_obtained = 1;
+      ++client.level_obtained_count;
+      if (client.level_obtained_count == config_.level_size_packets) {
+        ++stats_.levels_completed;
+      }
+    }
+    Ui32 ack_idx = NewPacket(NetSimPacket::Kind::kDataAck,
+      client.ip_address, kServerIp, config_.ack_packet_bytes,
+      client.session_id);
+    packets_[ack_idx].part_idx = packet.part_idx;
+    packets_[ack_idx].server_t0 = packet.server_t0;
+    Enqueue(client.output, ack_idx);
+  } else if (packet.kind == NetSimPacket::Kind::kWorldState) {
+    ++stats_.world_states_received;
+    stats_.world_state_latency_sum += client.last_delay;
+    stats_.world_state_latency_max = std::max(
+      stats_.world_state_latency_max, client.last_delay);
+    if (!client.is_world_state_obtained) {
+      client.is_world_state_obtained = true;
+      ClientTimer timer;
+      timer.client = client_idx;
+      client.controls_timer = scheduler_.Schedule(now, client_controls_,
+        timer);
+    }
+  }
+}
+
+void NetSim::OnClientTimeout(NetSim *sim, const ClientTimer &event) {
+  NetSimClient &client = sim->clients_[static_cast<size_t>(event.client)];
+  double now = sim->scheduler_.GetTime();
+  double deadline = client.last_receive_t + sim->config_.session_timeout;
+  if (deadline > now) {
+    client.timeout_timer = sim->scheduler_.Schedule(deadline,
+      sim->client_timeout_, event);
+    return;
+  }
+  // Disconnect on timeout and reconnect
+  client.is_world_state_obtained = false;
+  sim->scheduler_.Cancel(client.controls_timer);
+  std::fill(client.level_obtained.begin(), client.level_obtained.end(), 0);
+  client.level_obtained_count = 0;
+  client.session_id = sim->GetNextSessionId();
+  client.last_receive_t = now;
+  Ui32 packet_idx = sim->NewPacket(NetSimPacket::Kind::kConnectionRequest,
+    client.ip_address, kServerIp, sim->config_.ack_packet_bytes,
+    client.session_id);
+  sim->Enqueue(client.output, packet_idx);
+  client.timeout_timer = sim->scheduler_.Schedule(
+    now + sim->config_.session_timeout, sim->client_timeout_, event);
+}
+
+void NetSim::OnClientControls(NetSim *sim, const ClientTimer &event) {
+  NetSimClient &client = sim->clients_[static_cast<size_t>(event.client)];
+  Ui32 packet_idx = sim->NewPacket(NetSimPacket::Kind::kPlayerControls,
+    client.ip_address, kServerIp, sim->config_.controls_packet_bytes,
+    client.session_id);
+  sim->Enqueue(client.output, packet_idx);
+  client.controls_timer = sim->scheduler_.ScheduleAfter(
+    sim->config_.update_period, sim->client_controls_, event);
+}
+
+Si32 NetSim::AddClient() {
+  double now = scheduler_.GetTime();
+  Si32 idx = -1;
+  for (size_t i = 0; i < clients_.size(); ++i) {
+    if (!clients_[i].is_active) {
+      idx = static_cast<Si32>(i);
+      break;
+    }
+  }
+  if (idx < 0) {
+    idx = static_cast<Si32>(clients_.size());
+    clients_.emplace_back();
+    NetSimClient &client = clients_.back();
+    client.ip_address = kFirstClientIp + idx;
+    client.level_obtained.resize(
+      static_cast<size_t>(config_.level_size_packets));
+    client.output = AddOutput(false);
+    Si32 router_output = AddOutput(true);
+    router_output_by_ip_.push_back(router_output);
+    sessions_.emplace_back();
+    double delay = config_.client_link_delay +
+      config_.client_link_delay_spread *
+      static_cast<double>(Random(0, 35)) / 35.0;
+    double loss = config_.client_link_loss *
+      static_cast<double>(1 + Random(0, 1));
+    AddChannel(client.ip_address, kRouterIp,
+      config_.client_link_bits_per_second, delay, loss, client.output);
+    AddChannel(kRouterIp, client.ip_address,
+      config_.client_link_bits_per_second, delay, loss, router_output);
+  }
+  NetSimClient &client = clients_[static_cast<size_t>(idx)];
+  client.is_active = true;
+  client.session_id = GetNextSessionId();
+  client.last_receive_t = now - config_.session_timeout;
+  client.last_delay = 0.0;
+  client.is_world_state_obtained = false;
+  client.received_bytes = 0;
+  std::fill(client.level_obtained.begin(), client.level_obtained.end(), 0);
+  client.level_obtained_count = 0;
+  ClientTimer timer;
+  timer.client = idx;
+  client.timeout_timer = scheduler_.Schedule(now, client_timeout_, timer);
+  return idx;
+}
+
+void NetSim::RemoveClient() {
+  for (size_t i = 0; i < clients_.size(); ++i) {
+    NetSimClient &client = clients_[i];
+    if (client.is_active) {
+      client.is_active = false;
+      scheduler_.Cancel(client.timeout_timer);
+      scheduler_.Cancel(client.controls_timer);
+      ClearOutput(client.output);
+      client.received_bytes = 0;
+      return;
+    }
+  }
+}
+
+void NetSim::RebootServer() {
+  for (size_t ip = kFirstClientIp; ip < sessions_.size(); ++ip) {
+    Session &session = sessions_[ip];
+    if (session.is_active) {
+      session.is_active = false;
+      scheduler_.Cancel(session.timeout_timer);
+      scheduler_.Cancel(session.retransmit_timer);
+    }
+  }
+  OutputQueue &queue = outputs_[static_cast<size_t>(server_output_)];
+  ClearOutput(server_output_);
+  queue.sent_bytes = 0;
+}
+
+void NetSim::RebootRouter() {
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    if (outputs_[i].is_router) {
+      stats_.router_dropped_bytes += outputs_[i].used_memory;
+      ClearOutput(static_cast<Si32>(i));
+    }
+  }
+}
+
+void NetSim::SetServerBufferLimit(Si64 limit) {
+  config_.server_buffer_limit = limit;
+  ApplyServerLimit();
+}
+
+bool NetSim::IsPacketValid(const NetSimPacket &packet) const {
+  switch (packet.kind) {
+    case NetSimPacket::Kind::kData:
+    case NetSimPacket::Kind::kDataRetransmitt:
+    case NetSimPacket::Kind::kWorldState: {
+      Si32 idx = packet.destination_ip - kFirstClientIp;
+      if (idx < 0 || idx >= static_cast<Si32>(clients_.size())) {
+        return false;
+      }
+      const NetSimClient &client = clients_[static_cast<size_t>(idx)];
+      return client.is_active && client.session_id == packet.session_id;
+    }
+    case NetSimPacket::Kind::kDataAck:
+    case NetSimPacket::Kind::kPlayerControls: {
+      Si32 ip = packet.source_ip;
+      if (ip < kFirstClientIp || ip >= static_cast<Si32>(sessions_.size())) {
+        return false;
+      }
+      const Session &session = sessions_[static_cast<size_t>(ip)];
+      return session.is_active && session.session_id == packet.session_id;
+    }
+    default:
+      return true;
+  }
+}
+
+Si64 NetSim::GetServerQueuedBytes() const {
+  return outputs_[static_cast<size_t>(server_output_)].used_memory;
+}
+
+Si64 NetSim::GetServerSentBytes() const {
+  return outputs_[static_cast<size_t>(server_output_)].sent_bytes;
+}
+
+Si64 NetSim::GetServerDroppedBytes() const {
+  return outputs_[static_cast<size_t>(server_output_)].dropped_bytes;
+}
+
+}  // namespace arctic
@@ -0,0 +1,314 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 Huldra
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef TEMPLATE_PROJECT_NAME_NET_SIM_H_
+#define TEMPLATE_PROJECT_NAME_NET_SIM_H_
+
+#include <vector>
+
+#include "engine/arctic_types.h"
+#include "engine/event_scheduler.h"
+
+namespace arctic {
+
+/// @addtogroup global_advanced
+/// @{
+
+/// @brief Parameters of the NetSim client/router/server network model
+struct NetSimConfig {
+  Si32 level_size_packets = 1000000 / 576;
+  Si32 data_packet_bytes = 576;
+  Si32 ack_packet_bytes = 100;
+  Si32 controls_packet_bytes = 200;
+  double server_link_bits_per_second = 20000000.0;
+  double server_link_delay = 0.010;
+  double server_link_loss = 0.0001;
+  double client_link_bits_per_second = 2000000.0;
+  /// Each client link gets a base delay from client_link_delay to
+  /// client_link_delay + client_link_delay_spread
+  double client_link_delay = 0.010;
+  double client_link_delay_spread = 0.035;
+  /// Each client link loses packets with this or twice this probability
+  double client_link_loss = 0.01;
+  Si64 router_memory_bytes = 1000000;
+  /// The server drops its newest queued packets above this size, -1 for no
+  /// limit
+  Si64 server_buffer_limit = -1;
+  /// Period of world state updates and player controls
+  double update_period = 0.05;
+  /// Both sides drop a session that received nothing for this long
+  double session_timeout = 3.0;
+};
+
+/// @brief A packet of the NetSim model, in flight or queued
+struct NetSimPacket {
+  enum class Kind {
+    kConnectionRequest,  ///< Initial connection request from client
+    kData,  ///< Level data from server to client
+    kDataAck,  ///< Acknowledgment of received data
+    kDataRetransmitt,  ///< Retransmitted data after packet loss
+    kPlayerControls,  ///< Player input sent to server
+    kWorldState,  ///< Game state update from server
+  };
+
+  Ui64 session_id = 0;
+  Si32 source_ip = 0;
+  Si32 destination_ip = 0;
+  Si32 size_bytes = 0;
+  Kind kind = Kind::kData;
+  double server_t0 = 0.0;  ///< Server send time of data and world state
+  Si32 part_idx = 0;  ///< Level part of data, retransmitts and acks
+
+  Si32 channel = -1;  ///< Channel of the last hop
+  bool is_in_flight = false;
+  bool is_lost = false;
+  double t_in = 0.0;  ///< Time the packet entered the channel
+  double t_out = 0.0;  ///< Time the packet leaves the channel
+};
+
+/// @brief A one way link between two nodes of the NetSim model
+struct NetSimChannel {
+  Si32 in_ip = 0;
+  Si32 out_ip = 0;
+  double bits_per_second = 0.0;
+  double delay = 0.0;
+  double loss_probability = 0.0;
+  double busy_until = 0.0;
+  Si32 output = -1;  ///< The queue that feeds this channel
+};
+
+struct NetSimClient {
+  Si32 ip_address = 0;
+  bool is_active = false;
+  Ui64 session_id = 0;
+  double last_receive_t = 0.0;
+  double last_delay = 0.0;
+  bool is_world_state_obtained = false;
+  Si64 received_bytes = 0;
+  Si32 level_obtained_count = 0;
+  std::vector<Ui8> level_obtained;
+  Si32 output = -1;
+  EventHandle timeout_timer;
+  EventHandle controls_timer;
+};
+
+struct NetSimStats {
+  Si64 client_received_bytes = 0;  ///< Bytes delivered to active clients
+  Si64 server_sent_bytes = 0;
+  Si64 server_dropped_bytes = 0;  ///< Dropped by the server buffer limit
+  Si64 router_dropped_bytes = 0;  ///< Dropped by the full router
+  Si64 lost_packets = 0;  ///< Lost on the links
+  Si64 sessions_started = 0;
+  Si64 levels_completed = 0;
+  Si64 world_states_received = 0;
+  /// World state delay from the server to the client
+  double world_state_latency_sum = 0.0;
+  double world_state_latency_max = 0.0;
+};
+
+/// @brief Clients downloading a level from a server through a router,
+/// then exchanging world state and player controls, simulated on an
+/// EventScheduler
+///
+/// Links have a bandwidth, latency and loss, the router drops packets when
+/// its memory is full, the server resends unacknowledged level data. The
+/// model advances from event to event, so thousands of mostly idle
+/// clients simulate far faster than real time. Packets live in a pool and
+/// move between queues and channels by index. Random numbers come from
+/// Random, seed the calling thread for reproducible runs.
+/// IP addresses: 0 is the router, 1 is the server, clients start at 2.
+class NetSim {
+ public:
+  explicit NetSim(const NetSimConfig &config = NetSimConfig());
+  NetSim(const NetSim &other) = delete;
+  NetSim &operator=(const NetSim &other) = delete;
+
+  /// @brief Activates an inactive client or connects a new one to the
+  /// router
+  /// @return The client index
+  Si32 AddClient();
+  /// @brief Deactivates the first active client
+  void RemoveClient();
+  /// @brief Drops all sessions and the queued server output
+  void RebootServer();
+  /// @brief Drops all packets queued in the router
+  void RebootRouter();
+  void SetServerBufferLimit(Si64 limit);
+
+  /// @brief Runs the model up to the time given
+  /// @return The number of events processed
+  Ui64 RunUntil(double time, Ui64 max_events = ~0ull) {
+    return scheduler_.RunUntil(time, max_events);
+  }
+  double GetTime() const {
+    return scheduler_.GetTime();
+  }
+  const EventScheduler &GetScheduler() const {
+    return scheduler_;
+  }
+  const NetSimConfig &GetConfig() const {
+    return config_;
+  }
+  const NetSimStats &GetStats() const {
+    return stats_;
+  }
+
+  Si32 GetClientCount() const {
+    return static_cast<Si32>(clients_.size());
+  }
+  const NetSimClient &GetClient(Si32 idx) const {
+    return clients_[static_cast<size_t>(idx)];
+  }
+  Si32 GetChannelCount() const {
+    return static_cast<Si32>(channels_.size());
+  }
+  const NetSimChannel &GetChannel(Si32 idx) const {
+    return channels_[static_cast<size_t>(idx)];
+  }
+  /// @brief Returns the size of the packet pool, use with GetPacket and
+  /// NetSimPacket::is_in_flight to find packets in flight
+  Si32 GetPacketSlotCount() const {
+    return static_cast<Si32>(packets_.size());
+  }
+  const NetSimPacket &GetPacket(Si32 idx) const {
+    return packets_[static_cast<size_t>(idx)];
+  }
+  /// @brief Returns false for packets of a session that has ended
+  bool IsPacketValid(const NetSimPacket &packet) const;
+
+  Si64 GetServerQueuedBytes() const;
+  Si64 GetServerSentBytes() const;
+  Si64 GetServerDroppedBytes() const;
+  Si64 GetRouterQueuedBytes() const {
+    return router_used_memory_;
+  }
+  Si64 GetRouterDroppedBytes() const {
+    return stats_.router_dropped_bytes;
+  }
+
+ private:
+  static const Si32 kRouterIp = 0;
+  static const Si32 kServerIp = 1;
+  static const Si32 kFirstClientIp = 2;
+  static const Si32 kPingWindow = 5;
+
+  struct OutputQueue {
+    std::vector<Ui32> ring;
+    size_t head = 0;
+    size_t count = 0;
+    Si64 used_memory = 0;
+    Si64 sent_bytes = 0;
+    Si64 dropped_bytes = 0;
+    Si32 channel = -1;
+    bool is_router = false;
+    bool is_wake_scheduled = false;
+  };
+
+  struct Session {
+    bool is_active = false;
+    Ui64 session_id = 0;
+    double t_last_received = 0.0;
+    double ping_window[kPingWindow] = {};
+    Si32 next_ping_idx = 0;
+    std::vector<double> unconfirmed_send_t;  ///< Negative once confirmed
+    Si32 unconfirmed_count = 0;
+    EventHandle timeout_timer;
+    EventHandle retransmit_timer;
+
+    double GetAvgPing() const;
+  };
+
+  struct PacketArrival {
+    Ui32 packet;
+  };
+  struct OutputWake {
+    Si32 output;
+  };
+  struct ClientTimer {
+    Si32 client;
+  };
+  struct SessionTimer {
+    Si32 ip;
+    Ui64 session_id;
+  };
+  struct WorldStateTick {
+    Si32 unused;
+  };
+
+  static void OnPacketArrival(NetSim *sim, const PacketArrival &event);
+  static void OnOutputWake(NetSim *sim, const OutputWake &event);
+  static void OnClientTimeout(NetSim *sim, const ClientTimer &event);
+  static void OnClientControls(NetSim *sim, const ClientTimer &event);
+  static void OnSessionTimeout(NetSim *sim, const SessionTimer &event);
+  static void OnSessionRetransmit(NetSim *sim, const SessionTimer &event);
+  static void OnWorldStateTick(NetSim *sim, const WorldStateTick &event);
+
+  Ui32 NewPacket(NetSimPacket::Kind kind, Si32 source_ip,
+    Si32 destination_ip, Si32 size_bytes, Ui64 session_id);
+  void FreePacket(Ui32 packet);
+  Si32 AddOutput(bool is_router);
+  Si32 AddChannel(Si32 in_ip, Si32 out_ip, double bits_per_second,
+    double delay, double loss_probability, Si32 output);
+  void Enqueue(Si32 output, Ui32 packet);
+  void Pump(Si32 output);
+  void ClearOutput(Si32 output);
+  void ApplyServerLimit();
+  void Transmit(Si32 channel, Ui32 packet);
+  void RouterReceive(Ui32 packet);
+  void ServerReceive(Ui32 packet);
+  void ClientReceive(Si32 client, Ui32 packet);
+  void SendLevelPart(Session *session, Si32 ip, Si32 part,
+    NetSimPacket::Kind kind);
+  Ui64 GetNextSessionId() {
+    return next_session_id_++;
+  }
+
+  NetSimConfig config_;
+  EventScheduler scheduler_;
+  EventType<PacketArrival> packet_arrival_;
+  EventType<OutputWake> output_wake_;
+  EventType<ClientTimer> client_timeout_;
+  EventType<ClientTimer> client_controls_;
+  EventType<SessionTimer> session_timeout_;
+  EventType<SessionTimer> session_retransmit_;
+  EventType<WorldStateTick> world_state_tick_;
+
+  std::vector<NetSimPacket> packets_;
+  std::vector<Ui32> free_packets_;
+  std::vector<OutputQueue> outputs_;
+  std::vector<NetSimChannel> channels_;
+  std::vector<NetSimClient> clients_;
+  /// Indexed by client ip
+  std::vector<Session> sessions_;
+  /// Router output queue by destination ip, -1 if there is no route
+  std::vector<Si32> router_output_by_ip_;
+  Si32 server_output_ = -1;
+  Si64 router_used_memory_ = 0;
+  Ui64 next_session_id_ = 1;
+  NetSimStats stats_;
+};
+
+/// @}
+
+}  // namespace arctic
+
+#endif  // TEMPLATE_PROJECT_NAME_NET_SIM_H_
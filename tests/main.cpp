@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdio>
 #include <ctime>
 #include <deque>
@@ -10,16 +12,24 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT
 
 #include "engine/arctic_pi.h"
 #include "engine/arctic_platform.h"
 #include "engine/arctic_platform_def.h"
+#include "engine/arctic_platform_tcpip.h"
 #include "engine/arctic_types.h"
+#include "engine/bitstream.h"
+#include "engine/compressed_data.h"
 #include "engine/easy.h"
 #include "engine/easy_hw_sprite.h"
 #include "engine/opengl.h"
 #include "engine/gl_state.h"
+#include "engine/ini.h"
 #include "engine/localization.h"
+#include "engine/asset_pack.h"
+#include "engine/mapped_file.h"
+#include "engine/miniz.h"
 #include "engine/json.h"
 #include "engine/rgb.h"
 #include "engine/data_writer.h"
@@ -34,6 +44,16 @@
 #include "engine/mesh_gen_mod_complex.h"
 #include "engine/gui.h"
 #include "engine/csv.h"
+#include "engine/event_scheduler.h"
+#include "engine/frame_arena.h"
+#include "engine/mtq_blocking_queue.h"
+#include "engine/mtq_mpsc_vinfarr.h"
+#include "engine/net_channel.h"
+#include "engine/net_framing.h"
+#include "engine/profiler.h"
+#include "engine/snapshot_delta.h"
+#include "net_sim_batch/net_sim_batch.h"
+#include "template_project_name/net_sim.h"
 
 
 using namespace arctic;
@@ -347,6 +367,71 @@ void test_file_operations() {
   TEST_CHECK(list.size() > 0);
 }
 
+// Returns the contents of a gzip file written by the logger, or an empty
+// string if it is not a valid single-member gzip stream.
+std::string gunzip_log(const char *file_name) {
+  std::vector<Ui8> gz = ReadFile(file_name, true);
+  if (gz.size() < 18 || gz[0] != 0x1f || gz[1] != 0x8b || gz[2] != 8) {
+    return std::string();
+  }
+  size_t size = 0;
+  void *data = tinfl_decompress_mem_to_heap(gz.data() + 10, gz.size() - 18,
+    &size, 0);
+  if (!data) {
+    return std::string();
+  }
+  std::string text(static_cast<const char*>(data), size);
+  mz_free(data);
+  Ui32 crc = 0;
+  Ui32 raw_size = 0;
+  for (Si32 i = 0; i < 4; ++i) {
+    crc |= static_cast<Ui32>(gz[gz.size() - 8 + i]) << (i * 8);
+    raw_size |= static_cast<Ui32>(gz[gz.size() - 4 + i]) << (i * 8);
+  }
+  if (crc != mz_crc32(MZ_CRC32_INIT,
+      reinterpret_cast<const unsigned char*>(text.data()), text.size()) ||
+      raw_size != text.size()) {
+    return std::string();
+  }
+  return text;
+}
+
+void test_log_rotation() {
+  // The engine starts the logger before the tests, it is stopped here, run
+  // once per round and left running at the end
+  StopLogger();
+  const char *file_names[] = {"log.txt", "log.1.txt.gz", "log.2.txt.gz",
+    "log.3.txt.gz", "log.1.txt", "log.2.txt", "log.3.txt"};
+  for (const char *name : file_names) {
+    std::remove(name);
+  }
+  // Each round logs one line that does not fit next to the previous one,
+  // stopping the logger makes each line a separate batch
+  SetLogRotation(4096, 2, true);
+  std::vector<std::string> lines;
+  for (Si32 round = 0; round < 4; ++round) {
+    lines.push_back("Round " + std::to_string(round) + " " +
+      std::string(3000, static_cast<char>('a' + round)));
+    StartLogger();
+    Log(lines.back().c_str());
+    StopLogger();
+  }
+  SetLogRotation(0, 0, false);
+
+  std::vector<Ui8> current = ReadFile("log.txt", true);
+  TEST_CHECK(std::string(current.begin(), current.end()) ==
+    lines[3] + "\r\n");
+  TEST_CHECK(gunzip_log("log.1.txt.gz") == lines[2] + "\r\n");
+  TEST_CHECK(gunzip_log("log.2.txt.gz") == lines[1] + "\r\n");
+  // The oldest file is removed once there are 2 rotated files
+  TEST_CHECK(ReadFile("log.3.txt.gz", true).empty());
+  TEST_CHECK(ReadFile("log.1.txt", true).empty());
+  for (const char *name : file_names) {
+    std::remove(name);
+  }
+  StartLogger();
+}
+
 void test_tga_oom() {
   Sprite sp;
   sp.Load("data/oom.tga");
@@ -838,6 +923,129 @@ void test_localization_ordinal_english() {
   loc.Clear();
 }
 
+void test_localization_compiled_format() {
+  Localization& loc = Localization::Instance();
+  loc.Clear();
+  loc.SetLocale("ru");
+  
+  // Quirks of the pattern syntax are kept by the compiled form
+  std::string pattern = "{n, plural, =0 {none} one {# file '#'} few {} "
+      "other {# files {x}}}, {g, select, male {his} other {their}} {missing}";
+  std::string out = "> ";
+  loc.FormatPatternTo(pattern, {{"n", 1}, {"g", "male"}}, &out);
+  TEST_CHECK_(out == "> 1 file 1, his {missing}", "Got '%s'", out.c_str());
+  out.clear();
+  loc.FormatPatternTo(pattern, {{"n", 3}, {"x", "#"}, {"g", 2.5}}, &out);
+  TEST_CHECK_(out == "3 files 3, their {missing}", "Got '%s'", out.c_str());
+  TEST_CHECK(loc.FormatPattern(pattern, {{"n", 0}}) == "none,  {missing}");
+  
+  // A reloaded string replaces its compiled pattern
+  std::string path = "/tmp/arctic_test_compiled_format.csv";
+  std::string csv = "id,ru\nmsg,\"{n, plural, one {# день} few {# дня} many {# дней}}\"\n";
+  WriteFile(path.c_str(), reinterpret_cast<const Ui8*>(csv.data()), csv.size());
+  TEST_CHECK(loc.Load(path));
+  out.clear();
+  for (Si32 n = 20; n <= 22; ++n) {
+    loc.FormatTo("msg", {{"n", n}}, &out);
+    out += ';';
+  }
+  TEST_CHECK_(out == "20 дней;21 день;22 дня;", "Got '%s'", out.c_str());
+  csv = "id,ru\nmsg,{n} дн.\n";
+  WriteFile(path.c_str(), reinterpret_cast<const Ui8*>(csv.data()), csv.size());
+  TEST_CHECK(loc.Load(path));
+  TEST_CHECK(Loc("msg", {{"n", 5}}) == "5 дн.");
+  std::remove(path.c_str());
+  
+  // Formatting is safe from several threads, even while the pattern cache
+  // is being refilled
+  bool is_worker_ok = true;
+  std::thread worker([&loc, &is_worker_ok]() {
+    std::string text;
+    for (Si32 i = 0; i < 1000; ++i) {
+      text.clear();
+      loc.FormatTo("msg", {{"n", 2}}, &text);
+      loc.FormatPatternTo("{n}:" + std::to_string(i % 300), {{"n", 1}}, &text);
+      is_worker_ok = is_worker_ok &&
+          text == "2 дн.1:" + std::to_string(i % 300);
+    }
+  });
+  for (Si32 i = 0; i < 1000; ++i) {
+    loc.FormatPattern("{n}-" + std::to_string(i % 300), {{"n", 1}});
+  }
+  worker.join();
+  TEST_CHECK(is_worker_ok);
+  
+  loc.SetLocale("en");
+  loc.Clear();
+}
+
+void test_localization_binary_table() {
+  Localization& loc = Localization::Instance();
+  loc.Clear();
+  
+  std::string path = "/tmp/arctic_test_binary_table.csv";
+  std::string csv = "id,en,ru\n"
+      "hello,Hello,Привет\n"
+      "files,\"{n, plural, one {# file} other {# files}}\","
+      "\"{n, plural, one {# файл} few {# файла} many {# файлов}}\"\n"
+      "only_en,English only,\n";
+  for (Si32 i = 0; i < 300; ++i) {
+    csv += "key" + std::to_string(i) + ",Text " + std::to_string(i) +
+        ",Текст " + std::to_string(i) + "\n";
+  }
+  WriteFile(path.c_str(), reinterpret_cast<const Ui8*>(csv.data()), csv.size());
+  TEST_CHECK(loc.Load(path));
+  std::remove(path.c_str());
+  TEST_CHECK(loc.SaveTable("en", "/tmp/en.loctable"));
+  TEST_CHECK(loc.SaveTable("ru", "/tmp/ru.loctable"));
+  loc.Clear();
+  
+  TEST_CHECK(loc.LoadTable("/tmp/en.loctable"));
+  TEST_CHECK(!loc.LoadTable("/tmp/arctic_missing.loctable"));
+  loc.SetLocale("en");
+  TEST_CHECK(loc.Count() == 303);
+  TEST_CHECK(loc.Get("hello") == "Hello");
+  TEST_CHECK(loc.GetView("key299").ToString() == "Text 299");
+  TEST_CHECK(loc.HasKey("key0") && !loc.HasKey("key300"));
+  TEST_CHECK(loc.Get("nope") == "[?nope?]");
+  std::string files = loc.Format("files", {{"n", 1}}) + ";" +
+      loc.Format("files", {{"n", 7}});
+  TEST_CHECK_(files == "1 file;7 files", "Got '%s'", files.c_str());
+  
+  // Strings loaded over a table are counted once
+  csv = "id,en\nhello,Hi\nextra,Extra\n";
+  WriteFile(path.c_str(), reinterpret_cast<const Ui8*>(csv.data()), csv.size());
+  TEST_CHECK(loc.Load(path));
+  std::remove(path.c_str());
+  TEST_CHECK(loc.Count() == 304);
+  TEST_CHECK(loc.Get("hello") == "Hi");
+  
+  // A text without its terminating zero is rejected
+  std::vector<Ui8> table = ReadFile("/tmp/en.loctable");
+  std::string bytes(table.begin(), table.end());
+  size_t text_pos = bytes.find(std::string("\0Hello\0", 7));
+  TEST_CHECK(text_pos != std::string::npos);
+  table[text_pos + 6] = 'x';
+  WriteFile("/tmp/arctic_corrupt.loctable", table.data(), table.size());
+  TEST_CHECK(!loc.LoadTable("/tmp/arctic_corrupt.loctable"));
+  std::remove("/tmp/arctic_corrupt.loctable");
+  
+  // Tables of the current and fallback locales are mapped on switching
+  loc.SetTableDirectory("/tmp");
+  loc.SetLocale("ru");
+  TEST_CHECK(loc.Get("hello") == "Привет");
+  TEST_CHECK(loc.Get("only_en") == "English only");
+  files = loc.Format("files", {{"n", 3}});
+  TEST_CHECK_(files == "3 файла", "Got '%s'", files.c_str());
+  TEST_CHECK(loc.GetAvailableLocales().size() == 2);
+  
+  loc.SetTableDirectory("");
+  loc.SetLocale("en");
+  loc.Clear();
+  std::remove("/tmp/en.loctable");
+  std::remove("/tmp/ru.loctable");
+}
+
 // ============================================================================
 
 void test_ttf_font_loading() {
@@ -1128,6 +1336,67 @@ void test_json_comparison() {
   TEST_CHECK(arr1 != arr3);
 }
 
+// ============================================================================
+// IniFile tests
+// ============================================================================
+
+void test_ini_parse_and_lookup() {
+  IniFile ini;
+  TEST_CHECK(ini.LoadString(
+      "top = 1\r\n"
+      "; comment\n"
+      "[ai]\n"
+      "  aggression = 0.75  \n"
+      "name = \"Bob the bot\"\n"
+      "enabled: yes\n"
+      "[ render ]\n"
+      "width=1280\n"
+      "broken=12px"));
+  TEST_CHECK(ini.SectionCount() == 3);
+  TEST_CHECK(ini.GetInt("", "top") == 1);
+  TEST_CHECK(ini.GetFloat("ai", "aggression") == 0.75f);
+  TEST_CHECK(ini.GetString("ai", "name") == "Bob the bot");
+  TEST_CHECK(ini.GetBool("ai", "enabled"));
+  TEST_CHECK(ini.GetInt("render", "width") == 1280);
+  TEST_CHECK(ini.GetInt("render", "broken", -1) == -1);
+  TEST_CHECK(ini.GetInt("render", "broken", -2) == -2);
+  std::vector<std::string> names = ini.GetSectionNames();
+  TEST_CHECK(names.size() == 3 && names[0].empty() && names[1] == "ai" &&
+      names[2] == "render");
+  std::vector<std::string> keys = ini.GetSection("ai")->GetKeys();
+  TEST_CHECK(keys.size() == 3 && keys[0] == "aggression" &&
+      keys[2] == "name");
+
+  IniFile bad;
+  TEST_CHECK(!bad.LoadString("[ai]\nno separator\n"));
+  TEST_CHECK(bad.GetErrorDescription() == "Invalid key-value pair: no separator");
+}
+
+void test_ini_keys_and_save() {
+  IniFile ini;
+  TEST_CHECK(ini.LoadString("[ai]\naggression=0.5\n"));
+  IniKey aggression = ini.GetKey("ai", "aggression");
+  IniKey missing = ini.GetKey("ai", "fear");
+  TEST_CHECK(aggression.IsValid() && !missing.IsValid());
+  TEST_CHECK(aggression.GetSection() == ini.GetSection("ai"));
+  TEST_CHECK(aggression.GetFloat() == 0.5f && aggression.GetInt(7) == 7);
+  TEST_CHECK(missing.GetFloat(2.0f) == 2.0f);
+
+  // Resolved keys see edits and the cache is refreshed
+  ini.GetSection("ai")->SetValue("aggression", "3");
+  ini.GetSection("ai")->SetValue("fear", "0.25");
+  TEST_CHECK(aggression.GetInt(7) == 3 && aggression.GetFloat() == 3.0f);
+  TEST_CHECK(ini.GetFloat("ai", "fear") == 0.25f);
+
+  const char *path = "/tmp/arctic_test.ini";
+  TEST_CHECK(ini.SaveFile(path));
+  IniFile loaded;
+  TEST_CHECK(loaded.LoadFile(path));
+  TEST_CHECK(loaded.GetKey("ai", "aggression").GetInt() == 3);
+  TEST_CHECK(loaded.GetSection("ai")->GetKeys().size() == 2);
+  std::remove(path);
+}
+
 // ============================================================================
 // DataWriter / DataReader tests
 // ============================================================================
@@ -1325,6 +1594,883 @@ void test_data_writer_large_sequence() {
   }
 }
 
+void test_data_byte_order() {
+  DataWriter w;
+  w.byte_order = kByteOrderBigEndian;
+  w.WriteUInt16(0x0102);
+  w.WriteUInt32(0x03040506);
+  w.WriteUInt64(0x0708090A0B0C0D0Eull);
+  Ui32 values[7];
+  for (Ui32 i = 0; i < 7; ++i) {
+    values[i] = 0x11223344u * (i + 1);
+  }
+  w.WriteUInt32array(values, 7);
+  const Ui8 expected[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+      0x11, 0x22, 0x33, 0x44};
+  TEST_CHECK(w.data.size() == 14 + 7 * 4);
+  TEST_CHECK(std::memcmp(w.data.data(), expected, sizeof(expected)) == 0);
+
+  DataReader r;
+  r.ResetView(w.data.data(), w.data.size());
+  r.byte_order = kByteOrderBigEndian;
+  TEST_CHECK(r.ReadUInt16() == 0x0102);
+  TEST_CHECK(r.ReadUInt32() == 0x03040506);
+  TEST_CHECK(r.ReadUInt64() == 0x0708090A0B0C0D0Eull);
+  const Ui32 *span = r.ReadSpan<Ui32>(7);
+  TEST_CHECK(span != nullptr && std::memcmp(span, values, sizeof(values)) == 0);
+  TEST_CHECK(r.ReadSpan<Ui32>(1) == nullptr && !r.IsOk());
+
+  // Matching byte order and alignment read straight from the buffer
+  DataWriter native;
+  native.WriteArray(values, 7);
+  r.Reset(std::move(native.data));
+  r.byte_order = GetHostByteOrder();
+  TEST_CHECK(r.ReadSpan<Ui32>(7) == reinterpret_cast<const Ui32*>(r.data.data()));
+}
+
+void test_data_varint() {
+  DataWriter w;
+  const Ui64 values[] = {0, 1, 127, 128, 300, 16383, 16384, ~0ull};
+  for (Ui64 value : values) {
+    w.WriteVarUint(value);
+  }
+  w.WriteVarSint(-1);
+  w.WriteVarSint(-1000000000000ll);
+  TEST_CHECK(w.data.size() == 1 + 1 + 1 + 2 + 2 + 2 + 3 + 10 + 1 + 6);
+  TEST_CHECK(w.data[3] == 0x80 && w.data[4] == 0x01);
+
+  DataReader r;
+  r.Reset(std::move(w.data));
+  for (Ui64 value : values) {
+    TEST_CHECK(r.ReadVarUint() == value);
+  }
+  TEST_CHECK(r.ReadVarSint() == -1);
+  TEST_CHECK(r.ReadVarSint() == -1000000000000ll);
+  TEST_CHECK(r.IsOk());
+  r.ReadVarUint();
+  TEST_CHECK(!r.IsOk());
+}
+
+void test_data_file_sources() {
+  const char *path = "/tmp/arctic_test_data_stream.bin";
+  DataWriter w;
+  TEST_CHECK(w.OpenStream(path, 64));
+  for (Ui32 i = 0; i < 1000; ++i) {
+    w.WriteUInt32(i);
+    w.WriteVarUint(i * 1000);
+  }
+  TEST_CHECK(w.data.size() < 64);
+  TEST_CHECK(w.Close());
+
+  DataReader mapped;
+  TEST_CHECK(mapped.OpenMapped(path));
+  const Ui8 *file_data = mapped.p;
+  Ui64 file_size = static_cast<Ui64>(mapped.end - mapped.p);
+  DataReader streamed;
+  TEST_CHECK(streamed.OpenStream(path, 64));
+  bool is_same = true;
+  for (Ui32 i = 0; i < 1000; ++i) {
+    is_same = is_same && mapped.ReadUInt32() == i &&
+        mapped.ReadVarUint() == i * 1000 &&
+        streamed.ReadUInt32() == i && streamed.ReadVarUint() == i * 1000;
+  }
+  TEST_CHECK(is_same && mapped.IsOk() && streamed.IsOk());
+  TEST_CHECK(mapped.ReadUInt8() == 0 && !mapped.IsOk());
+  TEST_CHECK(streamed.ReadUInt8() == 0 && !streamed.IsOk());
+
+  // Spans and reads larger than the stream buffer
+  TEST_CHECK(streamed.OpenStream(path, 64));
+  const Ui8 *span = streamed.ReadSpan<Ui8>(100);
+  TEST_CHECK(span != nullptr && std::memcmp(span, file_data, 100) == 0);
+  std::vector<Ui8> rest(static_cast<size_t>(file_size));
+  Ui64 read = streamed.Read(rest.data(), file_size);
+  TEST_CHECK(read == file_size - 100 && !streamed.IsOk());
+  TEST_CHECK(std::memcmp(rest.data(), file_data + 100, read) == 0);
+  streamed.Reset(std::vector<Ui8>());
+  std::remove(path);
+}
+
+void test_compressed_data_roundtrip() {
+  const char *path = "/tmp/arctic_test_compressed.bin";
+  std::vector<Ui8> noise(100000);
+  Ui32 seed = 12345;
+  for (Ui8 &byte : noise) {
+    seed = seed * 1664525u + 1013904223u;
+    byte = static_cast<Ui8>(seed >> 24);
+  }
+  std::vector<Ui32> ramp(50000);
+  for (Ui32 i = 0; i < ramp.size(); ++i) {
+    ramp[i] = i / 7;
+  }
+  CompressedDataWriter w;
+  TEST_CHECK(w.Open(path, 6, 16 << 10));
+  for (Ui32 i = 0; i < 20000; ++i) {
+    w.WriteUInt32(i % 100);
+    w.WriteVarUint(i);
+  }
+  w.WriteArray(ramp.data(), ramp.size());
+  w.Write(noise.data(), noise.size());
+  w.WriteUInt64(0x0123456789abcdefull);
+  TEST_CHECK(w.Close());
+  Ui64 raw_size = w.GetRawSize();
+  TEST_CHECK(raw_size > 350000);
+  // The noise is stored as is, the rest shrinks
+  TEST_CHECK_(w.GetCompressedSize() < noise.size() + raw_size / 4,
+    "%llu bytes from %llu",
+    static_cast<unsigned long long>(w.GetCompressedSize()),
+    static_cast<unsigned long long>(raw_size));
+
+  CompressedDataReader r;
+  TEST_CHECK(r.Open(path, 1000));
+  bool is_same = true;
+  for (Ui32 i = 0; i < 20000; ++i) {
+    is_same = is_same && r.ReadUInt32() == i % 100 && r.ReadVarUint() == i;
+  }
+  std::vector<Ui32> ramp_read(ramp.size());
+  r.ReadUInt32array(ramp_read.data(), ramp_read.size());
+  std::vector<Ui8> noise_read(noise.size());
+  r.Read(noise_read.data(), noise_read.size());
+  TEST_CHECK(is_same && ramp_read == ramp && noise_read == noise);
+  TEST_CHECK(r.ReadUInt64() == 0x0123456789abcdefull && r.IsOk());
+  TEST_CHECK(r.ReadUInt8() == 0 && !r.IsOk() && !r.IsCorrupt());
+
+  // A damaged block ends the data
+  std::vector<Ui8> file;
+  {
+    std::ifstream in(path, std::ios_base::binary);
+    file.assign(std::istreambuf_iterator<char>(in),
+      std::istreambuf_iterator<char>());
+  }
+  file[100] ^= 0x55;
+  {
+    std::ofstream out(path, std::ios_base::binary | std::ios_base::trunc);
+    out.write(reinterpret_cast<const char*>(file.data()), file.size());
+  }
+  TEST_CHECK(r.Open(path));
+  std::vector<Ui8> all(static_cast<size_t>(raw_size));
+  TEST_CHECK(r.Read(all.data(), all.size()) < raw_size);
+  TEST_CHECK(!r.IsOk() && r.IsCorrupt());
+  r.Close();
+  std::remove(path);
+}
+
+// ============================================================================
+// BitStream tests
+// ============================================================================
+
+void test_bitstream_bit_layout() {
+  BitStream stream;
+  const Ui8 bits[] = {1, 0, 0, 0, 1, 0, 0, 1, 1, 1};
+  for (Ui8 bit : bits) {
+    stream.PushBit(bit);
+  }
+  const std::vector<Ui8> &data = stream.GetData();
+  TEST_CHECK_(data.size() == 2, "Expected 2 bytes, got %zu", data.size());
+  TEST_CHECK_(data[0] == 0x89 && data[1] == 0xC0, "Got 0x%02X 0x%02X",
+      data[0], data[1]);
+
+  // Writes after GetData continue the unfinished byte
+  stream.Write(0x2A, 6);
+  TEST_CHECK(stream.BitCount() == 16);
+  TEST_CHECK(stream.GetData().size() == 2 && stream.GetData()[1] == 0xEA);
+
+  BitStream copy(stream.GetData());
+  TEST_CHECK(copy.Read(10) == 0x227);
+  TEST_CHECK(copy.ReadBit() == 1 && copy.ReadBit() == 0);
+  TEST_CHECK(copy.ReadBitsLeft() == 4);
+  TEST_CHECK(copy.Read(8) == 0xA0);  // Bits past the end are zeros
+}
+
+void test_bitstream_roundtrip() {
+  BitStream stream;
+  stream.Reserve(1024);
+  for (Ui32 nbits = 0; nbits <= 64; ++nbits) {
+    stream.Write(0x0123456789ABCDEFull * (nbits + 1), nbits);
+  }
+  const Si64 signed_values[] = {0, -1, 1, -64, 63, 1000000, -9000000000ll};
+  for (Si64 value : signed_values) {
+    stream.WriteVarSint(value);
+  }
+  stream.WriteVarUint(~0ull);
+  stream.AlignWrite();
+  const Ui8 bytes[11] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  stream.WriteBytes(bytes, sizeof(bytes));
+  stream.PushBit(1);
+  stream.WriteBytes(bytes, sizeof(bytes));
+  TEST_CHECK(stream.BitCount() % 8 == 1);
+
+  stream.BeginRead();
+  for (Ui32 nbits = 0; nbits <= 64; ++nbits) {
+    Ui64 expected = (0x0123456789ABCDEFull * (nbits + 1)) &
+        (nbits ? ~0ull >> (64 - nbits) : 0);
+    Ui64 value = stream.Read(nbits);
+    if (!TEST_CHECK_(value == expected, "Width %u: expected %llx, got %llx",
+        nbits, static_cast<unsigned long long>(expected),
+        static_cast<unsigned long long>(value))) {
+      break;
+    }
+  }
+  for (Si64 value : signed_values) {
+    TEST_CHECK(stream.ReadVarSint() == value);
+  }
+  TEST_CHECK(stream.ReadVarUint() == ~0ull);
+  stream.AlignRead();
+  Ui8 out[11] = {};
+  stream.ReadBytes(out, sizeof(out));
+  TEST_CHECK(std::memcmp(out, bytes, sizeof(bytes)) == 0);
+  TEST_CHECK(stream.ReadBit() == 1);
+  std::memset(out, 0, sizeof(out));
+  stream.ReadBytes(out, sizeof(out));
+  TEST_CHECK(std::memcmp(out, bytes, sizeof(bytes)) == 0);
+  TEST_CHECK(stream.ReadBitsLeft() == 0);
+
+  // Clear keeps the memory, Assign reads foreign data
+  stream.Clear();
+  TEST_CHECK(stream.BitCount() == 0 && stream.GetData().empty());
+  stream.Assign(bytes, 2);
+  TEST_CHECK(stream.Read(16) == 0x0102);
+}
+
+// ============================================================================
+// Snapshot delta tests
+// ============================================================================
+
+struct SnapshotTestUnit {
+  float x;
+  float y;
+  Si16 vx;
+  Ui8 hp;
+  Ui8 unreplicated;
+};
+
+void InitSnapshotTestSchema(SnapshotSchema *schema) {
+  schema->AddFloat(offsetof(SnapshotTestUnit, x), -100.f, 100.f, 0.01f);
+  schema->AddFloat(offsetof(SnapshotTestUnit, y), -100.f, 100.f, 0.01f);
+  schema->AddSint(offsetof(SnapshotTestUnit, vx), 2, 10);
+  schema->AddUint(offsetof(SnapshotTestUnit, hp), 1, 7);
+}
+
+void test_snapshot_quantization() {
+  SnapshotSchema schema(sizeof(SnapshotTestUnit));
+  InitSnapshotTestSchema(&schema);
+  TEST_CHECK(schema.GetFieldCount() == 4);
+  TEST_CHECK(schema.GetField(0).bits == 15);
+
+  Snapshot snapshot(&schema);
+  SnapshotTestUnit unit = {12.345f, -1000.f, -300, 100, 7};
+  snapshot.Set(5, &unit);
+  TEST_CHECK(snapshot.GetCapacity() == 6);
+  TEST_CHECK(snapshot.Has(5) && !snapshot.Has(4));
+  SnapshotTestUnit out = {0.f, 0.f, 0, 0, 42};
+  TEST_CHECK(snapshot.Get(5, &out));
+  TEST_CHECK(std::fabs(out.x - 12.35f) < 0.001f);
+  TEST_CHECK(out.y == -100.f);  // Clamped
+  TEST_CHECK(out.vx == -300 && out.hp == 100 && out.unreplicated == 42);
+  snapshot.Remove(5);
+  TEST_CHECK(!snapshot.Has(5) && !snapshot.Get(5, &out));
+}
+
+void test_snapshot_delta_replication() {
+  SnapshotSchema schema(sizeof(SnapshotTestUnit));
+  InitSnapshotTestSchema(&schema);
+  SnapshotSender sender(&schema, 8);
+  SnapshotReceiver receiver(&schema, 8);
+  Snapshot world(&schema);
+  Snapshot decoded(&schema);
+  std::vector<SnapshotTestUnit> units(50);
+  for (Ui32 id = 0; id < units.size(); ++id) {
+    units[id] = {static_cast<float>(id), 0.f, 0, 100, 0};
+    world.Set(id, &units[id]);
+  }
+
+  Ui64 full_bits = 0;
+  Ui64 last_bits = 0;
+  bool is_ok = true;
+  for (Ui32 tick = 1; tick <= 20; ++tick) {
+    units[tick].x += 0.5f;
+    units[tick + 1].hp -= 1;
+    world.Set(tick, &units[tick]);
+    world.Set(tick + 1, &units[tick + 1]);
+    if (tick == 10) {
+      world.Remove(3);
+      world.Set(60, &units[0]);
+    }
+    world.SetTick(tick);
+    BitStream packet;
+    sender.Encode(world, &packet);
+    packet.GetData();
+    packet.BeginRead();
+    is_ok = is_ok && receiver.Decode(&packet, &decoded);
+    is_ok = is_ok && decoded.IsSame(world) && decoded.GetTick() == tick;
+    (tick == 1 ? full_bits : last_bits) = packet.BitCount();
+    // Every other packet is acknowledged
+    if (tick % 2) {
+      sender.Ack(receiver.GetLastTick());
+    }
+  }
+  TEST_CHECK(is_ok);
+  TEST_CHECK(!decoded.Has(3) && decoded.Has(60));
+  TEST_CHECK_(last_bits * 10 < full_bits, "Delta %u bits, full %u bits",
+      static_cast<unsigned>(last_bits), static_cast<unsigned>(full_bits));
+
+  // A packet against a baseline the receiver never got is rejected
+  SnapshotReceiver late_receiver(&schema, 8);
+  world.SetTick(21);
+  BitStream packet;
+  sender.Encode(world, &packet);
+  packet.GetData();
+  packet.BeginRead();
+  TEST_CHECK(sender.GetBaselineTick() == 19);
+  TEST_CHECK(!late_receiver.Decode(&packet, &decoded));
+
+  // Truncated data is rejected
+  BitStream truncated;
+  EncodeSnapshotDelta(nullptr, world, &truncated);
+  std::vector<Ui8> data = truncated.GetData();
+  data.resize(data.size() / 2);
+  truncated.Assign(data.data(), data.size());
+  TEST_CHECK(!DecodeSnapshotDelta(nullptr, &truncated, &decoded));
+}
+
+void test_socket_poller_loopback() {
+  SocketPoller poller;
+  TEST_CHECK(poller.IsValid());
+  ListenerSocket listener(AddressFamily::kIpV4, SocketProtocol::kTcp);
+  TEST_CHECK(listener.SetSoReuseAddress(true) == SocketResult::kSocketOk);
+  TEST_CHECK(listener.Bind("127.0.0.1", 0) == SocketResult::kSocketOk);
+  TEST_CHECK(listener.SetSoNonblocking(true) == SocketResult::kSocketOk);
+  uint16_t port = listener.GetLocalPort();
+  TEST_CHECK(port != 0);
+  TEST_CHECK(poller.Add(listener, kSocketEventRead, 1) ==
+    SocketResult::kSocketOk);
+
+  ConnectionSocket client(AddressFamily::kIpV4, SocketProtocol::kTcp);
+  TEST_CHECK(client.Connect("127.0.0.1", port) ==
+    SocketConnectResult::kSocketOk);
+  SocketEvent events[8];
+  size_t count = 0;
+  TEST_CHECK(poller.Wait(events, 8, 1000, &count) == SocketResult::kSocketOk);
+  TEST_CHECK(count == 1);
+  TEST_CHECK(events[0].token == 1);
+  TEST_CHECK(events[0].events & kSocketEventRead);
+
+  ConnectionSocket server = listener.Accept();
+  TEST_CHECK(server.IsValid());
+  TEST_CHECK(server.SetSoNonblocking(true) == SocketResult::kSocketOk);
+  TEST_CHECK(poller.Add(server, kSocketEventRead, 42) ==
+    SocketResult::kSocketOk);
+  TEST_CHECK(poller.Wait(events, 8, 0, &count) == SocketResult::kSocketOk);
+  TEST_CHECK(count == 0);
+
+  size_t size = 0;
+  TEST_CHECK(client.Write("ping", 4, &size) == SocketResult::kSocketOk);
+  TEST_CHECK(size == 4);
+  TEST_CHECK(poller.Wait(events, 8, 1000, &count) == SocketResult::kSocketOk);
+  TEST_CHECK(count == 1);
+  TEST_CHECK(events[0].token == 42);
+  TEST_CHECK(events[0].events & kSocketEventRead);
+  char buffer[16];
+  TEST_CHECK(server.Read(buffer, sizeof(buffer), &size) ==
+    SocketResult::kSocketOk);
+  TEST_CHECK(size == 4 && std::memcmp(buffer, "ping", 4) == 0);
+
+  // Write interest reports the socket at once, the token can change too
+  TEST_CHECK(poller.Modify(server, kSocketEventRead | kSocketEventWrite, 43)
+    == SocketResult::kSocketOk);
+  TEST_CHECK(poller.Wait(events, 8, 1000, &count) == SocketResult::kSocketOk);
+  TEST_CHECK(count == 1);
+  TEST_CHECK(events[0].token == 43);
+  TEST_CHECK(events[0].events & kSocketEventWrite);
+  TEST_CHECK(poller.Modify(server, kSocketEventRead, 42) ==
+    SocketResult::kSocketOk);
+
+  std::thread waker([&poller]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    poller.Wake();
+  });
+  TEST_CHECK(poller.Wait(events, 8, 5000, &count) == SocketResult::kSocketOk);
+  TEST_CHECK(count == 0);
+  waker.join();
+
+  // Hangup of the peer is reported as a read event, Read then closes
+  client = ConnectionSocket();
+  TEST_CHECK(poller.Wait(events, 8, 1000, &count) == SocketResult::kSocketOk);
+  TEST_CHECK(count == 1);
+  TEST_CHECK(events[0].token == 42);
+  TEST_CHECK(server.Read(buffer, sizeof(buffer), &size) ==
+    SocketResult::kSocketConnectionReset);
+  TEST_CHECK(poller.Remove(listener) == SocketResult::kSocketOk);
+  TEST_CHECK(poller.Wait(events, 8, 0, &count) == SocketResult::kSocketOk);
+  TEST_CHECK(count == 0);
+}
+
+void test_datagram_socket_batch() {
+  DatagramSocket receiver(AddressFamily::kIpV4);
+  DatagramSocket sender(AddressFamily::kIpV4);
+  TEST_CHECK(receiver.Bind("127.0.0.1", 0) == SocketResult::kSocketOk);
+  TEST_CHECK(sender.Bind("127.0.0.1", 0) == SocketResult::kSocketOk);
+  TEST_CHECK(receiver.SetSoNonblocking(true) == SocketResult::kSocketOk);
+  SocketAddress receiver_address;
+  TEST_CHECK(receiver_address.Resolve("127.0.0.1", receiver.GetLocalPort()));
+  TEST_CHECK(receiver_address.GetIp() == "127.0.0.1");
+  TEST_CHECK(receiver_address.GetPort() == receiver.GetLocalPort());
+
+  char buffer[64];
+  SocketAddress from;
+  size_t size = 1;
+  TEST_CHECK(receiver.ReceiveFrom(buffer, sizeof(buffer), &from, &size) ==
+    SocketResult::kSocketOk);
+  TEST_CHECK(size == 0);
+  TEST_CHECK(sender.SendTo(receiver_address, "hello", 5, &size) ==
+    SocketResult::kSocketOk);
+  TEST_CHECK(size == 5);
+  TEST_CHECK(receiver.ReceiveFrom(buffer, sizeof(buffer), &from, &size) ==
+    SocketResult::kSocketOk);
+  TEST_CHECK(size == 5 && std::memcmp(buffer, "hello", 5) == 0);
+  TEST_CHECK(from.GetPort() == sender.GetLocalPort());
+  TEST_CHECK(from.GetIp() == "127.0.0.1");
+
+  const size_t kCount = 100;
+  DatagramPacketPool outgoing(kCount, 256);
+  for (size_t i = 0; i < kCount; ++i) {
+    outgoing[i].address = receiver_address;
+    outgoing[i].size = 1 + i * 2;
+    std::memset(outgoing[i].data, static_cast<int>(i), outgoing[i].size);
+  }
+  size_t sent = 0;
+  TEST_CHECK(sender.SendBatch(outgoing.GetPackets(), kCount, &sent) ==
+    SocketResult::kSocketOk);
+  TEST_CHECK(sent == kCount);
+  DatagramPacketPool incoming(64, 256);
+  size_t total = 0;
+  bool is_same = true;
+  for (Si32 attempt = 0; attempt < 100 && total < kCount; ++attempt) {
+    size_t received = 0;
+    TEST_CHECK(receiver.ReceiveBatch(incoming.GetPackets(),
+      incoming.GetCount(), &received) == SocketResult::kSocketOk);
+    for (size_t i = 0; i < received; ++i) {
+      const DatagramPacket &packet = incoming[i];
+      is_same = is_same && packet.size == outgoing[total].size &&
+        std::memcmp(packet.data, outgoing[total].data, packet.size) == 0 &&
+        packet.address == from && !packet.is_truncated;
+      ++total;
+    }
+  }
+  TEST_CHECK(total == kCount);
+  TEST_CHECK(is_same);
+
+  DatagramPacketPool small(1, 16);
+  TEST_CHECK(sender.SendTo(receiver_address, outgoing[50].data, 100, &size)
+    == SocketResult::kSocketOk);
+  size_t received = 0;
+  for (Si32 attempt = 0; attempt < 100 && received == 0; ++attempt) {
+    TEST_CHECK(receiver.ReceiveBatch(small.GetPackets(), 1, &received) ==
+      SocketResult::kSocketOk);
+  }
+  TEST_CHECK(received == 1);
+  TEST_CHECK(small[0].is_truncated && small[0].size == 16);
+
+  // With segmentation offload one send becomes several datagrams
+  if (sender.SetUdpSegmentSize(100) == SocketResult::kSocketOk) {
+    TEST_CHECK(sender.SendTo(receiver_address, outgoing[99].data, 200,
+      &size) == SocketResult::kSocketOk);
+    total = 0;
+    for (Si32 attempt = 0; attempt < 100 && total < 2; ++attempt) {
+      TEST_CHECK(receiver.ReceiveBatch(incoming.GetPackets(),
+        incoming.GetCount(), &received) == SocketResult::kSocketOk);
+      for (size_t i = 0; i < received; ++i) {
+        TEST_CHECK(incoming[i].size == 100);
+      }
+      total += received;
+    }
+    TEST_CHECK(total == 2);
+  }
+}
+
+void test_net_connection_lossy_link() {
+  NetConnection client;
+  NetConnection server;
+  NetDelivery deliveries[] = {NetDelivery::kUnreliable,
+    NetDelivery::kReliableUnordered, NetDelivery::kReliableOrdered};
+  for (NetDelivery delivery : deliveries) {
+    client.AddChannel(delivery);
+    server.AddChannel(delivery);
+  }
+  NetLinkConfig config;
+  config.loss = 0.2;
+  config.duplicate = 0.05;
+  config.latency = 0.03;
+  config.jitter = 0.02;
+  NetLinkSimulator to_server(config, 1);
+  NetLinkSimulator to_client(config, 2);
+
+  const Ui32 kCount = 1500;
+  std::vector<Ui32> received[3];
+  std::vector<Ui8> packet;
+  std::vector<Ui8> message;
+  Ui32 next_message = 0;
+  double time = 0.0;
+  for (Si32 step = 0; step < 20000; ++step) {
+    time = step * 0.005;
+    // 5 messages on every channel each 5 ms, of 4 to 300 bytes
+    for (Si32 i = 0; i < 5 && next_message < kCount; ++i, ++next_message) {
+      message.assign(4 + (next_message * 37) % 297,
+        static_cast<Ui8>(next_message));
+      std::memcpy(message.data(), &next_message, 4);
+      for (Si32 channel = 0; channel < 3; ++channel) {
+        TEST_CHECK(client.Send(channel, message.data(),
+          static_cast<Ui32>(message.size())));
+      }
+    }
+    while (client.WritePacket(time, &packet)) {
+      TEST_CHECK(packet.size() <= 1200);
+      to_server.Send(time, packet.data(), packet.size());
+    }
+    while (to_server.Receive(time, &packet)) {
+      server.ReadPacket(time, packet.data(), packet.size());
+    }
+    Si32 channel = 0;
+    while (server.Receive(&channel, &message)) {
+      Ui32 value = 0;
+      std::memcpy(&value, message.data(), 4);
+      bool is_intact = message.size() == 4 + (value * 37) % 297;
+      for (size_t i = 4; i < message.size(); ++i) {
+        is_intact = is_intact && message[i] == static_cast<Ui8>(value);
+      }
+      TEST_CHECK(is_intact);
+      received[channel].push_back(value);
+    }
+    while (server.WritePacket(time, &packet)) {
+      to_client.Send(time, packet.data(), packet.size());
+    }
+    while (to_client.Receive(time, &packet)) {
+      client.ReadPacket(time, packet.data(), packet.size());
+    }
+    if (next_message == kCount && client.GetUnackedCount(1) == 0 &&
+        client.GetUnackedCount(2) == 0 && to_server.GetInFlightCount() == 0) {
+      break;
+    }
+  }
+
+  // Unreliable: some lost, nothing twice
+  std::vector<Ui32> unreliable = received[0];
+  std::sort(unreliable.begin(), unreliable.end());
+  TEST_CHECK(std::unique(unreliable.begin(), unreliable.end()) ==
+    unreliable.end());
+  TEST_CHECK(unreliable.size() < kCount && unreliable.size() > kCount / 2);
+  // Reliable unordered: everything once, reordered by jitter
+  std::vector<Ui32> unordered = received[1];
+  TEST_CHECK(unordered.size() == kCount);
+  TEST_CHECK(!std::is_sorted(unordered.begin(), unordered.end()));
+  std::sort(unordered.begin(), unordered.end());
+  bool is_complete = true;
+  for (Ui32 i = 0; i < unordered.size(); ++i) {
+    is_complete = is_complete && unordered[i] == i;
+  }
+  TEST_CHECK(is_complete);
+  // Reliable ordered: everything once, in order
+  TEST_CHECK(received[2].size() == kCount);
+  bool is_ordered = true;
+  for (Ui32 i = 0; i < received[2].size(); ++i) {
+    is_ordered = is_ordered && received[2][i] == i;
+  }
+  TEST_CHECK(is_ordered);
+  TEST_CHECK(client.GetStats().messages_resent > 0);
+  TEST_CHECK(client.GetRtt() > 0.04 && client.GetRtt() < 0.2);
+}
+
+void test_net_connection_coalescing() {
+  NetConnection client(600);
+  NetConnection server(600);
+  client.AddChannel(NetDelivery::kReliableOrdered);
+  server.AddChannel(NetDelivery::kReliableOrdered);
+  TEST_CHECK(!client.Send(0, "x", client.GetMaxMessageSize() + 1));
+  std::vector<Ui8> packet;
+  TEST_CHECK(!client.WritePacket(0.0, &packet));
+  // 100 messages of 10 bytes take two packets of up to 600 bytes
+  char text[10] = "message";
+  for (Si32 i = 0; i < 100; ++i) {
+    TEST_CHECK(client.Send(0, text, sizeof(text)));
+  }
+  std::vector<std::vector<Ui8>> packets;
+  while (client.WritePacket(0.0, &packet)) {
+    TEST_CHECK(packet.size() <= 600);
+    packets.push_back(packet);
+  }
+  TEST_CHECK(packets.size() == 3);
+  TEST_CHECK(client.GetStats().messages_sent == 100);
+
+  // A truncated packet is rejected as a whole
+  TEST_CHECK(!server.ReadPacket(0.01, packets[0].data(),
+    packets[0].size() - 1));
+  TEST_CHECK(!server.ReadPacket(0.01, packets[0].data(), 5));
+  Si32 channel = 0;
+  std::vector<Ui8> message;
+  TEST_CHECK(!server.Receive(&channel, &message));
+  // The second packet arrives first, the ordered channel waits
+  TEST_CHECK(server.ReadPacket(0.01, packets[1].data(), packets[1].size()));
+  TEST_CHECK(!server.Receive(&channel, &message));
+  TEST_CHECK(server.ReadPacket(0.01, packets[0].data(), packets[0].size()));
+  TEST_CHECK(!server.ReadPacket(0.01, packets[0].data(), packets[0].size()));
+  TEST_CHECK(server.ReadPacket(0.01, packets[2].data(), packets[2].size()));
+  Si32 count = 0;
+  while (server.Receive(&channel, &message)) {
+    TEST_CHECK(message.size() == sizeof(text));
+    ++count;
+  }
+  TEST_CHECK(count == 100);
+
+  // One ack packet acks all three, nothing is resent later
+  TEST_CHECK(server.WritePacket(0.02, &packet));
+  std::vector<Ui8> empty;
+  TEST_CHECK(!server.WritePacket(0.02, &empty));
+  TEST_CHECK(client.GetUnackedCount(0) == 100);
+  TEST_CHECK(client.ReadPacket(0.02, packet.data(), packet.size()));
+  TEST_CHECK(client.GetUnackedCount(0) == 0);
+  TEST_CHECK(client.GetStats().packets_acked == 3);
+  TEST_CHECK(!client.WritePacket(10.0, &packet));
+}
+
+void test_framed_connection_loopback() {
+  ListenerSocket listener(AddressFamily::kIpV4, SocketProtocol::kTcp);
+  TEST_CHECK(listener.SetSoReuseAddress(true) == SocketResult::kSocketOk);
+  TEST_CHECK(listener.Bind("127.0.0.1", 0) == SocketResult::kSocketOk);
+  ConnectionSocket client(AddressFamily::kIpV4, SocketProtocol::kTcp);
+  TEST_CHECK(client.Connect("127.0.0.1", listener.GetLocalPort()) ==
+    SocketConnectResult::kSocketOk);
+  ConnectionSocket server = listener.Accept();
+  TEST_CHECK(server.IsValid());
+  TEST_CHECK(client.SetSoNonblocking(true) == SocketResult::kSocketOk);
+  TEST_CHECK(server.SetSoNonblocking(true) == SocketResult::kSocketOk);
+
+  // A small ring and small blocks make messages cross both boundaries
+  FrameBufferPool pool(256);
+  FramedConnectionConfig config;
+  config.receive_buffer_size = 256;
+  config.max_message_size = 200;
+  config.max_queued_bytes = 4096;
+  FramedConnection sender(std::move(client), config, &pool);
+  FramedConnection receiver(std::move(server), config, &pool);
+  std::vector<Ui8> buffer(256);
+  TEST_CHECK(!sender.QueueMessage(buffer.data(), 201));
+
+  const Si32 kMessageCount = 2000;
+  Si32 sent = 0;
+  Si32 received = 0;
+  Si32 split_count = 0;
+  bool is_correct = true;
+  for (Si32 step = 0; step < 100000 && received < kMessageCount; ++step) {
+    while (sent < kMessageCount) {
+      Ui32 size = static_cast<Ui32>(sent * 37 % 201);
+      for (Ui32 idx = 0; idx < size; ++idx) {
+        buffer[idx] = static_cast<Ui8>(sent + idx);
+      }
+      if (!sender.QueueMessage(buffer.data(), size)) {
+        break;
+      }
+      ++sent;
+    }
+    TEST_CHECK(sender.GetQueuedBytes() <= config.max_queued_bytes);
+    TEST_CHECK(sender.Flush() == SocketResult::kSocketOk);
+    TEST_CHECK(receiver.Receive() == SocketResult::kSocketOk);
+    FrameView message;
+    while (receiver.ReadMessage(&message)) {
+      Ui32 size = static_cast<Ui32>(received * 37 % 201);
+      is_correct = is_correct && message.GetSize() == size;
+      for (Ui32 idx = 0; is_correct && idx < size; ++idx) {
+        is_correct = message[idx] == static_cast<Ui8>(received + idx);
+      }
+      split_count += message.IsContiguous() ? 0 : 1;
+      ++received;
+    }
+  }
+  TEST_CHECK(is_correct);
+  TEST_CHECK(received == kMessageCount);
+  TEST_CHECK(split_count > 0);
+  TEST_CHECK(sender.GetQueuedBytes() == 0);
+  // The queue limit bounds the pool, all blocks are back once flushed
+  TEST_CHECK(pool.GetBlockCount() <= config.max_queued_bytes / 256 + 1);
+  TEST_CHECK(pool.GetFreeCount() == pool.GetBlockCount());
+
+  // Backpressure rejects messages once the queue is full
+  Si32 queued = 0;
+  while (sender.QueueMessage(buffer.data(), 100)) {
+    ++queued;
+  }
+  TEST_CHECK(queued == 4096 / 104);
+  TEST_CHECK(!sender.CanQueue(100));
+  TEST_CHECK(sender.CanQueue(0));
+
+  // A size prefix above max_message_size marks the stream as malformed
+  size_t size = 0;
+  TEST_CHECK(sender.GetSocket().Write("\xff\xff\xff\xff", 4, &size) ==
+    SocketResult::kSocketOk);
+  TEST_CHECK(size == 4);
+  FrameView message;
+  for (Si32 step = 0; step < 1000 && receiver.GetReceivedBytes() < 4; ++step) {
+    TEST_CHECK(receiver.Receive() == SocketResult::kSocketOk);
+  }
+  TEST_CHECK(!receiver.ReadMessage(&message));
+  TEST_CHECK(receiver.Receive() == SocketResult::kSocketError);
+}
+
+struct SchedulerTestEvent {
+  Si32 id;
+};
+
+struct SchedulerTestLog {
+  EventScheduler *scheduler = nullptr;
+  EventType<SchedulerTestEvent> type;
+  std::vector<Si32> ids;
+  std::vector<double> times;
+};
+
+static void OnSchedulerTestEvent(SchedulerTestLog *log,
+    const SchedulerTestEvent &event) {
+  log->ids.push_back(event.id);
+  log->times.push_back(log->scheduler->GetTime());
+  if (event.id == 3) {
+    // schedule from a handler, ties run in scheduling order
+    SchedulerTestEvent next;
+    next.id = 30;
+    log->scheduler->ScheduleAfter(0.0, log->type, next);
+  }
+}
+
+void test_event_scheduler() {
+  EventScheduler scheduler;
+  SchedulerTestLog log;
+  log.scheduler = &scheduler;
+  log.type = scheduler.AddHandler(&log, OnSchedulerTestEvent);
+  SchedulerTestEvent event;
+  event.id = 1;
+  scheduler.Schedule(2.0, log.type, event);
+  event.id = 2;
+  EventHandle cancelled = scheduler.Schedule(1.0, log.type, event);
+  event.id = 3;
+  scheduler.Schedule(1.0, log.type, event);
+  event.id = 4;
+  scheduler.Schedule(1.0, log.type, event);
+  event.id = 5;
+  scheduler.Schedule(5.0, log.type, event);
+  TEST_CHECK(scheduler.GetPendingCount() == 5);
+  TEST_CHECK(scheduler.IsScheduled(cancelled));
+  TEST_CHECK(scheduler.Cancel(cancelled));
+  TEST_CHECK(!scheduler.Cancel(cancelled));
+  TEST_CHECK(!scheduler.IsScheduled(cancelled));
+  TEST_CHECK(scheduler.GetPendingCount() == 4);
+  TEST_CHECK(scheduler.GetNextEventTime() == 1.0);
+
+  TEST_CHECK(scheduler.RunUntil(3.0) == 4);
+  TEST_CHECK(scheduler.GetTime() == 3.0);
+  std::vector<Si32> expected_ids = {3, 4, 30, 1};
+  TEST_CHECK(log.ids == expected_ids);
+  std::vector<double> expected_times = {1.0, 1.0, 1.0, 2.0};
+  TEST_CHECK(log.times == expected_times);
+  TEST_CHECK(scheduler.GetPendingCount() == 1);
+
+  // a reused node must not be cancelled through a stale handle
+  event.id = 6;
+  EventHandle handle = scheduler.ScheduleAfter(1.0, log.type, event);
+  TEST_CHECK(!scheduler.Cancel(cancelled));
+  TEST_CHECK(scheduler.IsScheduled(handle));
+  TEST_CHECK(scheduler.RunUntil(10.0, 1) == 1);
+  TEST_CHECK(log.ids.back() == 6);
+  TEST_CHECK(scheduler.GetTime() == 4.0);
+  TEST_CHECK(scheduler.RunUntil(10.0) == 1);
+  TEST_CHECK(log.ids.back() == 5);
+  TEST_CHECK(scheduler.GetTime() == 10.0);
+  TEST_CHECK(!scheduler.Step());
+  TEST_CHECK(scheduler.GetProcessedCount() == 6);
+}
+
+void test_net_sim() {
+  NetSim sim;
+  for (Si32 i = 0; i < 5; ++i) {
+    TEST_CHECK(sim.AddClient() == i);
+  }
+  sim.RunUntil(60.0);
+  TEST_CHECK(sim.GetTime() == 60.0);
+  const NetSimStats &stats = sim.GetStats();
+  TEST_CHECK(stats.levels_completed >= 5);
+  TEST_CHECK(stats.world_states_received > 0);
+  for (Si32 i = 0; i < sim.GetClientCount(); ++i) {
+    const NetSimClient &client = sim.GetClient(i);
+    TEST_CHECK(client.is_active);
+    TEST_CHECK(client.level_obtained_count ==
+      sim.GetConfig().level_size_packets);
+    TEST_CHECK(client.is_world_state_obtained);
+  }
+  TEST_CHECK(sim.GetServerSentBytes() >=
+    5 * sim.GetConfig().level_size_packets *
+    sim.GetConfig().data_packet_bytes);
+
+  sim.RemoveClient();
+  TEST_CHECK(!sim.GetClient(0).is_active);
+  sim.RunUntil(61.0);
+  TEST_CHECK(sim.AddClient() == 0);
+  sim.RebootServer();
+  sim.RebootRouter();
+  TEST_CHECK(sim.GetServerQueuedBytes() == 0);
+  TEST_CHECK(sim.GetRouterQueuedBytes() == 0);
+  sim.RunUntil(120.0);
+  for (Si32 i = 0; i < sim.GetClientCount(); ++i) {
+    TEST_CHECK(sim.GetClient(i).level_obtained_count ==
+      sim.GetConfig().level_size_packets);
+  }
+}
+
+void test_net_sim_batch_reproducible() {
+  std::vector<NetSimScenario> scenarios;
+  for (Ui64 seed = 1; seed <= 4; ++seed) {
+    NetSimScenario scenario;
+    scenario.client_count = 3;
+    scenario.config.level_size_packets = 100;
+    scenario.config.client_link_loss = 0.05;
+    scenario.sim_seconds = 10.0;
+    scenario.seed = seed % 2 + 7;
+    scenarios.push_back(scenario);
+  }
+  std::vector<NetSimScenarioResult> serial = RunNetSimBatch(scenarios, 1);
+  std::vector<NetSimScenarioResult> parallel = RunNetSimBatch(scenarios, 3);
+  TEST_CHECK(serial.size() == 4 && parallel.size() == 4);
+  // runs 0 and 2, 1 and 3 share a seed
+  TEST_CHECK(serial[0].events == serial[2].events);
+  TEST_CHECK(serial[1].events == serial[3].events);
+  TEST_CHECK(serial[0].stats.world_state_latency_sum !=
+    serial[1].stats.world_state_latency_sum);
+  for (size_t i = 0; i < serial.size(); ++i) {
+    TEST_CHECK(serial[i].events == parallel[i].events);
+    TEST_CHECK(serial[i].clients_with_level == 3);
+    TEST_CHECK(serial[i].stats.lost_packets ==
+      parallel[i].stats.lost_packets);
+    TEST_CHECK(serial[i].stats.world_state_latency_sum ==
+      parallel[i].stats.world_state_latency_sum);
+  }
+
+  CsvTable serial_table;
+  NetSimBatchToCsv(scenarios, serial, &serial_table);
+  CsvTable parallel_table;
+  NetSimBatchToCsv(scenarios, parallel, &parallel_table);
+  TEST_CHECK(serial_table.SaveFile("net_sim_batch_serial.csv"));
+  TEST_CHECK(parallel_table.SaveFile("net_sim_batch_parallel.csv"));
+  std::vector<Ui8> serial_file = ReadFile("net_sim_batch_serial.csv");
+  TEST_CHECK(!serial_file.empty());
+  TEST_CHECK(serial_file == ReadFile("net_sim_batch_parallel.csv"));
+
+  CsvTable loaded;
+  TEST_CHECK(loaded.LoadFile("net_sim_batch_serial.csv"));
+  TEST_CHECK(loaded.RowCount() == 4);
+  TEST_CHECK(loaded.ColumnCount() == serial_table.ColumnCount());
+  std::vector<double> latencies =
+    loaded.GetColumn<double>("world_state_latency_ms", 0.0);
+  TEST_CHECK(latencies.size() == 4 && latencies[0] ==
+    serial[0].stats.world_state_latency_sum * 1000.0 /
+    static_cast<double>(serial[0].stats.world_states_received));
+  std::remove("net_sim_batch_serial.csv");
+  std::remove("net_sim_batch_parallel.csv");
+}
+
 // ============================================================================
 // easy_sound_instance bug reproduction tests
 // ============================================================================
@@ -1498,6 +2644,374 @@ void test_sound_8bit_signed_vs_unsigned() {
       (int)max_sample);
 }
 
+void test_mapped_file() {
+  const char *path = "/tmp/arctic_test_mapped_file.bin";
+  std::vector<Ui8> bytes(100000);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<Ui8>(i * 7 + (i >> 8));
+  }
+  WriteFile(path, bytes.data(), bytes.size());
+
+  MappedFile file;
+  if (!TEST_CHECK(file.Open(path))) {
+    return;
+  }
+  TEST_CHECK(file.IsOpen());
+  TEST_CHECK(file.IsMapped());
+  TEST_CHECK(file.Size() == bytes.size());
+  TEST_CHECK(memcmp(file.Data(), bytes.data(), bytes.size()) == 0);
+
+  // The mapping moves with the object
+  MappedFile moved = std::move(file);
+  TEST_CHECK(!file.IsOpen());
+  TEST_CHECK(moved.IsOpen());
+  TEST_CHECK(moved.Data()[12345] == bytes[12345]);
+  moved.Close();
+  TEST_CHECK(!moved.IsOpen());
+
+  // Copy-on-write changes stay in memory
+  MappedFile cow;
+  TEST_CHECK(cow.Open(path, true));
+  Ui8 *data = cow.MutableData();
+  data[0] = static_cast<Ui8>(bytes[0] + 1);
+  data[bytes.size() - 1] = static_cast<Ui8>(bytes.back() + 1);
+  TEST_CHECK(cow.Data()[0] == static_cast<Ui8>(bytes[0] + 1));
+  cow.Close();
+  std::vector<Ui8> on_disk = ReadFile(path);
+  TEST_CHECK(on_disk == bytes);
+
+  // Missing files are not opened, empty ones are
+  TEST_CHECK(!cow.Open("/tmp/arctic_test_no_such_file.bin"));
+  TEST_CHECK(!cow.IsOpen());
+  WriteFile(path, nullptr, 0);
+  TEST_CHECK(cow.Open(path));
+  TEST_CHECK(cow.Size() == 0);
+  cow.Close();
+  std::remove(path);
+}
+
+void test_asset_pack() {
+  const char *pack_path = "/tmp/arctic_test.pack";
+  const char *loose_path = "/tmp/arctic_test_pack_loose.txt";
+  std::string text;
+  for (Si32 i = 0; i < 200; ++i) {
+    text += "name,value\nhero,10\n";
+  }
+  std::vector<Ui8> noise(5000);
+  Ui64 state = 12345;
+  for (Ui8 &byte : noise) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    byte = static_cast<Ui8>(state >> 56);
+  }
+  std::string csv = "name,hp\nhero,10\norc,7\n";
+  WriteFile(loose_path, reinterpret_cast<const Ui8*>(csv.data()), csv.size());
+
+  AssetPackWriter writer;
+  writer.Add("text.txt", std::vector<Ui8>(text.begin(), text.end()));
+  writer.Add("sub\\noise.bin", noise);
+  writer.Add("stored.txt", std::vector<Ui8>(text.begin(), text.end()), false);
+  writer.Add("empty.bin", std::vector<Ui8>());
+  writer.AddFile(loose_path, "./tables/units.csv");
+  writer.Add("replaced.txt", std::vector<Ui8>(3, 'a'));
+  writer.Add("replaced.txt", std::vector<Ui8>(5, 'b'));
+  if (!TEST_CHECK(writer.Save(pack_path))) {
+    return;
+  }
+  TEST_CHECK(writer.GetEntryCount() == 6);
+  TEST_CHECK(writer.GetPackSize() < writer.GetRawSize());
+
+  AssetPack pack;
+  if (!TEST_CHECK(pack.Open(pack_path))) {
+    return;
+  }
+  TEST_CHECK(pack.GetEntryCount() == 6);
+  Ui32 index = pack.Find("text.txt");
+  std::vector<Ui8> data;
+  if (TEST_CHECK(index != kAssetPackNoEntry)) {
+    TEST_CHECK(pack.IsDeflated(index));
+    TEST_CHECK(pack.Read(index, &data));
+    TEST_CHECK(std::string(data.begin(), data.end()) == text);
+  }
+  index = pack.Find("sub/noise.bin");
+  if (TEST_CHECK(index != kAssetPackNoEntry)) {
+    TEST_CHECK(!pack.IsDeflated(index));
+    TEST_CHECK(reinterpret_cast<uintptr_t>(pack.GetStoredData(index)) % 16
+      == 0);
+    TEST_CHECK(pack.Read(index, &data) && data == noise);
+  }
+  index = pack.Find("stored.txt");
+  TEST_CHECK(index != kAssetPackNoEntry && !pack.IsDeflated(index));
+  index = pack.Find("empty.bin");
+  TEST_CHECK(index != kAssetPackNoEntry && pack.GetSize(index) == 0);
+  index = pack.Find("replaced.txt");
+  TEST_CHECK(index != kAssetPackNoEntry && pack.GetSize(index) == 5);
+  TEST_CHECK(pack.Find("tables/units.csv") != kAssetPackNoEntry);
+  TEST_CHECK(pack.Find("missing.txt") == kAssetPackNoEntry);
+  TEST_CHECK(pack.Find("text.tx") == kAssetPackNoEntry);
+  pack.Close();
+
+  // Mounted packs come before the loose files
+  std::remove(loose_path);
+  if (!TEST_CHECK(MountAssetPack(pack_path, "packtest/"))) {
+    return;
+  }
+  data = ReadFile("packtest/text.txt");
+  TEST_CHECK(std::string(data.begin(), data.end()) == text);
+  TEST_CHECK(ReadFile(".\\packtest\\sub\\noise.bin") == noise);
+  TEST_CHECK(ReadFile("text.txt", true).empty());
+  MappedFile file;
+  if (TEST_CHECK(file.Open("packtest/sub/noise.bin"))) {
+    TEST_CHECK(file.IsMapped());
+    TEST_CHECK(file.Size() == noise.size());
+    TEST_CHECK(memcmp(file.Data(), noise.data(), noise.size()) == 0);
+  }
+  TEST_CHECK(file.Open("packtest/text.txt", true));
+  TEST_CHECK(!file.IsMapped());
+  file.MutableData()[0] = 'X';
+  TEST_CHECK(ReadFile("packtest/text.txt")[0] == 'n');
+  CsvTable table;
+  if (TEST_CHECK(table.LoadFile("packtest/tables/units.csv"))) {
+    TEST_CHECK(table.RowCount() == 2);
+  }
+  // Data stays valid after the pack is unmounted
+  TEST_CHECK(file.Open("packtest/sub/noise.bin"));
+  TEST_CHECK(UnmountAssetPack(pack_path));
+  TEST_CHECK(!UnmountAssetPack(pack_path));
+  TEST_CHECK(memcmp(file.Data(), noise.data(), noise.size()) == 0);
+  file.Close();
+  TEST_CHECK(ReadFile("packtest/text.txt", true).empty());
+
+  // A deflated entry larger than deflate can expand to is rejected
+  std::vector<Ui8> bytes = ReadFile(pack_path);
+  std::vector<Ui8> corrupt = bytes;
+  Ui32 entry_count = 0;
+  Ui32 bucket_count = 0;
+  Ui64 directory_offset = 0;
+  memcpy(&entry_count, corrupt.data() + 12, sizeof(entry_count));
+  memcpy(&bucket_count, corrupt.data() + 16, sizeof(bucket_count));
+  memcpy(&directory_offset, corrupt.data() + 24, sizeof(directory_offset));
+  for (Ui32 i = 0; i < entry_count; ++i) {
+    AssetPack::Entry entry;
+    Ui8 *entry_data = corrupt.data() + directory_offset +
+      bucket_count * sizeof(Ui32) + i * sizeof(entry);
+    memcpy(&entry, entry_data, sizeof(entry));
+    if (entry.flags & AssetPack::kEntryDeflated) {
+      entry.size = entry.stored_size * 2000;
+      memcpy(entry_data, &entry, sizeof(entry));
+      break;
+    }
+  }
+  WriteFile(pack_path, corrupt.data(), corrupt.size());
+  TEST_CHECK(!pack.Open(pack_path));
+
+  // A truncated pack is rejected
+  bytes.pop_back();
+  WriteFile(pack_path, bytes.data(), bytes.size());
+  TEST_CHECK(!pack.Open(pack_path));
+  TEST_CHECK(!MountAssetPack(pack_path));
+  UnmountAllAssetPacks();
+  std::remove(pack_path);
+}
+
+void test_sound_load_mapped_wav() {
+  const char *path = "/tmp/arctic_test_mapped_sound.wav";
+  // 3 stereo 16-bit samples, the native format is used straight from the
+  // mapping
+  std::vector<Ui8> pcm = {
+    0x00, 0x01, 0x00, 0xFF,
+    0x34, 0x12, 0xCC, 0xED,
+    0xFF, 0x7F, 0x00, 0x80};
+  std::vector<Ui8> wav = build_wav(2, 44100, 16, pcm);
+  WriteFile(path, wav.data(), wav.size());
+
+  Sound sound;
+  sound.Load(path);
+  TEST_CHECK(sound.DurationSamples() == 3);
+  Si16 *out = sound.RawData();
+  if (TEST_CHECK(out != nullptr)) {
+    TEST_CHECK(out[0] == 0x0100);
+    TEST_CHECK(out[1] == -256);
+    TEST_CHECK(out[2] == 0x1234);
+    TEST_CHECK(out[3] == -4660);
+    TEST_CHECK(out[4] == 32767);
+    TEST_CHECK(out[5] == -32768);
+    // Writes to the samples never reach the file
+    out[0] = 7;
+    TEST_CHECK(sound.RawData()[0] == 7);
+  }
+  sound.Clear();
+  TEST_CHECK(ReadFile(path) == wav);
+
+  // Other formats are converted as before
+  std::vector<Ui8> mono = {128, 0, 255};
+  wav = build_wav(1, 44100, 8, mono);
+  WriteFile(path, wav.data(), wav.size());
+  std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+  if (TEST_CHECK(file->Open(path, true))) {
+    std::shared_ptr<SoundInstance> instance = LoadWav(file);
+    if (TEST_CHECK(instance != nullptr)) {
+      TEST_CHECK(instance->GetDurationSamples() == 3);
+      TEST_CHECK(instance->GetWavData()[0] == 0);
+      TEST_CHECK(instance->GetWavData()[2] == -32768);
+      TEST_CHECK(instance->GetWavData()[4] == 32512);
+    }
+  }
+  file = nullptr;
+  std::remove(path);
+}
+
+void test_async_loader() {
+  const char *sprite_path = "/tmp/arctic_test_async.tga";
+  const char *sound_path = "/tmp/arctic_test_async.wav";
+  Sprite source;
+  source.Create(3, 2);
+  source.Clear(Rgba(10, 20, 30));
+  source.Save(sprite_path);
+  std::vector<Ui8> pcm(4 * 100, 0x11);
+  std::vector<Ui8> wav = build_wav(2, 44100, 16, pcm);
+  WriteFile(sound_path, wav.data(), wav.size());
+
+  Si32 loaded_count = 0;
+  AsyncAsset<Sprite> sprite = LoadSpriteAsync(sprite_path,
+    [&loaded_count](Sprite &loaded) {
+      TEST_CHECK(loaded.Width() == 3);
+      ++loaded_count;
+    });
+  AsyncAsset<Sound> sound = LoadSoundAsync(sound_path, true,
+    [&loaded_count](Sound &loaded) {
+      TEST_CHECK(loaded.DurationSamples() == 100);
+      ++loaded_count;
+    });
+  AsyncAsset<Sprite> missing = LoadSpriteAsync(
+    "/tmp/arctic_test_async_missing.tga");
+  TEST_CHECK(GetPendingAsyncLoadCount() == 3);
+  WaitForAsyncLoads();
+  TEST_CHECK(GetPendingAsyncLoadCount() == 0);
+  TEST_CHECK(loaded_count == 2);
+  TEST_CHECK(sprite.IsReady() && sprite.IsLoaded());
+  TEST_CHECK(sprite.Get().Width() == 3 && sprite.Get().Height() == 2);
+  TEST_CHECK(sprite.Get().RgbaData()->rgba == Rgba(10, 20, 30).rgba);
+  TEST_CHECK(sound.IsReady() && sound.IsLoaded());
+  TEST_CHECK(missing.IsReady() && !missing.IsLoaded());
+
+  // Fonts are parsed from the bytes the I/O thread has read
+  const char *font_path = "/tmp/arctic_test_async_font.xml";
+  const char *font_sprite_path = "/tmp/arctic_test_async_font.tga";
+  Sprite font_sprite;
+  font_sprite.Create(64, 64);
+  font_sprite.Clear(Rgba(255, 255, 255, 255));
+  font_sprite.Save(font_sprite_path);
+  std::string xml = "<font type=\"ascii_square\" "
+    "path=\"arctic_test_async_font.tga\"/>";
+  WriteFile(font_path, reinterpret_cast<const Ui8*>(xml.data()), xml.size());
+  AsyncAsset<Font> font = LoadFontAsync(font_path);
+  WaitForAsyncLoads();
+  TEST_CHECK(font.IsReady() && font.IsLoaded());
+  TEST_CHECK(font.Get().FontInstance()->line_height_ == 3);
+  std::remove(font_path);
+  std::remove(font_sprite_path);
+
+  // Changing the thread counts finishes the loads in flight first
+  AsyncAsset<Sprite> again = LoadSpriteAsync(sprite_path);
+  SetAsyncLoadThreads(1, 1);
+  TEST_CHECK(again.IsReady() && again.IsLoaded());
+  
+  // Loads started by another thread while the threads restart are kept
+  std::vector<AsyncAsset<Sprite>> others;
+  std::thread starter([&others, sprite_path]() {
+    for (Si32 i = 0; i < 20; ++i) {
+      others.push_back(LoadSpriteAsync(sprite_path));
+    }
+  });
+  SetAsyncLoadThreads(0, 0);
+  starter.join();
+  WaitForAsyncLoads();
+  TEST_CHECK(GetPendingAsyncLoadCount() == 0);
+  for (AsyncAsset<Sprite> &other : others) {
+    TEST_CHECK(other.IsReady() && other.IsLoaded());
+  }
+  std::remove(sprite_path);
+  std::remove(sound_path);
+}
+
+void test_resource_cache() {
+  const char *paths[] = {"/tmp/arctic_test_cache0.tga",
+    "/tmp/arctic_test_cache1.tga", "/tmp/arctic_test_cache2.tga"};
+  for (Si32 i = 0; i < 3; ++i) {
+    Sprite source;
+    source.Create(4, 4);
+    source.Clear(Rgba(static_cast<Ui8>(i), 0, 0));
+    source.Save(paths[i]);
+  }
+  const char *sound_path = "/tmp/arctic_test_cache.wav";
+  std::vector<Ui8> pcm(4 * 10, 0x22);
+  std::vector<Ui8> wav = build_wav(2, 44100, 16, pcm);
+  WriteFile(sound_path, wav.data(), wav.size());
+
+  ResourceCache cache;
+  {
+    Sprite a = cache.GetSprite(paths[0]);
+    Sprite b = cache.GetSprite("/tmp/../tmp/./arctic_test_cache0.tga");
+    TEST_CHECK(a.SpriteInstance() == b.SpriteInstance());
+    TEST_CHECK(a.RgbaData()->r == 0);
+  }
+  ResourceCacheStats stats = cache.GetStats();
+  TEST_CHECK(stats.hits == 1 && stats.misses == 1);
+  // Pixels and opaque spans
+  const Ui64 sprite_bytes = stats.resident_bytes;
+  TEST_CHECK(sprite_bytes >= 4 * 4 * sizeof(Rgba));
+  TEST_CHECK(stats.resident_bytes_by_kind[kResourceSprite] == sprite_bytes);
+  cache.SetMemoryBudget(2 * sprite_bytes);
+
+  // The least recently used unreferenced sprite goes first
+  cache.GetSprite(paths[1]);
+  cache.GetSprite(paths[0]);
+  cache.GetSprite(paths[2]);
+  stats = cache.GetStats();
+  TEST_CHECK(stats.evictions == 1);
+  TEST_CHECK(stats.entry_count == 2);
+  cache.GetSprite(paths[0]);
+  TEST_CHECK(cache.GetStats().hits == 3);
+  cache.GetSprite(paths[1]);
+  stats = cache.GetStats();
+  TEST_CHECK(stats.misses == 4 && stats.evictions == 2);
+
+  // Sprites in use are never evicted
+  Sprite held = cache.GetSprite(paths[2]);
+  cache.SetMemoryBudget(0);
+  stats = cache.GetStats();
+  TEST_CHECK(stats.entry_count == 1);
+  TEST_CHECK(stats.resident_bytes == sprite_bytes);
+  TEST_CHECK(cache.GetSprite(paths[2]).SpriteInstance() ==
+    held.SpriteInstance());
+  held = Sprite();
+  cache.Trim();
+  TEST_CHECK(cache.GetStats().entry_count == 0);
+
+  // Load options are a part of the key, failed loads are not cached
+  cache.SetMemoryBudget(1 << 20);
+  Sound sound = cache.GetSound(sound_path);
+  TEST_CHECK(sound.DurationSamples() == 10);
+  TEST_CHECK(cache.GetSound(sound_path).GetInstance() ==
+    sound.GetInstance());
+  cache.GetSound(sound_path, false);
+  stats = cache.GetStats();
+  TEST_CHECK(stats.entry_count == 2);
+  TEST_CHECK(stats.resident_bytes_by_kind[kResourceSound] == 2 * 10 * 4);
+  cache.ResetStats();
+  TEST_CHECK(cache.GetSprite("/tmp/arctic_test_cache_missing.tga").Width()
+    == 0);
+  stats = cache.GetStats();
+  TEST_CHECK(stats.misses == 1 && stats.hits == 0 && stats.entry_count == 2);
+  cache.Clear();
+  TEST_CHECK(cache.GetStats().resident_bytes == 0);
+  TEST_CHECK(sound.DurationSamples() == 10);
+  for (const char *path : paths) {
+    std::remove(path);
+  }
+  std::remove(sound_path);
+}
+
 // ============================================================================
 // Quaternion bug tests
 // ============================================================================
@@ -2948,6 +4462,176 @@ void test_csv_roundtrip_quotes_in_field() {
   std::remove(path);
 }
 
+void test_csv_typed_columns() {
+  CsvTable table;
+  bool ok = table.LoadString(
+    "id,name,hp,speed\r\n"
+    "1,\"Orc, big\",120,1.5\r\n"
+    "\n"
+    "-7,\"say \"\"hi\"\"\",x,-0.25\r\n"
+    "2147483648,Elf,  30,2e1\n");
+  TEST_CHECK_(ok, "Load must succeed, error: %s",
+      table.GetErrorDescription().c_str());
+  TEST_CHECK(table.RowCount() == 3);
+  TEST_CHECK(table.ColumnIndex("hp") == 2);
+  TEST_CHECK(table.ColumnIndex("mana") == -1);
+
+  std::vector<Si32> ids = table.GetColumn<Si32>("id", 0);
+  TEST_CHECK(ids.size() == 3 && ids[0] == 1 && ids[1] == -7 && ids[2] == 0);
+  std::vector<Si64> ids64 = table.GetColumn<Si64>(0, Si64(0));
+  TEST_CHECK(ids64.size() == 3 && ids64[2] == 2147483648ll);
+  std::vector<Ui32> hps = table.GetColumn<Ui32>("hp", 99u);
+  TEST_CHECK(hps.size() == 3 && hps[0] == 120 && hps[1] == 99 && hps[2] == 30);
+  std::vector<float> speeds = table.GetColumn<float>("speed", 0.f);
+  TEST_CHECK(speeds.size() == 3 && speeds[0] == 1.5f && speeds[1] == -0.25f
+    && speeds[2] == 20.f);
+  std::vector<std::string> names = table.GetColumn<std::string>("name");
+  TEST_CHECK(names.size() == 3 && names[0] == "Orc, big"
+    && names[1] == "say \"hi\"" && names[2] == "Elf");
+  TEST_CHECK(table.GetColumn<Si32>("mana").empty());
+
+  // The row API stays in sync with the columns.
+  TEST_CHECK(table[1]["name"] == "say \"hi\"");
+  TEST_CHECK(table[0].GetValue<Si32>("hp", 0) == 120);
+  table[0].Set("hp", "121");
+  TEST_CHECK(table.GetColumn<Si32>("hp")[0] == 121);
+  TEST_CHECK(table.GetCell(0, 2).ToString() == "121");
+  table.AddRow(1, {"5", "Imp", "7", "3"});
+  TEST_CHECK(table.GetColumn<Si32>("hp")[1] == 7);
+  table.DeleteRow(0);
+  TEST_CHECK(table.RowCount() == 3);
+  TEST_CHECK(table.GetColumn<std::string>("name")[0] == "Imp");
+}
+
+void test_csv_stream_reader() {
+  const char *path = "/tmp/arctic_csv_test_stream.csv";
+  {
+    std::ofstream f(path, std::ios::binary);
+    f << "\xEF\xBB\xBFid,text\r\n";
+    f << "1,\"multi\nline, \"\"quoted\"\"\"\r\n";
+    f << "\r\n";
+    for (Si32 i = 2; i < 100; ++i) {
+      f << i << ",row " << i << "\n";
+    }
+    f << "100,";
+  }
+  CsvStreamReader reader(64);
+  TEST_CHECK(reader.Open(path));
+  std::vector<CsvCell> cells;
+  TEST_CHECK(reader.ReadRow(&cells));
+  TEST_CHECK(cells.size() == 2 && cells[0].ToString() == "id"
+    && cells[1].ToString() == "text");
+  TEST_CHECK(reader.ReadRow(&cells));
+  TEST_CHECK(cells.size() == 2
+    && cells[1].ToString() == "multi\nline, \"quoted\"");
+  Si32 expected_id = 2;
+  bool is_ok = reader.ForEachRow([&](const std::vector<CsvCell> &row) {
+    Si32 id = 0;
+    TEST_CHECK(row.size() == 2 && ParseCsvCell(row[0], &id));
+    TEST_CHECK(id == expected_id);
+    if (id < 100) {
+      TEST_CHECK(row[1].ToString() == "row " + std::to_string(id));
+    } else {
+      TEST_CHECK(row[1].size == 0);
+    }
+    ++expected_id;
+    return true;
+  });
+  TEST_CHECK(is_ok);
+  TEST_CHECK_(expected_id == 101, "Expected 99 data rows, got %d",
+      expected_id - 2);
+  TEST_CHECK(reader.LineNumber() == 103);
+
+  {
+    std::ofstream f(path, std::ios::binary);
+    f << "a,b\n\"" << std::string(100, 'x') << "\",c\n";
+  }
+  TEST_CHECK(reader.Open(path));
+  TEST_CHECK(reader.ReadRow(&cells));
+  TEST_CHECK(!reader.ReadRow(&cells));
+  TEST_CHECK(!reader.GetErrorDescription().empty());
+  reader.Close();
+  std::remove(path);
+}
+
+void test_csv_mid_field_quotes() {
+  const char *path = "/tmp/arctic_csv_test_mid_quotes.csv";
+  {
+    std::ofstream f(path, std::ios::binary);
+    f << "a,b,c\n";
+    f << "ab\"c,d\"e,x,\"q\"r\"s\"\"t\"\n";
+  }
+  const std::vector<std::string> expected = {"abc,de", "x", "qrs\"t"};
+  CsvTable table;
+  if (TEST_CHECK(table.LoadFile(path))) {
+    TEST_CHECK(table.RowCount() == 1);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      TEST_CHECK_(table.GetCell(0, i).ToString() == expected[i],
+        "CsvTable cell %d is \"%s\"", static_cast<int>(i),
+        table.GetCell(0, i).ToString().c_str());
+    }
+  }
+  CsvStreamReader reader;
+  std::vector<CsvCell> cells;
+  TEST_CHECK(reader.Open(path));
+  TEST_CHECK(reader.ReadRow(&cells));
+  if (TEST_CHECK(reader.ReadRow(&cells) && cells.size() == expected.size())) {
+    for (size_t i = 0; i < expected.size(); ++i) {
+      TEST_CHECK_(cells[i].ToString() == expected[i],
+        "CsvStreamReader cell %d is \"%s\"", static_cast<int>(i),
+        cells[i].ToString().c_str());
+    }
+  }
+  reader.Close();
+  std::remove(path);
+}
+
+void test_csv_parallel_load() {
+  std::string data = "id,name,value\r\n";
+  for (Si32 i = 0; i < 2000; ++i) {
+    data += std::to_string(i);
+    switch (i % 5) {
+      case 0: data += ",plain,1.5\n"; break;
+      case 1: data += ",\"with, comma\",\"2\"\r\n"; break;
+      case 2: data += ",\"multi\nline \"\"quoted\"\"\",3\n"; break;
+      case 3: data += ",\"\"\"\",4\n\n"; break;
+      default: data += ",,\n"; break;
+    }
+  }
+  CsvTable serial;
+  serial.SetParallelism(1);
+  TEST_CHECK(serial.LoadString(data));
+  TEST_CHECK(serial.RowCount() == 2000);
+  TEST_CHECK(serial.GetCell(2, 1).ToString() == "multi\nline \"quoted\"");
+  TEST_CHECK(serial.GetCell(3, 1).ToString() == "\"");
+
+  const Ui64 chunk_sizes[] = {1, 7, 64, 1000};
+  for (Ui64 chunk_size : chunk_sizes) {
+    CsvTable parallel;
+    parallel.SetParallelism(4, chunk_size);
+    TEST_CHECK(parallel.LoadString(data));
+    TEST_CHECK_(parallel.RowCount() == serial.RowCount(),
+      "chunk %d: %d rows", static_cast<Si32>(chunk_size),
+      static_cast<Si32>(parallel.RowCount()));
+    bool is_same = parallel.RowCount() == serial.RowCount();
+    for (Ui64 row = 0; is_same && row < serial.RowCount(); ++row) {
+      for (Ui64 column = 0; column < 3; ++column) {
+        is_same = is_same && parallel.GetCell(row, column).ToString() ==
+          serial.GetCell(row, column).ToString();
+      }
+    }
+    TEST_CHECK_(is_same, "chunk %d", static_cast<Si32>(chunk_size));
+  }
+
+  std::string broken = data + "2000,\"unmatched,5\n2001,x,6\n";
+  serial.LoadString(broken);
+  CsvTable parallel;
+  parallel.SetParallelism(4, 64);
+  TEST_CHECK(!parallel.LoadString(broken));
+  TEST_CHECK(parallel.GetErrorDescription() == serial.GetErrorDescription());
+  TEST_CHECK(parallel.RowCount() == 2000);
+}
+
 // Bug 62: Panel with top+bottom (or left+right) anchoring gets negative
 // size when the parent shrinks below the sum of anchor distances.
 void test_panel_anchor_no_negative_size() {
@@ -3294,6 +4978,140 @@ void test_canonicalize_before_and_after_create() {
   std::remove(filename);
 }
 
+void test_frame_arena() {
+  Ui32 *zeros = FrameAlloc<Ui32>(100);
+  bool is_zeroed = true;
+  for (Si32 i = 0; i < 100; ++i) {
+    is_zeroed = is_zeroed && zeros[i] == 0;
+  }
+  TEST_CHECK(is_zeroed);
+
+  void *aligned = FrameAllocBytes(10, 64);
+  TEST_CHECK_((reinterpret_cast<uintptr_t>(aligned) & 63) == 0,
+      "FrameAllocBytes must respect alignment, got %p", aligned);
+
+  Ui8 *large = FrameAlloc<Ui8>(FrameArena::kDefaultBlockSize * 2);
+  large[FrameArena::kDefaultBlockSize * 2 - 1] = 1;
+
+  FrameVector<Si32> values;
+  for (Si32 i = 0; i < 10000; ++i) {
+    values.push_back(i);
+  }
+  TEST_CHECK(values.size() == 10000 && values[9999] == 9999);
+
+  // Worker threads get their own sub-arena, freed when the thread exits.
+  bool is_worker_ok = false;
+  std::thread worker([&is_worker_ok]() {
+    Si32 *worker_values = FrameAlloc<Si32>(16);
+    worker_values[15] = 15;
+    is_worker_ok = (FrameArena::ThisThread().UsedBytes() >= 16 * sizeof(Si32));
+  });
+  worker.join();
+  TEST_CHECK(is_worker_ok);
+
+  FrameVector<Si32>().swap(values);
+  ResetFrameArena();
+  FrameArenaStats stats = GetFrameArenaStats();
+  TEST_CHECK_(stats.last_frame_bytes >= FrameArena::kDefaultBlockSize * 2,
+      "last_frame_bytes: %llu", (unsigned long long)stats.last_frame_bytes);
+  TEST_CHECK(stats.peak_frame_bytes >= stats.last_frame_bytes);
+  TEST_CHECK(FrameArena::ThisThread().UsedBytes() == 0);
+}
+
+void test_blocking_queue_multiple_producers() {
+  const Si32 kProducerCount = 4;
+  const Si64 kItemCount = 20000;
+  BlockingQueue<MpscVirtInfArray<Si64*, TuneDeletePayloadFlag<true>>> queue;
+  std::vector<std::thread> producers;
+  for (Si32 p = 0; p < kProducerCount; ++p) {
+    producers.emplace_back([&queue, kItemCount]() {
+      for (Si64 i = 1; i <= kItemCount; ++i) {
+        queue.Enqueue(new Si64(i));
+      }
+    });
+  }
+  Si64 sum = 0;
+  for (Si64 i = 0; i < kProducerCount * kItemCount; ++i) {
+    Si64 *item = queue.Dequeue();
+    sum += *item;
+    delete item;
+  }
+  for (std::thread &producer : producers) {
+    producer.join();
+  }
+  TEST_CHECK(sum == kProducerCount * kItemCount * (kItemCount + 1) / 2);
+  TEST_CHECK(queue.TryDequeue() == nullptr);
+}
+
+void test_profiler_frame_stats() {
+  SetProfilerEnabled(true);
+  ProfilerFrameMark();
+  for (Si32 i = 0; i < 3; ++i) {
+    ARCTIC_PROFILE_SCOPE("Test outer");
+    ARCTIC_PROFILE_SCOPE("Test inner");
+  }
+  {
+    ARCTIC_PROFILE_SCOPE("Test other");
+  }
+  ProfilerFrameMark();
+  SetProfilerEnabled(false);
+  {
+    ARCTIC_PROFILE_SCOPE("Test disabled");
+  }
+  const std::vector<ProfilerZoneStats> &stats = GetProfilerFrameStats();
+  Si32 outer_idx = -1;
+  Si32 inner_idx = -1;
+  for (size_t i = 0; i < stats.size(); ++i) {
+    if (std::string(stats[i].name) == "Test outer") {
+      outer_idx = static_cast<Si32>(i);
+    } else if (std::string(stats[i].name) == "Test inner") {
+      inner_idx = static_cast<Si32>(i);
+    }
+  }
+#ifndef ARCTIC_NO_PROFILER
+  TEST_CHECK(outer_idx >= 0);
+  TEST_CHECK(inner_idx == outer_idx + 1);
+  if (outer_idx >= 0 && inner_idx >= 0) {
+    TEST_CHECK(stats[outer_idx].count == 3);
+    TEST_CHECK(stats[inner_idx].count == 3);
+    TEST_CHECK(stats[inner_idx].depth == stats[outer_idx].depth + 1);
+    TEST_CHECK(stats[inner_idx].total_ms <= stats[outer_idx].total_ms);
+  }
+#endif  // ARCTIC_NO_PROFILER
+  ProfilerFrameMark();
+  TEST_CHECK(GetProfilerFrameStats().empty());
+}
+
+void test_profiler_thread_reuse() {
+#ifndef ARCTIC_NO_PROFILER
+  // Threads that come and go one after another share one ring
+  SetProfilerEnabled(true);
+  for (Si32 i = 0; i < 8; ++i) {
+    std::thread thread([]() {
+      SetProfilerThreadName("Test reused thread");
+      ARCTIC_PROFILE_SCOPE("Test thread zone");
+    });
+    thread.join();
+  }
+  SetProfilerEnabled(false);
+  const char *path = "/tmp/arctic_test_profiler_reuse.json";
+  SaveProfilerTrace(path);
+  std::vector<Ui8> data = ReadFile(path);
+  std::string trace(data.begin(), data.end());
+  const std::string name = "\"Test reused thread\"";
+  Si32 name_count = 0;
+  for (size_t pos = trace.find(name); pos != std::string::npos;
+      pos = trace.find(name, pos + 1)) {
+    ++name_count;
+  }
+  TEST_CHECK_(name_count == 1, "Expected 1 ring for 8 threads, got %d",
+    name_count);
+  TEST_CHECK(trace.find("\"Test thread zone\"") != std::string::npos);
+  std::remove(path);
+  ProfilerFrameMark();
+#endif  // ARCTIC_NO_PROFILER
+}
+
 TEST_LIST = {
 //  {"Tga oom", test_tga_oom},
   {"Rgba", test_rgba},
@@ -3301,6 +5119,7 @@ TEST_LIST = {
   {"Radix sort correctness", test_radix_sort_correctness},
   {"Rgb", test_rgb},
   {"File operations", test_file_operations},
+  {"Log rotation and gzip", test_log_rotation},
   {"Random generation", test_random},
   {"Localization basic load", test_localization_basic_load},
   {"Localization simple substitution", test_localization_simple_substitution},
@@ -3315,6 +5134,8 @@ TEST_LIST = {
   {"Localization Loc() function", test_localization_loc_function},
   {"Localization FormatPattern direct", test_localization_format_pattern_direct},
   {"Localization ordinal English", test_localization_ordinal_english},
+  {"Localization compiled format", test_localization_compiled_format},
+  {"Localization binary table", test_localization_binary_table},
   {"TTF font loading", test_ttf_font_loading},
   {"Find system font", test_find_system_font},
   {"Load system font", test_load_system_font},
@@ -3326,6 +5147,8 @@ TEST_LIST = {
   {"JSON error handling", test_json_error_handling},
   {"JSON modification", test_json_modification},
   {"JSON comparison", test_json_comparison},
+  {"IniFile parse and lookup", test_ini_parse_and_lookup},
+  {"IniFile keys and save", test_ini_keys_and_save},
   {"DataWriter empty initial write", test_data_writer_empty_initial_write},
   {"DataWriter multiple writes no overlap", test_data_writer_multiple_writes_no_overlap},
   {"DataWriter Ui16", test_data_writer_uint16},
@@ -3339,9 +5162,30 @@ TEST_LIST = {
   {"Data roundtrip arrays", test_data_roundtrip_arrays},
   {"DataReader past end", test_data_reader_past_end},
   {"DataWriter large sequence", test_data_writer_large_sequence},
+  {"Data byte order", test_data_byte_order},
+  {"Data varint", test_data_varint},
+  {"Data file sources", test_data_file_sources},
+  {"Compressed data roundtrip", test_compressed_data_roundtrip},
+  {"BitStream bit layout", test_bitstream_bit_layout},
+  {"BitStream roundtrip", test_bitstream_roundtrip},
+  {"Snapshot quantization", test_snapshot_quantization},
+  {"Snapshot delta replication", test_snapshot_delta_replication},
+  {"SocketPoller loopback", test_socket_poller_loopback},
+  {"DatagramSocket batch loopback", test_datagram_socket_batch},
+  {"NetConnection over a lossy link", test_net_connection_lossy_link},
+  {"NetConnection coalescing and acks", test_net_connection_coalescing},
+  {"FramedConnection loopback", test_framed_connection_loopback},
+  {"EventScheduler ordering and cancel", test_event_scheduler},
+  {"NetSim clients download the level", test_net_sim},
+  {"NetSim batch is reproducible from seeds", test_net_sim_batch_reproducible},
   {"Sound resample returns nullptr", test_sound_resample_returns_nullptr},
   {"Sound 8-bit stereo wrong offset", test_sound_8bit_stereo_wrong_offset},
   {"Sound 8-bit signed vs unsigned", test_sound_8bit_signed_vs_unsigned},
+  {"Sound LoadWav from a mapped file", test_sound_load_mapped_wav},
+  {"Async asset loading", test_async_loader},
+  {"ResourceCache LRU under a memory budget", test_resource_cache},
+  {"MappedFile read-only and copy-on-write", test_mapped_file},
+  {"AssetPack build, lookup and mount", test_asset_pack},
   {"Quaternion ToMat33F sign error", test_quat_to_mat33f_sign},
   {"Quaternion ToPartialMatrix33F sign error", test_quat_to_partial_mat33f_sign},
   {"Quaternion slerp uses unnormalized inputs", test_quat_slerp_unnormalized},
@@ -3393,6 +5237,10 @@ TEST_LIST = {
   {"SetLookat degenerate returns identity", test_lookat_degenerate_returns_identity},
   {"CSV round-trip: separator in field", test_csv_roundtrip_separator_in_field},
   {"CSV round-trip: quotes in field", test_csv_roundtrip_quotes_in_field},
+  {"CSV typed columns", test_csv_typed_columns},
+  {"CSV stream reader", test_csv_stream_reader},
+  {"CSV readers split mid-field quotes alike", test_csv_mid_field_quotes},
+  {"CSV parallel load", test_csv_parallel_load},
   {"Panel anchor: no negative size on parent shrink", test_panel_anchor_no_negative_size},
   {"SetPerspective y == cot(fovy/2)", test_perspective_y_equals_cot_half_fovy},
   {"SetPerspective matches SetFrustumPerspective", test_perspective_matches_frustum_perspective},
@@ -3403,6 +5251,10 @@ TEST_LIST = {
   {"SetOrtho consistent with Perspective at z=near", test_ortho_consistent_with_perspective},
   {"CanonicalizePath non-existent path", test_canonicalize_nonexistent_path},
   {"CanonicalizePath before and after file create", test_canonicalize_before_and_after_create},
+  {"Frame arena", test_frame_arena},
+  {"BlockingQueue multiple producers", test_blocking_queue_multiple_producers},
+  {"Profiler frame stats", test_profiler_frame_stats},
+  {"Profiler reuses rings of exited threads", test_profiler_thread_reuse},
   {0}
 };
 